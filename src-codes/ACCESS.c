@@ -0,0 +1,69 @@
+/**
+ * ============================================
+ * ACCESS
+ * The card moves main.c makes once a scan has
+ * resolved to a door move: the zone capacity
+ * check, the zone counts, the card's zone and
+ * the street <-> venue totals. Feedback (LEDs,
+ * LCD, gate) stays with the caller, so the same
+ * object runs on the host under the crowd
+ * simulator.
+ * ============================================
+ */
+
+#include "ACCESS.h"
+#include "ZONES.h"
+#include "FLOWRATE.h"
+#include "DELAY.h"
+#include <string.h>
+
+Access_Counts_t access_counts;
+
+void access_reset(void) {
+    memset(&access_counts, 0, sizeof(access_counts));
+}
+
+// Move through a door toward the inner zone; 0 = zone full
+uint8_t access_entry(Card_t *card, uint8_t to_zone, uint32_t tick) {
+    if(!zones_has_room(to_zone)) {
+        return 0;
+    }
+
+    if(!zones_move(card->zone, to_zone)) {
+        return 0;
+    }
+
+    // Room totals count street -> venue only
+    if(card->zone == ZONE_OUTSIDE) {
+        access_counts.entries++;
+        access_counts.inside++;
+        flowrate_record(FLOW_ENTRY, millis());
+    }
+
+    card->zone = to_zone;
+    card->scan_count++;
+    card->last_scan_time = tick;
+    return 1;
+}
+
+// Move toward the street; 0 = card not inside / not a neighbour
+uint8_t access_exit(Card_t *card, uint8_t to_zone, uint32_t tick) {
+    if(card->zone == ZONE_OUTSIDE) {
+        return 0;
+    }
+
+    if(!zones_move(card->zone, to_zone)) {
+        return 0;
+    }
+
+    card->zone = to_zone;
+    card->scan_count++;
+    card->last_scan_time = tick;
+
+    if(to_zone == ZONE_OUTSIDE) {
+        access_counts.exits++;
+        access_counts.inside--;
+        flowrate_record(FLOW_EXIT, millis());
+    }
+    return 1;
+}
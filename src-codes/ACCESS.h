@@ -0,0 +1,30 @@
+/**
+ * ============================================
+ * ACCESS HEADER
+ * Entry/exit decisions and venue totals
+ * (no hardware: linked as-is by tools/crowd_sim.c)
+ * ============================================
+ */
+
+#ifndef ACCESS_H
+#define ACCESS_H
+
+#include <stdint.h>
+#include "CARDDB.h"
+
+typedef struct {
+    int16_t inside;             // Street -> venue minus venue -> street
+    uint16_t entries;
+    uint16_t exits;
+} Access_Counts_t;
+
+extern Access_Counts_t access_counts;
+
+// ============================================
+// Function Prototypes
+// ============================================
+void access_reset(void);
+uint8_t access_entry(Card_t *card, uint8_t to_zone, uint32_t tick);
+uint8_t access_exit(Card_t *card, uint8_t to_zone, uint32_t tick);
+
+#endif // ACCESS_H
@@ -0,0 +1,261 @@
+/**
+ * ============================================
+ * ADC BURST ACQUISITION (GPDMA Ring)
+ * ADC runs in burst mode over ADC_BURST_CHANNELS.
+ * GPDMA channel 0 copies every ADGDR result into
+ * a circular ring (self-linked LLI), so sampling
+ * never needs the CPU. ADC_Burst_Update() turns
+ * the ring into oversampled average, moving median
+ * and EWMA per channel; the getters never block.
+ * Each ring wrap raises a terminal-count IRQ that
+ * posts EV_SENSOR_READY; at most one is queued.
+ * Between sensor samples the ADC is powered down
+ * and its clocks gated (ADC_Burst_Suspend); the
+ * sample task resumes it ADC_RESUME_MS ahead.
+ * ============================================
+ */
+
+#include "ADC_BURST.h"
+#include "EVENTBUS.h"
+
+// ============================================
+// GPDMA Linked List Item
+// ============================================
+typedef struct {
+    uint32_t src;
+    uint32_t dst;
+    uint32_t next;
+    uint32_t control;
+} ADC_DMA_LLI_t;
+
+// DMACCControl: TransferSize | SWidth=32bit | DWidth=32bit | DI | I
+#define ADC_DMA_CONTROL  ((ADC_RING_SIZE & 0xFFF) | (2 << 18) | (2 << 21) | \
+                          (1 << 27) | (1UL << 31))
+
+static volatile uint32_t adc_ring[ADC_RING_SIZE];
+static ADC_DMA_LLI_t adc_lli;
+static ADC_Filter_t adc_filter[ADC_NUM_CHANNELS];
+static volatile uint8_t adc_ready_posted = 0;   // Cleared by ADC_Burst_Update
+static uint8_t adc_running = 0;
+
+#define ADC_PCONP  ((1 << 12) | (1 << 29))         // PCADC, PCGPDMA
+
+// ============================================
+// Empty ring, channel 0 pointed at its start
+// ============================================
+static void adc_dma_arm(void) {
+    uint8_t i;
+
+    for(i = 0; i < ADC_RING_SIZE; i++) {
+        adc_ring[i] = 0;                    // DONE clear: slot not filled yet
+    }
+
+    LPC_GPDMA->DMACConfig = 0x01;           // Enable GPDMA, little endian
+    while(!(LPC_GPDMA->DMACConfig & 0x01));
+
+    LPC_GPDMA->DMACIntTCClear = (1 << ADC_DMA_CH_NUM);
+    LPC_GPDMA->DMACIntErrClr = (1 << ADC_DMA_CH_NUM);
+
+    ADC_DMA_CHANNEL->DMACCSrcAddr = adc_lli.src;
+    ADC_DMA_CHANNEL->DMACCDestAddr = adc_lli.dst;
+    ADC_DMA_CHANNEL->DMACCLLI = adc_lli.next;
+    ADC_DMA_CHANNEL->DMACCControl = adc_lli.control;
+
+    // [0] E, [5:1] SrcPeripheral = ADC, [13:11] TransferType = P2M,
+    // [15] ITC: terminal count (every ring wrap) reaches DMA_IRQHandler
+    ADC_DMA_CHANNEL->DMACCConfig = (1 << 0) |
+                                   (ADC_DMA_REQ_ADC << 1) |
+                                   (2 << 11) |
+                                   (1 << 15);
+}
+
+// ============================================
+// Initialize ADC burst mode + DMA ring
+// ============================================
+void ADC_Burst_Init(void) {
+    // Enable ADC (PCADC bit 12) and GPDMA (PCGPDMA bit 29) power
+    LPC_SC->PCONP |= ADC_PCONP;
+
+    // Configure P0.24 as AD0.1 (PINSEL1[17:16] = 01)
+    LPC_PINCON->PINSEL1 &= ~(3 << 16);
+    LPC_PINCON->PINSEL1 |= (1 << 16);
+
+    // Power up ADC first, burst is enabled after DMA is armed
+    LPC_ADC->ADCR = (ADC_BURST_CHANNELS & 0xFF) |
+                    (ADC_CLKDIV << 8) |
+                    (1 << 21);              // PDN: ADC operational
+
+    // Global DONE raises the ADC DMA request (ADGINTEN)
+    LPC_ADC->ADINTEN = (1 << 8);
+
+    // Self-linked LLI turns the single transfer into a ring
+    adc_lli.src = (uint32_t)&LPC_ADC->ADGDR;
+    adc_lli.dst = (uint32_t)&adc_ring[0];
+    adc_lli.next = (uint32_t)&adc_lli;
+    adc_lli.control = ADC_DMA_CONTROL;
+
+    adc_dma_arm();
+    NVIC_EnableIRQ(DMA_IRQn);
+
+    // Start burst conversions (START field must stay 000)
+    LPC_ADC->ADCR |= (1 << 16);
+    adc_running = 1;
+}
+
+// ============================================
+// Duty cycling: off between sensor samples
+// ============================================
+void ADC_Burst_Suspend(void) {
+    if(!adc_running) return;
+
+    LPC_ADC->ADCR &= ~((1 << 16) | (1 << 21));      // Burst off, PDN: power down
+    ADC_DMA_CHANNEL->DMACCConfig = 0;               // Channel off (ring is stale now)
+    LPC_GPDMA->DMACIntTCClear = (1 << ADC_DMA_CH_NUM);
+    NVIC_ClearPendingIRQ(DMA_IRQn);
+
+    LPC_SC->PCONP &= ~ADC_PCONP;
+    adc_running = 0;
+}
+
+// Fresh samples only: the ring starts empty, the filters keep
+// their history across the gap
+void ADC_Burst_Resume(void) {
+    if(adc_running) return;
+
+    LPC_SC->PCONP |= ADC_PCONP;
+    adc_dma_arm();
+
+    LPC_ADC->ADCR |= (1 << 21);
+    LPC_ADC->ADCR |= (1 << 16);
+    adc_running = 1;
+}
+
+uint8_t ADC_Burst_IsRunning(void) {
+    return adc_running;
+}
+
+// ============================================
+// GPDMA terminal count: a full ring of new samples
+// ============================================
+void DMA_IRQHandler(void) {
+    if(LPC_GPDMA->DMACIntTCStat & (1 << ADC_DMA_CH_NUM)) {
+        LPC_GPDMA->DMACIntTCClear = (1 << ADC_DMA_CH_NUM);
+
+        if(!adc_ready_posted &&
+           eventbus_post(EVQ_DMA, EV_SENSOR_READY, ADC_BURST_CHANNELS, 0, 0)) {
+            adc_ready_posted = 1;
+        }
+    }
+
+    if(LPC_GPDMA->DMACIntErrStat & (1 << ADC_DMA_CH_NUM)) {
+        LPC_GPDMA->DMACIntErrClr = (1 << ADC_DMA_CH_NUM);
+    }
+}
+
+// ============================================
+// Median of the averaging history (small insertion sort)
+// ============================================
+static uint16_t adc_median(const ADC_Filter_t *f) {
+    uint16_t sorted[ADC_MEDIAN_WINDOW];
+    uint8_t i, j;
+
+    for(i = 0; i < f->history_count; i++) {
+        uint16_t v = f->history[i];
+        j = i;
+        while(j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+
+    return sorted[f->history_count / 2];
+}
+
+// ============================================
+// Fold the current ring contents into the filters
+// ============================================
+void ADC_Burst_Update(void) {
+    uint32_t sum[ADC_NUM_CHANNELS] = {0};
+    uint16_t count[ADC_NUM_CHANNELS] = {0};
+    uint16_t last[ADC_NUM_CHANNELS] = {0};
+    uint32_t write_idx;
+    uint16_t i;
+    uint8_t ch;
+
+    adc_ready_posted = 0;
+
+    // Registers are not readable with the clock gated
+    if(!adc_running) {
+        return;
+    }
+
+    // DMA destination tells where the next sample lands (= oldest)
+    write_idx = (ADC_DMA_CHANNEL->DMACCDestAddr - (uint32_t)&adc_ring[0]) / 4;
+    if(write_idx >= ADC_RING_SIZE) {
+        write_idx = 0;
+    }
+
+    for(i = 0; i < ADC_RING_SIZE; i++) {
+        uint32_t sample = adc_ring[(write_idx + i) % ADC_RING_SIZE];
+
+        if(!(sample & (1UL << 31))) {
+            continue;                       // Slot not filled yet
+        }
+
+        ch = (sample >> 24) & 0x07;
+        last[ch] = (sample >> 4) & 0xFFF;
+        sum[ch] += last[ch];
+        count[ch]++;
+    }
+
+    for(ch = 0; ch < ADC_NUM_CHANNELS; ch++) {
+        ADC_Filter_t *f = &adc_filter[ch];
+
+        if(count[ch] == 0) {
+            continue;
+        }
+
+        f->raw = last[ch];
+        f->average = (uint16_t)((sum[ch] + count[ch] / 2) / count[ch]);
+
+        f->history[f->history_pos] = f->average;
+        f->history_pos = (f->history_pos + 1) % ADC_MEDIAN_WINDOW;
+        if(f->history_count < ADC_MEDIAN_WINDOW) {
+            f->history_count++;
+        }
+        f->median = adc_median(f);
+
+        if(!f->valid) {
+            f->ewma_q4 = (uint32_t)f->average << 4;
+            f->valid = 1;
+        } else {
+            f->ewma_q4 = f->ewma_q4 + (((int32_t)((uint32_t)f->average << 4) -
+                                        (int32_t)f->ewma_q4) >> ADC_EWMA_SHIFT);
+        }
+        f->ewma = (uint16_t)((f->ewma_q4 + 8) >> 4);
+    }
+}
+
+// ============================================
+// Non-blocking getters
+// ============================================
+uint16_t ADC_Burst_GetRaw(uint8_t channel) {
+    return (channel < ADC_NUM_CHANNELS) ? adc_filter[channel].raw : 0;
+}
+
+uint16_t ADC_Burst_GetAverage(uint8_t channel) {
+    return (channel < ADC_NUM_CHANNELS) ? adc_filter[channel].average : 0;
+}
+
+uint16_t ADC_Burst_GetMedian(uint8_t channel) {
+    return (channel < ADC_NUM_CHANNELS) ? adc_filter[channel].median : 0;
+}
+
+uint16_t ADC_Burst_GetEwma(uint8_t channel) {
+    return (channel < ADC_NUM_CHANNELS) ? adc_filter[channel].ewma : 0;
+}
+
+uint8_t ADC_Burst_IsValid(uint8_t channel) {
+    return (channel < ADC_NUM_CHANNELS) ? adc_filter[channel].valid : 0;
+}
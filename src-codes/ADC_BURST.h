@@ -0,0 +1,55 @@
+#ifndef ADC_BURST_H
+#define ADC_BURST_H
+
+#include "LPC17xx.h"
+#include <stdint.h>
+
+// ============================================
+// ADC Burst + GPDMA Configuration
+// ============================================
+// Channels sampled continuously in burst mode (bit n = AD0.n).
+// Add a bit here (and the matching PINSEL setup in ADC_Burst_Init)
+// for every extra gas sensor.
+#define ADC_BURST_CHANNELS   (1 << 1)   // AD0.1 = P0.24 (MQ135)
+
+#define ADC_NUM_CHANNELS     8
+#define ADC_RING_SIZE        64         // DMA sample ring (words)
+#define ADC_MEDIAN_WINDOW    5          // Moving median over averages
+#define ADC_EWMA_SHIFT       3          // EWMA alpha = 1/8
+#define ADC_CLKDIV           255        // 25MHz / 256 = ~98kHz ADC clock
+#define ADC_RESUME_MS        250        // Burst time before a reading (~6 ring wraps)
+
+#define ADC_DMA_CHANNEL      LPC_GPDMACH0
+#define ADC_DMA_CH_NUM       0
+#define ADC_DMA_REQ_ADC      4          // GPDMA request line for ADC
+
+// ============================================
+// Per-Channel Filter State
+// ============================================
+typedef struct {
+    uint16_t raw;                          // Most recent conversion
+    uint16_t average;                      // Oversampled average of last sweep
+    uint16_t median;                       // Moving median of averages
+    uint16_t ewma;                         // EWMA of averages (12-bit)
+    uint32_t ewma_q4;                      // EWMA accumulator (12.4 fixed point)
+    uint16_t history[ADC_MEDIAN_WINDOW];   // Last averages for the median
+    uint8_t history_count;
+    uint8_t history_pos;
+    uint8_t valid;                         // At least one sample seen
+} ADC_Filter_t;
+
+// ============================================
+// Function Prototypes
+// ============================================
+void ADC_Burst_Init(void);
+void ADC_Burst_Update(void);
+void ADC_Burst_Suspend(void);
+void ADC_Burst_Resume(void);
+uint8_t ADC_Burst_IsRunning(void);
+uint16_t ADC_Burst_GetRaw(uint8_t channel);
+uint16_t ADC_Burst_GetAverage(uint8_t channel);
+uint16_t ADC_Burst_GetMedian(uint8_t channel);
+uint16_t ADC_Burst_GetEwma(uint8_t channel);
+uint8_t ADC_Burst_IsValid(uint8_t channel);
+
+#endif // ADC_BURST_H
@@ -0,0 +1,761 @@
+/**
+ * ============================================
+ * CARD DATABASE
+ * - Fixed slot table + open-addressing hash index
+ *   on the 4-byte UID: O(1) add/revoke/lookup
+ * - Delta sync over the UART3 downlink (ESP32):
+ *
+ *   DB,ADD,<uid8hex>,<name>,<group>   upsert
+ *   DB,UPD,<uid8hex>,<name>,<group>   upsert (alias)
+ *   DB,REV,<uid8hex>                  revoke
+ *   DB,BEGIN,<version>                start batch (= current + 1)
+ *   DB,COMMIT                         apply staged batch at once
+ *   DB,ABORT                          drop staged batch
+ *   DB,VER                            report version
+ *
+ * Names keep 8 characters, groups 15.
+ *
+ * Batches are staged and applied in one go from
+ * the main loop, between two scans, so card_find()
+ * never sees a half-applied batch. Single ops
+ * outside a batch bump the version by one.
+ * A revoked card that is still inside keeps its
+ * record until it exits, so it can leave.
+ *
+ * A Bloom filter over the indexed UIDs answers
+ * "definitely not registered" with 3 bit tests;
+ * bits cannot be cleared, so freed slots leave
+ * stale bits and the filter is rebuilt once
+ * enough of them have piled up.
+ *
+ * Read-only tiers (CARDMPH_ENABLE: const table
+ * in ROM, FLASHIDX_ENABLE: SPI flash index) are
+ * tried when a UID is not held in RAM; a hit is
+ * copied into a slot (CARD_SRC_ROM/FLASH). Those
+ * copies are evicted, oldest scan first, when
+ * slots run out and the card is not inside.
+ * Revoking a tier card keeps its UID in a RAM
+ * list that hides it until the next build.
+ * Cards admitted on a card credential
+ * (CREDENTIAL_ENABLE) are held the same way
+ * (CARD_SRC_CRED) while they are inside.
+ * ============================================
+ */
+
+#include "CARDDB.h"
+#include "uart.h"
+#include "UARTLINK.h"
+#include "UPLINK.h"
+#include "DELAY.h"
+#include <stdio.h>
+#include <string.h>
+
+#define INDEX_EMPTY  0x0000
+#define INDEX_TOMB   0xFFFF
+
+#define CARDDB_OP_ADD     1
+#define CARDDB_OP_REVOKE  2
+
+typedef struct {
+    uint8_t op;
+    uint8_t uid[4];
+    char name[CARDDB_NAME_LEN];
+    char group[CARDDB_GROUP_LEN];
+} CardDB_Op_t;
+
+Card_t cards[CARDDB_MAX_CARDS];
+CardDB_Stats_t carddb_stats;
+
+static char card_groups[CARDDB_MAX_GROUPS][CARDDB_GROUP_LEN];
+static uint8_t group_count = 0;
+
+static uint16_t card_index[CARDDB_HASH_SIZE];   // slot + 1, 0 = empty
+static uint16_t free_slots[CARDDB_MAX_CARDS];
+static uint16_t free_count = 0;
+static uint16_t tomb_count = 0;
+static uint16_t active_count = 0;
+static uint32_t db_version = 0;
+
+static uint32_t card_bloom[CARDDB_BLOOM_BITS / 32];
+static uint16_t bloom_stale = 0;         // Slots freed since the last rebuild
+
+#if CARDDB_TIERS
+static uint32_t tier_revoked[CARDDB_REVOKE_MAX];
+static uint8_t tier_revoked_count = 0;
+#endif
+
+// Downlink parser / batch staging
+static char line_buf[CARDDB_LINE_MAX];
+static uint8_t line_len = 0;
+static uint8_t line_overflow = 0;
+static CardDB_Op_t batch[CARDDB_BATCH_MAX];
+static uint8_t batch_len = 0;
+static uint8_t batch_open = 0;
+static uint8_t batch_overflow = 0;
+static uint32_t batch_version = 0;
+
+// ============================================
+// Hash Index
+// ============================================
+static uint32_t uid_key(const uint8_t *uid) {
+    return (uint32_t)uid[0] | ((uint32_t)uid[1] << 8) |
+           ((uint32_t)uid[2] << 16) | ((uint32_t)uid[3] << 24);
+}
+
+static uint16_t uid_hash(const uint8_t *uid) {
+    return (uint16_t)((uint32_t)(uid_key(uid) * 2654435761UL) >> (32 - CARDDB_HASH_BITS));
+}
+
+static int16_t index_lookup(const uint8_t *uid, uint16_t *pos_out) {
+    uint16_t pos = uid_hash(uid);
+
+    for(uint32_t n = 0; n < CARDDB_HASH_SIZE; n++) {
+        uint16_t e = card_index[pos];
+
+        if(e == INDEX_EMPTY) {
+            return -1;
+        }
+        if(e != INDEX_TOMB && memcmp(cards[e - 1].uid, uid, 4) == 0) {
+            if(pos_out) *pos_out = pos;
+            return (int16_t)(e - 1);
+        }
+        pos = (pos + 1) & (CARDDB_HASH_SIZE - 1);
+    }
+    return -1;
+}
+
+static void index_insert(uint16_t slot) {
+    uint16_t pos = uid_hash(cards[slot].uid);
+
+    while(card_index[pos] != INDEX_EMPTY && card_index[pos] != INDEX_TOMB) {
+        pos = (pos + 1) & (CARDDB_HASH_SIZE - 1);
+    }
+    if(card_index[pos] == INDEX_TOMB) {
+        tomb_count--;
+    }
+    card_index[pos] = slot + 1;
+}
+
+static void index_rebuild(void) {
+    memset(card_index, 0, sizeof(card_index));
+    tomb_count = 0;
+    for(uint16_t i = 0; i < CARDDB_MAX_CARDS; i++) {
+        if(cards[i].is_active || cards[i].zone) {
+            index_insert(i);
+        }
+    }
+}
+
+static void slot_free(int16_t idx, uint16_t pos) {
+    card_index[pos] = INDEX_TOMB;
+    tomb_count++;
+    memset(&cards[idx], 0, sizeof(Card_t));
+    free_slots[free_count++] = (uint16_t)idx;
+    bloom_stale++;
+
+    // Long probe chains of tombstones: compact (rare, O(n))
+    if(tomb_count > CARDDB_HASH_SIZE / 4) {
+        index_rebuild();
+    }
+}
+
+// ============================================
+// Bloom Filter (double hashing: h1 + i*h2)
+// ============================================
+static void bloom_add(const uint8_t *uid) {
+    uint32_t k = uid_key(uid);
+    uint32_t h1 = k * 2654435761UL;
+    uint32_t h2 = ((k ^ (k >> 16)) * 0x85EBCA6BUL) | 1;
+
+    for(uint8_t i = 0; i < CARDDB_BLOOM_K; i++) {
+        uint32_t bit = h1 >> (32 - CARDDB_BLOOM_BITS_LOG2);
+        card_bloom[bit >> 5] |= (1UL << (bit & 31));
+        h1 += h2;
+    }
+}
+
+static uint8_t bloom_test(const uint8_t *uid) {
+    uint32_t k = uid_key(uid);
+    uint32_t h1 = k * 2654435761UL;
+    uint32_t h2 = ((k ^ (k >> 16)) * 0x85EBCA6BUL) | 1;
+
+    for(uint8_t i = 0; i < CARDDB_BLOOM_K; i++) {
+        uint32_t bit = h1 >> (32 - CARDDB_BLOOM_BITS_LOG2);
+        if(!(card_bloom[bit >> 5] & (1UL << (bit & 31)))) {
+            return 0;
+        }
+        h1 += h2;
+    }
+    return 1;
+}
+
+static void bloom_rebuild(void) {
+    memset(card_bloom, 0, sizeof(card_bloom));
+    for(uint16_t i = 0; i < CARDDB_MAX_CARDS; i++) {
+        if(cards[i].is_active || cards[i].zone) {
+            bloom_add(cards[i].uid);
+        }
+    }
+    bloom_stale = 0;
+}
+
+// 0 = UID is certainly not in the store (no index probe needed)
+uint8_t carddb_maybe_known(const uint8_t *uid) {
+    // Stale bits only cost false positives; rebuild once they pile up
+    if(bloom_stale > CARDDB_MAX_CARDS / 8) {
+        bloom_rebuild();
+    }
+    if(!bloom_test(uid)) {
+        carddb_stats.bloom_rejects++;
+        return 0;
+    }
+    return 1;
+}
+
+// ============================================
+// Slot Allocation
+// ============================================
+#if CARDDB_COPIES
+static int16_t copy_victim(void) {
+    int16_t victim = -1;
+
+    for(uint16_t i = 0; i < CARDDB_MAX_CARDS; i++) {
+        if(cards[i].source != CARD_SRC_LOCAL && cards[i].is_active &&
+           !cards[i].zone &&
+           (victim < 0 || cards[i].last_scan_time < cards[victim].last_scan_time)) {
+            victim = (int16_t)i;
+        }
+    }
+    return victim;
+}
+
+static uint16_t copy_evictable(void) {
+    uint16_t n = 0;
+    for(uint16_t i = 0; i < CARDDB_MAX_CARDS; i++) {
+        if(cards[i].source != CARD_SRC_LOCAL && cards[i].is_active && !cards[i].zone) {
+            n++;
+        }
+    }
+    return n;
+}
+#endif
+
+static int16_t slot_alloc(void) {
+#if CARDDB_COPIES
+    if(free_count == 0) {
+        uint16_t pos;
+        int16_t victim = copy_victim();
+
+        if(victim < 0 || index_lookup(cards[victim].uid, &pos) != victim) {
+            return -1;
+        }
+        cards[victim].is_active = 0;
+        active_count--;
+        slot_free(victim, pos);
+        carddb_stats.copy_evictions++;
+    }
+#endif
+    if(free_count == 0) return -1;
+    return (int16_t)free_slots[--free_count];
+}
+
+// ============================================
+// Groups (interned, cards store a 1-byte id)
+// ============================================
+static int8_t group_find(const char *name) {
+    for(uint8_t i = 0; i < group_count; i++) {
+        if(strncmp(card_groups[i], name, CARDDB_GROUP_LEN - 1) == 0) {
+            return (int8_t)i;
+        }
+    }
+    return -1;
+}
+
+static int8_t group_intern(const char *name) {
+    int8_t id = group_find(name);
+
+    if(id >= 0) return id;
+    if(group_count >= CARDDB_MAX_GROUPS) return -1;
+
+    strncpy(card_groups[group_count], name, CARDDB_GROUP_LEN - 1);
+    card_groups[group_count][CARDDB_GROUP_LEN - 1] = '\0';
+    return (int8_t)group_count++;
+}
+
+const char* card_group_name(const Card_t *card) {
+    return (card->group_id < group_count) ? card_groups[card->group_id] : "";
+}
+
+// ============================================
+// Store Operations
+// ============================================
+void carddb_init(void) {
+    memset(cards, 0, sizeof(cards));
+    memset(card_index, 0, sizeof(card_index));
+    memset(card_bloom, 0, sizeof(card_bloom));
+    bloom_stale = 0;
+#if CARDDB_TIERS
+    tier_revoked_count = 0;
+#endif
+    group_count = 0;
+    tomb_count = 0;
+    active_count = 0;
+    db_version = 0;
+    batch_open = 0;
+    line_len = 0;
+
+    // Pop order hands out the lowest slot first
+    free_count = CARDDB_MAX_CARDS;
+    for(uint16_t i = 0; i < CARDDB_MAX_CARDS; i++) {
+        free_slots[i] = CARDDB_MAX_CARDS - 1 - i;
+    }
+}
+
+// Add or update (upsert); returns slot or -1 when full
+int16_t carddb_add(const uint8_t *uid, const char *name, const char *group) {
+    int8_t gid = group_intern(group);
+    int16_t idx;
+
+    if(gid < 0) return -1;
+
+    idx = index_lookup(uid, 0);
+    if(idx < 0) {
+        idx = slot_alloc();
+        if(idx < 0) return -1;
+        memset(&cards[idx], 0, sizeof(Card_t));
+        memcpy(cards[idx].uid, uid, 4);
+        index_insert((uint16_t)idx);
+        bloom_add(uid);
+    }
+
+    strncpy(cards[idx].card_name, name, CARDDB_NAME_LEN - 1);
+    cards[idx].card_name[CARDDB_NAME_LEN - 1] = '\0';
+    cards[idx].group_id = (uint8_t)gid;
+    cards[idx].source = CARD_SRC_LOCAL;
+    if(!cards[idx].is_active) {
+        cards[idx].is_active = 1;
+        active_count++;
+    }
+    return idx;
+}
+
+#if CARDDB_TIERS
+// ============================================
+// Read-only Tiers (ROM table, SPI flash)
+// ============================================
+static uint8_t tier_is_revoked(uint32_t key) {
+    for(uint8_t i = 0; i < tier_revoked_count; i++) {
+        if(tier_revoked[i] == key) return 1;
+    }
+    return 0;
+}
+
+// Copy a tier card into a RAM slot; -1 if no tier has it
+static int16_t tier_load(const uint8_t *uid) {
+    char name[CARDDB_NAME_LEN];
+    int16_t idx;
+
+    if(tier_is_revoked(uid_key(uid))) return -1;
+
+#if CARDMPH_ENABLE
+    {
+        const CardMph_Record_t *rec = cardmph_find(uid);
+
+        if(rec && (rec->flags & CARDMPH_ACTIVE)) {
+            memcpy(name, rec->name, CARDMPH_NAME_LEN);
+            name[CARDMPH_NAME_LEN] = '\0';
+            idx = carddb_add(uid, name, cardmph_group_name(rec->group));
+            if(idx < 0) return -1;          // No evictable slot / group table full
+
+            cards[idx].source = CARD_SRC_ROM;
+            carddb_stats.rom_loads++;
+            return idx;
+        }
+    }
+#endif
+
+#if FLASHIDX_ENABLE
+    {
+        FlashIdx_Record_t rec;
+        char group[FLASHIDX_GROUP_LEN];
+
+        if(flashidx_lookup(uid, &rec)) {
+            memcpy(name, rec.name, sizeof(rec.name));
+            name[sizeof(rec.name)] = '\0';
+            idx = carddb_add(uid, name, flashidx_group_name(rec.group, group));
+            if(idx < 0) return -1;
+
+            cards[idx].source = CARD_SRC_FLASH;
+            carddb_stats.flash_loads++;
+            return idx;
+        }
+    }
+#endif
+
+    return -1;
+}
+
+// Hide a tier card until the next build; 0 = list full
+static uint8_t tier_revoke(const uint8_t *uid) {
+    uint32_t key = uid_key(uid);
+    uint8_t present = 0;
+
+#if CARDMPH_ENABLE
+    present |= (cardmph_find(uid) != 0);
+#endif
+#if FLASHIDX_ENABLE
+    present |= flashidx_lookup(uid, 0);
+#endif
+
+    if(!present || tier_is_revoked(key)) return 1;
+    if(tier_revoked_count >= CARDDB_REVOKE_MAX) return 0;
+
+    tier_revoked[tier_revoked_count++] = key;
+    return 1;
+}
+#endif // CARDDB_TIERS
+
+// Revoke (idempotent); record stays while the card is inside
+// 0 = flash revocation list full
+uint8_t carddb_revoke(const uint8_t *uid) {
+    uint16_t pos;
+    int16_t idx;
+
+#if CARDDB_TIERS
+    if(!tier_revoke(uid)) return 0;
+#endif
+
+    idx = index_lookup(uid, &pos);
+    if(idx < 0) return 1;
+
+    if(cards[idx].is_active) {
+        cards[idx].is_active = 0;
+        active_count--;
+    }
+    if(!cards[idx].zone) {
+        slot_free(idx, pos);
+    }
+    return 1;
+}
+
+// Active cards, plus revoked cards that are still inside (exit only)
+int16_t card_find(const uint8_t *uid) {
+    return index_lookup(uid, 0);
+}
+
+// Scan path: Bloom filter -> RAM index -> ROM table -> flash index
+int16_t carddb_lookup(const uint8_t *uid) {
+    int16_t idx = -1;
+
+    if(carddb_maybe_known(uid)) {
+        idx = index_lookup(uid, 0);
+    }
+
+#if CARDDB_TIERS
+    if(idx < 0) {
+        idx = tier_load(uid);
+    }
+#endif
+
+    return idx;
+}
+
+// Right after anticollision: warm the flash page cache for this UID
+void carddb_prefetch(const uint8_t *uid) {
+#if FLASHIDX_ENABLE
+    if(flashidx_ready() && index_lookup(uid, 0) < 0) {
+        flashidx_prefetch(uid);
+    }
+#else
+    (void)uid;
+#endif
+}
+
+// Exit recorded: drop a revoked card's record
+void carddb_card_left(int16_t idx) {
+    uint16_t pos;
+
+    if(idx < 0 || cards[idx].is_active) return;
+    if(index_lookup(cards[idx].uid, &pos) == idx) {
+        slot_free(idx, pos);
+    }
+}
+
+#if CREDENTIAL_ENABLE
+// Verified card credential, no record anywhere: RAM copy
+// while the card is inside, evicted like a tier copy after.
+// Name = last 3 UID bytes; groups beyond the table share one
+int16_t carddb_add_credential(const uint8_t *uid, uint8_t group) {
+    char name[CARDDB_NAME_LEN];
+    char gname[CARDDB_GROUP_LEN];
+    int16_t idx;
+
+    sprintf(name, "%02X%02X%02X", uid[1], uid[2], uid[3]);
+    sprintf(gname, "CRED GRP %u", group);
+
+    idx = carddb_add(uid, name, gname);
+    if(idx < 0) idx = carddb_add(uid, name, "CRED GRP");
+    if(idx < 0) return -1;
+
+    cards[idx].source = CARD_SRC_CRED;
+    carddb_stats.cred_loads++;
+    return idx;
+}
+#endif
+
+uint16_t carddb_count(void) {
+    return active_count;
+}
+
+uint32_t carddb_version(void) {
+    return db_version;
+}
+
+// ============================================
+// Downlink Replies
+// ============================================
+static void carddb_ack(void) {
+    char buf[96];
+    sprintf(buf, "DB,{\"type\":\"DB_ACK\",\"version\":%lu,\"cards\":%u}\r\n",
+            (unsigned long)db_version, active_count);
+    uart_dual_send_string(buf);
+}
+
+static void carddb_nak(const char *reason) {
+    char buf[96];
+    carddb_stats.rejected++;
+    sprintf(buf, "DB,{\"type\":\"DB_NAK\",\"reason\":\"%s\",\"version\":%lu}\r\n",
+            reason, (unsigned long)db_version);
+    uart_dual_send_string(buf);
+}
+
+// ============================================
+// Batch Commit
+// Capacity is checked first so a batch applies
+// completely or not at all
+// ============================================
+static uint8_t batch_fits(void) {
+    uint16_t new_cards = 0;
+    uint16_t room = free_count;
+    uint8_t new_groups = 0;
+    uint8_t revokes = 0;
+
+    for(uint8_t i = 0; i < batch_len; i++) {
+        uint8_t dup_uid = 0;
+        uint8_t dup_group = 0;
+
+        if(batch[i].op != CARDDB_OP_ADD) {
+            revokes++;
+            continue;
+        }
+
+        for(uint8_t j = 0; j < i; j++) {
+            if(batch[j].op != CARDDB_OP_ADD) continue;
+            if(memcmp(batch[j].uid, batch[i].uid, 4) == 0) dup_uid = 1;
+            if(strcmp(batch[j].group, batch[i].group) == 0) dup_group = 1;
+        }
+        if(!dup_uid && index_lookup(batch[i].uid, 0) < 0) new_cards++;
+        if(!dup_group && group_find(batch[i].group) < 0) new_groups++;
+    }
+
+#if CARDDB_TIERS
+    // Revokes may each need a slot in the tier revocation list
+    if(revokes > CARDDB_REVOKE_MAX - tier_revoked_count) return 0;
+#else
+    (void)revokes;
+#endif
+#if CARDDB_COPIES
+    if(new_cards > room) room += copy_evictable();
+#endif
+
+    return (new_cards <= room) &&
+           (group_count + new_groups <= CARDDB_MAX_GROUPS);
+}
+
+static void batch_commit(void) {
+    if(!batch_open) {
+        carddb_nak("NO_BATCH");
+        return;
+    }
+    batch_open = 0;
+
+    if(batch_overflow) {
+        carddb_nak("BATCH_TOO_LARGE");
+        return;
+    }
+    if(!batch_fits()) {
+        carddb_nak("FULL");
+        return;
+    }
+
+    for(uint8_t i = 0; i < batch_len; i++) {
+        if(batch[i].op == CARDDB_OP_ADD) {
+            carddb_add(batch[i].uid, batch[i].name, batch[i].group);
+        } else {
+            carddb_revoke(batch[i].uid);
+        }
+    }
+
+    carddb_stats.applied += batch_len;
+    carddb_stats.batches++;
+    db_version = batch_version;
+    carddb_ack();
+}
+
+// ============================================
+// Line Parser
+// ============================================
+static uint8_t parse_uid(const char *s, uint8_t *uid) {
+    for(uint8_t i = 0; i < 8; i++) {
+        char c = s[i];
+        uint8_t v;
+
+        if(c >= '0' && c <= '9') v = c - '0';
+        else if(c >= 'A' && c <= 'F') v = c - 'A' + 10;
+        else if(c >= 'a' && c <= 'f') v = c - 'a' + 10;
+        else return 0;
+
+        if(i & 1) uid[i / 2] |= v;
+        else uid[i / 2] = v << 4;
+    }
+    return s[8] == '\0';
+}
+
+static uint32_t parse_u32(const char *s) {
+    uint32_t v = 0;
+    while(*s >= '0' && *s <= '9') {
+        v = v * 10 + (*s++ - '0');
+    }
+    return v;
+}
+
+static void process_line(char *line) {
+    char *tok[5];
+    uint8_t n = 0;
+    CardDB_Op_t op;
+
+    // Split on ',' in place
+    tok[n++] = line;
+    for(char *p = line; *p && n < 5; p++) {
+        if(*p == ',') {
+            *p = '\0';
+            tok[n++] = p + 1;
+        }
+    }
+
+    // UART3 downlink is shared with the link handshake
+    if(n >= 2 && strcmp(tok[0], "LINK") == 0) {
+        uartlink_rx_line(tok, n);
+        return;
+    }
+    if(n >= 2 && strcmp(tok[0], "ACK") == 0) {
+        uplink_ack(parse_u32(tok[1]), millis());
+        return;
+    }
+#if CREDENTIAL_ENABLE
+    if(n >= 2 && strcmp(tok[0], "CRED") == 0) {
+        credential_rx_line(tok, n);
+        return;
+    }
+#endif
+
+    if(n < 2 || strcmp(tok[0], "DB") != 0) {
+        return;                             // Not for the card store
+    }
+
+    if(strcmp(tok[1], "VER") == 0) {
+        carddb_ack();
+        return;
+    }
+    if(strcmp(tok[1], "BEGIN") == 0) {
+        uint32_t v = (n >= 3) ? parse_u32(tok[2]) : 0;
+        if(v != db_version + 1) {
+            carddb_nak("VERSION");
+            return;
+        }
+        batch_open = 1;
+        batch_len = 0;
+        batch_overflow = 0;
+        batch_version = v;
+        return;
+    }
+    if(strcmp(tok[1], "COMMIT") == 0) {
+        batch_commit();
+        return;
+    }
+    if(strcmp(tok[1], "ABORT") == 0) {
+        batch_open = 0;
+        return;
+    }
+
+    memset(&op, 0, sizeof(op));
+    if((strcmp(tok[1], "ADD") == 0 || strcmp(tok[1], "UPD") == 0) && n >= 5) {
+        op.op = CARDDB_OP_ADD;
+        strncpy(op.name, tok[3], CARDDB_NAME_LEN - 1);
+        strncpy(op.group, tok[4], CARDDB_GROUP_LEN - 1);
+    } else if(strcmp(tok[1], "REV") == 0 && n >= 3) {
+        op.op = CARDDB_OP_REVOKE;
+    } else {
+        carddb_nak("BAD_CMD");
+        return;
+    }
+    if(!parse_uid(tok[2], op.uid)) {
+        carddb_nak("BAD_UID");
+        return;
+    }
+
+    if(batch_open) {
+        if(batch_len < CARDDB_BATCH_MAX) {
+            batch[batch_len++] = op;
+        } else {
+            batch_overflow = 1;
+        }
+        return;
+    }
+
+    // Single op outside a batch
+    if(op.op == CARDDB_OP_ADD) {
+        if(carddb_add(op.uid, op.name, op.group) < 0) {
+            carddb_nak("FULL");
+            return;
+        }
+    } else if(!carddb_revoke(op.uid)) {
+        carddb_nak("FULL");
+        return;
+    }
+    carddb_stats.applied++;
+    db_version++;
+    carddb_ack();
+}
+
+// ============================================
+// Poll the UART3 RX ring (bounded per pass)
+// ============================================
+void carddb_sync_poll(void) {
+    uint16_t budget = CARDDB_RX_BUDGET;
+    uint8_t c;
+
+    carddb_stats.rx_overflows = uart3_rx_overflows();
+
+    while(budget-- && uart3_rx_read(&c)) {
+        if(c == '\r') continue;
+
+        if(c == '\n') {
+            line_buf[line_len] = '\0';
+            if(line_overflow) {
+                carddb_nak("LINE_TOO_LONG");
+            } else if(line_len) {
+                process_line(line_buf);
+            }
+            line_len = 0;
+            line_overflow = 0;
+            continue;
+        }
+
+        if(line_len < CARDDB_LINE_MAX - 1) {
+            line_buf[line_len++] = (char)c;
+        } else {
+            line_overflow = 1;
+        }
+    }
+}
@@ -0,0 +1,101 @@
+/**
+ * ============================================
+ * CARD DATABASE HEADER
+ * Indexed card store + UART3 delta sync
+ * ============================================
+ */
+
+#ifndef CARDDB_H
+#define CARDDB_H
+
+#include <stdint.h>
+#include "FLASHIDX.h"
+#include "CARDMPH.h"
+#include "CREDENTIAL.h"
+
+// ============================================
+// Capacity
+// ============================================
+// Slots are int16_t indices (at most 32767), the index holds
+// 16-bit positions (HASH_BITS at most 16); host builds raise both
+#ifndef CARDDB_MAX_CARDS
+#define CARDDB_MAX_CARDS   512
+#endif
+#ifndef CARDDB_HASH_BITS
+#define CARDDB_HASH_BITS   10
+#endif
+#define CARDDB_HASH_SIZE   (1 << CARDDB_HASH_BITS)   // Load factor <= 0.5
+#define CARDDB_MAX_GROUPS  16
+#define CARDDB_NAME_LEN    9        // 8 characters + NUL
+#define CARDDB_GROUP_LEN   16
+#define CARDDB_BATCH_MAX   32       // Ops staged between BEGIN and COMMIT
+#define CARDDB_LINE_MAX    64
+#define CARDDB_RX_BUDGET   256      // Downlink bytes parsed per main-loop pass
+#define CARDDB_REVOKE_MAX  64       // Revocations of ROM/flash cards held in RAM
+
+// Read-only tiers behind the RAM store
+#define CARDDB_TIERS       (CARDMPH_ENABLE || FLASHIDX_ENABLE)
+
+// Slots that may hold evictable copies (tiers, card credentials)
+#define CARDDB_COPIES      (CARDDB_TIERS || CREDENTIAL_ENABLE)
+
+// Bloom filter over indexed UIDs: 8192 bits, 3 probes
+// -> ~0.5% false positives at 512 cards
+#define CARDDB_BLOOM_BITS_LOG2  13
+#define CARDDB_BLOOM_BITS       (1 << CARDDB_BLOOM_BITS_LOG2)
+#define CARDDB_BLOOM_K          3
+
+// ============================================
+// Card Record
+// ============================================
+typedef struct {
+    uint8_t uid[4];
+    char card_name[CARDDB_NAME_LEN];
+    uint8_t group_id;
+    uint8_t is_active;          // 0 = revoked (kept only while inside)
+    uint8_t zone;               // Current zone, 0 = outside (ZONES.h)
+    uint8_t source;             // CARD_SRC_*
+    uint16_t scan_count;
+    uint32_t last_scan_time;
+} Card_t;
+
+#define CARD_SRC_LOCAL  0           // Seed table / downlink delta
+#define CARD_SRC_FLASH  1           // Copied from the SPI flash index (evictable)
+#define CARD_SRC_ROM    2           // Copied from the const MPH table (evictable)
+#define CARD_SRC_CRED   3           // Admitted on its card credential (evictable)
+
+typedef struct {
+    uint32_t applied;           // Ops applied
+    uint32_t batches;           // Batches committed
+    uint32_t rejected;          // Lines/batches NAKed
+    uint32_t rx_overflows;      // Downlink bytes lost (UART3 RX ring full)
+    uint32_t bloom_rejects;     // Lookups answered by the Bloom filter alone
+    uint32_t flash_loads;       // Cards copied in from the flash index
+    uint32_t rom_loads;         // Cards copied in from the ROM table
+    uint32_t copy_evictions;    // ROM/flash/credential copies dropped to make room
+    uint32_t cred_loads;        // Cards copied in on a verified credential
+} CardDB_Stats_t;
+
+extern Card_t cards[CARDDB_MAX_CARDS];
+extern CardDB_Stats_t carddb_stats;
+
+// ============================================
+// Function Prototypes
+// ============================================
+void carddb_init(void);
+int16_t carddb_add(const uint8_t *uid, const char *name, const char *group);
+uint8_t carddb_revoke(const uint8_t *uid);
+int16_t card_find(const uint8_t *uid);
+uint8_t carddb_maybe_known(const uint8_t *uid);
+int16_t carddb_lookup(const uint8_t *uid);
+void carddb_prefetch(const uint8_t *uid);
+void carddb_card_left(int16_t idx);
+#if CREDENTIAL_ENABLE
+int16_t carddb_add_credential(const uint8_t *uid, uint8_t group);
+#endif
+const char* card_group_name(const Card_t *card);
+uint16_t carddb_count(void);
+uint32_t carddb_version(void);
+void carddb_sync_poll(void);
+
+#endif // CARDDB_H
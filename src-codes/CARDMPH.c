@@ -0,0 +1,48 @@
+/**
+ * ============================================
+ * CARD TABLE (ROM) LOOKUP
+ * CHD minimal perfect hash: one hash of the UID
+ * picks a bucket, the bucket's displacement pair
+ * gives the slot, and one 4-byte compare rejects
+ * UIDs that are not in the table. No RAM is used;
+ * all tables are const and stay in flash.
+ * Must match the formula in tools/cardmph_gen.py.
+ * ============================================
+ */
+
+#include "CARDMPH.h"
+
+#if CARDMPH_ENABLE
+
+static uint32_t mph_hash(uint32_t key) {
+    uint32_t h = key ^ cardmph_seed;
+
+    h ^= h >> 16;
+    h *= 0x85EBCA6BUL;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35UL;
+    h ^= h >> 16;
+    return h;
+}
+
+// NULL when the UID is not in the table
+const CardMph_Record_t* cardmph_find(const uint8_t *uid) {
+    uint32_t key = (uint32_t)uid[0] | ((uint32_t)uid[1] << 8) |
+                   ((uint32_t)uid[2] << 16) | ((uint32_t)uid[3] << 24);
+    uint32_t n = cardmph_count;
+    uint32_t h = mph_hash(key);
+    uint32_t b = (uint32_t)(((uint64_t)h * cardmph_buckets) >> 32);
+    uint32_t f1 = h % n;
+    uint32_t f2 = ((uint32_t)(h * 0x9E3779B1UL) >> 16) % n;
+    const CardMph_Record_t *rec;
+
+    rec = &cardmph_table[(f1 + cardmph_disp[b].d0 * f2 + cardmph_disp[b].d1) % n];
+
+    return (rec->key == key) ? rec : 0;
+}
+
+const char* cardmph_group_name(uint8_t group) {
+    return (group < cardmph_group_count) ? cardmph_groups[group] : "";
+}
+
+#endif // CARDMPH_ENABLE
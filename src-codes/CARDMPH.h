@@ -0,0 +1,65 @@
+/**
+ * ============================================
+ * CARD TABLE (ROM) HEADER
+ * Minimal perfect hash over a fixed card list
+ * (tables generated by tools/cardmph_gen.py)
+ * ============================================
+ */
+
+#ifndef CARDMPH_H
+#define CARDMPH_H
+
+#include <stdint.h>
+
+// ============================================
+// Build Switch
+// CARDMPH_ENABLE 1 - fixed-population venues:
+// CARDMPH_DATA.c (generated) is linked in and
+// consulted after the RAM store
+// ============================================
+#ifndef CARDMPH_ENABLE
+#define CARDMPH_ENABLE 0
+#endif
+
+// The generated tables (records, displacements, group names) must
+// fit in this much of the LPC1768's 512 KB flash, leaving 128 KB for
+// the firmware. At 16.5 bytes per card that is about 23,800 cards.
+// cardmph_gen.py refuses a larger list, and CARDMPH_DATA.c checks the
+// limit at compile time.
+#define CARDMPH_FLASH_BUDGET  (384UL * 1024)
+
+#define CARDMPH_NAME_LEN   8
+#define CARDMPH_GROUP_LEN  16
+#define CARDMPH_ACTIVE     0x01
+
+typedef struct {
+    uint32_t key;               // UID bytes 0..3, little-endian
+    char name[CARDMPH_NAME_LEN];    // NUL-padded, no NUL at full length
+    uint8_t group;
+    uint8_t flags;
+} CardMph_Record_t;
+
+typedef struct {
+    uint8_t d0;
+    uint8_t d1;
+} CardMph_Disp_t;
+
+#if CARDMPH_ENABLE
+
+extern const uint32_t cardmph_seed;
+extern const uint16_t cardmph_count;
+extern const uint16_t cardmph_buckets;
+extern const uint8_t cardmph_group_count;
+extern const char cardmph_groups[][CARDMPH_GROUP_LEN];
+extern const CardMph_Disp_t cardmph_disp[];
+extern const CardMph_Record_t cardmph_table[];
+
+// ============================================
+// Function Prototypes
+// ============================================
+const CardMph_Record_t* cardmph_find(const uint8_t *uid);
+const char* cardmph_group_name(uint8_t group);
+
+#endif // CARDMPH_ENABLE
+
+#endif // CARDMPH_H
@@ -0,0 +1,46 @@
+/**
+ * ============================================
+ * CARD TABLE (GENERATED - do not edit)
+ * Source: cards.csv, 10 cards, 4 groups
+ * Regenerate: tools/cardmph_gen.py
+ * ============================================
+ */
+
+#include "CARDMPH.h"
+
+#if CARDMPH_ENABLE
+
+const uint32_t cardmph_seed = 0xDECD3E9BUL;
+const uint16_t cardmph_count = 10;
+const uint16_t cardmph_buckets = 3;
+const uint8_t cardmph_group_count = 4;
+
+const char cardmph_groups[4][CARDMPH_GROUP_LEN] = {
+    "FOUR MEM GRP",
+    "THREE MEM GRP",
+    "TWO MEM GRP",
+    "ONE MEM GRP",
+};
+
+const CardMph_Disp_t cardmph_disp[3] = {
+    {0, 2}, {2, 0}, {5, 2},
+};
+
+const CardMph_Record_t cardmph_table[10] = {
+    {0x2A2252F3UL, "A0", 0, 1},
+    {0xED050083UL, "A1", 0, 1},
+    {0x0236881AUL, "B2", 1, 1},
+    {0x057DC8D4UL, "C0", 2, 1},
+    {0xEC5DF8D3UL, "A3", 0, 1},
+    {0x057D3D3BUL, "C1", 2, 1},
+    {0x5F946435UL, "B0", 1, 1},
+    {0x5F91D7A5UL, "D0", 3, 1},
+    {0xECD08433UL, "A2", 0, 1},
+    {0xED3C2203UL, "B1", 1, 1},
+};
+
+// Flash budget (CARDMPH.h)
+typedef char cardmph_flash_check[(sizeof(cardmph_table) + sizeof(cardmph_disp) +
+    sizeof(cardmph_groups) <= CARDMPH_FLASH_BUDGET) ? 1 : -1];
+
+#endif // CARDMPH_ENABLE
@@ -0,0 +1,337 @@
+/**
+ * ============================================
+ * CARD CREDENTIAL
+ * Offline admission: the card carries its own
+ * entitlement (group, validity window, zone
+ * rights) in one MIFARE Classic block, bound to
+ * its UID by a 64-bit SipHash-2-4 MAC under the
+ * venue key. A verified card needs no record in
+ * the card store, so the number of admissible
+ * cards is not limited by its size; the scan
+ * path keeps a RAM copy only while the card is
+ * inside (CARD_SRC_CRED, evictable once out).
+ *
+ * Read: select, auth key A of the credential
+ * sector, read one block, stop Crypto1. The
+ * MAC over 12 bytes is one SipHash block plus
+ * finalization, no table walk.
+ *
+ * Downlink (UART3, via the card store parser):
+ *
+ *   CRED,DAY,<day>        today, days since 1970
+ *   CRED,REV,<uid8hex>    refuse this card
+ *
+ * Until a day arrives, CREDENTIAL_BUILD_DAY is
+ * the lower bound: expired cards are refused,
+ * "valid from" is not enforced. The day then
+ * advances on millis(). Revocations are held in
+ * RAM and must be sent again after a reset.
+ * ============================================
+ */
+
+#include "CREDENTIAL.h"
+#include "RC522_RFID.h"
+#include "DELAY.h"
+#include "uart.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+Credential_Stats_t credential_stats;
+
+static uint8_t venue_key[16] = CREDENTIAL_VENUE_KEY;
+static uint8_t sector_key[6] = CREDENTIAL_SECTOR_KEY;
+
+static uint16_t day_base = CREDENTIAL_BUILD_DAY;
+static uint32_t day_base_ms = 0;
+static uint8_t day_synced = 0;
+
+static uint32_t cred_revoked[CREDENTIAL_REVOKE_MAX];
+static uint8_t cred_revoked_count = 0;
+
+static const char *cred_result_names[CRED_RESULT_COUNT] = {
+    "OK", "NO_SECTOR", "READ_ERR", "BLANK", "BAD_MAC",
+    "REVOKED", "NOT_YET_VALID", "EXPIRED", "NO_ZONE"
+};
+
+void credential_init(void) {
+    memset(&credential_stats, 0, sizeof(credential_stats));
+    day_base = CREDENTIAL_BUILD_DAY;
+    day_base_ms = millis();
+    day_synced = 0;
+    cred_revoked_count = 0;
+}
+
+// Host tests / issuing tools; the target uses the build key
+void credential_set_key(const uint8_t *key) {
+    memcpy(venue_key, key, sizeof(venue_key));
+}
+
+// ============================================
+// SipHash-2-4 (64-bit tag)
+// ============================================
+#define ROTL64(x, b)  (((x) << (b)) | ((x) >> (64 - (b))))
+
+#define SIPROUND(v0, v1, v2, v3) do {                           \
+    v0 += v1; v1 = ROTL64(v1, 13); v1 ^= v0; v0 = ROTL64(v0, 32); \
+    v2 += v3; v3 = ROTL64(v3, 16); v3 ^= v2;                    \
+    v0 += v3; v3 = ROTL64(v3, 21); v3 ^= v0;                    \
+    v2 += v1; v1 = ROTL64(v1, 17); v1 ^= v2; v2 = ROTL64(v2, 32); \
+} while(0)
+
+static uint64_t load_le64(const uint8_t *p) {
+    uint64_t v = 0;
+    for(int8_t i = 7; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+uint64_t credential_siphash(const uint8_t *key, const uint8_t *msg, uint8_t len) {
+    uint64_t k0 = load_le64(key);
+    uint64_t k1 = load_le64(key + 8);
+    uint64_t v0 = k0 ^ 0x736f6d6570736575ULL;
+    uint64_t v1 = k1 ^ 0x646f72616e646f6dULL;
+    uint64_t v2 = k0 ^ 0x6c7967656e657261ULL;
+    uint64_t v3 = k1 ^ 0x7465646279746573ULL;
+    uint64_t m;
+    uint8_t left = len & 7;
+    const uint8_t *end = msg + (len - left);
+
+    for(; msg != end; msg += 8) {
+        m = load_le64(msg);
+        v3 ^= m;
+        SIPROUND(v0, v1, v2, v3);
+        SIPROUND(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+
+    // Last block: remaining bytes, length in the top byte
+    m = (uint64_t)len << 56;
+    for(uint8_t i = 0; i < left; i++) {
+        m |= (uint64_t)msg[i] << (8 * i);
+    }
+    v3 ^= m;
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    v0 ^= m;
+
+    v2 ^= 0xFF;
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+// MAC input: UID, then the 8 data bytes of the block
+static uint64_t cred_mac(const uint8_t *block, const uint8_t *uid) {
+    uint8_t msg[4 + CREDENTIAL_MAC_OFFSET];
+
+    memcpy(msg, uid, 4);
+    memcpy(msg + 4, block, CREDENTIAL_MAC_OFFSET);
+    return credential_siphash(venue_key, msg, sizeof(msg));
+}
+
+// ============================================
+// Encode / Verify
+// ============================================
+// Issuer side: the 16 bytes written to CREDENTIAL_BLOCK
+void credential_encode(const Credential_t *cred, const uint8_t *uid, uint8_t *block) {
+    uint64_t mac;
+
+    block[0] = CREDENTIAL_MAGIC;
+    block[1] = cred->group_id;
+    block[2] = (uint8_t)cred->valid_from;
+    block[3] = (uint8_t)(cred->valid_from >> 8);
+    block[4] = (uint8_t)cred->valid_until;
+    block[5] = (uint8_t)(cred->valid_until >> 8);
+    block[6] = (uint8_t)cred->zones;
+    block[7] = (uint8_t)(cred->zones >> 8);
+
+    mac = cred_mac(block, uid);
+    for(uint8_t i = 0; i < 8; i++) {
+        block[CREDENTIAL_MAC_OFFSET + i] = (uint8_t)(mac >> (8 * i));
+    }
+}
+
+static uint32_t cred_uid_key(const uint8_t *uid) {
+    return ((uint32_t)uid[0] << 24) | ((uint32_t)uid[1] << 16) |
+           ((uint32_t)uid[2] << 8) | uid[3];
+}
+
+static uint8_t cred_is_revoked(const uint8_t *uid) {
+    uint32_t key = cred_uid_key(uid);
+
+    for(uint8_t i = 0; i < cred_revoked_count; i++) {
+        if(cred_revoked[i] == key) return 1;
+    }
+    return 0;
+}
+
+// Format + MAC (+ revocation); the window and zones are
+// left to credential_check(), exits do not need them
+Credential_Result_t credential_verify(const uint8_t *block, const uint8_t *uid,
+                                      Credential_t *out) {
+    uint64_t mac;
+    uint8_t diff = 0;
+
+    if(block[0] != CREDENTIAL_MAGIC) return CRED_BLANK;
+
+    // Compare every byte, no early exit on the first mismatch
+    mac = cred_mac(block, uid);
+    for(uint8_t i = 0; i < 8; i++) {
+        diff |= block[CREDENTIAL_MAC_OFFSET + i] ^ (uint8_t)(mac >> (8 * i));
+    }
+    if(diff) return CRED_BAD_MAC;
+
+    if(cred_is_revoked(uid)) return CRED_REVOKED;
+
+    out->group_id = block[1];
+    out->valid_from = (uint16_t)(block[2] | (block[3] << 8));
+    out->valid_until = (uint16_t)(block[4] | (block[5] << 8));
+    out->zones = (uint16_t)(block[6] | (block[7] << 8));
+    return CRED_OK;
+}
+
+// Entry into to_zone on day today
+Credential_Result_t credential_check(const Credential_t *cred, uint8_t to_zone,
+                                     uint16_t today) {
+    Credential_Result_t r = CRED_OK;
+
+    if(today > cred->valid_until) {
+        r = CRED_EXPIRED;
+    } else if(day_synced && today < cred->valid_from) {
+        r = CRED_NOT_YET_VALID;
+    } else if(cred->zones != CREDENTIAL_ZONES_ALL &&
+              (to_zone == 0 || to_zone > 16 || !(cred->zones & (1U << (to_zone - 1))))) {
+        r = CRED_NO_ZONE;
+    }
+
+    if(r != CRED_OK) credential_stats.results[r]++;
+    return r;
+}
+
+// ============================================
+// Card Read (uid = 5 bytes from anticollision)
+// ============================================
+Credential_Result_t credential_read(uint8_t *uid, Credential_t *out) {
+    uint8_t buf[18];
+    Credential_Result_t r;
+
+    if(RC522_SelectTag(uid) != MI_OK ||
+       RC522_Auth(PICC_CMD_MF_AUTH_KEY_A, CREDENTIAL_BLOCK, sector_key, uid) != MI_OK) {
+        r = CRED_NO_SECTOR;
+    } else if(RC522_Read(CREDENTIAL_BLOCK, buf) != MI_OK) {
+        r = CRED_READ_ERR;
+    } else {
+        r = credential_verify(buf, uid, out);
+    }
+
+    // Plain REQA again on the next poll
+    RC522_StopCrypto();
+
+    credential_stats.results[r]++;
+    return r;
+}
+
+// ============================================
+// Day (no RTC: set by the gateway, kept on millis)
+// ============================================
+void credential_set_day(uint16_t day, uint32_t now_ms) {
+    day_base = day;
+    day_base_ms = now_ms;
+    day_synced = 1;
+}
+
+// Called at least once per millis() wrap (task_ui reports)
+uint16_t credential_today(uint32_t now_ms) {
+    while(now_ms - day_base_ms >= CREDENTIAL_DAY_MS) {
+        day_base_ms += CREDENTIAL_DAY_MS;
+        day_base++;
+    }
+    return day_base;
+}
+
+// 0 = list full
+uint8_t credential_revoke(const uint8_t *uid) {
+    if(cred_is_revoked(uid)) return 1;
+    if(cred_revoked_count >= CREDENTIAL_REVOKE_MAX) {
+        credential_stats.revoke_full++;
+        return 0;
+    }
+
+    cred_revoked[cred_revoked_count++] = cred_uid_key(uid);
+    return 1;
+}
+
+const char* credential_result_name(Credential_Result_t r) {
+    return (r < CRED_RESULT_COUNT) ? cred_result_names[r] : "";
+}
+
+// ============================================
+// Downlink: CRED,<op>,<arg> (tokens split by
+// the card store line parser)
+// ============================================
+static void cred_reply(const char *type, const char *reason) {
+    char buf[128];
+
+    sprintf(buf, "CRED,{\"type\":\"%s\",\"reason\":\"%s\",\"day\":%u,\"revoked\":%u}\r\n",
+            type, reason, credential_today(millis()), cred_revoked_count);
+    uart_dual_send_string(buf);
+}
+
+void credential_rx_line(char **tok, uint8_t n) {
+    char *end;
+    unsigned long v;
+
+    if(n < 3) {
+        cred_reply("CRED_NAK", "BAD_CMD");
+        return;
+    }
+
+    v = strtoul(tok[2], &end, (strcmp(tok[1], "REV") == 0) ? 16 : 10);
+    if(!isxdigit((unsigned char)tok[2][0]) || *end != '\0') {
+        cred_reply("CRED_NAK", "BAD_ARG");
+        return;
+    }
+
+    if(strcmp(tok[1], "DAY") == 0 && v <= 0xFFFF) {
+        credential_set_day((uint16_t)v, millis());
+        credential_stats.day_syncs++;
+        cred_reply("CRED_ACK", "DAY");
+    } else if(strcmp(tok[1], "REV") == 0 && end - tok[2] == 8) {
+        uint8_t uid[4];
+
+        uid[0] = (uint8_t)(v >> 24);
+        uid[1] = (uint8_t)(v >> 16);
+        uid[2] = (uint8_t)(v >> 8);
+        uid[3] = (uint8_t)v;
+        if(credential_revoke(uid)) cred_reply("CRED_ACK", "REV");
+        else cred_reply("CRED_NAK", "FULL");
+    } else {
+        cred_reply("CRED_NAK", "BAD_CMD");
+    }
+}
+
+// ============================================
+// STATUS,{"type":"CRED_STATUS",...}
+// ============================================
+void credential_report(void) {
+    char buf[320];
+    int len;
+
+    len = sprintf(buf,
+        "STATUS,{\"type\":\"CRED_STATUS\",\"day\":%u,\"day_synced\":%u,"
+        "\"day_syncs\":%lu,\"revoked\":%u,\"revoke_full\":%lu,\"results\":{",
+        credential_today(millis()), day_synced,
+        (unsigned long)credential_stats.day_syncs, cred_revoked_count,
+        (unsigned long)credential_stats.revoke_full);
+
+    for(uint8_t r = 0; r < CRED_RESULT_COUNT; r++) {
+        len += sprintf(buf + len, "%s\"%s\":%lu", r ? "," : "",
+            cred_result_names[r], (unsigned long)credential_stats.results[r]);
+    }
+    sprintf(buf + len, "}}\r\n");
+    uart_dual_send_string(buf);
+}
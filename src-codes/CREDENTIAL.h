@@ -0,0 +1,110 @@
+/**
+ * ============================================
+ * CARD CREDENTIAL HEADER
+ * Signed admission credential in a MIFARE
+ * Classic block, checked without the card store
+ * ============================================
+ */
+
+#ifndef CREDENTIAL_H
+#define CREDENTIAL_H
+
+#include <stdint.h>
+
+// ============================================
+// Build Switch
+// CREDENTIAL_ENABLE 1 - a card without a record
+// in the card store (RAM / ROM / flash) is
+// admitted on the credential it carries; the
+// venue key must then be set for the build
+// ============================================
+#ifndef CREDENTIAL_ENABLE
+#define CREDENTIAL_ENABLE 0
+#endif
+
+#ifndef CREDENTIAL_VENUE_KEY
+#if CREDENTIAL_ENABLE
+#error "CREDENTIAL_ENABLE needs CREDENTIAL_VENUE_KEY (16 bytes, per venue)"
+#endif
+#define CREDENTIAL_VENUE_KEY    {0}
+#endif
+
+// Key A of the credential sector (issuer sets it in the trailer)
+#ifndef CREDENTIAL_SECTOR_KEY
+#define CREDENTIAL_SECTOR_KEY   {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}
+#endif
+
+// Lower bound for "today" until the gateway sends the day
+#ifndef CREDENTIAL_BUILD_DAY
+#define CREDENTIAL_BUILD_DAY    20745           // 2026-10-19
+#endif
+
+// ============================================
+// Block Layout (16 bytes, little-endian)
+//   [0]      CREDENTIAL_MAGIC (format 1)
+//   [1]      group id
+//   [2..3]   valid from  (day, inclusive)
+//   [4..5]   valid until (day, inclusive)
+//   [6..7]   zone rights, bit z-1 = zone z
+//   [8..15]  SipHash-2-4(venue key,
+//            UID[0..3] | block[0..7])
+// Days count from 1970-01-01 (Unix time / 86400)
+// ============================================
+#define CREDENTIAL_BLOCK        4               // Sector 1, block 0
+#define CREDENTIAL_MAGIC        0xC1
+#define CREDENTIAL_MAC_OFFSET   8
+#define CREDENTIAL_DAY_MS       86400000UL
+#define CREDENTIAL_ZONES_ALL    0xFFFF          // Every zone, also above 16
+#define CREDENTIAL_REVOKE_MAX   64              // Revoked UIDs held in RAM
+
+typedef struct {
+    uint8_t group_id;
+    uint16_t valid_from;
+    uint16_t valid_until;
+    uint16_t zones;
+} Credential_t;
+
+typedef enum {
+    CRED_OK = 0,
+    CRED_NO_SECTOR,         // Select / auth failed (no credential, other key)
+    CRED_READ_ERR,
+    CRED_BLANK,             // Readable, but not a credential
+    CRED_BAD_MAC,           // Altered, other venue, or copied to another UID
+    CRED_REVOKED,
+    CRED_NOT_YET_VALID,
+    CRED_EXPIRED,
+    CRED_NO_ZONE,           // No right for the zone being entered
+    CRED_RESULT_COUNT
+} Credential_Result_t;
+
+typedef struct {
+    uint32_t results[CRED_RESULT_COUNT];
+    uint32_t day_syncs;         // CRED,DAY lines applied
+    uint32_t revoke_full;       // CRED,REV refused (list full)
+} Credential_Stats_t;
+
+extern Credential_Stats_t credential_stats;
+
+// ============================================
+// Function Prototypes
+// ============================================
+void credential_init(void);
+void credential_set_key(const uint8_t *key);
+uint64_t credential_siphash(const uint8_t *key, const uint8_t *msg, uint8_t len);
+
+void credential_encode(const Credential_t *cred, const uint8_t *uid, uint8_t *block);
+Credential_Result_t credential_verify(const uint8_t *block, const uint8_t *uid,
+                                      Credential_t *out);
+Credential_Result_t credential_check(const Credential_t *cred, uint8_t to_zone,
+                                     uint16_t today);
+Credential_Result_t credential_read(uint8_t *uid, Credential_t *out);
+
+void credential_set_day(uint16_t day, uint32_t now_ms);
+uint16_t credential_today(uint32_t now_ms);
+uint8_t credential_revoke(const uint8_t *uid);
+
+const char* credential_result_name(Credential_Result_t r);
+void credential_rx_line(char **tok, uint8_t n);
+void credential_report(void);
+
+#endif // CREDENTIAL_H
@@ -5,8 +5,11 @@
  * ============================================
  */
 
+#include "LPC17xx.h"
 #include "DELAY.h"
 
+static volatile uint32_t systick_ms = 0;
+
 void delay_ms(unsigned int ms) {
     for(unsigned int i = 0; i < ms; i++) {
         for(volatile unsigned int j = 0; j < 10000; j++);
@@ -16,3 +19,26 @@ void delay_ms(unsigned int ms) {
 void delay_us(unsigned int us) {
     for(volatile unsigned int i = 0; i < us * 10; i++);
 }
+
+// ============================================
+// SysTick: 1ms wall clock for non-blocking
+// waits (delay_ms above does not advance it)
+// ============================================
+void systick_init(void) {
+    systick_ms = 0;
+    SysTick_Config(SystemCoreClock / 1000);
+}
+
+void SysTick_Handler(void) {
+    systick_ms++;
+}
+
+uint32_t millis(void) {
+    return systick_ms;
+}
+
+// Ticks that were not taken while the SysTick
+// interrupt was stopped (tickless idle, POWER.c)
+void millis_advance(uint32_t ms) {
+    systick_ms += ms;
+}
@@ -7,4 +7,9 @@
 void delay_ms(uint32_t ms);
 void delay_us(uint32_t us);
 
+// SysTick Time Base (1ms)
+void systick_init(void);
+uint32_t millis(void);
+void millis_advance(uint32_t ms);
+
 #endif
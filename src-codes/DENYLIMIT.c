@@ -0,0 +1,138 @@
+/**
+ * ============================================
+ * DENIAL LIMITER
+ * A stray card held near the reader would send
+ * one UNKNOWN_CARD frame per read. Each UID gets
+ * a token bucket (burst, refill_ticks); reads
+ * without a token are only counted, and the
+ * counts go out as one DENIAL_SUMMARY frame per
+ * summary window.
+ * ============================================
+ */
+
+#include "DENYLIMIT.h"
+#include "uart.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    uint8_t uid[4];
+    uint8_t used;
+    uint8_t tokens;
+    uint32_t refill_time;       // Tick the last token was credited
+    uint32_t last_seen;
+    uint16_t suppressed;        // In the current summary window
+} DenyLimit_Entry_t;
+
+DenyLimit_Config_t denylimit_config = {
+    DENY_BURST,
+    DENY_REFILL_TICKS,
+    DENY_SUMMARY_TICKS
+};
+
+DenyLimit_Stats_t denylimit_stats;
+
+static DenyLimit_Entry_t deny_table[DENY_TRACK_SIZE];
+static uint32_t deny_other = 0;         // Suppressed by UIDs evicted this window
+static uint32_t deny_window_start = 0;
+
+void denylimit_init(uint32_t now) {
+    memset(deny_table, 0, sizeof(deny_table));
+    memset(&denylimit_stats, 0, sizeof(denylimit_stats));
+    deny_other = 0;
+    deny_window_start = now;
+}
+
+static DenyLimit_Entry_t* deny_entry(const uint8_t *uid, uint32_t now) {
+    DenyLimit_Entry_t *victim = &deny_table[0];
+
+    for(uint8_t i = 0; i < DENY_TRACK_SIZE; i++) {
+        DenyLimit_Entry_t *e = &deny_table[i];
+
+        if(e->used && memcmp(e->uid, uid, 4) == 0) {
+            return e;
+        }
+        if(!e->used) {
+            if(victim->used) victim = e;
+        } else if(victim->used && (now - e->last_seen) > (now - victim->last_seen)) {
+            victim = e;
+        }
+    }
+
+    // New UID: take a free entry or the least recently seen one
+    deny_other += victim->suppressed;
+    memcpy(victim->uid, uid, 4);
+    victim->used = 1;
+    victim->tokens = denylimit_config.burst;
+    victim->refill_time = now;
+    victim->suppressed = 0;
+    return victim;
+}
+
+// 1 = send the full UNKNOWN_CARD frame, 0 = counted for the summary
+uint8_t denylimit_allow(const uint8_t *uid, uint32_t now) {
+    DenyLimit_Entry_t *e = deny_entry(uid, now);
+    uint32_t refills = (now - e->refill_time) / denylimit_config.refill_ticks;
+
+    if(refills) {
+        uint32_t t = e->tokens + refills;
+        e->tokens = (t > denylimit_config.burst) ? denylimit_config.burst : (uint8_t)t;
+        e->refill_time += refills * denylimit_config.refill_ticks;
+    }
+    e->last_seen = now;
+
+    if(e->tokens) {
+        e->tokens--;
+        denylimit_stats.sent++;
+        return 1;
+    }
+
+    if(e->suppressed != 0xFFFF) e->suppressed++;
+    denylimit_stats.suppressed++;
+    return 0;
+}
+
+// ============================================
+// Summary Frame (only when something was held)
+// ============================================
+void denylimit_service(uint32_t now) {
+    char buf[DENY_TRACK_SIZE * 40 + 128];
+    uint32_t total = deny_other;
+    int len;
+    uint8_t first = 1;
+
+    if((now - deny_window_start) < denylimit_config.summary_ticks) {
+        return;
+    }
+
+    for(uint8_t i = 0; i < DENY_TRACK_SIZE; i++) {
+        total += deny_table[i].suppressed;
+    }
+
+    if(total) {
+        len = sprintf(buf,
+            "RFID,{\"type\":\"DENIAL_SUMMARY\","
+            "\"window\":%lu,\"suppressed\":%lu,\"uids\":[",
+            (unsigned long)(now - deny_window_start), (unsigned long)total);
+
+        for(uint8_t i = 0; i < DENY_TRACK_SIZE; i++) {
+            DenyLimit_Entry_t *e = &deny_table[i];
+
+            if(!e->used || !e->suppressed) continue;
+
+            len += sprintf(buf + len,
+                "%s{\"uid\":\"%02X:%02X:%02X:%02X\",\"count\":%u}",
+                first ? "" : ",",
+                e->uid[0], e->uid[1], e->uid[2], e->uid[3], e->suppressed);
+            first = 0;
+            e->suppressed = 0;
+        }
+
+        sprintf(buf + len, "],\"other\":%lu}\r\n", (unsigned long)deny_other);
+        uart_dual_send_string(buf);
+        denylimit_stats.summaries++;
+    }
+
+    deny_other = 0;
+    deny_window_start = now;
+}
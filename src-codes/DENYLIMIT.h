@@ -0,0 +1,43 @@
+/**
+ * ============================================
+ * DENIAL LIMITER HEADER
+ * Per-UID token bucket for UNKNOWN_CARD frames
+ * ============================================
+ */
+
+#ifndef DENYLIMIT_H
+#define DENYLIMIT_H
+
+#include <stdint.h>
+
+// ============================================
+// Default Policy (main loop ticks)
+// ============================================
+#define DENY_TRACK_SIZE       8         // UIDs tracked at once
+#define DENY_BURST            2         // Frames a UID may send back to back
+#define DENY_REFILL_TICKS     300       // One more frame every ~30s
+#define DENY_SUMMARY_TICKS    600       // Summary of suppressed denials every ~60s
+
+typedef struct {
+    uint8_t burst;
+    uint16_t refill_ticks;
+    uint16_t summary_ticks;
+} DenyLimit_Config_t;
+
+typedef struct {
+    uint32_t sent;              // UNKNOWN_CARD frames allowed out
+    uint32_t suppressed;        // Denials folded into a summary
+    uint32_t summaries;         // DENIAL_SUMMARY frames sent
+} DenyLimit_Stats_t;
+
+extern DenyLimit_Config_t denylimit_config;
+extern DenyLimit_Stats_t denylimit_stats;
+
+// ============================================
+// Function Prototypes
+// ============================================
+void denylimit_init(uint32_t now);
+uint8_t denylimit_allow(const uint8_t *uid, uint32_t now);
+void denylimit_service(uint32_t now);
+
+#endif // DENYLIMIT_H
@@ -11,23 +11,31 @@
 
 #include "LPC17xx.h"
 #include "DHT11.h"
-#include "DELAY.h"
 #include "globals.h"
 
 // ========== PIN CONFIGURATION (CHANGE HERE) ==========
 #define DHT11_PIN (1<<7)           // P0.26 (bit 26)
 #define DHT11_PINSEL_BIT 20         // PINSEL1 bits 21:20 for P0.26
 
+#define DHT11_EDGES       42        // Response + 40 bits + end of frame
+#define DHT11_GAP_MIN_US  60        // Falling edge to falling edge, per bit
+#define DHT11_GAP_ONE_US  100       // ~78us = 0, ~120us = 1
+#define DHT11_GAP_MAX_US  160
+
 /* OTHER PIN OPTIONS:
  * P0.25: #define DHT11_PIN (1<<25)  // DHT11_PINSEL_BIT 18
  * P0.26: #define DHT11_PIN (1<<26)  // DHT11_PINSEL_BIT 20
  * P0.4:  #define DHT11_PIN (1<<4)   // DHT11_PINSEL_BIT 8  (use PINSEL0)
  * P0.5:  #define DHT11_PIN (1<<5)   // DHT11_PINSEL_BIT 10 (use PINSEL0)
- * P1.26: Use LPC_GPIO1 instead of LPC_GPIO0
+ * Port 0 pins only: the read is timed from the port 0 GPIO interrupt
  */
 
 uint8_t dht11_data[5];
 
+// Falling edges of one frame, TIMER1 us (EINT3_IRQHandler)
+static volatile uint32_t dht11_edge_us[DHT11_EDGES];
+static volatile uint8_t dht11_edge_n = 0;
+
 void DHT11_Init(void) {
     // Configure P0.26 as GPIO (not special function)
     //LPC_PINCON->PINSEL1 &= ~(3 << DHT11_PINSEL_BIT);  // Clear PINSEL bits for P0.26
@@ -35,74 +43,77 @@ void DHT11_Init(void) {
     // Set DHT11 pin as output initially
     LPC_GPIO0->FIODIR |= DHT11_PIN;
     LPC_GPIO0->FIOSET = DHT11_PIN;  // Pull HIGH
-    delay_ms(2000);  // Wait 2 seconds for sensor to stabilize
+    // Sensor needs 2 seconds to stabilize: the caller waits
+    // (millis() deadline) before the first dht11_start()
+
+    // Port 0 GPIO interrupts share EINT3; only armed during a read
+    LPC_GPIOINT->IO0IntEnF &= ~DHT11_PIN;
+    NVIC_SetPriority(EINT3_IRQn, DHT11_IRQ_PRIORITY);
+    NVIC_EnableIRQ(EINT3_IRQn);
 }
 
-uint8_t read_dht11(void) {
-    uint8_t i, j;
-    uint32_t timeout;
-   
-    // Clear data array
-    for(i = 0; i < 5; i++) {
-        dht11_data[i] = 0;
-    }
-   
-    // ========== START SIGNAL ==========
+// ========== READ (NON-BLOCKING) ==========
+// dht11_start(): host pulls the line LOW
+// dht11_release() DHT11_START_MS later: line handed to the sensor,
+//   every falling edge is timestamped from the interrupt
+// dht11_finish() DHT11_READ_MS after that: decode the edges
+// The caller sleeps in between; nothing here waits on the pin.
+void dht11_start(void) {
+    LPC_GPIOINT->IO0IntEnF &= ~DHT11_PIN;
     LPC_GPIO0->FIODIR |= DHT11_PIN;      // Set as output
     LPC_GPIO0->FIOCLR = DHT11_PIN;       // Pull LOW
-    delay_ms(20);                         // 20ms LOW signal
-    
+}
+
+void dht11_release(void) {
+    dht11_edge_n = 0;
+    LPC_GPIOINT->IO0IntClr = DHT11_PIN;
+    LPC_GPIOINT->IO0IntEnF |= DHT11_PIN;
     LPC_GPIO0->FIOSET = DHT11_PIN;       // Pull HIGH
-    delay_us(40);                         // 40us HIGH signal
-    
-    LPC_GPIO0->FIODIR &= ~DHT11_PIN;     // Switch to input mode
-   
-    // ========== WAIT FOR DHT11 RESPONSE ==========
-    // DHT11 should pull line LOW
-    timeout = 0;
-    while((LPC_GPIO0->FIOPIN & DHT11_PIN) && timeout++ < 5000);
-    if(timeout >= 5000) {
-        return 0;  // Timeout - no response
+    LPC_GPIO0->FIODIR &= ~DHT11_PIN;     // Input: the pull-up holds it, the sensor answers
+}
+
+// Edge 0: response (80us LOW + 80us HIGH). Edges 1..40: start of
+// each bit (50us LOW), then HIGH 26-28us for a 0 or 70us for a 1,
+// so the gap to the next falling edge is ~78us or ~120us. Edge 41
+// ends the frame.
+void EINT3_IRQHandler(void) {
+    uint32_t t_us = LPC_TIM1->TC;
+
+    if(LPC_GPIOINT->IO0IntStatF & DHT11_PIN) {
+        LPC_GPIOINT->IO0IntClr = DHT11_PIN;
+        if(dht11_edge_n < DHT11_EDGES) {
+            dht11_edge_us[dht11_edge_n++] = t_us;
+        }
+        if(dht11_edge_n >= DHT11_EDGES) {
+            LPC_GPIOINT->IO0IntEnF &= ~DHT11_PIN;
+        }
     }
+}
+
+uint8_t dht11_finish(void) {
+    uint8_t i;
+    uint32_t gap;
+
+    LPC_GPIOINT->IO0IntEnF &= ~DHT11_PIN;
    
-    // DHT11 pulls LOW for 80us
-    timeout = 0;
-    while(!(LPC_GPIO0->FIOPIN & DHT11_PIN) && timeout++ < 5000);
-    if(timeout >= 5000) {
-        return 0;  // Timeout
+    // Clear data array
+    for(i = 0; i < 5; i++) {
+        dht11_data[i] = 0;
     }
    
-    // DHT11 pulls HIGH for 80us
-    timeout = 0;
-    while((LPC_GPIO0->FIOPIN & DHT11_PIN) && timeout++ < 5000);
-    if(timeout >= 5000) {
-        return 0;  // Timeout
+    // ========== RESPONSE ==========
+    if(dht11_edge_n < DHT11_EDGES) {
+        return 0;  // No response, or edges missing
     }
    
-    // ========== READ 40 BITS (5 BYTES) ==========
-    for(i = 0; i < 5; i++) {
-        for(j = 0; j < 8; j++) {
-            // Wait for bit start (50us LOW)
-            timeout = 0;
-            while(!(LPC_GPIO0->FIOPIN & DHT11_PIN) && timeout++ < 5000);
-            if(timeout >= 5000) {
-                return 0;  // Timeout
-            }
-           
-            // Wait 40us and check if still HIGH
-            delay_us(40);
-           
-            // If HIGH = bit 1, if LOW = bit 0
-            if(LPC_GPIO0->FIOPIN & DHT11_PIN) {
-                dht11_data[i] |= (1 << (7 - j));  // Set bit to 1
-            }
-           
-            // Wait for HIGH signal to end
-            timeout = 0;
-            while((LPC_GPIO0->FIOPIN & DHT11_PIN) && timeout++ < 5000);
-            if(timeout >= 5000) {
-                return 0;  // Timeout
-            }
+    // ========== DECODE 40 BITS (5 BYTES) ==========
+    for(i = 0; i < 40; i++) {
+        gap = dht11_edge_us[i + 2] - dht11_edge_us[i + 1];
+        if(gap < DHT11_GAP_MIN_US || gap > DHT11_GAP_MAX_US) {
+            return 0;  // Glitch or lost edge
+        }
+        if(gap >= DHT11_GAP_ONE_US) {
+            dht11_data[i >> 3] |= (1 << (7 - (i & 7)));  // Set bit to 1
         }
     }
    
@@ -113,11 +124,12 @@ uint8_t read_dht11(void) {
     }
    
     // ========== EXTRACT VALUES ==========
-    humidity = (float)dht11_data[0] + ((float)dht11_data[1] / 10.0f);
-    temperature = (float)dht11_data[2] + ((float)dht11_data[3] / 10.0f);
+    // Integral byte + decimal byte, in tenths
+    humidity_x10 = (int16_t)(dht11_data[0] * 10 + dht11_data[1]);
+    temperature_x10 = (int16_t)(dht11_data[2] * 10 + dht11_data[3]);
    
     // ========== SANITY CHECK ==========
-    if(humidity > 100.0f || temperature > 60.0f || temperature < 0.0f) {
+    if(humidity_x10 > 1000 || temperature_x10 > 600 || temperature_x10 < 0) {
         return 0;  // Invalid reading
     }
    
@@ -9,8 +9,14 @@
 
 #include <stdint.h>
 
+#define DHT11_START_MS 20          // Start pulse (LOW) before the response
+#define DHT11_READ_MS 6            // Response + 40 bits (<= 5.1ms)
+#define DHT11_IRQ_PRIORITY 1       // Edge timestamps: below the emergency button
+
 // Function prototypes
 void DHT11_Init(void);
-uint8_t read_dht11(void);
+void dht11_start(void);
+void dht11_release(void);
+uint8_t dht11_finish(void);
 
 #endif // DHT11_H
@@ -0,0 +1,244 @@
+/**
+ * ============================================
+ * EVENT BUS
+ * Interrupt handlers hand work to the main loop
+ * through single-producer/single-consumer rings
+ * of fixed 16-byte records. Each ring has one
+ * writer context (head) and one reader (tail),
+ * both free running, so neither side ever needs
+ * to mask interrupts:
+ *
+ *   producer: fill slot, DMB, publish head
+ *   consumer: read head, DMB, copy slot,
+ *             DMB, publish tail
+ *
+ * A full ring drops the new event and counts it;
+ * the dispatcher then delivers one EV_QUEUE_LOST
+ * so the subscriber can resync from the source
+ * (e.g. drain the whole UART3 RX ring).
+ * ============================================
+ */
+
+#include "EVENTBUS.h"
+#include "DELAY.h"
+#include "uart.h"
+#include <stdio.h>
+#include <string.h>
+
+// ============================================
+// Barriers
+// Cortex-M3 does not reorder memory accesses on
+// its own, but the compiler and the write buffer
+// may; DMB orders the slot against the index.
+// ============================================
+#ifdef EVENTBUS_HOST
+#define EVQ_LOAD_ACQUIRE(p)       __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define EVQ_STORE_RELEASE(p, v)   __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#else
+#include "LPC17xx.h"
+
+static __inline uint32_t evq_load_acquire(volatile uint32_t *p) {
+    uint32_t v = *p;
+    __DMB();
+    return v;
+}
+
+static __inline void evq_store_release(volatile uint32_t *p, uint32_t v) {
+    __DMB();
+    *p = v;
+}
+
+#define EVQ_LOAD_ACQUIRE(p)       evq_load_acquire(p)
+#define EVQ_STORE_RELEASE(p, v)   evq_store_release((p), (v))
+#endif
+
+typedef struct {
+    Event_t *buf;
+    uint32_t mask;
+    volatile uint32_t head;         // Written by the producer only
+    volatile uint32_t tail;         // Written by the consumer only
+    EventBus_QueueStats_t stats;    // Producer-owned, read by reports
+    uint32_t drops_seen;            // Consumer-owned
+} EventQueue_t;
+
+static Event_t evq_gpio_buf[EVQ_GPIO_SIZE];
+static Event_t evq_uart_buf[EVQ_UART_SIZE];
+static Event_t evq_dma_buf[EVQ_DMA_SIZE];
+static Event_t evq_main_buf[EVQ_MAIN_SIZE];
+
+static EventQueue_t ev_queues[EVQ_COUNT];
+static EventBus_Handler_t ev_handlers[EV_TYPE_COUNT];
+static EventBus_Notify_t ev_notify = 0;         // Runs in the producer's context
+
+static const char *evq_names[EVQ_COUNT] = {"GPIO", "UART", "DMA", "MAIN"};
+
+EventBus_Stats_t eventbus_stats;
+
+static void evq_setup(uint8_t q, Event_t *buf, uint16_t size) {
+    EventQueue_t *eq = &ev_queues[q];
+
+    memset(eq, 0, sizeof(*eq));
+    eq->buf = buf;
+    eq->mask = size - 1;
+    eq->stats.size = size;
+}
+
+// Call before the producing interrupts are enabled
+void eventbus_init(void) {
+    evq_setup(EVQ_GPIO, evq_gpio_buf, EVQ_GPIO_SIZE);
+    evq_setup(EVQ_UART, evq_uart_buf, EVQ_UART_SIZE);
+    evq_setup(EVQ_DMA, evq_dma_buf, EVQ_DMA_SIZE);
+    evq_setup(EVQ_MAIN, evq_main_buf, EVQ_MAIN_SIZE);
+
+    memset(ev_handlers, 0, sizeof(ev_handlers));
+    ev_notify = 0;
+    memset(&eventbus_stats, 0, sizeof(eventbus_stats));
+}
+
+// ============================================
+// Producer side (the queue's own context only)
+// ============================================
+uint8_t eventbus_post(uint8_t queue, uint8_t type, uint16_t arg,
+                      const void *data, uint8_t len) {
+    EventQueue_t *eq = &ev_queues[queue];
+    uint32_t head = eq->head;
+    uint32_t tail = EVQ_LOAD_ACQUIRE(&eq->tail);
+    uint32_t depth;
+    Event_t *ev;
+
+    if(head - tail > eq->mask) {
+        // Read by the dispatcher, so published like an index
+        EVQ_STORE_RELEASE(&eq->stats.drops, eq->stats.drops + 1);
+        return 0;
+    }
+
+    if(len > EV_DATA_MAX) len = EV_DATA_MAX;
+
+    ev = &eq->buf[head & eq->mask];
+    ev->type = type;
+    ev->len = len;
+    ev->arg = arg;
+    ev->time = millis();
+    if(len) memcpy(ev->data, data, len);
+
+    EVQ_STORE_RELEASE(&eq->head, head + 1);
+
+    depth = head + 1 - tail;
+    if(depth > eq->stats.hwm) eq->stats.hwm = (uint16_t)depth;
+    eq->stats.posted++;
+
+    if(ev_notify) ev_notify();
+    return 1;
+}
+
+// ============================================
+// Consumer side (main loop)
+// ============================================
+void eventbus_subscribe(uint8_t type, EventBus_Handler_t handler) {
+    if(type < EV_TYPE_COUNT) ev_handlers[type] = handler;
+}
+
+// Called after every successful post, e.g. to wake the consumer task
+void eventbus_set_notify(EventBus_Notify_t notify) {
+    ev_notify = notify;
+}
+
+static void evq_deliver(const Event_t *ev) {
+    EventBus_Handler_t h = (ev->type < EV_TYPE_COUNT) ? ev_handlers[ev->type] : 0;
+
+    if(h) {
+        h(ev);
+        eventbus_stats.dispatched++;
+    } else {
+        eventbus_stats.unhandled++;
+    }
+}
+
+static uint8_t evq_pop(EventQueue_t *eq, Event_t *out) {
+    uint32_t tail = eq->tail;
+    uint32_t head = EVQ_LOAD_ACQUIRE(&eq->head);
+
+    if(tail == head) return 0;
+
+    *out = eq->buf[tail & eq->mask];
+
+    // Slot is copied out before the producer may reuse it
+    EVQ_STORE_RELEASE(&eq->tail, tail + 1);
+    return 1;
+}
+
+// Queues are drained in enum order: button edges first
+uint16_t eventbus_dispatch(uint16_t budget) {
+    uint16_t n = 0;
+    Event_t ev;
+
+    for(uint8_t q = 0; q < EVQ_COUNT && n < budget; q++) {
+        EventQueue_t *eq = &ev_queues[q];
+        uint32_t drops;
+
+        while(n < budget && evq_pop(eq, &ev)) {
+            evq_deliver(&ev);
+            n++;
+        }
+
+        // Report losses once the queue has room again
+        drops = EVQ_LOAD_ACQUIRE(&eq->stats.drops);
+        if(drops != eq->drops_seen && EVQ_LOAD_ACQUIRE(&eq->head) == eq->tail) {
+            eq->drops_seen = drops;
+            memset(&ev, 0, sizeof(ev));
+            ev.type = EV_QUEUE_LOST;
+            ev.arg = q;
+            ev.time = millis();
+            evq_deliver(&ev);
+            eventbus_stats.lost_reports++;
+            n++;
+        }
+    }
+
+    return n;
+}
+
+uint16_t eventbus_depth(uint8_t queue) {
+    EventQueue_t *eq = &ev_queues[queue];
+    return (uint16_t)(EVQ_LOAD_ACQUIRE(&eq->head) - EVQ_LOAD_ACQUIRE(&eq->tail));
+}
+
+// Events left behind by a dispatch that ran out of budget
+uint16_t eventbus_pending(void) {
+    uint16_t n = 0;
+
+    for(uint8_t q = 0; q < EVQ_COUNT; q++) n += eventbus_depth(q);
+    return n;
+}
+
+const EventBus_QueueStats_t* eventbus_queue_stats(uint8_t queue) {
+    return &ev_queues[queue].stats;
+}
+
+// ============================================
+// STATUS,{"type":"EVENTBUS_STATUS",...}
+// ============================================
+void eventbus_report(void) {
+    char buf[480];
+    int len;
+
+    len = sprintf(buf,
+        "STATUS,{\"type\":\"EVENTBUS_STATUS\",\"dispatched\":%lu,"
+        "\"unhandled\":%lu,\"lost\":%lu,\"queues\":[",
+        (unsigned long)eventbus_stats.dispatched,
+        (unsigned long)eventbus_stats.unhandled,
+        (unsigned long)eventbus_stats.lost_reports);
+
+    for(uint8_t q = 0; q < EVQ_COUNT; q++) {
+        const EventQueue_t *eq = &ev_queues[q];
+        len += sprintf(buf + len,
+            "%s{\"q\":\"%s\",\"size\":%u,\"depth\":%u,\"hwm\":%u,"
+            "\"posted\":%lu,\"drops\":%lu}",
+            q ? "," : "", evq_names[q], eq->stats.size,
+            eventbus_depth(q), eq->stats.hwm,
+            (unsigned long)eq->stats.posted, (unsigned long)eq->stats.drops);
+    }
+
+    sprintf(buf + len, "]}\r\n");
+    uart_dual_send_string(buf);
+}
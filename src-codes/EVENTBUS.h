@@ -0,0 +1,96 @@
+/**
+ * ============================================
+ * EVENT BUS HEADER
+ * Lock-free SPSC queues: interrupt -> main loop
+ * ============================================
+ */
+
+#ifndef EVENTBUS_H
+#define EVENTBUS_H
+
+#include <stdint.h>
+
+// ============================================
+// Build Switches
+// EVENTBUS_HOST - C11-style acquire/release
+//                 builtins instead of __DMB()
+//                 (tools/eventbus_stress.c)
+// ============================================
+
+// ============================================
+// Queues: one per producer context, so every
+// queue has exactly one writer (the ISR) and one
+// reader (eventbus_dispatch in the main loop).
+// Sizes must be powers of two.
+// ============================================
+typedef enum {
+    EVQ_GPIO = 0,           // EINT handlers (button edges)
+    EVQ_UART,               // UART3 RX handler
+    EVQ_DMA,                // GPDMA handler (sensor ready)
+    EVQ_MAIN,               // Main-context producers
+    EVQ_COUNT
+} EventBus_Queue_t;
+
+#define EVQ_GPIO_SIZE       8
+#define EVQ_UART_SIZE       16
+#define EVQ_DMA_SIZE        8
+#define EVQ_MAIN_SIZE       8
+
+#define EVENTBUS_DISPATCH_BUDGET  16    // Events per main-loop pass
+
+// ============================================
+// Event Record (16 bytes)
+// ============================================
+typedef enum {
+    EV_NONE = 0,
+    EV_CARD_DETECTED,       // data = UID (5 bytes)
+    EV_BUTTON_EDGE,         // arg = 1 pressed / 0 released
+    EV_SENSOR_READY,        // arg = ADC channel mask
+    EV_UART_RX_LINE,        // arg = RX ring fill at the '\n'
+    EV_QUEUE_LOST,          // Synthetic: arg = queue that dropped events
+    EV_TYPE_COUNT
+} EventBus_Type_t;
+
+#define EV_DATA_MAX         8
+
+typedef struct {
+    uint8_t type;
+    uint8_t len;            // Bytes used in data
+    uint16_t arg;
+    uint32_t time;          // millis() when posted
+    uint8_t data[EV_DATA_MAX];
+} Event_t;
+
+typedef void (*EventBus_Handler_t)(const Event_t *ev);
+typedef void (*EventBus_Notify_t)(void);
+
+typedef struct {
+    uint32_t posted;
+    uint32_t drops;         // Queue full at post time
+    uint16_t hwm;           // Deepest fill seen by the producer
+    uint16_t size;
+} EventBus_QueueStats_t;
+
+typedef struct {
+    uint32_t dispatched;
+    uint32_t unhandled;     // No handler subscribed
+    uint32_t lost_reports;  // EV_QUEUE_LOST delivered
+} EventBus_Stats_t;
+
+extern EventBus_Stats_t eventbus_stats;
+
+// ============================================
+// Function Prototypes
+// ============================================
+void eventbus_init(void);
+uint8_t eventbus_post(uint8_t queue, uint8_t type, uint16_t arg,
+                      const void *data, uint8_t len);
+void eventbus_subscribe(uint8_t type, EventBus_Handler_t handler);
+void eventbus_set_notify(EventBus_Notify_t notify);
+uint16_t eventbus_pending(void);
+uint16_t eventbus_dispatch(uint16_t budget);
+uint16_t eventbus_depth(uint8_t queue);
+const EventBus_QueueStats_t* eventbus_queue_stats(uint8_t queue);
+void eventbus_report(void);
+
+#endif // EVENTBUS_H
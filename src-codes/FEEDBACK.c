@@ -0,0 +1,190 @@
+/**
+ * ============================================
+ * FEEDBACK SEQUENCER
+ * TIMER2 ticks every FEEDBACK_TICK_MS and walks
+ * two independent channels (buzzer, LEDs) through
+ * declarative step tables. Starting a pattern
+ * returns immediately; a new pattern on a channel
+ * replaces the one playing. When an LED pattern
+ * ends, the LEDs return to the base mask
+ * (occupancy bargraph).
+ * ============================================
+ */
+
+#include "LPC17xx.h"
+#include "FEEDBACK.h"
+
+// ============================================
+// Pattern Tables
+// ============================================
+static const Feedback_Step_t steps_card[] = { {1, 100} };
+static const Feedback_Step_t steps_double[] = { {1, 100}, {0, 100}, {1, 100} };
+static const Feedback_Step_t steps_error[] = { {1, 500}, {0, 200} };
+static const Feedback_Step_t steps_emergency[] = { {1, 800} };
+static const Feedback_Step_t steps_success[] = { {1, 150}, {0, 100}, {1, 150} };
+
+static const Feedback_Step_t steps_running[] = {
+    {0x01, 80}, {0x02, 80}, {0x04, 80}, {0x08, 80},
+    {0x10, 80}, {0x20, 80}, {0x40, 80}
+};
+static const Feedback_Step_t steps_blink[] = { {LED_MASK_ALL, 150}, {0x00, 150} };
+
+#define FB_STEPS(s) (s), (uint8_t)(sizeof(s) / sizeof((s)[0]))
+
+const Feedback_Pattern_t FB_BUZZ_CARD       = { FB_STEPS(steps_card), 1 };
+const Feedback_Pattern_t FB_BUZZ_GATE_OPEN  = { FB_STEPS(steps_double), 1 };
+const Feedback_Pattern_t FB_BUZZ_GATE_CLOSE = { FB_STEPS(steps_card), 1 };
+const Feedback_Pattern_t FB_BUZZ_ERROR      = { FB_STEPS(steps_error), 3 };
+const Feedback_Pattern_t FB_BUZZ_EMERGENCY  = { FB_STEPS(steps_emergency), 1 };
+const Feedback_Pattern_t FB_BUZZ_SUCCESS    = { FB_STEPS(steps_success), 1 };
+const Feedback_Pattern_t FB_LED_RUNNING     = { FB_STEPS(steps_running), 1 };
+const Feedback_Pattern_t FB_LED_BLINK       = { FB_STEPS(steps_blink), 1 };
+
+// Single-step pattern for feedback_beep()
+static Feedback_Step_t beep_step = { 1, 100 };
+static const Feedback_Pattern_t beep_pattern = { &beep_step, 1, 1 };
+
+// ============================================
+// Channel State
+// ============================================
+typedef struct {
+    const Feedback_Pattern_t *pattern;
+    uint8_t step;
+    uint8_t repeat_left;
+    uint16_t remaining_ms;
+} Feedback_Channel_t;
+
+static volatile Feedback_Channel_t ch_buzzer;
+static volatile Feedback_Channel_t ch_leds;
+static volatile uint8_t led_base = 0;
+
+static void buzzer_out(uint8_t on) {
+    if(on) {
+        LPC_GPIO1->FIOSET = BUZZER_PIN;
+    } else {
+        LPC_GPIO1->FIOCLR = BUZZER_PIN;
+    }
+}
+
+static void leds_out(uint8_t mask) {
+    LPC_GPIO1->FIOCLR = LED_ALL_PINS & ~((uint32_t)mask << 19);
+    LPC_GPIO1->FIOSET = (uint32_t)(mask & LED_MASK_ALL) << 19;
+}
+
+// ============================================
+// Initialize TIMER2 sequencer tick
+// ============================================
+void feedback_init(void) {
+    LPC_GPIO1->FIODIR |= BUZZER_PIN | LED_ALL_PINS;
+    LPC_GPIO1->FIOCLR = BUZZER_PIN | LED_ALL_PINS;
+
+    ch_buzzer.pattern = 0;
+    ch_leds.pattern = 0;
+    led_base = 0;
+
+    LPC_SC->PCONP |= (1 << 22);                     // PCTIM2
+    LPC_TIM2->TCR = 0x02;                           // Reset
+    LPC_TIM2->PR = (SystemCoreClock / 4) / 1000000 - 1;   // 1us ticks
+    LPC_TIM2->MR0 = FEEDBACK_TICK_MS * 1000;
+    LPC_TIM2->MCR = (1 << 0) | (1 << 1);            // IRQ + reset on MR0
+    LPC_TIM2->IR = 0x3F;
+    LPC_TIM2->TCR = 0x01;
+
+    NVIC_EnableIRQ(TIMER2_IRQn);
+}
+
+// ============================================
+// Start a pattern on a channel (non-blocking)
+// ============================================
+static void channel_start(volatile Feedback_Channel_t *ch,
+                          const Feedback_Pattern_t *pattern, uint8_t repeat) {
+    NVIC_DisableIRQ(TIMER2_IRQn);
+    ch->pattern = pattern;
+    ch->step = 0;
+    ch->repeat_left = repeat ? repeat : 1;
+    ch->remaining_ms = pattern->steps[0].ms;
+    if(ch == &ch_buzzer) {
+        buzzer_out(pattern->steps[0].out);
+    } else {
+        leds_out(pattern->steps[0].out);
+    }
+    NVIC_EnableIRQ(TIMER2_IRQn);
+}
+
+void feedback_buzzer(const Feedback_Pattern_t *pattern) {
+    channel_start(&ch_buzzer, pattern, pattern->repeat);
+}
+
+void feedback_beep(uint16_t ms) {
+    NVIC_DisableIRQ(TIMER2_IRQn);
+    beep_step.ms = ms;
+    NVIC_EnableIRQ(TIMER2_IRQn);
+    channel_start(&ch_buzzer, &beep_pattern, 1);
+}
+
+void feedback_leds(const Feedback_Pattern_t *pattern, uint8_t repeat) {
+    channel_start(&ch_leds, pattern, repeat ? repeat : pattern->repeat);
+}
+
+// LED state shown whenever no LED pattern is playing
+void feedback_led_base(uint8_t mask) {
+    led_base = mask & LED_MASK_ALL;
+    if(ch_leds.pattern == 0) {
+        leds_out(led_base);
+    }
+}
+
+void feedback_stop(void) {
+    NVIC_DisableIRQ(TIMER2_IRQn);
+    ch_buzzer.pattern = 0;
+    ch_leds.pattern = 0;
+    buzzer_out(0);
+    leds_out(led_base);
+    NVIC_EnableIRQ(TIMER2_IRQn);
+}
+
+uint8_t feedback_busy(void) {
+    return (ch_buzzer.pattern != 0) || (ch_leds.pattern != 0);
+}
+
+// ============================================
+// Advance one channel by one tick
+// Returns the new output, or 0xFF when the
+// pattern has just ended
+// ============================================
+static uint8_t channel_tick(volatile Feedback_Channel_t *ch) {
+    const Feedback_Pattern_t *p = ch->pattern;
+
+    if(ch->remaining_ms > FEEDBACK_TICK_MS) {
+        ch->remaining_ms -= FEEDBACK_TICK_MS;
+        return p->steps[ch->step].out;
+    }
+
+    ch->step++;
+    if(ch->step >= p->count) {
+        ch->step = 0;
+        if(--ch->repeat_left == 0) {
+            ch->pattern = 0;
+            return 0xFF;
+        }
+    }
+
+    ch->remaining_ms = p->steps[ch->step].ms;
+    return p->steps[ch->step].out;
+}
+
+void TIMER2_IRQHandler(void) {
+    uint8_t out;
+
+    LPC_TIM2->IR = (1 << 0);
+
+    if(ch_buzzer.pattern) {
+        out = channel_tick(&ch_buzzer);
+        buzzer_out(out == 0xFF ? 0 : out);
+    }
+
+    if(ch_leds.pattern) {
+        out = channel_tick(&ch_leds);
+        leds_out(out == 0xFF ? led_base : out);
+    }
+}
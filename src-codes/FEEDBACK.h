@@ -0,0 +1,66 @@
+/**
+ * ============================================
+ * FEEDBACK HEADER
+ * Timer-driven buzzer / LED pattern sequencer
+ * ============================================
+ */
+
+#ifndef FEEDBACK_H
+#define FEEDBACK_H
+
+#include <stdint.h>
+
+// ============================================
+// Pin Definitions
+// ============================================
+#define BUZZER_PIN (1<<27)         // P1.27
+
+// LED Pins P1.19 to P1.25 (7 LEDs)
+#define LED1_PIN (1<<19)
+#define LED2_PIN (1<<20)
+#define LED3_PIN (1<<21)
+#define LED4_PIN (1<<22)
+#define LED5_PIN (1<<23)
+#define LED6_PIN (1<<24)
+#define LED7_PIN (1<<25)
+#define LED_ALL_PINS (0x7F<<19)
+#define LED_MASK_ALL 0x7F          // bit0 = LED1 ... bit6 = LED7
+
+#define FEEDBACK_TICK_MS 10        // TIMER2 sequencer tick
+
+// ============================================
+// Pattern Tables
+// out = buzzer on/off, or LED mask for LED patterns
+// ============================================
+typedef struct {
+    uint8_t out;
+    uint16_t ms;
+} Feedback_Step_t;
+
+typedef struct {
+    const Feedback_Step_t *steps;
+    uint8_t count;
+    uint8_t repeat;                // Times to play the whole table
+} Feedback_Pattern_t;
+
+extern const Feedback_Pattern_t FB_BUZZ_CARD;
+extern const Feedback_Pattern_t FB_BUZZ_GATE_OPEN;
+extern const Feedback_Pattern_t FB_BUZZ_GATE_CLOSE;
+extern const Feedback_Pattern_t FB_BUZZ_ERROR;
+extern const Feedback_Pattern_t FB_BUZZ_EMERGENCY;
+extern const Feedback_Pattern_t FB_BUZZ_SUCCESS;
+extern const Feedback_Pattern_t FB_LED_RUNNING;
+extern const Feedback_Pattern_t FB_LED_BLINK;
+
+// ============================================
+// Function Prototypes
+// ============================================
+void feedback_init(void);
+void feedback_buzzer(const Feedback_Pattern_t *pattern);
+void feedback_beep(uint16_t ms);
+void feedback_leds(const Feedback_Pattern_t *pattern, uint8_t repeat);
+void feedback_led_base(uint8_t mask);
+void feedback_stop(void);
+uint8_t feedback_busy(void);
+
+#endif // FEEDBACK_H
@@ -0,0 +1,248 @@
+/**
+ * ============================================
+ * FLASH CARD INDEX
+ * Static 3-level B-tree on SPI NOR flash:
+ * root keys in RAM -> inner page -> leaf page.
+ * A lookup is two binary searches over cached
+ * pages plus one over the 16 leaf records, so at
+ * most two 256-byte SPI reads on a cold cache
+ * (~0.7ms at 3MHz) and none on a warm one.
+ *
+ * The index is read-only; CARDDB copies a found
+ * card into its RAM store, where in/out state
+ * lives, and keeps downlink revocations until the
+ * host tool builds the next image.
+ * ============================================
+ */
+
+#include "FLASHIDX.h"
+
+#if FLASHIDX_ENABLE
+
+#include "PROFILE.h"
+#include <string.h>
+
+#ifdef FLASHIDX_SIM
+const uint8_t *flashidx_sim_image = 0;
+uint32_t flashidx_sim_size = 0;
+#else
+#include "SSP0.h"
+#define FLASH_CMD_READ  0x03
+#endif
+
+typedef struct {
+    uint32_t page;
+    uint32_t stamp;                 // LRU age
+    uint8_t valid;
+    uint8_t data[FLASHIDX_PAGE_SIZE];
+} FlashIdx_CachePage_t;
+
+FlashIdx_Stats_t flashidx_stats;
+
+static FlashIdx_Header_t idx_hdr;
+static uint8_t idx_ready = 0;
+static uint32_t idx_root[FLASHIDX_ROOT_MAX];
+static FlashIdx_CachePage_t idx_cache[FLASHIDX_CACHE_PAGES];
+static uint32_t idx_clock = 0;
+
+// ============================================
+// Backend
+// ============================================
+static void flash_read(uint32_t addr, uint8_t *buf, uint16_t len) {
+#ifdef FLASHIDX_SIM
+    for(uint16_t i = 0; i < len; i++) {
+        buf[i] = (addr + i < flashidx_sim_size) ? flashidx_sim_image[addr + i] : 0xFF;
+    }
+#else
+    SelFlash();
+    SSP0_TRANSFER(FLASH_CMD_READ);
+    SSP0_TRANSFER((uint8_t)(addr >> 16));
+    SSP0_TRANSFER((uint8_t)(addr >> 8));
+    SSP0_TRANSFER((uint8_t)addr);
+    for(uint16_t i = 0; i < len; i++) {
+        buf[i] = SSP0_TRANSFER(0xFF);
+    }
+    DeselFlash();
+#endif
+    flashidx_stats.bytes_read += len;
+}
+
+// ============================================
+// LRU Page Cache
+// ============================================
+static const uint8_t* page_get(uint32_t page) {
+    FlashIdx_CachePage_t *victim = &idx_cache[0];
+
+    idx_clock++;
+
+    for(uint8_t i = 0; i < FLASHIDX_CACHE_PAGES; i++) {
+        FlashIdx_CachePage_t *c = &idx_cache[i];
+
+        if(c->valid && c->page == page) {
+            c->stamp = idx_clock;
+            flashidx_stats.page_hits++;
+            return c->data;
+        }
+        if(!c->valid) {
+            if(victim->valid) victim = c;
+        } else if(victim->valid && c->stamp < victim->stamp) {
+            victim = c;
+        }
+    }
+
+    flashidx_stats.page_misses++;
+    flash_read(page * FLASHIDX_PAGE_SIZE, victim->data, FLASHIDX_PAGE_SIZE);
+    victim->page = page;
+    victim->stamp = idx_clock;
+    victim->valid = 1;
+    return victim->data;
+}
+
+static uint32_t rd32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Index of the last key <= key in a sorted array, -1 if none
+static int16_t fence_search(const uint8_t *keys, uint16_t n, uint32_t key) {
+    int16_t lo = 0;
+    int16_t hi = (int16_t)n - 1;
+    int16_t found = -1;
+
+    while(lo <= hi) {
+        int16_t mid = (lo + hi) / 2;
+        if(rd32(keys + mid * 4) <= key) {
+            found = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return found;
+}
+
+// ============================================
+// Init: read and check the header, load root
+// ============================================
+uint8_t flashidx_init(void) {
+    uint8_t hdr[sizeof(FlashIdx_Header_t)];
+
+    idx_ready = 0;
+    memset(idx_cache, 0, sizeof(idx_cache));
+    memset(&flashidx_stats, 0, sizeof(flashidx_stats));
+
+    flash_read(0, hdr, sizeof(hdr));
+    memcpy(&idx_hdr, hdr, sizeof(idx_hdr));
+
+    if(idx_hdr.magic != FLASHIDX_MAGIC ||
+       idx_hdr.version != FLASHIDX_VERSION ||
+       idx_hdr.page_size != FLASHIDX_PAGE_SIZE ||
+       idx_hdr.root_count == 0 ||
+       idx_hdr.root_count > FLASHIDX_ROOT_MAX) {
+        return 0;                           // No chip / no image
+    }
+
+    flash_read(idx_hdr.root_page * FLASHIDX_PAGE_SIZE,
+               (uint8_t *)idx_root, idx_hdr.root_count * 4);
+
+    idx_ready = 1;
+    return 1;
+}
+
+uint8_t flashidx_ready(void) {
+    return idx_ready;
+}
+
+uint32_t flashidx_record_count(void) {
+    return idx_ready ? idx_hdr.record_count : 0;
+}
+
+// Walk root -> inner -> leaf; record copied out on a hit
+static uint8_t index_walk(uint32_t key, FlashIdx_Record_t *rec) {
+    const uint8_t *page;
+    int16_t r, l, k;
+    uint32_t leaf;
+    uint16_t n;
+
+    r = fence_search((const uint8_t *)idx_root, idx_hdr.root_count, key);
+    if(r < 0) return 0;
+
+    // Inner page r covers leaves r*64 ... r*64+63
+    n = FLASHIDX_INNER_KEYS;
+    if((uint32_t)(r + 1) * FLASHIDX_INNER_KEYS > idx_hdr.leaf_count) {
+        n = idx_hdr.leaf_count - (uint32_t)r * FLASHIDX_INNER_KEYS;
+    }
+    page = page_get(idx_hdr.inner_page + r);
+    l = fence_search(page, n, key);
+    if(l < 0) return 0;
+
+    leaf = (uint32_t)r * FLASHIDX_INNER_KEYS + l;
+    n = FLASHIDX_LEAF_RECORDS;
+    if((leaf + 1) * FLASHIDX_LEAF_RECORDS > idx_hdr.record_count) {
+        n = idx_hdr.record_count - leaf * FLASHIDX_LEAF_RECORDS;
+    }
+    page = page_get(idx_hdr.leaf_page + leaf);
+
+    // Records are 16 bytes with the key first: search on a 16-byte stride
+    {
+        int16_t lo = 0;
+        int16_t hi = (int16_t)n - 1;
+
+        k = -1;
+        while(lo <= hi) {
+            int16_t mid = (lo + hi) / 2;
+            uint32_t v = rd32(page + mid * sizeof(FlashIdx_Record_t));
+
+            if(v == key) { k = mid; break; }
+            if(v < key) lo = mid + 1;
+            else hi = mid - 1;
+        }
+    }
+    if(k < 0) return 0;
+
+    if(rec) {
+        memcpy(rec, page + k * sizeof(FlashIdx_Record_t), sizeof(FlashIdx_Record_t));
+    }
+    return 1;
+}
+
+uint8_t flashidx_lookup(const uint8_t *uid, FlashIdx_Record_t *rec) {
+    FlashIdx_Record_t r;
+    uint32_t key = rd32(uid);
+    uint8_t ok;
+
+    if(!idx_ready) return 0;
+
+    PROF_BEGIN(PROF_FLASH_LOOKUP);
+    flashidx_stats.lookups++;
+    ok = index_walk(key, &r) && (r.flags & FLASHIDX_REC_ACTIVE);
+    PROF_END(PROF_FLASH_LOOKUP);
+
+    if(!ok) return 0;
+
+    flashidx_stats.found++;
+    if(rec) *rec = r;
+    return 1;
+}
+
+// Pull the inner/leaf pages for this UID into the cache
+void flashidx_prefetch(const uint8_t *uid) {
+    if(idx_ready) {
+        index_walk(rd32(uid), 0);
+    }
+}
+
+// buf must hold FLASHIDX_GROUP_LEN bytes
+const char* flashidx_group_name(uint8_t group, char *buf) {
+    const uint8_t *page;
+
+    buf[0] = '\0';
+    if(!idx_ready || group >= idx_hdr.group_count) return buf;
+
+    page = page_get(idx_hdr.group_page);
+    memcpy(buf, page + group * FLASHIDX_GROUP_LEN, FLASHIDX_GROUP_LEN);
+    buf[FLASHIDX_GROUP_LEN - 1] = '\0';
+    return buf;
+}
+
+#endif // FLASHIDX_ENABLE
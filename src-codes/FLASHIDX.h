@@ -0,0 +1,103 @@
+/**
+ * ============================================
+ * FLASH CARD INDEX HEADER
+ * Read-only card index on SPI NOR flash
+ * (image built by tools/flashidx_build.py)
+ * ============================================
+ */
+
+#ifndef FLASHIDX_H
+#define FLASHIDX_H
+
+#include <stdint.h>
+
+// ============================================
+// Build Switches
+// FLASHIDX_ENABLE 1 - flash tier behind the RAM
+//                     store; off by default, boards
+//                     with the chip on P0.6 set it in
+//                     the target's C/C++ defines
+// FLASHIDX_SIM      - pages come from a RAM image
+//                     (flashidx_sim_image) instead
+//                     of the SPI chip
+// ============================================
+#ifndef FLASHIDX_ENABLE
+#define FLASHIDX_ENABLE 0
+#endif
+
+// ============================================
+// Image Layout (little-endian, 256-byte pages)
+//
+// page 0            header
+// group_page        group_count x 16-byte names
+// leaf pages        16 records each, sorted by key
+// inner pages       64 keys each = first key of 64 leaves
+// root_page         root_count keys = first key of each
+//                   inner page (held in RAM)
+//
+// key = UID bytes 0..3 as a little-endian word
+// ============================================
+#define FLASHIDX_MAGIC         0x58444943UL     // "CIDX"
+#define FLASHIDX_VERSION       1
+#define FLASHIDX_PAGE_SIZE     256
+#define FLASHIDX_LEAF_RECORDS  16
+#define FLASHIDX_INNER_KEYS    64
+#define FLASHIDX_ROOT_MAX      256      // 256 x 64 x 16 = 262144 cards
+#define FLASHIDX_GROUP_LEN     16
+
+#ifndef FLASHIDX_CACHE_PAGES
+#define FLASHIDX_CACHE_PAGES   8        // 2KB LRU page cache
+#endif
+
+#define FLASHIDX_REC_ACTIVE    0x01
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t page_size;
+    uint32_t record_count;
+    uint32_t group_page;
+    uint32_t leaf_page;
+    uint32_t leaf_count;
+    uint32_t inner_page;
+    uint32_t inner_count;
+    uint32_t root_page;
+    uint16_t root_count;
+    uint8_t group_count;
+    uint8_t reserved;
+} FlashIdx_Header_t;
+
+typedef struct {
+    uint32_t key;
+    char name[8];               // NUL-padded, no NUL at full length
+    uint8_t group;
+    uint8_t flags;
+    uint16_t reserved;
+} FlashIdx_Record_t;               // 16 bytes
+
+typedef struct {
+    uint32_t lookups;
+    uint32_t found;
+    uint32_t page_hits;
+    uint32_t page_misses;
+    uint32_t bytes_read;            // SPI payload bytes
+} FlashIdx_Stats_t;
+
+extern FlashIdx_Stats_t flashidx_stats;
+
+#ifdef FLASHIDX_SIM
+extern const uint8_t *flashidx_sim_image;
+extern uint32_t flashidx_sim_size;
+#endif
+
+// ============================================
+// Function Prototypes
+// ============================================
+uint8_t flashidx_init(void);
+uint8_t flashidx_ready(void);
+uint32_t flashidx_record_count(void);
+uint8_t flashidx_lookup(const uint8_t *uid, FlashIdx_Record_t *rec);
+void flashidx_prefetch(const uint8_t *uid);
+const char* flashidx_group_name(uint8_t group, char *buf);
+
+#endif // FLASHIDX_H
@@ -0,0 +1,158 @@
+/**
+ * ============================================
+ * FLOW RATE ESTIMATOR
+ * A scan only bumps a bucket counter. Closing a
+ * bucket is one multiply-add per horizon and
+ * direction, and the time-to-full is
+ *     (capacity - inside) / (entry - exit rate)
+ * on the alert horizon, checked once per bucket.
+ * Everything is integer; no floats, no history.
+ * ============================================
+ */
+
+#include "FLOWRATE.h"
+#include "uart.h"
+#include <stdio.h>
+#include <string.h>
+
+#define FLOW_BUCKET_MAX  1000           // Keeps count << 16 well inside int32
+
+static const uint16_t flow_alpha[FLOW_HORIZONS] = {
+    FLOW_H0_ALPHA_Q16, FLOW_H1_ALPHA_Q16, FLOW_H2_ALPHA_Q16
+};
+
+static const uint16_t flow_tau_s[FLOW_HORIZONS] = {
+    FLOW_H0_TAU_S, FLOW_H1_TAU_S, FLOW_H2_TAU_S
+};
+
+FlowRate_Config_t flowrate_config = {
+    {FLOW_ALERT_TTF_1_S, FLOW_ALERT_TTF_2_S, FLOW_ALERT_TTF_3_S},
+    1                                   // 5 min horizon
+};
+
+FlowRate_Stats_t flowrate_stats;
+
+static int32_t flow_rate[2][FLOW_HORIZONS];     // Q16 people per bucket
+static uint16_t flow_count[2];                  // Current bucket
+static uint32_t flow_bucket_start = 0;
+
+void flowrate_init(uint32_t now) {
+    memset(flow_rate, 0, sizeof(flow_rate));
+    memset(flow_count, 0, sizeof(flow_count));
+    memset(&flowrate_stats, 0, sizeof(flowrate_stats));
+    flow_bucket_start = now;
+}
+
+// ============================================
+// Bucket Close
+// ============================================
+static void bucket_close(void) {
+    for(uint8_t d = 0; d < 2; d++) {
+        int32_t x = (int32_t)flow_count[d] << 16;
+
+        for(uint8_t h = 0; h < FLOW_HORIZONS; h++) {
+            flow_rate[d][h] += (int32_t)(((int64_t)(x - flow_rate[d][h]) * flow_alpha[h]) >> 16);
+        }
+        flow_count[d] = 0;
+    }
+    flowrate_stats.buckets++;
+}
+
+static void bucket_roll(uint32_t now) {
+    uint16_t n = 0;
+
+    while((now - flow_bucket_start) >= FLOW_BUCKET_MS) {
+        if(++n > FLOW_MAX_CATCHUP) {
+            // Idle for over an hour: every rate has decayed to noise
+            memset(flow_rate, 0, sizeof(flow_rate));
+            memset(flow_count, 0, sizeof(flow_count));
+            flow_bucket_start = now;
+            flowrate_stats.resets++;
+            return;
+        }
+        bucket_close();
+        flow_bucket_start += FLOW_BUCKET_MS;
+    }
+}
+
+void flowrate_record(FlowRate_Dir_t dir, uint32_t now) {
+    bucket_roll(now);
+    if(flow_count[dir] < FLOW_BUCKET_MAX) flow_count[dir]++;
+}
+
+// ============================================
+// Readouts
+// ============================================
+uint16_t flowrate_per_hour(FlowRate_Dir_t dir, uint8_t horizon) {
+    int64_t r = (int64_t)flow_rate[dir][horizon] * (3600000UL / FLOW_BUCKET_MS);
+
+    return (uint16_t)((r + 0x8000) >> 16);
+}
+
+int16_t flowrate_net_per_hour(uint8_t horizon) {
+    int64_t r = (int64_t)(flow_rate[FLOW_ENTRY][horizon] - flow_rate[FLOW_EXIT][horizon]) *
+                (3600000UL / FLOW_BUCKET_MS);
+
+    return (int16_t)((r + (r < 0 ? -0x8000 : 0x8000)) / 65536);
+}
+
+// Seconds until inside reaches capacity at the current net inflow
+int32_t flowrate_ttf_s(uint8_t horizon, int16_t inside, int16_t capacity) {
+    int32_t net = flow_rate[FLOW_ENTRY][horizon] - flow_rate[FLOW_EXIT][horizon];
+    int32_t room = capacity - inside;
+    int64_t ttf;
+
+    if(room <= 0) return 0;
+    if(net <= 0) return FLOW_TTF_NONE;
+
+    ttf = ((int64_t)room * (FLOW_BUCKET_MS / 1000) << 16) / net;
+    return (ttf > FLOW_TTF_MAX_S) ? FLOW_TTF_NONE : (int32_t)ttf;
+}
+
+// ============================================
+// Service: roll buckets, raise/clear alerts
+// ============================================
+void flowrate_service(uint32_t now, int16_t inside, int16_t capacity) {
+    char buf[192];
+    uint32_t closed = flowrate_stats.buckets;
+    uint8_t h = flowrate_config.alert_horizon;
+    uint8_t level = flowrate_stats.level;
+    int32_t ttf;
+
+    bucket_roll(now);
+    if(flowrate_stats.buckets == closed) {
+        return;
+    }
+
+    ttf = flowrate_ttf_s(h, inside, capacity);
+
+    // Escalate to the deepest threshold crossed
+    while(level < FLOW_ALERT_LEVELS && flowrate_config.alert_ttf_s[level] &&
+          ttf != FLOW_TTF_NONE && ttf <= flowrate_config.alert_ttf_s[level]) {
+        level++;
+    }
+
+    // Step down with 25% hysteresis
+    while(level > 0) {
+        uint32_t limit = flowrate_config.alert_ttf_s[level - 1];
+
+        if(ttf != FLOW_TTF_NONE && (uint32_t)ttf <= limit + limit / 4) break;
+        level--;
+    }
+
+    if(level == flowrate_stats.level) {
+        return;
+    }
+
+    sprintf(buf,
+        "ALERT,{\"type\":\"CAPACITY_FORECAST\",\"level\":%u,"
+        "\"ttf_s\":%ld,\"limit_s\":%u,\"horizon_s\":%u,"
+        "\"inside\":%d,\"capacity\":%d,\"net_ph\":%d}\r\n",
+        level, (long)ttf,
+        level ? flowrate_config.alert_ttf_s[level - 1] : 0,
+        flow_tau_s[h], inside, capacity, flowrate_net_per_hour(h));
+    uart_dual_send_string(buf);
+
+    flowrate_stats.level = level;
+    flowrate_stats.alerts++;
+}
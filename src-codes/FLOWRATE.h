@@ -0,0 +1,78 @@
+/**
+ * ============================================
+ * FLOW RATE ESTIMATOR HEADER
+ * EWMA entry/exit rates + time-to-capacity
+ * ============================================
+ */
+
+#ifndef FLOWRATE_H
+#define FLOWRATE_H
+
+#include <stdint.h>
+
+// ============================================
+// Estimator (millis() time base)
+// Scans are counted per bucket; at each bucket
+// close every horizon folds the count in with
+//     rate += alpha * (count - rate)
+// alpha = 1 - exp(-bucket / horizon), Q16.
+// Rates are Q16 people per bucket.
+// ============================================
+#define FLOW_BUCKET_MS        10000UL   // 10 s buckets
+#define FLOW_HORIZONS         3
+#define FLOW_MAX_CATCHUP      360       // Idle buckets folded in before a reset (1 h)
+#define FLOW_TTF_NONE         (-1)      // Not filling / beyond FLOW_TTF_MAX_S
+#define FLOW_TTF_MAX_S        86400L
+
+// Horizon time constants and their alpha for a 10 s bucket
+#define FLOW_H0_TAU_S         60
+#define FLOW_H0_ALPHA_Q16     10061     // 1 - exp(-10/60)
+#define FLOW_H1_TAU_S         300
+#define FLOW_H1_ALPHA_Q16     2149      // 1 - exp(-10/300)
+#define FLOW_H2_TAU_S         900
+#define FLOW_H2_ALPHA_Q16     724       // 1 - exp(-10/900)
+
+// ============================================
+// Pre-capacity Alerts
+// Level n is raised when the projected time to
+// full on alert_horizon drops to alert_ttf_s[n-1]
+// (thresholds descending, 0 = level unused). A
+// level clears once the projection is 25% above
+// its threshold again.
+// ============================================
+#define FLOW_ALERT_LEVELS     3
+#define FLOW_ALERT_TTF_1_S    600       // Full in <10 min
+#define FLOW_ALERT_TTF_2_S    300       // Full in <5 min
+#define FLOW_ALERT_TTF_3_S    60        // Full in <1 min
+
+typedef enum {
+    FLOW_ENTRY = 0,
+    FLOW_EXIT
+} FlowRate_Dir_t;
+
+typedef struct {
+    uint16_t alert_ttf_s[FLOW_ALERT_LEVELS];
+    uint8_t alert_horizon;              // Index into the horizons
+} FlowRate_Config_t;
+
+typedef struct {
+    uint32_t buckets;                   // Buckets folded in
+    uint32_t resets;                    // Idle gaps past FLOW_MAX_CATCHUP
+    uint32_t alerts;                    // CAPACITY_FORECAST frames sent
+    uint8_t level;                      // Current alert level
+} FlowRate_Stats_t;
+
+extern FlowRate_Config_t flowrate_config;
+extern FlowRate_Stats_t flowrate_stats;
+
+// ============================================
+// Function Prototypes
+// ============================================
+void flowrate_init(uint32_t now);
+void flowrate_record(FlowRate_Dir_t dir, uint32_t now);
+void flowrate_service(uint32_t now, int16_t inside, int16_t capacity);
+uint16_t flowrate_per_hour(FlowRate_Dir_t dir, uint8_t horizon);
+int16_t flowrate_net_per_hour(uint8_t horizon);
+int32_t flowrate_ttf_s(uint8_t horizon, int16_t inside, int16_t capacity);
+
+#endif // FLOWRATE_H
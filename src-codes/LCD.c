@@ -1,5 +1,41 @@
 #include "LCD.h"
 #include "DELAY.h"
+#include "PROFILE.h"
+
+static void lcd_fb_flush_blocking(void);
+
+// ============================================
+// Shadow State
+// lcd_shown mirrors the panel DDRAM (tracked in
+// lcd_command/lcd_data), lcd_fb is what callers drew
+// ============================================
+static char lcd_shown[LCD_ROWS][LCD_COLS];
+static char lcd_fb[LCD_ROWS][LCD_COLS];
+static uint8_t lcd_shown_valid = 0;
+static uint8_t lcd_addr = 0;            // DDRAM address counter, 0xFF = unknown/CGRAM
+static uint8_t lcd_fb_pending = 0;      // Last flush hit a full queue
+static uint8_t lcd_fb_full = 0;         // Full redraw queued, not yet drained
+
+LCD_Flush_Stats_t lcd_flush_stats;
+
+// ============================================
+// Async Writer State (TIMER1 ISR)
+// Entry = RS flag | byte; producer owns tail,
+// ISR owns head
+// ============================================
+#define LCD_Q_RS 0x100
+
+static volatile uint16_t lcd_q[LCD_QUEUE_SIZE];
+static volatile uint32_t lcd_q_time[LCD_QUEUE_SIZE];
+static volatile uint8_t lcd_q_head = 0;
+static volatile uint8_t lcd_q_tail = 0;
+static volatile uint8_t lcd_async_on = 0;
+static volatile uint8_t lcd_async_idle = 1;
+static uint16_t lcd_cur_op;
+static uint8_t lcd_phase = 0;           // 0 = upper nibble next, 1 = lower
+static uint8_t lcd_wait_ticks = 0;
+
+LCD_Async_Stats_t lcd_async_stats;
 
 // ============================================
 // LCD Initialization
@@ -55,13 +91,14 @@ void lcd_init(void) {
     // Home Cursor
     lcd_command(0x02);
     delay_ms(5);
+
+    lcd_fb_clear();
 }
 
 // ============================================
-// Send 4-bit nibble to LCD
+// Put 4-bit nibble on D4-D7
 // ============================================
-void lcd_nibble(unsigned char nibble) {
-    // Set data pins based on nibble value
+static void lcd_data_pins(unsigned char nibble) {
     if(nibble & 0x01) 
         LPC_GPIO0->FIOSET = D4; 
     else 
@@ -81,6 +118,13 @@ void lcd_nibble(unsigned char nibble) {
         LPC_GPIO0->FIOSET = D7; 
     else 
         LPC_GPIO0->FIOCLR = D7;
+}
+
+// ============================================
+// Send 4-bit nibble to LCD
+// ============================================
+void lcd_nibble(unsigned char nibble) {
+    lcd_data_pins(nibble);
     
     // Create enable pulse (minimum 450ns high time)
     LPC_GPIO0->FIOSET = EN;
@@ -89,6 +133,44 @@ void lcd_nibble(unsigned char nibble) {
     delay_us(100);
 }
 
+// ============================================
+// Shadow tracking of DDRAM contents/address
+// ============================================
+static void lcd_track_command(unsigned char cmd) {
+    if(cmd == 0x01) {
+        for(uint8_t r = 0; r < LCD_ROWS; r++) {
+            for(uint8_t c = 0; c < LCD_COLS; c++) {
+                lcd_shown[r][c] = ' ';
+            }
+        }
+        lcd_shown_valid = 1;
+        lcd_addr = 0x00;
+    } else if(cmd & 0x80) {
+        lcd_addr = cmd & 0x7F;              // Set DDRAM address
+    } else if(cmd & 0x40) {
+        lcd_addr = 0xFF;                    // Set CGRAM address
+    } else if((cmd & 0xFE) == 0x02) {
+        lcd_addr = 0x00;                    // Return home
+    }
+}
+
+static void lcd_track_data(unsigned char data) {
+    // Mirror the write and advance like the controller (increment mode)
+    if(lcd_addr == 0xFF) {
+        return;
+    }
+    if((lcd_addr & 0x3F) < LCD_COLS) {
+        lcd_shown[(lcd_addr & 0x40) ? 1 : 0][lcd_addr & 0x3F] = data;
+    }
+    if(lcd_addr == 0x27) {
+        lcd_addr = 0x40;
+    } else if(lcd_addr == 0x67) {
+        lcd_addr = 0x00;
+    } else {
+        lcd_addr++;
+    }
+}
+
 // ============================================
 // Send command to LCD
 // ============================================
@@ -97,6 +179,8 @@ void lcd_command(unsigned char cmd) {
     lcd_nibble(cmd >> 4);     // Send upper nibble
     lcd_nibble(cmd & 0x0F);   // Send lower nibble
     delay_ms(2);              // Wait for command execution
+
+    lcd_track_command(cmd);
 }
 
 // ============================================
@@ -107,15 +191,19 @@ void lcd_data(unsigned char data) {
     lcd_nibble(data >> 4);    // Send upper nibble
     lcd_nibble(data & 0x0F);  // Send lower nibble
     delay_us(200);
+
+    lcd_track_data(data);
 }
 
 // ============================================
 // Send string to LCD
 // ============================================
 void lcd_string(const char *str) {
+    PROF_BEGIN(PROF_LCD_STRING);
     while(*str) {
         lcd_data(*str++);
     }
+    PROF_END(PROF_LCD_STRING);
 }
 
 // ============================================
@@ -170,3 +258,264 @@ void lcd_test(void) {
     
     lcd_clear();
 }
+
+// ============================================
+// Framebuffer: draw into RAM
+// ============================================
+void lcd_fb_clear(void) {
+    for(uint8_t r = 0; r < LCD_ROWS; r++) {
+        for(uint8_t c = 0; c < LCD_COLS; c++) {
+            lcd_fb[r][c] = ' ';
+        }
+    }
+}
+
+void lcd_fb_write(unsigned char row, unsigned char col, const char *str) {
+    if(row >= LCD_ROWS) return;
+    while(*str && col < LCD_COLS) {
+        lcd_fb[row][col++] = *str++;
+    }
+}
+
+// Whole line, padded with spaces
+void lcd_fb_line(unsigned char row, const char *str) {
+    if(row >= LCD_ROWS) return;
+    for(uint8_t c = 0; c < LCD_COLS; c++) {
+        lcd_fb[row][c] = *str ? *str++ : ' ';
+    }
+}
+
+// Next flush rewrites every cell (panel content unknown)
+void lcd_fb_invalidate(void) {
+    lcd_shown_valid = 0;
+}
+
+// ============================================
+// Async writer: enqueue one byte (never blocks)
+// Caller holds TIMER1 IRQ off (see lcd_fb_flush)
+// ============================================
+static uint8_t lcd_async_put(uint16_t op) {
+    uint8_t next = (lcd_q_tail + 1) % LCD_QUEUE_SIZE;
+    uint8_t depth;
+
+    if(next == lcd_q_head) {
+        lcd_async_stats.overflows++;
+        return 0;
+    }
+
+    lcd_q[lcd_q_tail] = op;
+    lcd_q_time[lcd_q_tail] = LPC_TIM1->TC;
+    lcd_q_tail = next;
+
+    depth = (lcd_q_tail + LCD_QUEUE_SIZE - lcd_q_head) % LCD_QUEUE_SIZE;
+    if(depth > lcd_async_stats.max_depth) {
+        lcd_async_stats.max_depth = depth;
+    }
+    return 1;
+}
+
+// ============================================
+// Framebuffer: write only the changed cells
+// Async mode: pending (not yet started) writes of
+// the previous screen are dropped first, so the
+// latest screen always wins; the diff runs against
+// what the ISR has already committed to the panel.
+// Short clean gaps are rewritten instead of
+// issuing a cursor move when that is cheaper.
+// ============================================
+void lcd_fb_flush(void) {
+    uint16_t bytes = 0;
+    uint16_t moves = 0;
+    uint8_t addr;
+    uint8_t ok = 1;
+    PROF_BEGIN(PROF_LCD_FLUSH);
+
+    if(!lcd_async_on) {
+        lcd_fb_flush_blocking();
+        PROF_END(PROF_LCD_FLUSH);
+        return;
+    }
+
+    NVIC_DisableIRQ(TIMER1_IRQn);
+
+    if(lcd_q_tail != lcd_q_head) {
+        lcd_async_stats.replaced += (lcd_q_tail + LCD_QUEUE_SIZE - lcd_q_head) % LCD_QUEUE_SIZE;
+        lcd_q_tail = lcd_q_head;
+
+        // Dropped cells of a full redraw: panel content unknown again
+        if(lcd_fb_full) lcd_shown_valid = 0;
+    }
+    lcd_fb_full = 0;
+
+    // Address after the op currently on the bus (already committed)
+    addr = lcd_addr;
+
+    for(uint8_t r = 0; r < LCD_ROWS && ok; r++) {
+        uint8_t base = r ? 0x40 : 0x00;
+
+        for(uint8_t c = 0; c < LCD_COLS && ok; c++) {
+            if(lcd_shown_valid && lcd_fb[r][c] == lcd_shown[r][c]) {
+                continue;
+            }
+
+            if(addr != base + c) {
+                uint8_t cur = addr - base;
+
+                if(addr != 0xFF && addr >= base && cur < c &&
+                   (c - cur) <= LCD_FB_BRIDGE_MAX) {
+                    while(cur < c && ok) {
+                        ok = lcd_async_put(LCD_Q_RS | (uint8_t)lcd_fb[r][cur++]);
+                        bytes += ok;
+                    }
+                } else {
+                    ok = lcd_async_put(0x80 | (base + c));
+                    bytes += ok;
+                    moves += ok;
+                }
+            }
+
+            if(ok) {
+                ok = lcd_async_put(LCD_Q_RS | (uint8_t)lcd_fb[r][c]);
+                bytes += ok;
+                addr = base + c + 1;
+            }
+        }
+    }
+
+    // A truncated screen is completed by lcd_fb_service(); a
+    // complete one makes every cell known again once drained
+    lcd_fb_pending = !ok;
+    if(ok && !lcd_shown_valid) {
+        lcd_shown_valid = 1;
+        lcd_fb_full = (lcd_q_tail != lcd_q_head);
+    }
+
+    // Kick the writer if it went idle (queue published first)
+    if(lcd_async_idle && lcd_q_tail != lcd_q_head) {
+        lcd_async_idle = 0;
+        LPC_TIM1->MR0 = LPC_TIM1->TC + LCD_TICK_US;
+        LPC_TIM1->MCR |= (1 << 0);
+    }
+
+    NVIC_EnableIRQ(TIMER1_IRQn);
+
+    lcd_flush_stats.bytes = bytes;
+    lcd_flush_stats.cursor_moves = moves;
+    lcd_flush_stats.bus_us = (uint32_t)(bytes - moves) * LCD_DATA_US +
+                             (uint32_t)moves * LCD_CMD_US;
+    if(bytes) {
+        lcd_flush_stats.total_bytes += bytes;
+        lcd_flush_stats.flushes++;
+    }
+    PROF_END(PROF_LCD_FLUSH);
+}
+
+// Retry a flush that was cut short by a full queue
+void lcd_fb_service(void) {
+    if(lcd_fb_pending) {
+        lcd_fb_flush();
+    }
+}
+
+// ============================================
+// Blocking flush (boot, before lcd_async_init)
+// ============================================
+static void lcd_fb_flush_blocking(void) {
+    for(uint8_t r = 0; r < LCD_ROWS; r++) {
+        for(uint8_t c = 0; c < LCD_COLS; c++) {
+            if(lcd_shown_valid && lcd_fb[r][c] == lcd_shown[r][c]) {
+                continue;
+            }
+            if(lcd_addr != (r ? 0x40 : 0x00) + c) {
+                lcd_goto(r, c);
+            }
+            lcd_data(lcd_fb[r][c]);
+        }
+    }
+    lcd_shown_valid = 1;
+}
+
+// ============================================
+// Async writer: TIMER1 as 1us free-running
+// counter, MR0 match = one writer tick
+// ============================================
+void lcd_async_init(void) {
+    LPC_SC->PCONP |= (1 << 2);              // PCTIM1
+    LPC_TIM1->TCR = 0x02;                   // Reset
+    LPC_TIM1->PR = (SystemCoreClock / 4) / 1000000 - 1;   // PCLK = CCLK/4, 1us
+    LPC_TIM1->MCR = 0;                      // Match IRQ enabled on demand
+    LPC_TIM1->IR = 0x3F;
+    LPC_TIM1->TCR = 0x01;                   // Free running
+
+    lcd_q_head = lcd_q_tail = 0;
+    lcd_phase = 0;
+    lcd_wait_ticks = 0;
+    lcd_async_idle = 1;
+
+    NVIC_SetPriority(TIMER1_IRQn, LCD_IRQ_PRIORITY);
+    NVIC_EnableIRQ(TIMER1_IRQn);
+    lcd_async_on = 1;
+}
+
+uint8_t lcd_async_busy(void) {
+    return (lcd_q_head != lcd_q_tail) || !lcd_async_idle;
+}
+
+// One nibble per tick; EN high >450ns by a short spin
+static void lcd_nibble_fast(unsigned char nibble) {
+    lcd_data_pins(nibble);
+    LPC_GPIO0->FIOSET = EN;
+    for(volatile uint8_t i = 0; i < LCD_EN_SPIN; i++);
+    LPC_GPIO0->FIOCLR = EN;
+}
+
+void TIMER1_IRQHandler(void) {
+    LPC_TIM1->IR = (1 << 0);
+    LPC_TIM1->MR0 = LPC_TIM1->TC + LCD_TICK_US;
+
+    if(lcd_wait_ticks) {
+        lcd_wait_ticks--;                   // Clear/home execution time
+        return;
+    }
+
+    if(lcd_phase == 0) {
+        uint32_t latency;
+
+        if(lcd_q_head == lcd_q_tail) {
+            LPC_TIM1->MCR &= ~(1 << 0);     // Nothing queued: stop ticking
+            lcd_async_idle = 1;
+            return;
+        }
+
+        lcd_cur_op = lcd_q[lcd_q_head];
+        latency = LPC_TIM1->TC - lcd_q_time[lcd_q_head];
+        lcd_q_head = (lcd_q_head + 1) % LCD_QUEUE_SIZE;
+
+        // Committed once it leaves the queue: it can no longer be dropped
+        if(lcd_cur_op & LCD_Q_RS) {
+            lcd_track_data(lcd_cur_op & 0xFF);
+            LPC_GPIO0->FIOSET = RS;
+        } else {
+            lcd_track_command(lcd_cur_op & 0xFF);
+            LPC_GPIO0->FIOCLR = RS;
+        }
+
+        lcd_async_stats.last_latency_us = latency;
+        if(latency > lcd_async_stats.max_latency_us) {
+            lcd_async_stats.max_latency_us = latency;
+        }
+        lcd_async_stats.written++;
+
+        lcd_nibble_fast((lcd_cur_op >> 4) & 0x0F);
+        lcd_phase = 1;
+    } else {
+        lcd_nibble_fast(lcd_cur_op & 0x0F);
+        lcd_phase = 0;
+
+        // Next tick (>37us) covers normal commands/data;
+        // clear and home need ~1.52ms
+        if(!(lcd_cur_op & LCD_Q_RS) && (lcd_cur_op & 0xFF) <= 0x03) {
+            lcd_wait_ticks = LCD_CLEAR_TICKS;
+        }
+    }
+}
@@ -2,6 +2,7 @@
 #define LCD_H
 
 #include "LPC17xx.h"
+#include <stdint.h>
 
 // ============================================
 // LCD Pin Definitions (YOUR CONFIGURATION)
@@ -16,8 +17,55 @@
 #define D6 (1<<21)  // P0.21 (was commented as P0.17)
 #define D7 (1<<22)  // P0.22 (was commented as P0.18)
 
+// ============================================
+// Shadow Framebuffer (2x16)
+// ============================================
+#define LCD_ROWS 2
+#define LCD_COLS 16
+
+// Bridge a run of clean cells instead of a cursor move when the
+// rewrite is cheaper. Async data and commands both take two ticks,
+// so only a single-cell gap is worth bridging.
+#define LCD_FB_BRIDGE_MAX 1
+
+// ============================================
+// Async Writer (TIMER1, one nibble per tick)
+// ============================================
+#define LCD_QUEUE_SIZE    64       // Bytes; a full redraw needs 34
+#define LCD_TICK_US       50       // > 37us execution time per byte
+#define LCD_CLEAR_TICKS   32       // Clear/home: 1.52ms + margin
+#define LCD_EN_SPIN       20       // EN high time (>450ns at 100MHz)
+#define LCD_IRQ_PRIORITY  6        // Below RFID/emergency work
+
+// Bus time of one queued write (two ticks)
+#define LCD_DATA_US (2 * LCD_TICK_US)
+#define LCD_CMD_US  (2 * LCD_TICK_US)
+
+typedef struct {
+    uint16_t bytes;          // Bytes written by the last flush (data + commands)
+    uint16_t cursor_moves;   // Set-DDRAM-address commands in the last flush
+    uint32_t bus_us;         // Bus time the last flush queued
+    uint32_t total_bytes;    // Bytes written by all flushes
+    uint32_t flushes;        // Flushes that wrote at least one byte
+} LCD_Flush_Stats_t;
+
+typedef struct {
+    uint32_t overflows;        // Bytes refused because the queue was full
+    uint32_t replaced;         // Queued bytes dropped by a newer screen
+    uint32_t written;          // Bytes put on the bus
+    uint32_t max_latency_us;   // Worst enqueue-to-bus time
+    uint32_t last_latency_us;
+    uint8_t max_depth;         // Queue high-water mark
+} LCD_Async_Stats_t;
+
+extern LCD_Flush_Stats_t lcd_flush_stats;
+extern LCD_Async_Stats_t lcd_async_stats;
+
 // ============================================
 // LCD Functions
+// Blocking calls (lcd_command, lcd_data, ...) are
+// for boot/test only; once lcd_async_init() has
+// run, draw with lcd_fb_* and lcd_fb_flush()
 // ============================================
 void lcd_init(void);
 void lcd_command(unsigned char cmd);
@@ -28,4 +76,14 @@ void lcd_goto(unsigned char row, unsigned char col);
 void lcd_nibble(unsigned char nibble);
 void lcd_test(void);
 
+void lcd_fb_clear(void);
+void lcd_fb_write(unsigned char row, unsigned char col, const char *str);
+void lcd_fb_line(unsigned char row, const char *str);
+void lcd_fb_flush(void);
+void lcd_fb_invalidate(void);
+void lcd_fb_service(void);
+
+void lcd_async_init(void);
+uint8_t lcd_async_busy(void);
+
 #endif
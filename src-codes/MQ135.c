@@ -4,60 +4,74 @@
 // Global Variables
 // ============================================
 uint16_t mq135_adc_value = 0;
+uint16_t mq135_raw_value = 0;
 AirQuality_Status_t mq135_status = AIR_CLEAN;
 
 // ============================================
-// Initialize MQ135 ADC for P0.24 (AD0.1)
+// Initialize MQ135 on P0.24 (AD0.1)
+// Sampling runs continuously in ADC burst mode
+// with GPDMA filling the ring (see ADC_BURST.c)
 // ============================================
 void MQ135_Init(void) {
-    // Enable ADC power (PCADC bit in PCONP)
-    LPC_SC->PCONP |= (1 << 12);
-    
-    // Configure P0.24 as AD0.1
-    // PINSEL1[17:16] = 01 for AD0.1 function
-    LPC_PINCON->PINSEL1 &= ~(3 << 16);  // Clear bits 17:16
-    LPC_PINCON->PINSEL1 |= (1 << 16);   // Set bit 16 = 01
-    
-    // Configure ADC Control Register (ADCR)
-    // [7:0] SEL: Select Channel 1 (for AD0.1)
-    // [15:8] CLKDIV: 10 (ADC clock divider)
-    // [16] BURST: 0 (software controlled)
-    // [21] PDN: 1 (ADC operational)
-    // [24] START: 0 (no conversion yet)
-    LPC_ADC->ADCR = (1 << 1) |   // Select Channel 1 (AD0.1 = P0.24)
-                    (10 << 8) |  // CLKDIV = 10
-                    (1 << 21);   // Power up ADC
+    ADC_Burst_Init();
 }
 
 // ============================================
-// Read MQ135 Sensor Value
+// Read MQ135 Sensor Value (non-blocking)
+// Returns the EWMA-filtered value of the
+// oversampled burst samples; the filters are
+// advanced by ADC_Burst_Update() in the main loop
 // ============================================
 uint16_t MQ135_Read(void) {
-    // Start ADC conversion (START field = 001)
-    LPC_ADC->ADCR |= (1 << 24);
-    
-    // Wait for conversion to complete (DONE bit = 1)
-    while (!(LPC_ADC->ADGDR & (1 << 31)));
-    
-    // Read 12-bit result from ADGDR[15:4]
-    mq135_adc_value = (LPC_ADC->ADGDR >> 4) & 0xFFF;
-    
-    // Update status based on value
+    mq135_raw_value = ADC_Burst_GetRaw(MQ135_ADC_CHANNEL);
+    mq135_adc_value = ADC_Burst_GetEwma(MQ135_ADC_CHANNEL);
+
+    // Update status based on filtered value
     MQ135_GetStatus();
-    
+
     return mq135_adc_value;
 }
 
+// ============================================
+// Moving median of the oversampled averages
+// ============================================
+uint16_t MQ135_ReadMedian(void) {
+    return ADC_Burst_GetMedian(MQ135_ADC_CHANNEL);
+}
+
 // ============================================
 // Get Air Quality Status
+// Thresholds apply with AIR_HYSTERESIS so the
+// status does not chatter around a boundary
 // ============================================
 AirQuality_Status_t MQ135_GetStatus(void) {
-    if (mq135_adc_value <= AIR_CLEAN_MAX) {
-        mq135_status = AIR_CLEAN;
-    } else if (mq135_adc_value <= AIR_MODERATE_MAX) {
-        mq135_status = AIR_MODERATE;
-    } else {
-        mq135_status = AIR_POOR;
+    uint16_t v = mq135_adc_value;
+
+    switch(mq135_status) {
+        case AIR_CLEAN:
+            if(v > AIR_MODERATE_MAX + AIR_HYSTERESIS) {
+                mq135_status = AIR_POOR;
+            } else if(v > AIR_CLEAN_MAX + AIR_HYSTERESIS) {
+                mq135_status = AIR_MODERATE;
+            }
+            break;
+
+        case AIR_MODERATE:
+            if(v > AIR_MODERATE_MAX + AIR_HYSTERESIS) {
+                mq135_status = AIR_POOR;
+            } else if(v + AIR_HYSTERESIS < AIR_CLEAN_MAX) {
+                mq135_status = AIR_CLEAN;
+            }
+            break;
+
+        case AIR_POOR:
+        default:
+            if(v + AIR_HYSTERESIS < AIR_CLEAN_MAX) {
+                mq135_status = AIR_CLEAN;
+            } else if(v + AIR_HYSTERESIS < AIR_MODERATE_MAX) {
+                mq135_status = AIR_MODERATE;
+            }
+            break;
     }
     
     return mq135_status;
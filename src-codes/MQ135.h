@@ -3,6 +3,7 @@
 
 #include "LPC17xx.h"
 #include <stdint.h>
+#include "ADC_BURST.h"
 
 // ============================================
 // MQ135 Pin Configuration
@@ -16,6 +17,7 @@
 #define AIR_CLEAN_MAX 1000     // 0-1000: Clean air
 #define AIR_MODERATE_MAX 2500  // 1001-2500: Moderate
                                // 2501-4095: Poor/Smoke
+#define AIR_HYSTERESIS 50      // Counts to cross a threshold before switching
 
 // ============================================
 // Air Quality Status Enum
@@ -29,7 +31,8 @@ typedef enum {
 // ============================================
 // Global Variables (extern)
 // ============================================
-extern uint16_t mq135_adc_value;
+extern uint16_t mq135_adc_value;      // Filtered (EWMA) value
+extern uint16_t mq135_raw_value;      // Latest single conversion
 extern AirQuality_Status_t mq135_status;
 
 // ============================================
@@ -37,6 +40,7 @@ extern AirQuality_Status_t mq135_status;
 // ============================================
 void MQ135_Init(void);
 uint16_t MQ135_Read(void);
+uint16_t MQ135_ReadMedian(void);
 AirQuality_Status_t MQ135_GetStatus(void);
 const char* MQ135_GetStatusString(void);
 
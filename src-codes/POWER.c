@@ -0,0 +1,192 @@
+/**
+ * ============================================
+ * POWER
+ * Idle manager for the task scheduler. When no
+ * task is ready, tasks_run_once() masks
+ * interrupts and calls power_sleep() with the
+ * time until the next task is due:
+ *
+ *   - SSP0 and UART0 clocks are gated (their
+ *     drivers switch them back on at the next
+ *     access); the ADC is already off between
+ *     sensor samples (ADC_Burst_Suspend)
+ *   - waits of POWER_TICKLESS_MIN_MS or more
+ *     stop the SysTick interrupt and arm the RIT
+ *     for the due time, so the core is not woken
+ *     every millisecond; millis() is advanced by
+ *     the TIMER1 time slept
+ *   - WFI (Sleep mode); any enabled interrupt
+ *     ends it even with PRIMASK set, so the wake
+ *     source is read from the NVIC before the
+ *     handler runs
+ *
+ * Deep-sleep is not used: it stops the PLL,
+ * TIMER1 and the UART3 receiver, and the link to
+ * the gateway must keep receiving.
+ * ============================================
+ */
+
+#include "LPC17xx.h"
+#include "POWER.h"
+#include "ADC_BURST.h"
+#include "SSP0.h"
+#include "DELAY.h"
+#include "uart.h"
+#include <stdio.h>
+#include <string.h>
+
+Power_Stats_t power_stats;
+
+static uint32_t rit_ticks_per_us;
+
+static const char *power_wake_names[POWER_WAKE_COUNT] = {
+    "timer", "tick", "uart", "eint", "adc", "other"
+};
+
+void power_init(void) {
+    LPC_SC->PCONP &= ~POWER_UNUSED_PCONP;
+
+    // RIT: one-shot wake timer (PCLK = CCLK/4, reset default)
+    LPC_SC->PCONP |= POWER_PCRIT;
+    LPC_RIT->RICTRL = (1 << 0);             // Clear RITINT, counter stopped
+    LPC_RIT->RIMASK = 0;
+    rit_ticks_per_us = (SystemCoreClock / 4) / 1000000;
+    NVIC_EnableIRQ(RIT_IRQn);
+
+    // WFI enters Sleep, not Deep-sleep
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+    LPC_SC->PCON = 0;
+
+    memset(&power_stats, 0, sizeof(power_stats));
+    power_stats.window_start_us = LPC_TIM1->TC;
+}
+
+// Only reached if a wake was not cleared in power_sleep()
+void RIT_IRQHandler(void) {
+    LPC_RIT->RICTRL = (1 << 0);
+}
+
+// ============================================
+// SysTick phase: us since the last 1ms tick
+// ============================================
+static uint32_t systick_phase_us(void) {
+    uint32_t load = SysTick->LOAD;
+    return (load - SysTick->VAL) * 1000 / (load + 1);
+}
+
+// First pending source, most urgent first
+static Power_Wake_t power_wake_source(uint8_t tickless) {
+    if(NVIC_GetPendingIRQ(EINT1_IRQn)) return POWER_WAKE_EINT;
+    if(NVIC_GetPendingIRQ(UART3_IRQn) || NVIC_GetPendingIRQ(UART0_IRQn)) return POWER_WAKE_UART;
+    if(NVIC_GetPendingIRQ(DMA_IRQn)) return POWER_WAKE_ADC;
+    if(tickless && NVIC_GetPendingIRQ(RIT_IRQn)) return POWER_WAKE_TIMER;
+    if(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) return POWER_WAKE_TICK;
+    return POWER_WAKE_OTHER;
+}
+
+// ============================================
+// Sleep until an interrupt or the horizon
+// ============================================
+void power_sleep(uint32_t horizon_ms) {
+    uint32_t t0 = LPC_TIM1->TC;
+    uint32_t phase0 = 0;
+    uint32_t target_us = 0;
+    uint32_t slept;
+    uint8_t gated[POWER_CLK_COUNT];
+    uint8_t tickless = (horizon_ms >= POWER_TICKLESS_MIN_MS);
+    Power_Wake_t wake;
+
+    gated[POWER_CLK_ADC] = !ADC_Burst_IsRunning();
+    gated[POWER_CLK_SSP] = SSP0_clock_gate();
+    gated[POWER_CLK_UART0] = uart0_clock_gate();
+
+    if(tickless) {
+        if(horizon_ms > POWER_TICKLESS_MAX_MS) horizon_ms = POWER_TICKLESS_MAX_MS;
+
+        // SysTick keeps counting (its phase is kept), only the
+        // interrupt stops; the RIT fires when the task is due
+        phase0 = systick_phase_us();
+        target_us = horizon_ms * 1000 - phase0;
+        SysTick->CTRL &= ~SysTick_CTRL_TICKINT_Msk;
+
+        LPC_RIT->RICOUNTER = 0;
+        LPC_RIT->RICOMPVAL = target_us * rit_ticks_per_us;
+        LPC_RIT->RICTRL = (1 << 0) | (1 << 1) | (1 << 3);  // Clear, clear-on-match, run
+    }
+
+    __DSB();
+    __WFI();
+
+    wake = power_wake_source(tickless);
+    slept = LPC_TIM1->TC - t0;
+
+    if(tickless) {
+        uint32_t phase1;
+        uint32_t val;
+
+        LPC_RIT->RICTRL = (1 << 0);         // Stop, clear RITINT
+        NVIC_ClearPendingIRQ(RIT_IRQn);
+
+        // Ticks missed while asleep: whole ms between the two phases.
+        // A tick between re-enabling and reading VAL is counted here,
+        // so its pending interrupt is dropped (VAL just reloaded).
+        SysTick->CTRL |= SysTick_CTRL_TICKINT_Msk;
+        val = SysTick->VAL;
+        phase1 = (SysTick->LOAD - val) * 1000 / (SysTick->LOAD + 1);
+        if((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) && val > SysTick->LOAD / 2) {
+            SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk;
+        }
+        millis_advance((phase0 + slept - phase1 + 500) / 1000);
+
+        power_stats.tickless++;
+        if(wake == POWER_WAKE_TIMER && slept > target_us &&
+           slept - target_us > power_stats.oversleep_max_us) {
+            power_stats.oversleep_max_us = slept - target_us;
+        }
+    }
+
+    power_stats.sleeps++;
+    power_stats.sleep_us += slept;
+    if(slept > power_stats.sleep_max_us) power_stats.sleep_max_us = slept;
+    power_stats.wakes[wake]++;
+
+    for(uint8_t c = 0; c < POWER_CLK_COUNT; c++) {
+        if(gated[c]) power_stats.gated_us[c] += slept;
+    }
+}
+
+// ============================================
+// STATUS,{"type":"POWER_STATUS",...}
+// duty_pm = awake share of the window
+// ============================================
+void power_report(void) {
+    char buf[320];
+    int len;
+    uint32_t now = LPC_TIM1->TC;
+    uint32_t window = now - power_stats.window_start_us;
+
+    if(window == 0) window = 1;
+
+    len = sprintf(buf,
+        "STATUS,{\"type\":\"POWER_STATUS\",\"window_ms\":%lu,\"duty_pm\":%lu,"
+        "\"sleeps\":%lu,\"tickless\":%lu,\"sleep_max_us\":%lu,\"oversleep_max_us\":%lu,"
+        "\"gated_pm\":{\"adc\":%lu,\"ssp\":%lu,\"uart0\":%lu},\"wakes\":{",
+        (unsigned long)(window / 1000),
+        (unsigned long)(1000 - (uint64_t)power_stats.sleep_us * 1000 / window),
+        (unsigned long)power_stats.sleeps, (unsigned long)power_stats.tickless,
+        (unsigned long)power_stats.sleep_max_us,
+        (unsigned long)power_stats.oversleep_max_us,
+        (unsigned long)((uint64_t)power_stats.gated_us[POWER_CLK_ADC] * 1000 / window),
+        (unsigned long)((uint64_t)power_stats.gated_us[POWER_CLK_SSP] * 1000 / window),
+        (unsigned long)((uint64_t)power_stats.gated_us[POWER_CLK_UART0] * 1000 / window));
+
+    for(uint8_t w = 0; w < POWER_WAKE_COUNT; w++) {
+        len += sprintf(buf + len, "%s\"%s\":%lu", w ? "," : "",
+            power_wake_names[w], (unsigned long)power_stats.wakes[w]);
+    }
+    sprintf(buf + len, "}}\r\n");
+    uart_dual_send_string(buf);
+
+    memset(&power_stats, 0, sizeof(power_stats));
+    power_stats.window_start_us = now;
+}
@@ -0,0 +1,72 @@
+/**
+ * ============================================
+ * POWER HEADER
+ * Idle sleep (tickless WFI) + peripheral clock
+ * gating, driven by the task scheduler
+ * ============================================
+ */
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+
+// ============================================
+// Configuration
+// ============================================
+#define POWER_TICKLESS_MIN_MS   2       // Shorter waits keep the 1ms SysTick
+#define POWER_TICKLESS_MAX_MS   1000    // Longest RIT wait (nothing due)
+
+// PCONP bits the firmware never uses (on after reset):
+// TIM0, UART1, I2C0, SPI, RTC registers, SSP1, I2C1, I2C2
+#define POWER_UNUSED_PCONP      ((1UL << 1) | (1UL << 4) | (1UL << 7) | \
+                                 (1UL << 8) | (1UL << 9) | (1UL << 10) | \
+                                 (1UL << 19) | (1UL << 26))
+
+#define POWER_PCRIT             (1UL << 16)
+
+// ============================================
+// Wake Sources (pending interrupt at wake-up)
+// ============================================
+typedef enum {
+    POWER_WAKE_TIMER = 0,   // RIT: a task came due (tickless)
+    POWER_WAKE_TICK,        // SysTick: short wait
+    POWER_WAKE_UART,        // UART3 RX / UART0 TX drain
+    POWER_WAKE_EINT,        // Emergency button
+    POWER_WAKE_ADC,         // GPDMA ring wrap
+    POWER_WAKE_OTHER,       // LCD writer, feedback, servo PWM, DHT11 edges
+    POWER_WAKE_COUNT
+} Power_Wake_t;
+
+// Clocks gated while asleep
+typedef enum {
+    POWER_CLK_ADC = 0,      // ADC + GPDMA between sensor samples
+    POWER_CLK_SSP,          // SSP0 between reader / flash accesses
+    POWER_CLK_UART0,        // UART0 once its TX queue has drained
+    POWER_CLK_COUNT
+} Power_Clock_t;
+
+// ============================================
+// Statistics (window = since the last report)
+// ============================================
+typedef struct {
+    uint32_t window_start_us;
+    uint32_t sleep_us;
+    uint32_t sleeps;
+    uint32_t tickless;              // Sleeps with SysTick stopped
+    uint32_t sleep_max_us;
+    uint32_t oversleep_max_us;      // RIT wake after the due time
+    uint32_t wakes[POWER_WAKE_COUNT];
+    uint32_t gated_us[POWER_CLK_COUNT];     // Asleep with the clock off
+} Power_Stats_t;
+
+extern Power_Stats_t power_stats;
+
+// ============================================
+// Function Prototypes
+// ============================================
+void power_init(void);
+void power_sleep(uint32_t horizon_ms);  // PRIMASK set by the caller
+void power_report(void);
+
+#endif // POWER_H
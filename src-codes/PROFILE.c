@@ -0,0 +1,176 @@
+/**
+ * ============================================
+ * PROFILER - DWT CYCCNT
+ * The Cortex-M3 cycle counter runs at the core
+ * clock; a scope costs two register reads plus
+ * one profile_record() (a CLZ and a few adds).
+ * CYCCNT wraps after 2^32 cycles (~42s at
+ * 100MHz); unsigned subtraction keeps shorter
+ * intervals correct across the wrap.
+ * Recording is main-context only.
+ * ============================================
+ */
+
+#include "PROFILE.h"
+
+#if PROFILE_ENABLE
+
+#include "uart.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef PROFILE_HOST_TIMER
+#ifndef PROFILE_HOST_MHZ
+#define PROFILE_HOST_MHZ 100
+#endif
+volatile uint32_t profile_host_cycles = 0;
+#else
+#include "LPC17xx.h"
+
+// Debug registers (not in every CMSIS core_cm3.h revision)
+#define DEMCR       (*(volatile uint32_t *)0xE000EDFC)
+#define DWT_CTRL    (*(volatile uint32_t *)0xE0001000)
+#define DWT_CYCCNT  (*(volatile uint32_t *)0xE0001004)
+#define DEMCR_TRCENA        (1UL << 24)
+#define DWT_CTRL_CYCCNTENA  (1UL << 0)
+#endif
+
+static const char *const prof_names[PROF_SCOPE_COUNT] = {
+    "card_find",
+    "rc522_tocard",
+    "json_format",
+    "lcd_string",
+    "lcd_flush",
+    "dht11_read",
+    "scan_decision",
+    "scan_gate",
+    "flash_lookup",
+    "env_report",
+    "cred_read"
+};
+
+static Prof_Stats_t prof_stats[PROF_SCOPE_COUNT];
+static uint32_t prof_span_t0[PROF_SCOPE_COUNT];
+static uint8_t prof_span_armed[PROF_SCOPE_COUNT];
+
+void profile_init(void) {
+#ifndef PROFILE_HOST_TIMER
+    DEMCR |= DEMCR_TRCENA;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+#endif
+    profile_reset();
+}
+
+uint32_t profile_now(void) {
+#ifdef PROFILE_HOST_TIMER
+    return profile_host_cycles;
+#else
+    return DWT_CYCCNT;
+#endif
+}
+
+void profile_reset(void) {
+    memset(prof_stats, 0, sizeof(prof_stats));
+    memset(prof_span_armed, 0, sizeof(prof_span_armed));
+    for(uint8_t i = 0; i < PROF_SCOPE_COUNT; i++) {
+        prof_stats[i].min = 0xFFFFFFFF;
+    }
+}
+
+static uint8_t log2_bin(uint32_t cycles) {
+    if(cycles == 0) return 0;
+#if defined(PROFILE_HOST_TIMER)
+    return (uint8_t)(31 - __builtin_clz(cycles));
+#else
+    return (uint8_t)(31 - __CLZ(cycles));
+#endif
+}
+
+void profile_record(uint8_t scope, uint32_t cycles) {
+    Prof_Stats_t *s;
+    uint8_t bin;
+
+    if(scope >= PROF_SCOPE_COUNT) return;
+    s = &prof_stats[scope];
+
+    s->count++;
+    s->sum += cycles;
+    if(cycles < s->min) s->min = cycles;
+    if(cycles > s->max) s->max = cycles;
+
+    bin = log2_bin(cycles);
+    if(s->hist[bin] != 0xFFFF) s->hist[bin]++;
+}
+
+void profile_span_start(uint8_t scope) {
+    if(scope >= PROF_SCOPE_COUNT) return;
+    prof_span_t0[scope] = profile_now();
+    prof_span_armed[scope] = 1;
+}
+
+void profile_span_end(uint8_t scope) {
+    if(scope >= PROF_SCOPE_COUNT || !prof_span_armed[scope]) return;
+    prof_span_armed[scope] = 0;
+    profile_record(scope, profile_now() - prof_span_t0[scope]);
+}
+
+// Span will not complete (e.g. access denied, gate stays shut)
+void profile_span_cancel(uint8_t scope) {
+    if(scope < PROF_SCOPE_COUNT) prof_span_armed[scope] = 0;
+}
+
+const Prof_Stats_t* profile_stats(uint8_t scope) {
+    return (scope < PROF_SCOPE_COUNT) ? &prof_stats[scope] : 0;
+}
+
+static uint32_t cycles_per_us(void) {
+#ifdef PROFILE_HOST_TIMER
+    return PROFILE_HOST_MHZ;
+#else
+    return SystemCoreClock / 1000000;
+#endif
+}
+
+// ============================================
+// PERF frames (routed to the debug sinks - local diagnostics)
+// One frame per scope that has samples; the
+// histogram is sent from the first to the last
+// non-empty bin, "h0" is the first bin index
+// ============================================
+void profile_report(void) {
+    char buf[448];
+    uint32_t mhz = cycles_per_us();
+
+    for(uint8_t i = 0; i < PROF_SCOPE_COUNT; i++) {
+        const Prof_Stats_t *s = &prof_stats[i];
+        uint8_t lo = 0;
+        uint8_t hi = PROF_HIST_BINS - 1;
+        int len;
+
+        if(s->count == 0) continue;
+
+        while(s->hist[lo] == 0) lo++;
+        while(s->hist[hi] == 0) hi--;
+
+        len = sprintf(buf,
+            "PERF,{\"scope\":\"%s\",\"n\":%lu,"
+            "\"min_cyc\":%lu,\"max_cyc\":%lu,\"mean_cyc\":%lu,"
+            "\"max_us\":%lu,\"mean_us\":%lu,\"mhz\":%lu,"
+            "\"h0\":%u,\"hist\":[",
+            prof_names[i], (unsigned long)s->count,
+            (unsigned long)s->min, (unsigned long)s->max,
+            (unsigned long)(s->sum / s->count),
+            (unsigned long)(s->max / mhz),
+            (unsigned long)(s->sum / s->count / mhz),
+            (unsigned long)mhz, lo);
+
+        for(uint8_t b = lo; b <= hi; b++) {
+            len += sprintf(buf + len, (b == lo) ? "%u" : ",%u", s->hist[b]);
+        }
+        sprintf(buf + len, "]}\r\n");
+        uart_dual_send_string(buf);
+    }
+}
+
+#endif // PROFILE_ENABLE
@@ -0,0 +1,94 @@
+/**
+ * ============================================
+ * PROFILE HEADER
+ * DWT cycle-counter scopes + latency histograms
+ * ============================================
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+// ============================================
+// Build Switches
+// PROFILE_ENABLE 0  - every PROF_* macro expands
+//                     to nothing, no code or RAM
+// PROFILE_HOST_TIMER - profile_now() reads the
+//                     profile_host_cycles stub
+//                     instead of DWT->CYCCNT
+// ============================================
+#ifndef PROFILE_ENABLE
+#define PROFILE_ENABLE 1
+#endif
+
+#define PROF_HIST_BINS         32       // bin n = cycles in [2^n, 2^(n+1))
+#define PROF_REPORT_INTERVAL   600      // PERF frames every ~60s (main loop ticks)
+
+// ============================================
+// Scopes
+// ============================================
+typedef enum {
+    PROF_CARD_FIND = 0,
+    PROF_RC522_TOCARD,
+    PROF_JSON_FORMAT,       // sprintf of the JSON frames
+    PROF_LCD_STRING,
+    PROF_LCD_FLUSH,
+    PROF_DHT11_READ,
+    PROF_SCAN_DECISION,     // anticollision -> entry/exit/deny decided
+    PROF_SCAN_GATE,         // anticollision -> gate starts opening
+    PROF_FLASH_LOOKUP,      // SPI flash card index walk
+    PROF_ENV_REPORT,        // DHT11 read -> ENV frame queued (task_sensors)
+    PROF_CRED_READ,         // Card credential select/auth/read + MAC check
+    PROF_SCOPE_COUNT
+} Prof_Scope_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;           // Cycles
+    uint32_t max;
+    uint64_t sum;
+    uint16_t hist[PROF_HIST_BINS];  // Saturating
+} Prof_Stats_t;
+
+#if PROFILE_ENABLE
+
+#ifdef PROFILE_HOST_TIMER
+extern volatile uint32_t profile_host_cycles;
+#endif
+
+void profile_init(void);
+uint32_t profile_now(void);
+void profile_record(uint8_t scope, uint32_t cycles);
+void profile_span_start(uint8_t scope);
+void profile_span_end(uint8_t scope);
+void profile_span_cancel(uint8_t scope);
+const Prof_Stats_t* profile_stats(uint8_t scope);
+void profile_reset(void);
+void profile_report(void);
+
+// Scoped timing inside one function
+#define PROF_BEGIN(s)      uint32_t prof_t0_##s = profile_now()
+#define PROF_END(s)        profile_record((s), profile_now() - prof_t0_##s)
+
+// Spans across functions (end is ignored unless started)
+#define PROF_SPAN_START(s) profile_span_start(s)
+#define PROF_SPAN_END(s)   profile_span_end(s)
+#define PROF_SPAN_CANCEL(s) profile_span_cancel(s)
+
+#define PROF_INIT()        profile_init()
+#define PROF_REPORT()      profile_report()
+
+#else
+
+#define PROF_BEGIN(s)
+#define PROF_END(s)
+#define PROF_SPAN_START(s)
+#define PROF_SPAN_END(s)
+#define PROF_SPAN_CANCEL(s)
+#define PROF_INIT()
+#define PROF_REPORT()
+
+#endif // PROFILE_ENABLE
+
+#endif // PROFILE_H
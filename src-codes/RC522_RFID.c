@@ -7,6 +7,8 @@
 #include "RC522_RFID.h"
 #include "SSP0.h"
 #include "DELAY.h"
+#include "PROFILE.h"
+#include "SPITRACE.h"
 
 // ============================================
 // RC522 Low-Level Functions
@@ -45,6 +47,7 @@ void RC522_TX_off(void) {
 }
 
 void RC522_Init(void) {
+    SPITRACE_PHASE(SPITRACE_PH_INIT);
     RC522_reset();
     
     SSP0_Write(RC522_REG_TMODE, 0x8D);
@@ -77,6 +80,7 @@ uint8_t RC522_ToCard(uint8_t command, uint8_t *sendData, uint8_t sendLen,
     uint8_t lastBits;
     uint8_t n;
     uint16_t i;
+    PROF_BEGIN(PROF_RC522_TOCARD);
     
     switch(command) {
         case RC522_CMD_MF_AUTHENT:
@@ -150,6 +154,7 @@ uint8_t RC522_ToCard(uint8_t command, uint8_t *sendData, uint8_t sendLen,
         }
     }
     
+    PROF_END(PROF_RC522_TOCARD);
     return status;
 }
 
@@ -161,6 +166,7 @@ uint8_t RC522_Request(uint8_t reqMode, uint8_t *tagType) {
     uint8_t status;
     uint16_t backBits;
     
+    SPITRACE_PHASE(SPITRACE_PH_REQUEST);
     SSP0_Write(RC522_REG_BIT_FRAMING, 0x07);
     
     tagType[0] = reqMode;
@@ -179,6 +185,7 @@ uint8_t RC522_Anticoll(uint8_t *serNum) {
     uint8_t serNumCheck = 0;
     uint16_t unLen;
     
+    SPITRACE_PHASE(SPITRACE_PH_ANTICOLL);
     SSP0_Write(RC522_REG_BIT_FRAMING, 0x00);
     
     serNum[0] = PICC_CMD_SEL_CL1;
@@ -208,6 +215,7 @@ uint8_t RC522_SelectTag(uint8_t *serNum) {
     uint16_t recvBits;
     uint8_t buffer[9];
     
+    SPITRACE_PHASE(SPITRACE_PH_SELECT);
     buffer[0] = PICC_CMD_SEL_CL1;
     buffer[1] = 0x70;
     
@@ -234,6 +242,7 @@ uint8_t RC522_Auth(uint8_t authMode, uint8_t blockAddr, uint8_t *key, uint8_t *s
     uint8_t i;
     uint8_t buffer[12];
     
+    SPITRACE_PHASE(SPITRACE_PH_AUTH);
     buffer[0] = authMode;
     buffer[1] = blockAddr;
     
@@ -262,6 +271,7 @@ uint8_t RC522_Read(uint8_t blockAddr, uint8_t *recvData) {
     uint8_t status;
     uint16_t unLen;
     
+    SPITRACE_PHASE(SPITRACE_PH_READ);
     recvData[0] = PICC_CMD_MF_READ;
     recvData[1] = blockAddr;
     
@@ -282,6 +292,7 @@ uint8_t RC522_Write(uint8_t blockAddr, uint8_t *writeData) {
     uint8_t i;
     uint8_t buffer[18];
     
+    SPITRACE_PHASE(SPITRACE_PH_WRITE);
     buffer[0] = PICC_CMD_MF_WRITE;
     buffer[1] = blockAddr;
     
@@ -336,6 +347,7 @@ void RC522_Halt(void) {
     uint16_t unLen;
     uint8_t buffer[4];
     
+    SPITRACE_PHASE(SPITRACE_PH_HALT);
     buffer[0] = PICC_CMD_HLTA;
     buffer[1] = 0;
     
@@ -343,3 +355,8 @@ void RC522_Halt(void) {
     
     RC522_ToCard(RC522_CMD_TRANSCEIVE, buffer, 4, buffer, &unLen);
 }
+
+// Leave the authenticated state (MFCrypto1On) after RC522_Auth
+void RC522_StopCrypto(void) {
+    RC522_ClearBitMask(RC522_REG_STATUS2, 0x08);
+}
@@ -127,5 +127,6 @@ uint8_t RC522_Write(uint8_t blockAddr, uint8_t *writeData);
 
 void RC522_CalculateCRC(uint8_t *pIndata, uint8_t len, uint8_t *pOutData);
 void RC522_Halt(void);
+void RC522_StopCrypto(void);
 
 #endif // RC522_RFID_H
@@ -0,0 +1,135 @@
+/**
+ * ============================================
+ * SCAN CACHE
+ * A card left on the antenna is read again on
+ * the next poll. The last SCAN_CACHE_SIZE UIDs
+ * are kept with the time they were last seen and
+ * the last decision taken, and checked before
+ * card_find(): a repeat read costs a few word
+ * compares and sends nothing.
+ *
+ * - Repeat: same UID seen within repeat_ticks;
+ *   the seen time is refreshed, so a card that
+ *   stays on the reader stays suppressed
+ * - Anti-passback: after ENTRY the card cannot
+ *   EXIT for min_inside_ticks, after EXIT it
+ *   cannot re-ENTER for min_outside_ticks
+ *
+ * UIDs evicted from the cache fall back to the
+ * card record (zone + last_scan_time).
+ * ============================================
+ */
+
+#include "SCANCACHE.h"
+#include "ZONES.h"
+#include <string.h>
+
+typedef struct {
+    uint32_t uid;               // 4-byte UID as one word, 0 = free
+    uint32_t seen;
+    uint32_t action_time;
+    uint8_t action;
+} ScanCache_Entry_t;
+
+ScanCache_Config_t scancache_config = {
+    SCAN_REPEAT_TICKS,
+    SCAN_MIN_INSIDE_TICKS,
+    SCAN_MIN_OUTSIDE_TICKS
+};
+
+ScanCache_Stats_t scancache_stats;
+
+static ScanCache_Entry_t scan_cache[SCAN_CACHE_SIZE];
+
+static uint32_t uid_word(const uint8_t *uid) {
+    return (uint32_t)uid[0] | ((uint32_t)uid[1] << 8) |
+           ((uint32_t)uid[2] << 16) | ((uint32_t)uid[3] << 24);
+}
+
+static ScanCache_Entry_t* cache_find(uint32_t key) {
+    for(uint8_t i = 0; i < SCAN_CACHE_SIZE; i++) {
+        if(scan_cache[i].uid == key && scan_cache[i].action != SCAN_ACT_NONE) {
+            return &scan_cache[i];
+        }
+    }
+    return 0;
+}
+
+// Direction-aware window on the last decision
+static uint8_t passback_blocked(uint8_t inside, uint32_t since) {
+    if(inside) {
+        return since < scancache_config.min_inside_ticks;
+    }
+    return since < scancache_config.min_outside_ticks;
+}
+
+// Insert/update an entry (evicts the stalest one)
+static void cache_store(uint32_t key, uint8_t action, uint32_t when) {
+    ScanCache_Entry_t *e = cache_find(key);
+
+    if(!e) {
+        e = &scan_cache[0];
+        for(uint8_t i = 0; i < SCAN_CACHE_SIZE; i++) {
+            if(scan_cache[i].action == SCAN_ACT_NONE) {
+                e = &scan_cache[i];
+                break;
+            }
+            if((when - scan_cache[i].seen) > (when - e->seen)) {
+                e = &scan_cache[i];
+            }
+        }
+        e->uid = key;
+    }
+
+    e->seen = when;
+    e->action_time = when;
+    e->action = action;
+}
+
+void scancache_init(void) {
+    memset(scan_cache, 0, sizeof(scan_cache));
+    memset(&scancache_stats, 0, sizeof(scancache_stats));
+}
+
+// Called right after anticollision, before card_find()
+ScanCache_Result_t scancache_check(const uint8_t *uid, uint32_t now) {
+    ScanCache_Entry_t *e = cache_find(uid_word(uid));
+
+    if(!e) {
+        return SCAN_ACCEPT;
+    }
+
+    if((now - e->seen) < scancache_config.repeat_ticks) {
+        e->seen = now;
+        scancache_stats.repeats++;
+        return SCAN_SUPPRESS_REPEAT;
+    }
+
+    if((e->action == SCAN_ACT_ENTRY || e->action == SCAN_ACT_EXIT) &&
+       passback_blocked(e->action == SCAN_ACT_ENTRY, now - e->action_time)) {
+        e->seen = now;
+        scancache_stats.passbacks++;
+        return SCAN_SUPPRESS_PASSBACK;
+    }
+
+    return SCAN_ACCEPT;
+}
+
+// Fallback for a registered card whose UID is no longer cached
+ScanCache_Result_t scancache_check_card(const Card_t *card, uint32_t now) {
+    if(card->scan_count &&
+       passback_blocked(card->zone != ZONE_OUTSIDE, now - card->last_scan_time)) {
+        scancache_stats.passbacks++;
+        cache_store(uid_word(card->uid),
+                    card->zone != ZONE_OUTSIDE ? SCAN_ACT_ENTRY : SCAN_ACT_EXIT,
+                    card->last_scan_time);
+        return SCAN_SUPPRESS_PASSBACK;
+    }
+    return SCAN_ACCEPT;
+}
+
+// Remember the decision taken for this UID
+void scancache_record(const uint8_t *uid, ScanCache_Action_t action, uint32_t now) {
+    cache_store(uid_word(uid), action, now);
+    scancache_stats.accepted++;
+}
@@ -0,0 +1,59 @@
+/**
+ * ============================================
+ * SCAN CACHE HEADER
+ * Recent-UID cache + anti-passback rules
+ * ============================================
+ */
+
+#ifndef SCANCACHE_H
+#define SCANCACHE_H
+
+#include <stdint.h>
+#include "CARDDB.h"
+
+// ============================================
+// Default Policy (main loop ticks)
+// ============================================
+#define SCAN_CACHE_SIZE          8
+#define SCAN_REPEAT_TICKS        20     // Same UID still on the antenna
+#define SCAN_MIN_INSIDE_TICKS    150    // No EXIT this soon after ENTRY
+#define SCAN_MIN_OUTSIDE_TICKS   50     // No re-ENTRY this soon after EXIT
+
+typedef enum {
+    SCAN_ACCEPT = 0,
+    SCAN_SUPPRESS_REPEAT,       // Card lingering / re-read
+    SCAN_SUPPRESS_PASSBACK      // Direction flip inside the anti-passback window
+} ScanCache_Result_t;
+
+typedef enum {
+    SCAN_ACT_NONE = 0,
+    SCAN_ACT_ENTRY,
+    SCAN_ACT_EXIT,
+    SCAN_ACT_DENIED,
+    SCAN_ACT_UNKNOWN
+} ScanCache_Action_t;
+
+typedef struct {
+    uint16_t repeat_ticks;
+    uint16_t min_inside_ticks;
+    uint16_t min_outside_ticks;
+} ScanCache_Config_t;
+
+typedef struct {
+    uint32_t accepted;
+    uint32_t repeats;           // Suppressed as lingering reads
+    uint32_t passbacks;         // Suppressed by anti-passback
+} ScanCache_Stats_t;
+
+extern ScanCache_Config_t scancache_config;
+extern ScanCache_Stats_t scancache_stats;
+
+// ============================================
+// Function Prototypes
+// ============================================
+void scancache_init(void);
+ScanCache_Result_t scancache_check(const uint8_t *uid, uint32_t now);
+ScanCache_Result_t scancache_check_card(const Card_t *card, uint32_t now);
+void scancache_record(const uint8_t *uid, ScanCache_Action_t action, uint32_t now);
+
+#endif // SCANCACHE_H
@@ -0,0 +1,105 @@
+/**
+ * ============================================
+ * SERVO DRIVER - Hardware PWM (PWM1.1, P2.0 or P1.18)
+ * PWM1 generates the 50Hz frame; the MR0 (period)
+ * interrupt steps the pulse width along the
+ * motion profile, so a movement costs no CPU
+ * apart from one short interrupt per 20ms.
+ * ============================================
+ */
+
+#include "LPC17xx.h"
+#include "SERVO.h"
+
+static volatile uint16_t servo_pos_us = SERVO_CLOSED_US;
+static volatile uint16_t servo_target_us = SERVO_CLOSED_US;
+static volatile uint16_t servo_speed_us = 0;
+static Servo_Profile_t servo_profile = { SERVO_MAX_STEP_US, SERVO_ACCEL_US };
+
+void servo_pwm_init(uint16_t start_us) {
+    servo_pos_us = start_us;
+    servo_target_us = start_us;
+    servo_speed_us = 0;
+
+    // Power PWM1 (PCPWM1 bit 6)
+    LPC_SC->PCONP |= (1 << 6);
+
+#if SERVO_PWM_P1_18
+    // P1.18 as PWM1.1 (PINSEL3[5:4] = 10)
+    LPC_PINCON->PINSEL3 &= ~(3 << 4);
+    LPC_PINCON->PINSEL3 |= (2 << 4);
+#else
+    // P2.0 as PWM1.1 (PINSEL4[1:0] = 01)
+    LPC_PINCON->PINSEL4 &= ~(3 << 0);
+    LPC_PINCON->PINSEL4 |= (1 << 0);
+#endif
+
+    LPC_PWM1->TCR = (1 << 1);                       // Counter reset
+    LPC_PWM1->PR = (SystemCoreClock / 4) / 1000000 - 1;   // 1us ticks
+    LPC_PWM1->MR0 = SERVO_PERIOD_US;
+    LPC_PWM1->MR1 = start_us;
+    LPC_PWM1->MCR = (1 << 0) | (1 << 1);            // IRQ + reset on MR0
+    LPC_PWM1->PCR = (1 << 9);                       // PWMENA1, single edge
+    LPC_PWM1->LER = (1 << 0) | (1 << 1);
+    LPC_PWM1->TCR = (1 << 0) | (1 << 3);            // Counter + PWM enable
+
+    NVIC_EnableIRQ(PWM1_IRQn);
+}
+
+void servo_pwm_set_profile(const Servo_Profile_t *profile) {
+    servo_profile = *profile;
+    if(servo_profile.accel_us == 0) servo_profile.accel_us = 1;
+    if(servo_profile.max_step_us == 0) servo_profile.max_step_us = 1;
+}
+
+// Start moving; returns at once
+void servo_pwm_move(uint16_t target_us) {
+    servo_target_us = target_us;
+}
+
+uint8_t servo_pwm_moving(void) {
+    return servo_pos_us != servo_target_us;
+}
+
+uint16_t servo_pwm_position(void) {
+    return servo_pos_us;
+}
+
+// ============================================
+// PWM1 period interrupt: one profile step
+// ============================================
+void PWM1_IRQHandler(void) {
+    uint16_t pos = servo_pos_us;
+    uint16_t target = servo_target_us;
+    uint16_t remaining;
+    uint16_t speed = servo_speed_us;
+
+    LPC_PWM1->IR = (1 << 0);                        // Clear MR0 flag
+
+    if(pos == target) {
+        servo_speed_us = 0;
+        return;
+    }
+
+    remaining = (target > pos) ? (target - pos) : (pos - target);
+
+    // Brake when the stopping distance reaches the remaining travel
+    if((uint32_t)speed * speed / (2 * servo_profile.accel_us) >= remaining) {
+        speed = (speed > servo_profile.accel_us) ? speed - servo_profile.accel_us
+                                                 : servo_profile.accel_us;
+    } else if(speed < servo_profile.max_step_us) {
+        speed += servo_profile.accel_us;
+        if(speed > servo_profile.max_step_us) speed = servo_profile.max_step_us;
+    }
+
+    if(speed > remaining) speed = remaining;
+
+    pos = (target > pos) ? pos + speed : pos - speed;
+
+    servo_speed_us = speed;
+    servo_pos_us = pos;
+
+    // New width takes effect at the start of the next frame
+    LPC_PWM1->MR1 = pos;
+    LPC_PWM1->LER = (1 << 1);
+}
@@ -0,0 +1,53 @@
+/**
+ * ============================================
+ * SERVO HEADER - PWM1.1 on P2.0 (or P1.18)
+ * ============================================
+ */
+
+#ifndef SERVO_H
+#define SERVO_H
+
+#include <stdint.h>
+
+// ============================================
+// Pin / Timing Configuration
+// ============================================
+// PWM1.1 comes out on P1.18 or P2.0. The old bit-banged pin, P0.5,
+// has no PWM function, so the servo wire moves either way. Both pins
+// are free here (the LEDs are P1.19-P1.25). P2.0 is the default: it
+// sits with the other port 2 signals (UART3 RTS/CTS P2.2/P2.3,
+// emergency button P2.11), and boards that route P1.18 to an
+// on-board LED (mbed LPC1768: LED1) keep only P2.0 on the header.
+// Build with SERVO_PWM_P1_18=1 to use P1.18 instead.
+#ifndef SERVO_PWM_P1_18
+#define SERVO_PWM_P1_18      0
+#endif
+
+#define SERVO_PERIOD_US      20000      // 50Hz frame
+#define SERVO_OPEN_US        1500
+#define SERVO_CLOSED_US      1000
+
+// ============================================
+// Motion Profile (per 20ms frame)
+// Trapezoidal: speed ramps up by ACCEL, is
+// capped at MAX_STEP and ramps down to stop
+// exactly on the target pulse width
+// ============================================
+#define SERVO_MAX_STEP_US    25         // 500us swing in ~0.45s
+#define SERVO_ACCEL_US       5
+
+typedef struct {
+    uint16_t max_step_us;
+    uint16_t accel_us;
+} Servo_Profile_t;
+
+// ============================================
+// Function Prototypes
+// ============================================
+void servo_pwm_init(uint16_t start_us);
+void servo_pwm_move(uint16_t target_us);
+void servo_pwm_set_profile(const Servo_Profile_t *profile);
+uint8_t servo_pwm_moving(void);
+uint16_t servo_pwm_position(void);
+
+#endif // SERVO_H
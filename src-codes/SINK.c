@@ -0,0 +1,192 @@
+/**
+ * ============================================
+ * TELEMETRY SINKS
+ * Every frame is built once (sprintf into the
+ * caller's buffer) and handed to sink_publish().
+ * Its type comes from the prefix; each sink then
+ * takes it or not by its own level and type mask,
+ * in its own format, into its own queue. The
+ * UART queues drain from the THRE interrupt, so
+ * the 9600 baud console no longer paces the cloud
+ * link, and a full queue drops whole frames for
+ * that sink only.
+ * ============================================
+ */
+
+#include "SINK.h"
+#include "uart.h"
+#include "UPLINK.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    const char *prefix;
+    uint8_t level;
+} Sink_EventDef_t;
+
+static const Sink_EventDef_t sink_events[EVT_COUNT] = {
+    {"INIT",   SINK_LVL_INFO},
+    {"CARD",   SINK_LVL_INFO},
+    {"STATUS", SINK_LVL_INFO},
+    {"RFID",   SINK_LVL_INFO},
+    {"ENV",    SINK_LVL_INFO},
+    {"GATE",   SINK_LVL_INFO},
+    {"ALERT",  SINK_LVL_ALERT},
+    {"DB",     SINK_LVL_INFO},
+    {"PERF",   SINK_LVL_DEBUG},
+    {"LINK",   SINK_LVL_DEBUG},
+    {"TRACE",  SINK_LVL_DEBUG},
+    {"CRED",   SINK_LVL_INFO},
+    {"",       SINK_LVL_DEBUG}
+};
+
+static const char *sink_names[SINK_COUNT] = {"UART0", "UART3", "RAM"};
+
+Sink_Config_t sink_config[SINK_COUNT] = {
+    // Debug console: everything, as sent before
+    {1, SINK_LVL_DEBUG, SINK_FMT_TEXT, EVT_ALL},
+    // Cloud bridge: no boot chatter (INIT / CARD list) or profiler output
+    {1, SINK_LVL_INFO, SINK_FMT_TEXT,
+        EVT_ALL & ~(EVT_BIT(EVT_INIT) | EVT_BIT(EVT_CARD) | EVT_BIT(EVT_PERF))},
+    // History: everything but SPI trace dumps, compact to keep more of it
+    {1, SINK_LVL_DEBUG, SINK_FMT_COMPACT, EVT_ALL & ~EVT_BIT(EVT_TRACE)}
+};
+
+Sink_Stats_t sink_stats[SINK_COUNT];
+
+static char sink_ram[SINK_RAM_SIZE];
+static uint32_t sink_ram_head = 0;          // Free running
+static char sink_compact[SINK_FRAME_MAX];
+
+// ============================================
+// Helpers
+// ============================================
+static Sink_Event_t sink_classify(const char *frame) {
+    for(uint8_t e = 0; e < EVT_OTHER; e++) {
+        uint8_t n = strlen(sink_events[e].prefix);
+
+        if(strncmp(frame, sink_events[e].prefix, n) == 0 && frame[n] == ',') {
+            return (Sink_Event_t)e;
+        }
+    }
+    return EVT_OTHER;
+}
+
+static uint16_t sink_make_compact(const char *frame) {
+    uint16_t n = 0;
+
+    while(*frame && n < SINK_FRAME_MAX - 1) {
+        if(*frame != '"') sink_compact[n++] = *frame;
+        frame++;
+    }
+    sink_compact[n] = '\0';
+    return n;
+}
+
+static uint8_t sink_ram_write(const char *s, uint16_t len) {
+    for(uint16_t i = 0; i < len; i++) {
+        sink_ram[(sink_ram_head + i) % SINK_RAM_SIZE] = s[i];
+    }
+    sink_ram_head += len;
+    return 1;                               // Overwrites the oldest bytes
+}
+
+// ============================================
+// Publish (replaces the byte-by-byte dual send)
+// ============================================
+void sink_publish(const char *frame) {
+    Sink_Event_t evt = sink_classify(frame);
+    uint8_t level = sink_events[evt].level;
+    uint16_t len = strlen(frame);
+    uint16_t clen = 0;
+
+    for(uint8_t i = 0; i < SINK_COUNT; i++) {
+        const Sink_Config_t *cfg = &sink_config[i];
+        Sink_Stats_t *st = &sink_stats[i];
+        const char *out = frame;
+        uint16_t n = len;
+        uint8_t ok;
+
+        if(!cfg->enabled || level < cfg->level || !(cfg->event_mask & EVT_BIT(evt))) {
+            st->filtered++;
+            continue;
+        }
+
+        if(cfg->format == SINK_FMT_COMPACT) {
+            if(!clen) clen = sink_make_compact(frame);
+            out = sink_compact;
+            n = clen;
+        }
+
+        if(i == SINK_RAM) {
+            ok = sink_ram_write(out, n);
+#if UPLINK_ENABLE
+        } else if(i == SINK_UART3) {
+            // Sequenced and held until the bridge ACKs it (UPLINK.c)
+            ok = uplink_submit(out, n);
+            if(uplink_stats.backlog > st->max_depth) {
+                st->max_depth = uplink_stats.backlog;
+            }
+#endif
+        } else {
+            uint8_t port = (i == SINK_UART0) ? 0 : 3;
+
+            // ALERT frames overtake what is already queued
+            ok = (level >= SINK_LVL_ALERT) ? uart_tx_write_urgent(port, out, n)
+                                           : uart_tx_write(port, out, n);
+            if(uart_tx_used(port) > st->max_depth) {
+                st->max_depth = uart_tx_used(port);
+            }
+        }
+
+        if(ok) {
+            st->frames++;
+            st->bytes += n;
+        } else {
+            st->drops++;
+        }
+    }
+}
+
+void sink_service(void) {
+    uart_tx_service();
+}
+
+// Reads history from *pos on; a reader that fell behind skips
+// to the oldest byte still held
+uint16_t sink_ram_read(uint32_t *pos, char *buf, uint16_t max) {
+    uint16_t n = 0;
+
+    if(sink_ram_head - *pos > SINK_RAM_SIZE) {
+        *pos = sink_ram_head - SINK_RAM_SIZE;
+    }
+    while(*pos != sink_ram_head && n < max) {
+        buf[n++] = sink_ram[*pos % SINK_RAM_SIZE];
+        (*pos)++;
+    }
+    return n;
+}
+
+// ============================================
+// SINK_STATUS frame
+// ============================================
+void sink_report(void) {
+    char buf[SINK_COUNT * 128 + 64];
+    int len;
+
+    len = sprintf(buf, "STATUS,{\"type\":\"SINK_STATUS\",\"sinks\":[");
+    for(uint8_t i = 0; i < SINK_COUNT; i++) {
+        const Sink_Config_t *cfg = &sink_config[i];
+        const Sink_Stats_t *st = &sink_stats[i];
+
+        len += sprintf(buf + len,
+            "%s{\"sink\":\"%s\",\"on\":%u,\"level\":%u,\"fmt\":\"%s\",\"mask\":%u,"
+            "\"frames\":%lu,\"bytes\":%lu,\"drops\":%lu,\"filtered\":%lu,\"max_depth\":%u}",
+            i ? "," : "", sink_names[i], cfg->enabled, cfg->level,
+            (cfg->format == SINK_FMT_COMPACT) ? "compact" : "text", cfg->event_mask,
+            (unsigned long)st->frames, (unsigned long)st->bytes,
+            (unsigned long)st->drops, (unsigned long)st->filtered, st->max_depth);
+    }
+    sprintf(buf + len, "]}\r\n");
+    sink_publish(buf);
+}
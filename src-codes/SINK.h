@@ -0,0 +1,86 @@
+/**
+ * ============================================
+ * TELEMETRY SINKS HEADER
+ * Per-destination routing of outgoing frames
+ * ============================================
+ */
+
+#ifndef SINK_H
+#define SINK_H
+
+#include <stdint.h>
+
+// ============================================
+// Sinks
+// ============================================
+#define SINK_RAM_SIZE       2048        // History kept for inspection
+#define SINK_FRAME_MAX      768         // Longest frame (= uart_buf)
+
+typedef enum {
+    SINK_UART0 = 0,                     // Debug console
+    SINK_UART3,                         // ESP32 cloud bridge
+    SINK_RAM,                           // Ring buffer, read with sink_ram_read()
+    SINK_COUNT
+} Sink_Id_t;
+
+typedef enum {
+    SINK_LVL_DEBUG = 0,
+    SINK_LVL_INFO,
+    SINK_LVL_ALERT
+} Sink_Level_t;
+
+typedef enum {
+    SINK_FMT_TEXT = 0,                  // Frame as built: TYPE,{"key":value}
+    SINK_FMT_COMPACT                    // Quotes stripped: TYPE,{key:value}
+} Sink_Format_t;
+
+// ============================================
+// Event Types (frame prefix before the ',')
+// ============================================
+typedef enum {
+    EVT_INIT = 0,
+    EVT_CARD,
+    EVT_STATUS,
+    EVT_RFID,
+    EVT_ENV,
+    EVT_GATE,
+    EVT_ALERT,
+    EVT_DB,
+    EVT_PERF,
+    EVT_LINK,
+    EVT_TRACE,
+    EVT_CRED,                           // Credential ACK / NAK to the gateway
+    EVT_OTHER,
+    EVT_COUNT
+} Sink_Event_t;
+
+#define EVT_BIT(e)          (1U << (e))
+#define EVT_ALL             ((1U << EVT_COUNT) - 1)
+
+typedef struct {
+    uint8_t enabled;
+    uint8_t level;                      // Minimum Sink_Level_t
+    uint8_t format;                     // Sink_Format_t
+    uint16_t event_mask;                // EVT_BIT() of the types it takes
+} Sink_Config_t;
+
+typedef struct {
+    uint32_t frames;                    // Frames queued
+    uint32_t bytes;                     // Bytes queued
+    uint32_t drops;                     // Frames lost to a full queue
+    uint32_t filtered;                  // Frames outside level / mask
+    uint16_t max_depth;                 // Queue high-water mark (bytes; UART3: frames)
+} Sink_Stats_t;
+
+extern Sink_Config_t sink_config[SINK_COUNT];
+extern Sink_Stats_t sink_stats[SINK_COUNT];
+
+// ============================================
+// Function Prototypes
+// ============================================
+void sink_publish(const char *frame);
+void sink_service(void);
+uint16_t sink_ram_read(uint32_t *pos, char *buf, uint16_t max);
+void sink_report(void);
+
+#endif // SINK_H
@@ -0,0 +1,186 @@
+/**
+ * ============================================
+ * SPI TRACE
+ * Every SSP0_Write / SSP0_Read to the RC522 is
+ * logged with its register, value and TIMER1
+ * time into a RAM ring, tagged with the driver
+ * call (scan phase) it belongs to. The scan path
+ * freezes the ring after a good anticollision, so
+ * it holds the tail of the idle polls plus the
+ * whole REQA -> anticoll exchange; it is then
+ * dumped over UART0 a few lines per main-loop
+ * pass and re-armed.
+ *
+ * TRACE,{"type":"SPI_TRACE",...}    header
+ * TRACE,i,dt_us,W|R|M,phase,AA,VV   one entry
+ * TRACE,{"type":"SPI_TRACE_END",...} per-phase counts
+ *
+ * Flash index reads go through SSP0_TRANSFER
+ * directly and are not recorded.
+ * ============================================
+ */
+
+#include "SPITRACE.h"
+
+#if SPITRACE_ENABLE
+
+#include "LPC17xx.h"
+#include "uart.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef enum {
+    TRACE_RECORDING = 0,
+    TRACE_HEADER,
+    TRACE_ENTRIES,
+    TRACE_SUMMARY
+} SpiTrace_State_t;
+
+static const char *trace_phase_names[SPITRACE_PH_COUNT] = {
+    "NONE", "INIT", "REQUEST", "ANTICOLL", "SELECT",
+    "AUTH", "READ", "WRITE", "HALT"
+};
+
+static const char trace_kind_chars[3] = {'W', 'R', 'M'};
+
+SpiTrace_Stats_t spitrace_stats;
+
+static SpiTrace_Entry_t trace_ring[SPITRACE_DEPTH];
+static uint32_t trace_head = 0;             // Free running
+static uint8_t trace_phase = SPITRACE_PH_NONE;
+static SpiTrace_State_t trace_state = TRACE_RECORDING;
+static uint32_t trace_first = 0;            // Oldest entry of a frozen ring
+static uint32_t trace_next = 0;             // Next entry to dump
+
+void spitrace_init(void) {
+    memset(&spitrace_stats, 0, sizeof(spitrace_stats));
+    trace_head = 0;
+    trace_phase = SPITRACE_PH_NONE;
+    trace_state = TRACE_RECORDING;
+}
+
+void spitrace_record(uint8_t kind, uint8_t addr, uint8_t value) {
+    SpiTrace_Entry_t *e;
+
+    if(trace_state != TRACE_RECORDING) return;
+
+    if(trace_head >= SPITRACE_DEPTH) spitrace_stats.overwritten++;
+
+    e = &trace_ring[trace_head % SPITRACE_DEPTH];
+    e->t_us = LPC_TIM1->TC;
+    e->kind = kind;
+    e->addr = addr;
+    e->value = value;
+    e->phase = trace_phase;
+    trace_head++;
+    spitrace_stats.recorded++;
+}
+
+// Called at the top of each RC522 driver entry point
+void spitrace_phase(uint8_t phase) {
+    trace_phase = phase;
+    spitrace_record(SPITRACE_MARK, phase, 0);
+}
+
+// Freeze what is in the ring and start the dump
+void spitrace_trigger(void) {
+    if(trace_state != TRACE_RECORDING || trace_head == 0) return;
+
+    trace_first = (trace_head > SPITRACE_DEPTH) ? trace_head - SPITRACE_DEPTH : 0;
+    trace_next = trace_first;
+    trace_state = TRACE_HEADER;
+}
+
+// ============================================
+// Dump (paced on the UART0 queue)
+// ============================================
+static void trace_summary(void) {
+    char buf[640];
+    uint16_t calls[SPITRACE_PH_COUNT];
+    uint16_t xfers[SPITRACE_PH_COUNT];
+    uint32_t us[SPITRACE_PH_COUNT];
+    uint8_t mark_ph = SPITRACE_PH_NONE;
+    uint8_t first = 1;
+    int len;
+
+    memset(calls, 0, sizeof(calls));
+    memset(xfers, 0, sizeof(xfers));
+    memset(us, 0, sizeof(us));
+
+    // A call lasts from its mark to the last transaction before the next mark
+    for(uint32_t i = trace_first; i < trace_head; i++) {
+        const SpiTrace_Entry_t *e = &trace_ring[i % SPITRACE_DEPTH];
+        uint8_t ph = (e->phase < SPITRACE_PH_COUNT) ? e->phase : SPITRACE_PH_NONE;
+
+        if(e->kind == SPITRACE_MARK) {
+            calls[ph]++;
+            mark_ph = ph;
+        } else {
+            xfers[ph]++;
+            if(ph == mark_ph && i != trace_first) {
+                const SpiTrace_Entry_t *p = &trace_ring[(i - 1) % SPITRACE_DEPTH];
+                us[ph] += e->t_us - p->t_us;
+            }
+        }
+    }
+
+    len = sprintf(buf,
+        "TRACE,{\"type\":\"SPI_TRACE_END\",\"n\":%lu,\"phases\":[",
+        (unsigned long)(trace_head - trace_first));
+
+    for(uint8_t p = 0; p < SPITRACE_PH_COUNT; p++) {
+        if(!calls[p] && !xfers[p]) continue;
+        len += sprintf(buf + len,
+            "%s{\"phase\":\"%s\",\"calls\":%u,\"xfers\":%u,\"us\":%lu}",
+            first ? "" : ",", trace_phase_names[p],
+            calls[p], xfers[p], (unsigned long)us[p]);
+        first = 0;
+    }
+
+    sprintf(buf + len, "]}\r\n");
+    uart_dual_send_string(buf);
+}
+
+void spitrace_service(void) {
+    char buf[96];
+    uint8_t lines = 0;
+
+    if(trace_state == TRACE_RECORDING) return;
+
+    while(lines < SPITRACE_DUMP_LINES &&
+          uart_tx_used(0) < UART_TX_RING_SIZE - SPITRACE_DUMP_ROOM) {
+        if(trace_state == TRACE_HEADER) {
+            sprintf(buf,
+                "TRACE,{\"type\":\"SPI_TRACE\",\"n\":%lu,\"overwritten\":%lu,\"t0\":%lu}\r\n",
+                (unsigned long)(trace_head - trace_first),
+                (unsigned long)spitrace_stats.overwritten,
+                (unsigned long)trace_ring[trace_first % SPITRACE_DEPTH].t_us);
+            uart_dual_send_string(buf);
+            trace_state = TRACE_ENTRIES;
+        } else if(trace_state == TRACE_ENTRIES) {
+            const SpiTrace_Entry_t *e = &trace_ring[trace_next % SPITRACE_DEPTH];
+            uint32_t t0 = trace_ring[trace_first % SPITRACE_DEPTH].t_us;
+
+            sprintf(buf, "TRACE,%lu,%lu,%c,%u,%02X,%02X\r\n",
+                (unsigned long)(trace_next - trace_first),
+                (unsigned long)(e->t_us - t0),
+                trace_kind_chars[e->kind <= SPITRACE_MARK ? e->kind : SPITRACE_MARK],
+                e->phase, e->addr, e->value);
+            uart_dual_send_string(buf);
+
+            if(++trace_next >= trace_head) trace_state = TRACE_SUMMARY;
+        } else {
+            trace_summary();
+
+            // Re-arm: next capture starts empty
+            spitrace_stats.dumps++;
+            spitrace_stats.overwritten = 0;
+            trace_head = 0;
+            trace_state = TRACE_RECORDING;
+            return;
+        }
+        lines++;
+    }
+}
+
+#endif // SPITRACE_ENABLE
@@ -0,0 +1,87 @@
+/**
+ * ============================================
+ * SPI TRACE HEADER
+ * RC522 register transaction recorder
+ * (replayed on the host by tools/rc522_replay.c)
+ * ============================================
+ */
+
+#ifndef SPITRACE_H
+#define SPITRACE_H
+
+#include <stdint.h>
+
+// ============================================
+// Build Switches
+// SPITRACE_ENABLE 0 - SPITRACE_* macros expand to
+//                     nothing, no code or RAM
+// ============================================
+#ifndef SPITRACE_ENABLE
+#define SPITRACE_ENABLE 0
+#endif
+
+#define SPITRACE_DEPTH         256      // Entries (8 bytes each)
+#define SPITRACE_DUMP_LINES    8        // TRACE lines per service pass
+#define SPITRACE_DUMP_ROOM     256      // UART0 queue bytes kept free while dumping
+
+// ============================================
+// Entry Kinds / Scan Phases
+// ============================================
+#define SPITRACE_WRITE         0
+#define SPITRACE_READ          1
+#define SPITRACE_MARK          2        // Driver call starts, addr = phase
+
+typedef enum {
+    SPITRACE_PH_NONE = 0,
+    SPITRACE_PH_INIT,
+    SPITRACE_PH_REQUEST,
+    SPITRACE_PH_ANTICOLL,
+    SPITRACE_PH_SELECT,
+    SPITRACE_PH_AUTH,
+    SPITRACE_PH_READ,
+    SPITRACE_PH_WRITE,
+    SPITRACE_PH_HALT,
+    SPITRACE_PH_COUNT
+} SpiTrace_Phase_t;
+
+typedef struct {
+    uint32_t t_us;                  // TIMER1 count
+    uint8_t kind;
+    uint8_t addr;                   // RC522 register
+    uint8_t value;
+    uint8_t phase;
+} SpiTrace_Entry_t;
+
+typedef struct {
+    uint32_t recorded;
+    uint32_t overwritten;           // Older entries lost to the ring
+    uint32_t dumps;
+} SpiTrace_Stats_t;
+
+#if SPITRACE_ENABLE
+
+extern SpiTrace_Stats_t spitrace_stats;
+
+void spitrace_init(void);
+void spitrace_phase(uint8_t phase);
+void spitrace_record(uint8_t kind, uint8_t addr, uint8_t value);
+void spitrace_trigger(void);
+void spitrace_service(void);
+
+#define SPITRACE_PHASE(p)          spitrace_phase(p)
+#define SPITRACE_REC(k, a, v)      spitrace_record((k), (a), (v))
+#define SPITRACE_INIT()            spitrace_init()
+#define SPITRACE_TRIGGER()         spitrace_trigger()
+#define SPITRACE_SERVICE()         spitrace_service()
+
+#else
+
+#define SPITRACE_PHASE(p)          ((void)0)
+#define SPITRACE_REC(k, a, v)      ((void)0)
+#define SPITRACE_INIT()            ((void)0)
+#define SPITRACE_TRIGGER()         ((void)0)
+#define SPITRACE_SERVICE()         ((void)0)
+
+#endif // SPITRACE_ENABLE
+
+#endif // SPITRACE_H
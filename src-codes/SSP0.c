@@ -1,15 +1,17 @@
 /**
  * ============================================
- * SSP0 (SPI) Driver for RC522
+ * SSP0 (SPI) Driver for RC522 + SPI flash
  * ============================================
  */
 
 #include "LPC17xx.h"
 #include "SSP0.h"
+#include "SPITRACE.h"
+#include "FLASHIDX.h"
 
 void SSP0_init(void) {
     // Power on SSP0
-    LPC_SC->PCONP |= (1 << 21);
+    LPC_SC->PCONP |= SSP0_PCONP;
     
     // Configure pins for SSP0
     // P0.15 = SCK0
@@ -25,6 +27,13 @@ void SSP0_init(void) {
     LPC_GPIO0->FIODIR |= (1 << 16);
     LPC_GPIO0->FIOSET = (1 << 16);  // CS high initially
     
+#if FLASHIDX_ENABLE
+    // P0.6 as GPIO: SPI flash CS (same SCK/MISO/MOSI)
+    LPC_PINCON->PINSEL0 &= ~(3 << 12);
+    LPC_GPIO0->FIODIR |= SSP0_FLASH_CS;
+    LPC_GPIO0->FIOSET = SSP0_FLASH_CS;
+#endif
+    
     // Configure SSP0 for RC522
     LPC_SSP0->CR0 = 0x07;  // 8-bit, SPI mode, CPOL=0, CPHA=0
     LPC_SSP0->CPSR = 8;    // Clock prescaler
@@ -38,7 +47,18 @@ void SSP0_init(void) {
     (void)dummy;
 }
 
+// Idle (power_sleep): clock off until the next chip select;
+// registers keep their contents while gated
+uint8_t SSP0_clock_gate(void) {
+    if(LPC_SC->PCONP & SSP0_PCONP) {
+        if(LPC_SSP0->SR & (1 << 4)) return 0;      // BSY
+        LPC_SC->PCONP &= ~SSP0_PCONP;
+    }
+    return 1;
+}
+
 void SelSlave(void) {
+    LPC_SC->PCONP |= SSP0_PCONP;
     LPC_GPIO0->FIOCLR = (1 << 16);  // CS low (active)
 }
 
@@ -46,6 +66,15 @@ void DeselSlave(void) {
     LPC_GPIO0->FIOSET = (1 << 16);  // CS high (inactive)
 }
 
+void SelFlash(void) {
+    LPC_SC->PCONP |= SSP0_PCONP;
+    LPC_GPIO0->FIOCLR = SSP0_FLASH_CS;
+}
+
+void DeselFlash(void) {
+    LPC_GPIO0->FIOSET = SSP0_FLASH_CS;
+}
+
 uint8_t SSP0_TRANSFER(uint8_t data) {
     // Wait until TX FIFO is not full
     while(!(LPC_SSP0->SR & (1 << 1)));
@@ -65,6 +94,7 @@ void SSP0_Write(uint8_t addr, uint8_t value) {
     SSP0_TRANSFER((addr << 1) & 0x7E);  // Address, write mode
     SSP0_TRANSFER(value);
     DeselSlave();
+    SPITRACE_REC(SPITRACE_WRITE, addr, value);
 }
 
 uint8_t SSP0_Read(uint8_t addr) {
@@ -73,5 +103,6 @@ uint8_t SSP0_Read(uint8_t addr) {
     SSP0_TRANSFER(((addr << 1) & 0x7E) | 0x80);  // Address, read mode
     data = SSP0_TRANSFER(0x00);  // Dummy byte to read
     DeselSlave();
+    SPITRACE_REC(SPITRACE_READ, addr, data);
     return data;
 }
@@ -3,9 +3,18 @@
 
 #include <stdint.h>
 
+// Second slave on the bus: SPI NOR flash (card index)
+// RC522 keeps P0.16; both are driven from main context only
+#define SSP0_FLASH_CS (1 << 6)   // P0.6
+
+#define SSP0_PCONP (1 << 21)
+
 void SSP0_init(void);
+uint8_t SSP0_clock_gate(void);
 void SelSlave(void);
 void DeselSlave(void);
+void SelFlash(void);
+void DeselFlash(void);
 uint8_t SSP0_TRANSFER(uint8_t data);
 void SSP0_Write(uint8_t addr, uint8_t value);
 uint8_t SSP0_Read(uint8_t addr);
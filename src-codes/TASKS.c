@@ -0,0 +1,272 @@
+/**
+ * ============================================
+ * TASKS
+ * Cooperative fixed-priority scheduler (not an
+ * RTOS: no preemption, one stack, no context
+ * switch). Each main-loop pass runs the
+ * highest-priority task that is ready:
+ * signalled (task_signal, also from an
+ * interrupt) or due (its period, or the time it
+ * asked for with task_sleep_ms), and the task
+ * runs to completion. A low-priority task holds
+ * up a higher one for the length of one of its
+ * runs, so task bodies must not wait: waits
+ * become a sleep and a state to resume from,
+ * UART frames are queued or dropped (never
+ * waited on), and the DHT11 frame is captured
+ * by its edge interrupt while the task sleeps.
+ *
+ * When nothing is ready the core sleeps until
+ * the next due time (power_sleep, POWER.c) with
+ * interrupts masked around the check, so a
+ * signal raised just before cannot be slept on.
+ *
+ * Per task: runs, CPU share (TIMER1 us), worst
+ * run, worst start delay after it was due, and
+ * the stack depth it reached (main stack is
+ * painted; the part a task dirtied is measured
+ * and repainted after every run).
+ * ============================================
+ */
+
+#include "TASKS.h"
+#include "DELAY.h"
+#include "uart.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef TASKS_HOST
+#include "LPC17xx.h"
+#include "POWER.h"
+#endif
+
+Task_t tasks[TASK_COUNT];
+Tasks_Stats_t tasks_stats;
+
+static uint8_t task_running = TASK_COUNT;
+static uint8_t task_slept = 0;              // Running task set its own due time
+
+// ============================================
+// Time
+// ============================================
+static uint32_t tasks_now_us(void) {
+#ifdef TASKS_HOST
+    return tasks_host_now_us();
+#else
+    return LPC_TIM1->TC;
+#endif
+}
+
+// ============================================
+// Stack Painting (startup_LPC17xx.s: AREA STACK)
+// ============================================
+#if TASKS_STACK_CHECK
+extern uint32_t STACK$$Base;
+extern uint32_t STACK$$Limit;
+
+// Everything from 'from' up to just below the caller's frame
+static void stack_repaint(uint32_t *from) {
+    uint32_t *sp = (uint32_t *)(__get_MSP() - TASKS_STACK_MARGIN);
+
+    for(uint32_t *p = from; p < sp; p++) *p = TASKS_STACK_PAINT;
+}
+
+static uint32_t *stack_first_dirty(void) {
+    uint32_t *p = &STACK$$Base;
+
+    while(p < &STACK$$Limit && *p == TASKS_STACK_PAINT) p++;
+    return p;
+}
+#endif
+
+void tasks_init(void) {
+    memset(tasks, 0, sizeof(tasks));
+    memset(&tasks_stats, 0, sizeof(tasks_stats));
+    task_running = TASK_COUNT;
+    tasks_stats.window_start_us = tasks_now_us();
+
+#if TASKS_STACK_CHECK
+    tasks_stats.stack_size = (uint16_t)((&STACK$$Limit - &STACK$$Base) * 4);
+    stack_repaint(&STACK$$Base);
+#endif
+}
+
+void task_create(uint8_t id, const char *name, Task_Fn_t fn,
+                 uint8_t prio, uint16_t period_ms, uint16_t stack_budget) {
+    Task_t *t = &tasks[id];
+
+    t->name = name;
+    t->fn = fn;
+    t->prio = prio;
+    t->period_ms = period_ms;
+    t->stack_budget = stack_budget;
+    t->timed = (period_ms != 0);
+    t->next_ms = millis() + period_ms;
+}
+
+// Interrupt-safe: one byte store
+void task_signal(uint8_t id) {
+    tasks[id].signaled = 1;
+}
+
+// Due again in ms (from the task itself, or from another one)
+void task_sleep_ms(uint8_t id, uint32_t ms) {
+    tasks[id].next_ms = millis() + ms;
+    tasks[id].timed = 1;
+    if(id == task_running) task_slept = 1;
+}
+
+// ============================================
+// Scheduler
+// ============================================
+static uint8_t task_ready(const Task_t *t, uint32_t now) {
+    if(!t->fn) return 0;
+    if(t->signaled) return 1;
+    return t->timed && (int32_t)(now - t->next_ms) >= 0;
+}
+
+static void task_run(uint8_t id, uint32_t now) {
+    Task_t *t = &tasks[id];
+    uint32_t t0, dt;
+    uint8_t was_due = t->timed && (int32_t)(now - t->next_ms) >= 0;
+
+    if(was_due && (now - t->next_ms) > t->late_max_ms) {
+        t->late_max_ms = now - t->next_ms;
+    }
+
+    t->signaled = 0;                        // A signal during the run runs it again
+    task_running = id;
+    task_slept = 0;
+
+    t0 = tasks_now_us();
+    t->fn();
+    dt = tasks_now_us() - t0;
+
+    task_running = TASK_COUNT;
+    t->runs++;
+    t->us_window += dt;
+    if(dt > t->us_max) t->us_max = dt;
+
+    // Next period counts from the due time, not from when it ran
+    if(!task_slept && was_due) {
+        if(t->period_ms) {
+            t->next_ms += t->period_ms;
+            if((int32_t)(millis() - t->next_ms) >= 0) t->next_ms = millis() + t->period_ms;
+        } else {
+            t->timed = 0;                   // Signal-only task woke from a sleep
+        }
+    }
+
+#if TASKS_STACK_CHECK
+    {
+        uint32_t *dirty = stack_first_dirty();
+        uint16_t depth = (uint16_t)((&STACK$$Limit - dirty) * 4);
+
+        if(depth > t->stack_hwm) {
+            if(t->stack_hwm <= t->stack_budget && depth > t->stack_budget) {
+                tasks_stats.over_budget++;
+            }
+            t->stack_hwm = depth;
+        }
+        if(depth > tasks_stats.stack_hwm) tasks_stats.stack_hwm = depth;
+        stack_repaint(dirty);
+    }
+#endif
+}
+
+static void tasks_idle(uint32_t now) {
+    uint32_t horizon = 0xFFFFFFFF;
+    uint32_t t0 = tasks_now_us();
+
+    for(uint8_t i = 0; i < TASK_COUNT; i++) {
+        if(tasks[i].fn && tasks[i].timed) {
+            int32_t d = (int32_t)(tasks[i].next_ms - now);
+            if(d < 0) d = 0;
+            if((uint32_t)d < horizon) horizon = (uint32_t)d;
+        }
+    }
+
+#ifdef TASKS_HOST
+    tasks_host_idle(horizon);
+#else
+    // Any interrupt ends the sleep even with PRIMASK set; the
+    // handler runs once it is cleared again
+    __disable_irq();
+    {
+        uint8_t signaled = 0;
+        for(uint8_t i = 0; i < TASK_COUNT; i++) signaled |= tasks[i].signaled;
+        if(!signaled) power_sleep(horizon);
+    }
+    __enable_irq();
+#endif
+
+    tasks_stats.idle_us += tasks_now_us() - t0;
+    tasks_stats.idle_entries++;
+}
+
+// One scheduling decision; 0 = nothing was ready (idled)
+uint8_t tasks_run_once(void) {
+    uint32_t now = millis();
+    uint8_t best = TASK_COUNT;
+
+    for(uint8_t i = 0; i < TASK_COUNT; i++) {
+        if(task_ready(&tasks[i], now) &&
+           (best == TASK_COUNT || tasks[i].prio < tasks[best].prio)) {
+            best = i;
+        }
+    }
+
+    if(best == TASK_COUNT) {
+        tasks_idle(now);
+        return 0;
+    }
+
+    task_run(best, now);
+    return 1;
+}
+
+// ============================================
+// STATUS,{"type":"TASK_STATUS",...} + one
+// STATUS,{"type":"TASK",...} per task; starts
+// a new CPU share window
+// ============================================
+void tasks_report(void) {
+    char buf[224];
+    uint32_t now = tasks_now_us();
+    uint32_t window = now - tasks_stats.window_start_us;
+
+    if(window == 0) window = 1;
+
+    sprintf(buf,
+        "STATUS,{\"type\":\"TASK_STATUS\",\"window_ms\":%lu,\"idle_pm\":%lu,"
+        "\"idle_entries\":%lu,\"stack_size\":%u,\"stack_hwm\":%u,\"over_budget\":%u}\r\n",
+        (unsigned long)(window / 1000),
+        (unsigned long)((uint64_t)tasks_stats.idle_us * 1000 / window),
+        (unsigned long)tasks_stats.idle_entries,
+        tasks_stats.stack_size, tasks_stats.stack_hwm, tasks_stats.over_budget);
+    uart_dual_send_string(buf);
+
+    for(uint8_t i = 0; i < TASK_COUNT; i++) {
+        Task_t *t = &tasks[i];
+
+        if(!t->fn) continue;
+
+        sprintf(buf,
+            "STATUS,{\"type\":\"TASK\",\"name\":\"%s\",\"prio\":%u,\"runs\":%lu,"
+            "\"cpu_pm\":%lu,\"max_us\":%lu,\"late_ms\":%lu,\"stack\":%u,\"budget\":%u}\r\n",
+            t->name, t->prio, (unsigned long)t->runs,
+            (unsigned long)((uint64_t)t->us_window * 1000 / window),
+            (unsigned long)t->us_max, (unsigned long)t->late_max_ms,
+            t->stack_hwm, t->stack_budget);
+        uart_dual_send_string(buf);
+
+        t->runs = 0;
+        t->us_window = 0;
+        t->us_max = 0;
+        t->late_max_ms = 0;
+    }
+
+    tasks_stats.idle_us = 0;
+    tasks_stats.idle_entries = 0;
+    tasks_stats.window_start_us = now;
+}
@@ -0,0 +1,124 @@
+/**
+ * ============================================
+ * TASKS HEADER
+ * Cooperative prioritized run-to-completion
+ * tasks on one stack (tools/tasks_sim.c runs
+ * them on the host)
+ * ============================================
+ */
+
+#ifndef TASKS_H
+#define TASKS_H
+
+#include <stdint.h>
+
+// ============================================
+// Build Switches
+// TASKS_HOST        - time and idle come from the
+//                     host harness, no stack check
+// TASKS_STACK_CHECK - paint the main stack and
+//                     measure each task's depth
+// ============================================
+#ifndef TASKS_STACK_CHECK
+#ifdef TASKS_HOST
+#define TASKS_STACK_CHECK 0
+#else
+#define TASKS_STACK_CHECK 1
+#endif
+#endif
+
+#define TASKS_STACK_PAINT     0x5AA5C33CUL
+#define TASKS_STACK_MARGIN    64        // Bytes below the scheduler's SP left alone
+#define TASKS_REPORT_MS       60000     // CPU share window
+
+// ============================================
+// Task Set (bodies in main.c)
+// Priority 0 is the highest; period 0 = runs
+// only when signalled. Stack is the budget the
+// task's measured depth is checked against.
+// ============================================
+typedef enum {
+    TASK_EVENTS = 0,        // eventbus_dispatch: emergency, UART3 lines, ADC
+    TASK_GATE,              // Gate open/hold/close sequence
+    TASK_RFID,              // Reader poll + scan sequence
+    TASK_SENSORS,           // DHT11 / MQ135, ENV frames
+    TASK_TELEMETRY,         // Sinks, uplink, link, denials, forecast, boot
+    TASK_UI,                // LCD, uptime, PERF / status reports
+    TASK_COUNT
+} Task_Id_t;
+
+#define TASK_EVENTS_PRIO        0
+#define TASK_EVENTS_PERIOD_MS   0
+#define TASK_EVENTS_STACK       512
+
+#define TASK_GATE_PRIO          1
+#define TASK_GATE_PERIOD_MS     100
+#define TASK_GATE_STACK         384
+
+#define TASK_RFID_PRIO          2
+#define TASK_RFID_PERIOD_MS     100
+#define TASK_RFID_STACK         512
+
+#define TASK_SENSORS_PRIO       3
+#define TASK_SENSORS_PERIOD_MS  1000    // Rescheduled from telemetry_sample_interval()
+#define TASK_SENSORS_STACK      384
+
+#define TASK_TELEMETRY_PRIO     4
+#define TASK_TELEMETRY_PERIOD_MS 10
+#define TASK_TELEMETRY_STACK    768
+
+#define TASK_UI_PRIO            5
+#define TASK_UI_PERIOD_MS       100     // One UI tick = one old main-loop pass
+#define TASK_UI_STACK           768
+
+typedef void (*Task_Fn_t)(void);
+
+typedef struct {
+    const char *name;
+    Task_Fn_t fn;
+    uint8_t prio;
+    uint16_t period_ms;
+    uint16_t stack_budget;
+    uint32_t next_ms;               // Due time (period or task_sleep_ms)
+    volatile uint8_t signaled;      // task_signal(), also from interrupts
+    uint8_t timed;                  // Has a due time
+    // Statistics (window = since the last report)
+    uint32_t runs;
+    uint32_t us_window;
+    uint32_t us_max;
+    uint32_t late_max_ms;           // Due -> started
+    uint16_t stack_hwm;             // Bytes, incl. interrupts taken meanwhile
+} Task_t;
+
+typedef struct {
+    uint32_t idle_us;               // Window
+    uint32_t idle_entries;
+    uint32_t window_start_us;
+    uint16_t stack_size;            // Bytes of main stack (0 = not checked)
+    uint16_t stack_hwm;             // Deepest over all tasks
+    uint8_t over_budget;            // Tasks whose depth passed their budget
+} Tasks_Stats_t;
+
+extern Task_t tasks[TASK_COUNT];
+extern Tasks_Stats_t tasks_stats;
+
+// ============================================
+// Host harness (TASKS_HOST)
+// ============================================
+#ifdef TASKS_HOST
+uint32_t tasks_host_now_us(void);
+void tasks_host_idle(uint32_t ms);
+#endif
+
+// ============================================
+// Function Prototypes
+// ============================================
+void tasks_init(void);
+void task_create(uint8_t id, const char *name, Task_Fn_t fn,
+                 uint8_t prio, uint16_t period_ms, uint16_t stack_budget);
+void task_signal(uint8_t id);
+void task_sleep_ms(uint8_t id, uint32_t ms);
+uint8_t tasks_run_once(void);
+void tasks_report(void);
+
+#endif // TASKS_H
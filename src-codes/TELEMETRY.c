@@ -0,0 +1,187 @@
+/**
+ * ============================================
+ * TELEMETRY POLICY
+ * Decides when an ENV frame is worth sending:
+ * - deadband per field against the last SENT value
+ * - immediate send on alert threshold crossings
+ *   (cleared only a hysteresis band below)
+ * - heartbeat when nothing changed for a while
+ * - fast sampling while values are moving
+ * - repeated sensor errors collapsed
+ * ============================================
+ */
+
+#include "TELEMETRY.h"
+
+Telemetry_Config_t telemetry_config = {
+    TELEM_DEADBAND_TEMP_X10,
+    TELEM_DEADBAND_HUM_X10,
+    TELEM_DEADBAND_AIR,
+    TELEM_TEMP_HIGH_X10,
+    TELEM_HUM_HIGH_X10,
+    TELEM_TEMP_HYST_X10,
+    TELEM_HUM_HYST_X10,
+    TELEM_SAMPLE_SLOW,
+    TELEM_SAMPLE_FAST,
+    TELEM_STABLE_SAMPLES,
+    TELEM_HEARTBEAT_TICKS,
+    TELEM_ERROR_REPEAT_TICKS
+};
+
+Telemetry_Stats_t telemetry_stats = {0, 0, 0, 0};
+
+// Last values actually reported
+static int16_t sent_temp_x10;
+static int16_t sent_hum_x10;
+static uint16_t sent_air;
+static uint8_t sent_air_status;
+static uint8_t sent_temp_high;         // Alert state last reported
+static uint8_t sent_hum_high;
+static uint32_t sent_time;
+static uint8_t have_sent = 0;
+
+// Previous sample (for the adaptive sampling rate)
+static int16_t prev_temp_x10;
+static int16_t prev_hum_x10;
+static uint16_t prev_air;
+static uint8_t stable_count = 0;
+
+// Error suppression
+static uint8_t error_active = 0;
+static uint32_t error_sent_time = 0;
+
+static uint16_t abs_diff_i16(int16_t a, int16_t b) {
+    return (a > b) ? (uint16_t)(a - b) : (uint16_t)(b - a);
+}
+
+static uint16_t abs_diff_u16(uint16_t a, uint16_t b) {
+    return (a > b) ? (a - b) : (b - a);
+}
+
+// Alert raised at the threshold, cleared only below threshold - hyst,
+// so a value hovering on the line does not report every sample
+static uint8_t alert_state(int16_t v, int16_t high, int16_t hyst, uint8_t raised) {
+    return raised ? (v >= high - hyst) : (v >= high);
+}
+
+// ============================================
+// Reset policy state
+// ============================================
+void telemetry_init(void) {
+    have_sent = 0;
+    stable_count = 0;
+    error_active = 0;
+    error_sent_time = 0;
+    telemetry_stats.sent = 0;
+    telemetry_stats.suppressed = 0;
+    telemetry_stats.errors_sent = 0;
+    telemetry_stats.errors_suppressed = 0;
+}
+
+// ============================================
+// Evaluate a new sample; returns why it should
+// be sent (and records it as sent), or TELEM_NONE
+// ============================================
+Telemetry_Reason_t telemetry_evaluate(int16_t temp_x10, int16_t hum_x10,
+                                      uint16_t air, uint8_t air_status,
+                                      uint32_t now) {
+    const Telemetry_Config_t *cfg = &telemetry_config;
+    Telemetry_Reason_t reason = TELEM_NONE;
+    uint8_t temp_high = alert_state(temp_x10, cfg->temp_high_x10,
+                                    cfg->temp_hyst_x10, have_sent && sent_temp_high);
+    uint8_t hum_high = alert_state(hum_x10, cfg->hum_high_x10,
+                                   cfg->hum_hyst_x10, have_sent && sent_hum_high);
+
+    // Sampling rate follows movement between consecutive samples
+    if(have_sent &&
+       abs_diff_i16(temp_x10, prev_temp_x10) < cfg->deadband_temp_x10 &&
+       abs_diff_i16(hum_x10, prev_hum_x10) < cfg->deadband_hum_x10 &&
+       abs_diff_u16(air, prev_air) < cfg->deadband_air) {
+        if(stable_count < 255) stable_count++;
+    } else {
+        stable_count = 0;
+    }
+    prev_temp_x10 = temp_x10;
+    prev_hum_x10 = hum_x10;
+    prev_air = air;
+
+    if(!have_sent) {
+        reason = TELEM_FIRST;
+    } else if(air_status != sent_air_status ||
+              temp_high != sent_temp_high || hum_high != sent_hum_high) {
+        reason = TELEM_THRESHOLD;
+    } else if(abs_diff_i16(temp_x10, sent_temp_x10) >= cfg->deadband_temp_x10 ||
+              abs_diff_i16(hum_x10, sent_hum_x10) >= cfg->deadband_hum_x10 ||
+              abs_diff_u16(air, sent_air) >= cfg->deadband_air) {
+        reason = TELEM_CHANGE;
+    } else if((now - sent_time) >= cfg->heartbeat_ticks) {
+        reason = TELEM_HEARTBEAT;
+    }
+
+    if(reason == TELEM_NONE) {
+        telemetry_stats.suppressed++;
+        return TELEM_NONE;
+    }
+
+    sent_temp_x10 = temp_x10;
+    sent_hum_x10 = hum_x10;
+    sent_air = air;
+    sent_air_status = air_status;
+    sent_temp_high = temp_high;
+    sent_hum_high = hum_high;
+    sent_time = now;
+    have_sent = 1;
+    telemetry_stats.sent++;
+
+    return reason;
+}
+
+// ============================================
+// Ticks until the next sensor sample
+// ============================================
+uint16_t telemetry_sample_interval(void) {
+    if(stable_count >= telemetry_config.stable_samples) {
+        return telemetry_config.sample_slow;
+    }
+    return telemetry_config.sample_fast;
+}
+
+// ============================================
+// Sensor error suppression: report the first
+// failure, then only every error_repeat_ticks
+// ============================================
+uint8_t telemetry_error_should_report(uint32_t now) {
+    if(!error_active || (now - error_sent_time) >= telemetry_config.error_repeat_ticks) {
+        error_active = 1;
+        error_sent_time = now;
+        telemetry_stats.errors_sent++;
+        return 1;
+    }
+
+    telemetry_stats.errors_suppressed++;
+    return 0;
+}
+
+// Returns 1 once when a reported error condition clears
+uint8_t telemetry_error_cleared(void) {
+    if(error_active) {
+        error_active = 0;
+        return 1;
+    }
+    return 0;
+}
+
+const char* telemetry_reason_string(Telemetry_Reason_t reason) {
+    switch(reason) {
+        case TELEM_FIRST:
+            return "FIRST";
+        case TELEM_CHANGE:
+            return "CHANGE";
+        case TELEM_THRESHOLD:
+            return "THRESHOLD";
+        case TELEM_HEARTBEAT:
+            return "HEARTBEAT";
+        default:
+            return "NONE";
+    }
+}
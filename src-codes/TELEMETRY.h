@@ -0,0 +1,83 @@
+/**
+ * ============================================
+ * TELEMETRY POLICY HEADER
+ * Report-by-exception for ENV frames
+ * ============================================
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+// ============================================
+// Default Policy (main loop ticks = ~100ms)
+// ============================================
+#define TELEM_DEADBAND_TEMP_X10   5      // +/-0.5 C
+#define TELEM_DEADBAND_HUM_X10    20     // +/-2.0 %RH
+#define TELEM_DEADBAND_AIR        50     // +/-50 ADC counts
+
+#define TELEM_TEMP_HIGH_X10       350    // 35.0 C alert threshold
+#define TELEM_HUM_HIGH_X10        800    // 80.0 %RH alert threshold
+#define TELEM_TEMP_HYST_X10       10     // Re-armed below 34.0 C
+#define TELEM_HUM_HYST_X10        20     // Re-armed below 78.0 %RH
+
+#define TELEM_SAMPLE_SLOW         600    // 60 s while stable
+#define TELEM_SAMPLE_FAST         50     // 5 s while values move
+#define TELEM_STABLE_SAMPLES      6      // Stable samples before slowing down
+#define TELEM_HEARTBEAT_TICKS     3000   // Heartbeat at most every 5 min
+
+#define TELEM_ERROR_REPEAT_TICKS  3000   // Re-report a persisting error every 5 min
+
+// ============================================
+// Report Reasons
+// ============================================
+typedef enum {
+    TELEM_NONE = 0,        // Suppressed
+    TELEM_FIRST,           // First valid sample after boot
+    TELEM_CHANGE,          // A field moved outside its deadband
+    TELEM_THRESHOLD,       // An alert threshold / air status was crossed
+    TELEM_HEARTBEAT        // Nothing changed, keep-alive
+} Telemetry_Reason_t;
+
+// ============================================
+// Runtime Configuration
+// ============================================
+typedef struct {
+    int16_t deadband_temp_x10;
+    int16_t deadband_hum_x10;
+    uint16_t deadband_air;
+    int16_t temp_high_x10;
+    int16_t hum_high_x10;
+    int16_t temp_hyst_x10;
+    int16_t hum_hyst_x10;
+    uint16_t sample_slow;
+    uint16_t sample_fast;
+    uint8_t stable_samples;
+    uint32_t heartbeat_ticks;
+    uint32_t error_repeat_ticks;
+} Telemetry_Config_t;
+
+typedef struct {
+    uint32_t sent;             // ENV frames allowed out
+    uint32_t suppressed;       // ENV frames held back by deadbands
+    uint32_t errors_sent;      // SENSOR_ERROR frames allowed out
+    uint32_t errors_suppressed;
+} Telemetry_Stats_t;
+
+extern Telemetry_Config_t telemetry_config;
+extern Telemetry_Stats_t telemetry_stats;
+
+// ============================================
+// Function Prototypes
+// ============================================
+void telemetry_init(void);
+Telemetry_Reason_t telemetry_evaluate(int16_t temp_x10, int16_t hum_x10,
+                                      uint16_t air, uint8_t air_status,
+                                      uint32_t now);
+uint16_t telemetry_sample_interval(void);
+uint8_t telemetry_error_should_report(uint32_t now);
+uint8_t telemetry_error_cleared(void);
+const char* telemetry_reason_string(Telemetry_Reason_t reason);
+
+#endif // TELEMETRY_H
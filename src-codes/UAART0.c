@@ -1,17 +1,96 @@
 #include "LPC17xx.h"
 #include "uart.h"
+#include "DELAY.h"
+#include "SINK.h"
+#include "EVENTBUS.h"
 #include <stdint.h>
+#include <string.h>
+
+Uart3_Stats_t uart3_stats;
+
+/* ================= Baud Rate (DLL/DLM + Fractional Divider) ================= */
+// baud = PCLK / (16 * DL * (1 + DivAddVal / MulVal)), MulVal 1..15,
+// DivAddVal 0..MulVal-1; with DivAddVal > 0 the DL must be >= 3
+uint32_t uart_pclk(uint8_t port){
+    static const uint8_t div[4] = {4, 1, 2, 8};
+    uint32_t sel = (port == 0) ? (LPC_SC->PCLKSEL0 >> 6) : (LPC_SC->PCLKSEL1 >> 18);
+
+    return SystemCoreClock / div[sel & 3];
+}
+
+uint8_t uart_calc_divisor(uint32_t pclk, uint32_t baud, UartDivisor_t *d){
+    uint32_t best_err = 0xFFFFFFFF;
+
+    if(baud == 0) return 0;
+
+    for(uint8_t mul = 1; mul <= 15; mul++){
+        for(uint8_t add = 0; add < mul; add++){
+            uint64_t den = (uint64_t)16 * baud * (mul + add);
+            uint32_t dl = (uint32_t)(((uint64_t)pclk * mul + den / 2) / den);
+            uint32_t actual, err;
+
+            if(dl == 0 || dl > 0xFFFF || (add && dl < 3)) continue;
+
+            actual = (uint32_t)((uint64_t)pclk * mul / ((uint64_t)16 * dl * (mul + add)));
+            err = (actual > baud) ? actual - baud : baud - actual;
+            if(err < best_err){
+                best_err = err;
+                d->dl = (uint16_t)dl;
+                d->mul = mul;
+                d->divadd = add;
+                d->actual = actual;
+                d->err_ppm = (int32_t)(((int64_t)actual - baud) * 1000000 / baud);
+            }
+        }
+    }
+
+    if(best_err == 0xFFFFFFFF) return 0;
+    return (d->err_ppm <= UART_MAX_ERR_PPM && d->err_ppm >= -UART_MAX_ERR_PPM);
+}
+
+// UART0 is TX only: its clock is gated in idle once the queue has
+// drained (uart0_clock_gate) and comes back with the next access
+static LPC_UART_TypeDef* uart_regs(uint8_t port){
+    if(port == 0){
+        LPC_SC->PCONP |= UART0_PCONP;
+        return (LPC_UART_TypeDef *)LPC_UART0;
+    }
+    return LPC_UART3;
+}
+
+// Waits for the transmitter to drain, then reprograms the divisors.
+// Only boot waits here: UARTLINK switches once uart_tx_idle().
+uint8_t uart_set_baud(uint8_t port, uint32_t baud, UartDivisor_t *d){
+    LPC_UART_TypeDef *u = uart_regs(port);
+    UartDivisor_t div;
+
+    if(!uart_calc_divisor(uart_pclk(port), baud, &div)) return 0;
+
+    uart_tx_flush(port);                    // Queue out, then TEMT
+    u->LCR = 0x83;
+    u->DLL = div.dl & 0xFF;
+    u->DLM = div.dl >> 8;
+    u->FDR = (div.mul << 4) | div.divadd;
+    u->LCR = 0x03;
+
+    if(d) *d = div;
+    return 1;
+}
 
 /* ================= UART0 Functions ================= */
 void UART0_Init(void){
-    LPC_SC->PCONP |= (1 << 3);
+    LPC_SC->PCONP |= UART0_PCONP;
     LPC_PINCON->PINSEL0 |= (0x5 << 4);
-    LPC_UART0->LCR = 0x83;
-    LPC_UART0->DLL = 0xA2;
-    LPC_UART0->LCR = 0x03;
+    uart_set_baud(0, UART0_BAUD, 0);
+
+    // TX: FIFO on, THRE interrupt drains the queue
+    LPC_UART0->FCR = 0x07;
+    LPC_UART0->IER = (1 << 1);
+    NVIC_EnableIRQ(UART0_IRQn);
 }
 
 void UART0_SendChar(char c){
+    LPC_SC->PCONP |= UART0_PCONP;
     while(!(LPC_UART0->LSR & (1 << 5)));
     LPC_UART0->THR = c;
 }
@@ -30,10 +109,21 @@ void UART0_SendHex(uint8_t value){
 void UART3_Init(void){
     LPC_SC->PCONP |= (1 << 25);
     LPC_PINCON->PINSEL0 |= (0xA << 0); 
-    LPC_UART3->LCR = 0x83;
-    LPC_UART3->DLL = 0xA2;
-		LPC_UART3->DLM = 0x00;
-    LPC_UART3->LCR = 0x03;
+    uart_set_baud(3, UART3_BAUD, 0);
+
+#if UART3_FLOW_CONTROL
+    // RTS out (low = send), CTS in with pull-down so an unwired CTS reads "clear"
+    LPC_GPIO2->FIODIR |= UART3_RTS_PIN;
+    LPC_GPIO2->FIOCLR = UART3_RTS_PIN;
+    LPC_GPIO2->FIODIR &= ~UART3_CTS_PIN;
+    LPC_PINCON->PINMODE4 |= (3 << 6);
+#endif
+
+    // RX: FIFO on (trigger 8 bytes), receive-data interrupt into the ring
+    // TX: THRE interrupt drains the queue
+    LPC_UART3->FCR = 0x07 | (2 << 6);
+    LPC_UART3->IER = (1 << 0) | (1 << 1);
+    NVIC_EnableIRQ(UART3_IRQn);
 }
 
 void UART3_SendChar(char c){
@@ -51,6 +141,263 @@ void UART3_SendHex(uint8_t value){
     UART3_SendChar(hex[value & 0x0F]);
 }
 
+/* ================= TX Queues (THRE Interrupt) ================= */
+// One ring per port. Only the main loop moves head; the ISR moves
+// tail and loads one FIFO (16 bytes) per THRE interrupt, so a slow
+// port no longer holds up the other one or the main loop.
+// Next to the ring sits one urgent frame (ALERT); it goes out at the
+// next frame boundary in the ring, ahead of everything queued.
+typedef struct {
+    volatile uint8_t buf[UART_TX_RING_SIZE];
+    volatile uint16_t head;
+    volatile uint16_t tail;
+    volatile uint8_t busy;                  // FIFO loaded, THRE pending
+    volatile uint8_t mid_line;              // Last ring byte sent was not '\n'
+    volatile uint8_t urg[UART_TX_URGENT_SIZE];
+    volatile uint16_t urg_len;              // Set by main loop, 0 = free
+    volatile uint16_t urg_pos;              // Moved by the ISR
+    volatile uint32_t idle_us;              // TIMER1 at the last THRE with nothing left
+    uint8_t hold;                           // New writes refused (rate switch pending)
+} UartTxRing_t;
+
+static UartTxRing_t uart_tx[2];             // [0] UART0, [1] UART3
+
+#define UART_TX_Q(port)     (&uart_tx[(port) != 0])
+#define UART_TX_IRQ(port)   ((port) == 0 ? UART0_IRQn : UART3_IRQn)
+
+// ISR context, or main loop with the port IRQ masked; FIFO is empty
+static void uart_tx_fill(uint8_t port){
+    UartTxRing_t *q = UART_TX_Q(port);
+    LPC_UART_TypeDef *u = uart_regs(port);
+    uint8_t n = 0;
+
+#if UART3_FLOW_CONTROL
+    // Bridge holds CTS high while its buffer is full; it must still
+    // take the up to 16 bytes already in our TX FIFO
+    if(port == 3 && (LPC_GPIO2->FIOPIN & UART3_CTS_PIN)){
+        q->busy = 0;                        // uart_tx_service() retries
+        uart3_stats.cts_waits++;
+        return;
+    }
+#endif
+
+    while(n < 16){
+        if(q->urg_len && (!q->mid_line || q->urg_pos || q->tail == q->head)){
+            u->THR = q->urg[q->urg_pos++];
+            if(q->urg_pos == q->urg_len){
+                q->urg_pos = 0;
+                q->urg_len = 0;
+            }
+        } else if(q->tail != q->head){
+            uint8_t c = q->buf[q->tail];
+            u->THR = c;
+            q->tail = (q->tail + 1) % UART_TX_RING_SIZE;
+            q->mid_line = (c != '\n');
+        } else {
+            break;
+        }
+        n++;
+    }
+    if(port == 3) uart3_stats.tx_bytes += n;
+    if(q->busy && !n) q->idle_us = LPC_TIM1->TC;
+    q->busy = (n != 0);
+}
+
+static void uart_tx_kick(uint8_t port){
+    NVIC_DisableIRQ(UART_TX_IRQ(port));
+    if(!UART_TX_Q(port)->busy) uart_tx_fill(port);
+    NVIC_EnableIRQ(UART_TX_IRQ(port));
+}
+
+// head < tail once the queued bytes wrap: add the size first so the
+// uint16_t indices (promoted to int) never give a negative modulo
+uint16_t uart_tx_used(uint8_t port){
+    UartTxRing_t *q = UART_TX_Q(port);
+    return (uint16_t)((q->head + UART_TX_RING_SIZE - q->tail) % UART_TX_RING_SIZE);
+}
+
+// Whole string or nothing; 0 = no room (caller counts the drop)
+// Room for a whole frame; 0 while the queue is held
+uint16_t uart_tx_free(uint8_t port){
+    if(UART_TX_Q(port)->hold) return 0;
+    return (UART_TX_RING_SIZE - 1) - uart_tx_used(port);
+}
+
+uint8_t uart_tx_write(uint8_t port, const char *s, uint16_t len){
+    UartTxRing_t *q = UART_TX_Q(port);
+    uint16_t h = q->head;
+
+    if(len > uart_tx_free(port)) return 0;
+
+    for(uint16_t i = 0; i < len; i++){
+        q->buf[h] = s[i];
+        h = (h + 1) % UART_TX_RING_SIZE;
+    }
+    q->head = h;
+    uart_tx_kick(port);
+    return 1;
+}
+
+// Urgent frame: ahead of the ring at the next '\n'. Only one is
+// held; while it is still going out the frame joins the ring.
+uint8_t uart_tx_write_urgent(uint8_t port, const char *s, uint16_t len){
+    UartTxRing_t *q = UART_TX_Q(port);
+
+    if(q->hold) return 0;
+    if(q->urg_len || len > UART_TX_URGENT_SIZE){
+        return uart_tx_write(port, s, len);
+    }
+
+    for(uint16_t i = 0; i < len; i++){
+        q->urg[i] = s[i];
+    }
+    q->urg_pos = 0;
+    q->urg_len = len;                       // Publishes the frame to the ISR
+    uart_tx_kick(port);
+    return 1;
+}
+
+// Control traffic: wait for room instead of dropping
+void uart_tx_write_wait(uint8_t port, const char *s, uint16_t len){
+    uint32_t t0 = millis();
+
+    while(len){
+        uint16_t n = (len > 64) ? 64 : len;
+
+        while(!uart_tx_write(port, s, n)){
+            if((millis() - t0) >= UART_TX_FLUSH_MS) return;     // Stuck CTS
+            uart_tx_kick(port);
+        }
+        s += n;
+        len -= n;
+    }
+}
+
+void uart_tx_flush(uint8_t port){
+    uint32_t t0 = millis();
+
+    while((uart_tx_used(port) || UART_TX_Q(port)->urg_len) &&
+          (millis() - t0) < UART_TX_FLUSH_MS){
+        uart_tx_kick(port);
+    }
+    while(!(uart_regs(port)->LSR & (1 << 6)));  // TEMT
+}
+
+// 1 = everything queued is off the line (FIFO empty at *since_us,
+// TIMER1, and TEMT now). Lets a caller time a send or switch the
+// rate without waiting for it (UARTLINK.c).
+uint8_t uart_tx_idle(uint8_t port, uint32_t *since_us){
+    UartTxRing_t *q = UART_TX_Q(port);
+
+    if(uart_tx_used(port) || q->urg_len || q->busy) return 0;
+    if(port != 0 || (LPC_SC->PCONP & UART0_PCONP)){
+        if(!(uart_regs(port)->LSR & (1 << 6))) return 0;     // Last byte shifting
+    }
+    if(since_us) *since_us = q->idle_us;
+    return 1;
+}
+
+// Refuse new writes so the queue drains before a rate switch
+void uart_tx_hold(uint8_t port, uint8_t on){
+    UART_TX_Q(port)->hold = on;
+}
+
+// Main loop: restart a queue that stalled on CTS
+void uart_tx_service(void){
+    if(uart_tx_used(0) || uart_tx[0].urg_len) uart_tx_kick(0);
+    if(uart_tx_used(3) || uart_tx[1].urg_len) uart_tx_kick(3);
+}
+
+// Idle (power_sleep, interrupts masked): 1 = clock is off
+uint8_t uart0_clock_gate(void){
+    UartTxRing_t *q = &uart_tx[0];
+
+    if(!(LPC_SC->PCONP & UART0_PCONP)) return 1;
+    if(uart_tx_used(0) || q->urg_len || q->busy) return 0;
+    if(!(LPC_UART0->LSR & (1 << 6))) return 0;     // TEMT: last byte shifting
+
+    LPC_SC->PCONP &= ~UART0_PCONP;
+    return 1;
+}
+
+void UART0_IRQHandler(void){
+    if((LPC_UART0->IIR & 0x0E) == 0x02){    // THRE
+        uart_tx_fill(0);
+    }
+}
+
+/* ================= UART3 Receive (Interrupt) ================= */
+static volatile uint8_t uart3_rx_ring[UART3_RX_RING_SIZE];
+static volatile uint16_t uart3_rx_head = 0;     // Written by ISR
+static volatile uint16_t uart3_rx_tail = 0;     // Written by main loop
+static volatile uint32_t uart3_rx_ovf = 0;
+
+// Size added first: unsigned fill while the data wraps (see uart_tx_used)
+#define UART3_RX_FILL() ((uint16_t)((uart3_rx_head + UART3_RX_RING_SIZE - uart3_rx_tail) % UART3_RX_RING_SIZE))
+
+#if UART3_FLOW_CONTROL
+static volatile uint8_t uart3_rts_stopped = 0;
+#endif
+
+void UART3_IRQHandler(void){
+    uint32_t iir = LPC_UART3->IIR;
+    uint8_t lsr;
+
+    // Drain the FIFO (clears RDA and character-timeout interrupts)
+    while((lsr = LPC_UART3->LSR) & 0x01){
+        uint8_t c = LPC_UART3->RBR;
+        uint16_t next = (uart3_rx_head + 1) % UART3_RX_RING_SIZE;
+
+        if(lsr & 0x0E){
+            uart3_stats.line_errors++;      // Overrun / parity / framing
+        }
+        uart3_stats.rx_bytes++;
+
+        if(next == uart3_rx_tail){
+            uart3_rx_ovf++;
+        } else {
+            uart3_rx_ring[uart3_rx_head] = c;
+            uart3_rx_head = next;
+
+            // A complete line is waiting for carddb_sync_poll()
+            if(c == '\n'){
+                eventbus_post(EVQ_UART, EV_UART_RX_LINE, UART3_RX_FILL(), 0, 0);
+            }
+        }
+    }
+
+#if UART3_FLOW_CONTROL
+    // Ask the bridge to pause before the ring is full
+    if(!uart3_rts_stopped && UART3_RX_FILL() >= UART3_RTS_HIGH){
+        LPC_GPIO2->FIOSET = UART3_RTS_PIN;
+        uart3_rts_stopped = 1;
+        uart3_stats.rts_stops++;
+    }
+#endif
+
+    if((iir & 0x0E) == 0x02){               // THRE
+        uart_tx_fill(3);
+    }
+}
+
+uint8_t uart3_rx_read(uint8_t *c){
+    if(uart3_rx_tail == uart3_rx_head) return 0;
+    *c = uart3_rx_ring[uart3_rx_tail];
+    uart3_rx_tail = (uart3_rx_tail + 1) % UART3_RX_RING_SIZE;
+
+#if UART3_FLOW_CONTROL
+    if(uart3_rts_stopped && UART3_RX_FILL() <= UART3_RTS_LOW){
+        uart3_rts_stopped = 0;
+        LPC_GPIO2->FIOCLR = UART3_RTS_PIN;
+    }
+#endif
+    return 1;
+}
+
+uint32_t uart3_rx_overflows(void){
+    return uart3_rx_ovf;
+}
+
 /* ================= Wrapper Functions ================= */
 void init_uart0(void){
     UART0_Init();
@@ -60,19 +407,34 @@ void init_uart3(void){
     UART3_Init();
 }
 
-/* ================= DUAL UART - Sends to BOTH! ================= */
+void uart_send_char(char c){
+    uart_tx_write_wait(0, &c, 1);
+}
+
+void uart_send_string(const char *str){
+    uart_tx_write_wait(0, str, strlen(str));
+}
+
+void uart3_send_char(char c){
+    uart_tx_write_wait(3, &c, 1);
+}
+
+void uart3_send_string(const char *str){
+    uart_tx_write_wait(3, str, strlen(str));
+}
+
+/* ================= DUAL UART - Routed through the sinks (SINK.c) ================= */
 void uart_dual_send_char(char c){
-    UART0_SendChar(c);      // ? UART0 (P0.2/P0.3)
-    UART3_SendChar(c);      // ? UART3 (P0.0/P0.1)
+    uart_tx_write_wait(0, &c, 1);
+    uart_tx_write_wait(3, &c, 1);
 }
 
 void uart_dual_send_string(const char *str){
-    while(*str){
-        uart_dual_send_char(*str++);
-    }
+    sink_publish(str);
 }
 
 void uart_dual_send_hex(uint8_t value){
-    UART0_SendHex(value);   // ? UART0
-    UART3_SendHex(value);   // ? UART3
+    const char hex[] = "0123456789ABCDEF";
+    uart_dual_send_char(hex[(value >> 4) & 0x0F]);
+    uart_dual_send_char(hex[value & 0x0F]);
 }
@@ -0,0 +1,334 @@
+/**
+ * ============================================
+ * UART3 LINK NEGOTIATION
+ * Boots at UART3_BAUD, then walks a ladder of
+ * faster rates with the bridge (see UARTLINK.h)
+ * and keeps the first one whose probes all come
+ * back intact. While up, a window with too many
+ * line errors steps the link down a rate.
+ * Runs from the TELEMETRY task and never waits
+ * on the line: a frame that does not fit in the
+ * TX queue is tried again on the next pass, a
+ * PING is timed by the queue's THRE interrupt,
+ * and a rate change holds new writes until the
+ * queue is off the line (LINK_DRAIN).
+ * ============================================
+ */
+
+#include "UARTLINK.h"
+#include "LPC17xx.h"
+#include "uart.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+typedef enum {
+    LINK_START = 0,
+    LINK_PROPOSE,
+    LINK_DRAIN,
+    LINK_SWITCH,
+    LINK_PROBE,
+    LINK_REVERT,
+    LINK_UP,
+    LINK_FIXED
+} LinkState_t;
+
+typedef enum {
+    LINK_RX_NONE = 0,
+    LINK_RX_OK,
+    LINK_RX_NO,
+    LINK_RX_PONG,
+    LINK_RX_BAD
+} LinkReply_t;
+
+static const uint32_t link_ladder[UARTLINK_RATES] = {
+    1000000, 921600, 460800, 230400, 115200, 57600
+};
+
+UartLink_Stats_t uartlink_stats;
+
+static LinkState_t link_state = LINK_FIXED;
+static LinkReply_t link_reply = LINK_RX_NONE;
+static uint8_t link_idx = 0;
+static uint8_t link_seq = 0;
+static uint8_t link_good = 0;
+static uint8_t link_heard = 0;              // Bridge answered at least once
+static uint32_t link_deadline = 0;
+static uint32_t link_ping_us = 0;           // TIMER1 when the PING was queued
+static uint32_t link_ping_bytes = 0;        // uart3_stats.tx_bytes then
+static uint8_t link_ping_timed = 0;
+static uint32_t link_drain_baud = 0;        // Rate to set once UART3 is idle
+static LinkState_t link_drain_next = LINK_SWITCH;
+
+static uint32_t win_start = 0;
+static uint32_t win_tx = 0;
+static uint32_t win_rx = 0;
+static uint32_t win_err = 0;
+
+void uartlink_init(void) {
+    uint32_t pclk = uart_pclk(3);
+
+    memset(&uartlink_stats, 0, sizeof(uartlink_stats));
+    uartlink_stats.baud = UART3_BAUD;
+
+    for(uint8_t i = 0; i < UARTLINK_RATES; i++) {
+        UartDivisor_t d;
+        UartLink_Rate_t *r = &uartlink_stats.rates[i];
+
+        r->baud = link_ladder[i];
+        r->supported = uart_calc_divisor(pclk, r->baud, &d);
+        r->err_ppm = d.err_ppm;
+    }
+
+    link_idx = 0;
+    link_heard = 0;
+    link_state = UARTLINK_ENABLE ? LINK_START : LINK_FIXED;
+}
+
+// ============================================
+// Downlink (LINK,... lines, via carddb_sync_poll)
+// ============================================
+void uartlink_rx_line(char **tok, uint8_t n) {
+    if(n < 3) return;
+
+    if(strcmp(tok[1], "OK") == 0 || strcmp(tok[1], "NO") == 0) {
+        if(link_state == LINK_PROPOSE &&
+           strtoul(tok[2], 0, 10) == link_ladder[link_idx]) {
+            link_reply = (tok[1][0] == 'O') ? LINK_RX_OK : LINK_RX_NO;
+        }
+    } else if(strcmp(tok[1], "PONG") == 0 && n >= 4) {
+        if(link_state == LINK_PROBE && strtoul(tok[2], 0, 10) == link_seq) {
+            link_reply = (strtoul(tok[3], 0, 10) == UARTLINK_PATTERN_LEN) ?
+                         LINK_RX_PONG : LINK_RX_BAD;
+        }
+    }
+}
+
+// ============================================
+// Helpers
+// ============================================
+static void link_status(const char *event) {
+    char buf[128];
+    int n;
+
+    n = sprintf(buf, "LINK,{\"type\":\"%s\",\"baud\":%lu}\r\n",
+                event, (unsigned long)uartlink_stats.baud);
+    uart_tx_write(3, buf, n);                       // Informational: dropped when full
+}
+
+static void link_propose(uint32_t now) {
+    char buf[80];
+    int n;
+
+    while(link_idx < UARTLINK_RATES && !uartlink_stats.rates[link_idx].supported) {
+        link_idx++;
+    }
+    if(link_idx >= UARTLINK_RATES) {
+        link_state = LINK_FIXED;
+        link_status("BAUD_FINAL");
+        return;
+    }
+
+    n = sprintf(buf, "LINK,{\"type\":\"BAUD_PROPOSE\",\"baud\":%lu}\r\n",
+                (unsigned long)link_ladder[link_idx]);
+    if(!uart_tx_write(3, buf, n)) {
+        link_state = LINK_START;                    // Queue full: same rate next pass
+        return;
+    }
+
+    link_reply = LINK_RX_NONE;
+    link_deadline = now + UARTLINK_REPLY_MS;
+    link_state = LINK_PROPOSE;
+}
+
+// One PING: line header + fixed pattern, queued whole. The send is
+// timed from here to the THRE interrupt that finds the queue empty
+// (see LINK_PROBE); every byte sent in between counts towards the rate.
+static void link_ping(uint32_t now) {
+    static char buf[24 + UARTLINK_PATTERN_LEN + 2];
+    uint16_t n;
+
+    n = sprintf(buf, "LINK,PING,%u,", (uint8_t)(link_seq + 1));
+    for(uint16_t i = 0; i < UARTLINK_PATTERN_LEN; i++) {
+        buf[n++] = (i & 1) ? 'U' : '*';             // 0x55 / 0x2A edges
+    }
+    buf[n++] = '\r';
+    buf[n++] = '\n';
+
+    link_ping_us = LPC_TIM1->TC;
+    link_ping_bytes = uart3_stats.tx_bytes;
+    if(!uart_tx_write(3, buf, n)) {
+        link_deadline = now;                        // Queue full: again next pass
+        link_state = LINK_SWITCH;
+        return;
+    }
+    link_seq++;
+    link_ping_timed = 0;
+    uartlink_stats.rates[link_idx].probes++;
+
+    link_reply = LINK_RX_NONE;
+    link_deadline = now + UARTLINK_REPLY_MS;
+    link_state = LINK_PROBE;
+}
+
+// LINK_PROBE: once the PING (and anything after it) has left the FIFO
+static void link_ping_time(void) {
+    uint32_t t1, us;
+
+    if(link_ping_timed || !uart_tx_idle(3, &t1)) return;
+    link_ping_timed = 1;
+
+    us = t1 - link_ping_us;
+    if(us) {
+        uartlink_stats.rates[link_idx].tx_Bps =
+            (uint32_t)(((uint64_t)(uart3_stats.tx_bytes - link_ping_bytes) * 1000000) / us);
+    }
+}
+
+// Rate change: UART3 takes no new frames until what is queued has
+// gone out at the old rate, then the divisors change (LINK_DRAIN)
+static void link_set_rate(uint32_t baud, LinkState_t next) {
+    link_drain_baud = baud;
+    link_drain_next = next;
+    uart_tx_hold(3, 1);
+    link_state = LINK_DRAIN;
+}
+
+static void link_fallback(void) {
+    link_idx++;
+    link_set_rate(UART3_BAUD, LINK_REVERT);
+}
+
+// ============================================
+// Service
+// ============================================
+void uartlink_service(uint32_t now) {
+    switch(link_state) {
+        case LINK_START:
+            link_propose(now);
+            break;
+
+        case LINK_PROPOSE:
+            if(link_reply == LINK_RX_OK) {
+                link_heard = 1;
+                link_set_rate(link_ladder[link_idx], LINK_SWITCH);
+            } else if(link_reply == LINK_RX_NO) {
+                link_heard = 1;
+                link_idx++;
+                link_propose(now);
+            } else if((int32_t)(now - link_deadline) >= 0) {
+                if(!link_heard) {
+                    // Bridge without LINK support: stay where we are
+                    link_state = LINK_FIXED;
+                } else {
+                    link_idx++;
+                    link_propose(now);
+                }
+            }
+            break;
+
+        case LINK_DRAIN:
+            if(!uart_tx_idle(3, 0)) break;
+
+            uart_set_baud(3, link_drain_baud, 0);   // Nothing left to flush
+            uart_tx_hold(3, 0);
+            uartlink_stats.baud = link_drain_baud;
+            if(link_drain_next == LINK_SWITCH) {
+                link_good = 0;
+                link_deadline = now + UARTLINK_SETTLE_MS;
+            } else {
+                link_deadline = now + UARTLINK_REVERT_MS;
+            }
+            link_state = link_drain_next;
+            break;
+
+        case LINK_SWITCH:
+            // Bridge reprograms its UART after sending OK
+            if((int32_t)(now - link_deadline) >= 0) {
+                link_ping(now);
+            }
+            break;
+
+        case LINK_PROBE:
+            link_ping_time();
+            if(link_reply == LINK_RX_PONG) {
+                if(++link_good >= UARTLINK_PROBES) {
+                    win_start = now;
+                    win_tx = uart3_stats.tx_bytes;
+                    win_rx = uart3_stats.rx_bytes;
+                    win_err = uart3_stats.line_errors;
+                    link_state = LINK_UP;
+                    link_status("BAUD_FINAL");
+                } else {
+                    link_ping(now);
+                }
+            } else if(link_reply == LINK_RX_BAD || (int32_t)(now - link_deadline) >= 0) {
+                uartlink_stats.rates[link_idx].fails++;
+                link_fallback();
+            }
+            break;
+
+        case LINK_REVERT:
+            // Give the bridge time to fall back on its own
+            if((int32_t)(now - link_deadline) >= 0) {
+                link_propose(now);
+            }
+            break;
+
+        case LINK_UP:
+            if((now - win_start) >= UARTLINK_WINDOW_MS) {
+                uint32_t ms = now - win_start;
+
+                uartlink_stats.tx_Bps = (uart3_stats.tx_bytes - win_tx) * 1000 / ms;
+                uartlink_stats.rx_Bps = (uart3_stats.rx_bytes - win_rx) * 1000 / ms;
+                uartlink_stats.window_errors = uart3_stats.line_errors - win_err;
+
+                if(uartlink_stats.window_errors > UARTLINK_MAX_ERRORS) {
+                    uartlink_stats.rates[link_idx].fails++;
+                    uartlink_stats.step_downs++;
+                    link_status("BAUD_DROP");
+                    link_fallback();
+                    break;
+                }
+
+                win_start = now;
+                win_tx = uart3_stats.tx_bytes;
+                win_rx = uart3_stats.rx_bytes;
+                win_err = uart3_stats.line_errors;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+// ============================================
+// LINK_STATUS frame (per-rate probe results)
+// ============================================
+void uartlink_report(void) {
+    char buf[UARTLINK_RATES * 96 + 256];
+    int len;
+
+    len = sprintf(buf,
+        "STATUS,{\"type\":\"LINK_STATUS\",\"baud\":%lu,"
+        "\"tx_Bps\":%lu,\"rx_Bps\":%lu,\"line_err\":%lu,"
+        "\"cts_waits\":%lu,\"rts_stops\":%lu,"
+        "\"step_downs\":%lu,\"rates\":[",
+        (unsigned long)uartlink_stats.baud,
+        (unsigned long)uartlink_stats.tx_Bps, (unsigned long)uartlink_stats.rx_Bps,
+        (unsigned long)uart3_stats.line_errors,
+        (unsigned long)uart3_stats.cts_waits, (unsigned long)uart3_stats.rts_stops, (unsigned long)uartlink_stats.step_downs);
+
+    for(uint8_t i = 0; i < UARTLINK_RATES; i++) {
+        const UartLink_Rate_t *r = &uartlink_stats.rates[i];
+
+        len += sprintf(buf + len,
+            "%s{\"baud\":%lu,\"err_ppm\":%ld,\"ok\":%u,\"probes\":%u,\"fails\":%u,\"Bps\":%lu}",
+            i ? "," : "", (unsigned long)r->baud, (long)r->err_ppm, r->supported,
+            r->probes, r->fails, (unsigned long)r->tx_Bps);
+    }
+
+    sprintf(buf + len, "]}\r\n");
+    uart_dual_send_string(buf);
+}
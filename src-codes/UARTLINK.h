@@ -0,0 +1,69 @@
+/**
+ * ============================================
+ * UART3 LINK NEGOTIATION HEADER
+ * Start-up baud handshake with the ESP32 bridge
+ * ============================================
+ */
+
+#ifndef UARTLINK_H
+#define UARTLINK_H
+
+#include <stdint.h>
+
+// ============================================
+// Handshake (all lines on UART3)
+//
+// MCU  LINK,{"type":"BAUD_PROPOSE","baud":N}   at UART3_BAUD
+// ESP  LINK,OK,N  |  LINK,NO,N                 at UART3_BAUD
+//      -- both switch to N --
+// MCU  LINK,PING,seq,<pattern>                 x UARTLINK_PROBES
+// ESP  LINK,PONG,seq,<pattern chars received>
+//
+// A missed or short PONG drops both sides back to
+// UART3_BAUD (the bridge on its own after 500ms of
+// silence) and the next lower rate is tried. No
+// reply to the first proposal = old bridge firmware,
+// the link stays at UART3_BAUD.
+// ============================================
+#ifndef UARTLINK_ENABLE
+#define UARTLINK_ENABLE       1
+#endif
+
+#define UARTLINK_RATES        6
+#define UARTLINK_PROBES       3
+#define UARTLINK_PATTERN_LEN  200       // Bytes per PING (throughput sample)
+#define UARTLINK_REPLY_MS     300
+#define UARTLINK_SETTLE_MS    20        // Bridge switch time after OK
+#define UARTLINK_REVERT_MS    600       // > bridge fallback timeout
+#define UARTLINK_WINDOW_MS    1000      // Throughput / error window
+#define UARTLINK_MAX_ERRORS   4         // Line errors per window before stepping down
+
+typedef struct {
+    uint32_t baud;
+    int32_t err_ppm;                    // Divisor error at this PCLK
+    uint8_t supported;                  // Within UART_MAX_ERR_PPM
+    uint16_t probes;                    // PINGs sent
+    uint16_t fails;                     // PINGs lost or damaged
+    uint32_t tx_Bps;                    // Measured PING send rate
+} UartLink_Rate_t;
+
+typedef struct {
+    uint32_t baud;                      // Current UART3 rate
+    uint32_t tx_Bps;                    // Last window
+    uint32_t rx_Bps;
+    uint32_t window_errors;
+    uint32_t step_downs;
+    UartLink_Rate_t rates[UARTLINK_RATES];
+} UartLink_Stats_t;
+
+extern UartLink_Stats_t uartlink_stats;
+
+// ============================================
+// Function Prototypes
+// ============================================
+void uartlink_init(void);
+void uartlink_service(uint32_t now);
+void uartlink_rx_line(char **tok, uint8_t n);
+void uartlink_report(void);
+
+#endif // UARTLINK_H
@@ -0,0 +1,234 @@
+/**
+ * ============================================
+ * RELIABLE UPLINK
+ * Frames for the cloud sink are stamped with a
+ * sequence number and copied into a byte ring;
+ * a slot table keeps each frame's offset/length
+ * by seq. Three counters describe the window:
+ *
+ *   tail_seq <= send_seq <= head_seq
+ *   [acked)   [in flight)  [queued)
+ *
+ * ACKs move tail_seq, the service loop moves
+ * send_seq, a full buffer evicts from the tail.
+ * ============================================
+ */
+
+#include "UPLINK.h"
+#include "uart.h"
+#include "DELAY.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SLOT(seq)   ((seq) & (UPLINK_MAX_FRAMES - 1))
+
+Uplink_Stats_t uplink_stats;
+
+static uint8_t up_buf[UPLINK_BUF_SIZE];
+static uint32_t up_buf_head = 0;                // Free running byte offset
+static uint32_t up_off[UPLINK_MAX_FRAMES];
+static uint16_t up_len[UPLINK_MAX_FRAMES];
+
+static uint32_t tail_seq = 1;                   // Oldest frame held
+static uint32_t send_seq = 1;                   // Next frame to put on the wire
+static uint32_t head_seq = 1;                   // Next seq to assign
+static uint32_t sent_max = 1;                   // One past the highest seq ever sent
+static uint32_t rto_start = 0;                  // Oldest in-flight frame's send time
+static uint8_t sync_pending = 0;                // Tell the bridge where the buffer starts
+static uint8_t dup_acks = 0;
+static uint32_t recover_seq = 0;                // No second fast resend before this is ACKed
+
+void uplink_init(void) {
+    memset(&uplink_stats, 0, sizeof(uplink_stats));
+    up_buf_head = 0;
+    tail_seq = send_seq = head_seq = sent_max = 1;
+    sync_pending = 0;
+    dup_acks = 0;
+    recover_seq = 0;
+    uplink_stats.rto_ms = UPLINK_RTO_MS;
+}
+
+static void evict_oldest(void) {
+    if(uplink_stats.reliable) {
+        uplink_stats.lost++;
+        sync_pending = 1;                       // Bridge must skip the gap
+    }
+    tail_seq++;
+    if(send_seq < tail_seq) send_seq = tail_seq;
+}
+
+static uint32_t buf_used(void) {
+    return (tail_seq == head_seq) ? 0 : up_buf_head - up_off[SLOT(tail_seq)];
+}
+
+// ============================================
+// Submit (from the cloud sink)
+// ============================================
+uint8_t uplink_submit(const char *frame, uint16_t len) {
+    char seq_txt[UPLINK_SEQ_MAX + 1];
+    const char *brace = memchr(frame, '{', len);
+    uint16_t pre, slen, total;
+    uint32_t seq = head_seq;
+
+    slen = brace ? sprintf(seq_txt, "\"seq\":%lu%s", (unsigned long)seq,
+                           (brace[1] == '}') ? "" : ",") : 0;
+    total = len + slen;
+    if(total > UPLINK_BUF_SIZE / 2) return 0;
+
+    // Make room: oldest frames go first, acked or not
+    while(head_seq - tail_seq >= UPLINK_MAX_FRAMES ||
+          buf_used() + total > UPLINK_BUF_SIZE) {
+        evict_oldest();
+    }
+
+    // TYPE,{  +  "seq":N,  +  rest of the frame
+    pre = brace ? (uint16_t)(brace - frame + 1) : len;
+    up_off[SLOT(seq)] = up_buf_head;
+    up_len[SLOT(seq)] = total;
+    for(uint16_t i = 0; i < total; i++) {
+        char c;
+
+        if(i < pre) c = frame[i];
+        else if(i < pre + slen) c = seq_txt[i - pre];
+        else c = frame[i - slen];
+        up_buf[(up_buf_head + i) % UPLINK_BUF_SIZE] = c;
+    }
+    up_buf_head += total;
+    head_seq++;
+    uplink_stats.frames++;
+
+    uplink_service(millis());
+    return 1;
+}
+
+// ============================================
+// ACK (cumulative, via the UART3 line reader)
+// ============================================
+void uplink_ack(uint32_t seq, uint32_t now) {
+    uplink_stats.reliable = 1;
+
+    // Repeated ACK of the frame before the tail: the bridge is
+    // getting frames past a hole, resend without waiting the RTO
+    if(seq + 1 == tail_seq && send_seq > tail_seq) {
+        if(++dup_acks >= UPLINK_DUP_ACKS && tail_seq > recover_seq) {
+            dup_acks = 0;
+            recover_seq = sent_max - 1;
+            send_seq = tail_seq;
+            rto_start = now;
+            uplink_stats.fast_retransmits++;
+        }
+        return;
+    }
+
+    if(seq < tail_seq || seq >= sent_max) {
+        return;                                 // Stale or from the future
+    }
+
+    dup_acks = 0;
+    uplink_stats.acked += seq + 1 - tail_seq;
+    uplink_stats.last_ack = seq;
+    tail_seq = seq + 1;
+    if(send_seq < tail_seq) send_seq = tail_seq;
+
+    // Link is answering: back to the base RTO and replay the backlog
+    uplink_stats.rto_ms = UPLINK_RTO_MS;
+    rto_start = now;
+}
+
+// ============================================
+// Service: fill the window, handle the RTO
+// ============================================
+static uint8_t send_frame(uint32_t seq) {
+    char tmp[64];
+    uint32_t off = up_off[SLOT(seq)];
+    uint16_t len = up_len[SLOT(seq)];
+
+    // Frame may wrap in the ring; go out in chunks
+    if(len > uart_tx_free(3)) return 0;
+
+    for(uint16_t i = 0; i < len; ) {
+        uint16_t n = 0;
+
+        while(n < sizeof(tmp) && i < len) {
+            tmp[n++] = up_buf[(off + i++) % UPLINK_BUF_SIZE];
+        }
+        uart_tx_write(3, tmp, n);
+    }
+    return 1;
+}
+
+void uplink_service(uint32_t now) {
+    // Nothing from the bridge yet: plain fire-and-forget
+    if(!uplink_stats.reliable) {
+        while(send_seq < head_seq && send_frame(send_seq)) {
+            send_seq++;
+            uplink_stats.sent++;
+        }
+        sent_max = send_seq;
+        tail_seq = send_seq;
+        uplink_stats.backlog = head_seq - tail_seq;
+        return;
+    }
+
+    // Oldest in-flight frame timed out: go back to it
+    if(send_seq > tail_seq && (now - rto_start) >= uplink_stats.rto_ms) {
+        uplink_stats.timeouts++;
+        send_seq = tail_seq;
+        sync_pending = 1;
+        if(uplink_stats.rto_ms < UPLINK_RTO_MAX_MS) {
+            uplink_stats.rto_ms *= 2;
+        }
+    }
+
+    if(sync_pending && tail_seq < head_seq) {
+        char sync[24];
+        uint16_t n = sprintf(sync, "SYNC,%lu\r\n", (unsigned long)tail_seq);
+
+        if(uart_tx_write(3, sync, n)) {
+            sync_pending = 0;
+
+            // After an eviction the window is past the tail; a bridge that
+            // restarted and missed the SYNC would take the next frame as its
+            // base, so the tail goes out once behind it
+            if(send_seq > tail_seq && send_frame(tail_seq)) {
+                uplink_stats.retransmits++;
+            }
+        }
+    }
+
+    while(send_seq < head_seq && send_seq - tail_seq < UPLINK_WINDOW) {
+        if(!send_frame(send_seq)) break;
+
+        if(send_seq == tail_seq) rto_start = now;
+        if(send_seq < sent_max) {
+            uplink_stats.retransmits++;
+        } else {
+            uplink_stats.sent++;
+            sent_max = send_seq + 1;
+        }
+        send_seq++;
+    }
+
+    uplink_stats.backlog = head_seq - tail_seq;
+}
+
+// ============================================
+// UPLINK_STATUS frame
+// ============================================
+void uplink_report(void) {
+    char buf[320];
+
+    sprintf(buf,
+        "STATUS,{\"type\":\"UPLINK_STATUS\",\"reliable\":%u,"
+        "\"frames\":%lu,\"sent\":%lu,\"retransmits\":%lu,\"acked\":%lu,"
+        "\"lost\":%lu,\"timeouts\":%lu,\"fast_retx\":%lu,\"last_ack\":%lu,"
+        "\"backlog\":%u,\"rto_ms\":%u}\r\n",
+        uplink_stats.reliable,
+        (unsigned long)uplink_stats.frames, (unsigned long)uplink_stats.sent,
+        (unsigned long)uplink_stats.retransmits, (unsigned long)uplink_stats.acked,
+        (unsigned long)uplink_stats.lost, (unsigned long)uplink_stats.timeouts,
+        (unsigned long)uplink_stats.fast_retransmits,
+        (unsigned long)uplink_stats.last_ack,
+        uplink_stats.backlog, uplink_stats.rto_ms);
+    uart_dual_send_string(buf);
+}
@@ -0,0 +1,71 @@
+/**
+ * ============================================
+ * RELIABLE UPLINK HEADER
+ * Sequenced frames, retransmit buffer and
+ * cumulative ACKs on the UART3 cloud link
+ * ============================================
+ */
+
+#ifndef UPLINK_H
+#define UPLINK_H
+
+#include <stdint.h>
+
+// ============================================
+// Protocol
+// MCU  TYPE,{"seq":N,...}       every cloud frame
+// MCU  SYNC,N                   oldest seq still held; the
+//                               bridge skips any gap below it
+// ESP  ACK,N                    all frames <= N delivered;
+//                               repeated on every frame past
+//                               a hole (fast resend)
+//
+// Up to UPLINK_WINDOW frames are in flight. If the
+// oldest is not ACKed within the RTO, sending goes
+// back to it (go-back-N, SYNC first) and the RTO
+// doubles up to UPLINK_RTO_MAX_MS, so a dead link
+// is polled, not flooded. The first ACK after that
+// replays the backlog. The bridge drops seq <= its
+// last ACK and re-ACKs; after a restart it takes
+// the first seq it sees as its base. Until a bridge
+// has ACKed once, frames are sent once and not kept
+// (old bridge firmware keeps working).
+// ============================================
+#ifndef UPLINK_ENABLE
+#define UPLINK_ENABLE       1
+#endif
+
+#define UPLINK_BUF_SIZE     4096        // Retransmit buffer (bytes)
+#define UPLINK_MAX_FRAMES   64          // Frames held (power of 2)
+#define UPLINK_WINDOW       8           // Frames in flight
+#define UPLINK_RTO_MS       500
+#define UPLINK_RTO_MAX_MS   8000
+#define UPLINK_DUP_ACKS     2           // Repeated ACKs that trigger a resend
+#define UPLINK_SEQ_MAX      17          // "\"seq\":4294967295,"
+
+typedef struct {
+    uint32_t frames;                    // Frames sequenced
+    uint32_t sent;                      // First transmissions
+    uint32_t retransmits;
+    uint32_t acked;
+    uint32_t lost;                      // Evicted before an ACK (buffer full)
+    uint32_t timeouts;
+    uint32_t fast_retransmits;          // Resends on repeated ACKs
+    uint32_t last_ack;
+    uint16_t backlog;                   // Frames held (unacked + unsent)
+    uint16_t rto_ms;
+    uint8_t reliable;                   // Bridge has ACKed at least once
+} Uplink_Stats_t;
+
+extern Uplink_Stats_t uplink_stats;
+
+// ============================================
+// Function Prototypes
+// ============================================
+void uplink_init(void);
+uint8_t uplink_submit(const char *frame, uint16_t len);
+void uplink_ack(uint32_t seq, uint32_t now);
+void uplink_service(uint32_t now);
+void uplink_report(void);
+
+#endif // UPLINK_H
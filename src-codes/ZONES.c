@@ -0,0 +1,152 @@
+/**
+ * ============================================
+ * ZONE GRAPH
+ * Nested venue model: zones connected by reader
+ * doors. A card carries one zone byte; a scan
+ * resolves to a move with one door lookup and
+ * one compare, the graph check is one bit test
+ * and the move itself is a decrement and an
+ * increment, so a scan is O(1) for any venue.
+ * ============================================
+ */
+
+#include "ZONES.h"
+#include "uart.h"
+#include <stdio.h>
+#include <string.h>
+
+Zone_t zones[ZONE_MAX];
+Zones_Stats_t zones_stats;
+
+static ZoneDoor_t zone_doors[ZONE_READER_MAX];
+static uint32_t zone_adj[ZONE_MAX][2];          // 64-bit neighbour set per zone
+
+static void adj_set(uint8_t a, uint8_t b) {
+    zone_adj[a][b >> 5] |= (1UL << (b & 31));
+}
+
+void zones_init(void) {
+    memset(zones, 0, sizeof(zones));
+    memset(zone_doors, 0, sizeof(zone_doors));
+    memset(zone_adj, 0, sizeof(zone_adj));
+    memset(&zones_stats, 0, sizeof(zones_stats));
+
+    strcpy(zones[ZONE_OUTSIDE].name, "OUTSIDE");
+    zones[ZONE_OUTSIDE].defined = 1;
+}
+
+uint8_t zones_define(uint8_t zone, const char *name, uint16_t capacity) {
+    if(zone == ZONE_OUTSIDE || zone >= ZONE_MAX) return 0;
+
+    strncpy(zones[zone].name, name, ZONE_NAME_LEN - 1);
+    zones[zone].name[ZONE_NAME_LEN - 1] = '\0';
+    zones[zone].capacity = capacity;
+    zones[zone].defined = 1;
+    return 1;
+}
+
+uint8_t zones_add_door(uint8_t reader, uint8_t from, uint8_t to) {
+    if(reader >= ZONE_READER_MAX || from >= ZONE_MAX || to >= ZONE_MAX ||
+       from == to || !zones[from].defined || !zones[to].defined) {
+        return 0;
+    }
+
+    zone_doors[reader].from = from;
+    zone_doors[reader].to = to;
+    zone_doors[reader].defined = 1;
+    adj_set(from, to);
+    adj_set(to, from);
+    return 1;
+}
+
+uint8_t zones_adjacent(uint8_t a, uint8_t b) {
+    if(a >= ZONE_MAX || b >= ZONE_MAX) return 0;
+    return (zone_adj[a][b >> 5] >> (b & 31)) & 1;
+}
+
+// ============================================
+// Scan Routing
+// ============================================
+ZoneMove_t zones_route(uint8_t reader, uint8_t zone, uint8_t *to) {
+    const ZoneDoor_t *d;
+
+    if(reader < ZONE_READER_MAX && zone_doors[reader].defined) {
+        d = &zone_doors[reader];
+
+        if(zone == d->from) {
+            *to = d->to;
+            return ZONE_MOVE_IN;
+        }
+        if(zone == d->to) {
+            *to = d->from;
+            return ZONE_MOVE_OUT;
+        }
+    }
+
+    // Card was last seen behind another door (missed read / tailgate)
+    zones_stats.invalid++;
+    return ZONE_MOVE_INVALID;
+}
+
+uint8_t zones_has_room(uint8_t zone) {
+    const Zone_t *z = &zones[zone];
+
+    if(zone == ZONE_OUTSIDE || z->capacity == ZONE_NO_LIMIT || z->count < z->capacity) {
+        return 1;
+    }
+    zones_stats.full++;
+    return 0;
+}
+
+// Counts follow the card; rejects moves the graph has no door for
+uint8_t zones_move(uint8_t from, uint8_t to) {
+    if(!zones_adjacent(from, to)) {
+        zones_stats.invalid++;
+        return 0;
+    }
+
+    if(from != ZONE_OUTSIDE && zones[from].count) zones[from].count--;
+    if(to != ZONE_OUTSIDE) zones[to].count++;
+    zones_stats.moves++;
+    return 1;
+}
+
+void zones_clear_counts(void) {
+    for(uint8_t i = 0; i < ZONE_MAX; i++) {
+        zones[i].count = 0;
+    }
+}
+
+const char* zones_name(uint8_t zone) {
+    return (zone < ZONE_MAX && zones[zone].defined) ? zones[zone].name : "?";
+}
+
+// ============================================
+// ZONE_STATUS Frames (ZONE_REPORT_CHUNK zones each)
+// ============================================
+// Longest entry: ,{"id":63,"name":"<11 chars>","n":65535,"cap":65535}
+#define ZONE_JSON_MAX   (44 + ZONE_NAME_LEN)
+
+void zones_report(void) {
+    char buf[ZONE_REPORT_CHUNK * ZONE_JSON_MAX + 64];
+    uint8_t n = 0;
+    int len = 0;
+
+    for(uint8_t i = 1; i <= ZONE_MAX; i++) {
+        if(i < ZONE_MAX && zones[i].defined) {
+            if(n == 0) {
+                len = sprintf(buf, "STATUS,{\"type\":\"ZONE_STATUS\",\"zones\":[");
+            }
+            len += sprintf(buf + len,
+                "%s{\"id\":%u,\"name\":\"%s\",\"n\":%u,\"cap\":%u}",
+                n ? "," : "", i, zones[i].name, zones[i].count, zones[i].capacity);
+            n++;
+        }
+
+        if(n && (n == ZONE_REPORT_CHUNK || i == ZONE_MAX)) {
+            sprintf(buf + len, "]}\r\n");
+            uart_dual_send_string(buf);
+            n = 0;
+        }
+    }
+}
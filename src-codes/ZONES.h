@@ -0,0 +1,70 @@
+/**
+ * ============================================
+ * ZONE GRAPH HEADER
+ * Venue zones, reader doors, per-zone counts
+ * ============================================
+ */
+
+#ifndef ZONES_H
+#define ZONES_H
+
+#include <stdint.h>
+
+// ============================================
+// Limits
+// Zone 0 is the street (no count, no capacity).
+// Each reader sits on one door between an outer
+// (from) and an inner (to) zone; a card on the
+// from side moves in, on the to side moves out.
+// ============================================
+#define ZONE_MAX            64          // Fits the adjacency bitmap
+#define ZONE_OUTSIDE        0
+#define ZONE_READER_MAX     64
+#define ZONE_NAME_LEN       12
+#define ZONE_NO_LIMIT       0           // capacity 0 = unbounded
+
+#define ZONE_REPORT_CHUNK   16          // Zones per ZONE_STATUS frame
+
+typedef enum {
+    ZONE_MOVE_IN = 0,                   // from -> to
+    ZONE_MOVE_OUT,                      // to -> from
+    ZONE_MOVE_INVALID                   // Card is on neither side of this door
+} ZoneMove_t;
+
+typedef struct {
+    char name[ZONE_NAME_LEN];
+    uint16_t count;
+    uint16_t capacity;
+    uint8_t defined;
+} Zone_t;
+
+typedef struct {
+    uint8_t from;
+    uint8_t to;
+    uint8_t defined;
+} ZoneDoor_t;
+
+typedef struct {
+    uint32_t moves;
+    uint32_t invalid;                   // Scans rejected by the graph
+    uint32_t full;                      // Moves refused by a zone capacity
+} Zones_Stats_t;
+
+extern Zone_t zones[ZONE_MAX];
+extern Zones_Stats_t zones_stats;
+
+// ============================================
+// Function Prototypes
+// ============================================
+void zones_init(void);
+uint8_t zones_define(uint8_t zone, const char *name, uint16_t capacity);
+uint8_t zones_add_door(uint8_t reader, uint8_t from, uint8_t to);
+uint8_t zones_adjacent(uint8_t a, uint8_t b);
+ZoneMove_t zones_route(uint8_t reader, uint8_t zone, uint8_t *to);
+uint8_t zones_has_room(uint8_t zone);
+uint8_t zones_move(uint8_t from, uint8_t to);
+void zones_clear_counts(void);
+const char* zones_name(uint8_t zone);
+void zones_report(void);
+
+#endif // ZONES_H
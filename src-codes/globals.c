@@ -6,6 +6,6 @@
 
 #include "globals.h"
 
-// Define temperature and humidity here
-float temperature = 0.0f;
-float humidity = 0.0f;
+// Define temperature and humidity here (tenths: 235 = 23.5)
+int16_t temperature_x10 = 0;
+int16_t humidity_x10 = 0;
@@ -7,8 +7,17 @@
 #ifndef GLOBALS_H
 #define GLOBALS_H
 
-// Declare temperature and humidity
-extern float temperature;
-extern float humidity;
+#include <stdint.h>
+
+// Declare temperature and humidity (tenths of a degree C / %RH;
+// no float on the Cortex-M3, it has no FPU)
+extern int16_t temperature_x10;
+extern int16_t humidity_x10;
+
+// Tenths as text without soft-float printf: X10_FMT takes the
+// three X10_ARGS (sign, whole, tenth), e.g. -5 -> "-0.5"
+#define X10_ABS(v)   ((v) < 0 ? -(int)(v) : (int)(v))
+#define X10_FMT      "%s%d.%d"
+#define X10_ARGS(v)  ((v) < 0 ? "-" : ""), X10_ABS(v) / 10, X10_ABS(v) % 10
 
 #endif // GLOBALS_H
@@ -18,7 +18,26 @@
 #include "LCD.h"
 #include "DHT11.h"
 #include "MQ135.h"
+#include "ADC_BURST.h"
 #include "globals.h"
+#include "TELEMETRY.h"
+#include "SERVO.h"
+#include "FEEDBACK.h"
+#include "CARDDB.h"
+#include "PROFILE.h"
+#include "SCANCACHE.h"
+#include "DENYLIMIT.h"
+#include "FLOWRATE.h"
+#include "ZONES.h"
+#include "ACCESS.h"
+#include "UARTLINK.h"
+#include "SINK.h"
+#include "UPLINK.h"
+#include "SPITRACE.h"
+#include "EVENTBUS.h"
+#include "TASKS.h"
+#include "POWER.h"
+#include "CREDENTIAL.h"
 #include "UART3.h"
 
 
@@ -26,116 +45,244 @@
 // PIN DEFINITIONS
 // ============================================
 #define RC522_RST_PIN (1<<1)
-#define BUZZER_PIN (1<<27)
-#define SERVO_PIN (1<<5)
-#define EMERGENCY_BUTTON (1<<11)
+#define EMERGENCY_BUTTON (1<<11)        // P2.11 = EINT1
 #define DHT11_PIN (1<<7)
-
-// LED Pins P1.19 to P1.25 (7 LEDs)
-#define LED1_PIN (1<<19)
-#define LED2_PIN (1<<20)
-#define LED3_PIN (1<<21)
-#define LED4_PIN (1<<22)
-#define LED5_PIN (1<<23)
-#define LED6_PIN (1<<24)
-#define LED7_PIN (1<<25)
-#define LED_ALL_PINS (0x7F<<19)
+// Buzzer / LED pins: FEEDBACK.h, servo (PWM1.1 on P2.0): SERVO.h
 
 // ============================================
 // SYSTEM CONFIGURATION
 // ============================================
 #define MAX_ROOM_CAPACITY 9
 #define GATE_OPEN_TIME 3
-#define MAX_CARDS 10
-#define SENSOR_READ_INTERVAL 600  // Every 60 seconds (600 * 100ms)
 #define LCD_UPDATE_INTERVAL 30
+#define SYSTEM_TICK_MS 100              // system_tick unit (gate, caches, denials)
+#define EMERGENCY_IRQ_PRIORITY 0        // Above every other handler
+#define EMERGENCY_LOCKOUT_MS 200        // Contact bounce after a press
+
+// Card record / store: CARDDB.h
 
 // ============================================
-// CARD STRUCTURE
+// VENUE ZONES (ZONES.h)
+// This board has one RC522 on the main door
+// (reader 0). Further doors add a zone and a
+// reader row below; the room total and the
+// capacity checks follow the graph.
 // ============================================
+#define READER_MAIN 0
+#define ZONE_ROOM   1
+
 typedef struct {
-    uint8_t uid[4];
-    char card_name[16];
-    char group_name[16];
-    uint16_t scan_count;
-    uint8_t is_active;
-    uint8_t is_inside;
-    uint32_t last_scan_time;
-} Card_t;
+    uint8_t zone;
+    const char *name;
+    uint16_t capacity;
+} ZoneSeed_t;
+
+typedef struct {
+    uint8_t reader;
+    uint8_t from;
+    uint8_t to;
+} DoorSeed_t;
+
+static const ZoneSeed_t zone_seed[] = {
+    {ZONE_ROOM, "ROOM", MAX_ROOM_CAPACITY}
+};
+
+static const DoorSeed_t door_seed[] = {
+    {READER_MAIN, ZONE_OUTSIDE, ZONE_ROOM}
+};
 
 typedef struct {
-    int16_t total_people_inside;
     uint8_t gate_open;
     uint8_t gate_busy;
-    float temperature;
-    float humidity;
+    int16_t temperature_x10;            // 0.1 C
+    int16_t humidity_x10;               // 0.1 %RH
     uint16_t air_quality;
     uint32_t system_uptime;
-    uint16_t total_entries;
-    uint16_t total_exits;
 } SystemState_t;
 
 // ============================================
-// ALL 10 CARDS
+// DEFAULT CARDS (loaded into the card store at
+// boot; the ESP32 adds/revokes over UART3)
 // ============================================
-Card_t cards[MAX_CARDS] = {
-    {{0xF3, 0x52, 0x22, 0x2A}, "A0", "FOUR MEM GRP", 0, 1, 0, 0},
-    {{0x83, 0x00, 0x05, 0xED}, "A1", "FOUR MEM GRP", 0, 1, 0, 0},
-    {{0x33, 0x84, 0xD0, 0xEC}, "A2", "FOUR MEM GRP", 0, 1, 0, 0},
-    {{0xD3, 0xF8, 0x5D, 0xEC}, "A3", "FOUR MEM GRP", 0, 1, 0, 0},
+typedef struct {
+    uint8_t uid[4];
+    const char *card_name;
+    const char *group_name;
+} CardSeed_t;
+
+static const CardSeed_t card_seed[] = {
+    {{0xF3, 0x52, 0x22, 0x2A}, "A0", "FOUR MEM GRP"},
+    {{0x83, 0x00, 0x05, 0xED}, "A1", "FOUR MEM GRP"},
+    {{0x33, 0x84, 0xD0, 0xEC}, "A2", "FOUR MEM GRP"},
+    {{0xD3, 0xF8, 0x5D, 0xEC}, "A3", "FOUR MEM GRP"},
 
-    {{0x35, 0x64, 0x94, 0x5F}, "B0", "THREE MEM GRP", 0, 1, 0, 0},
-    {{0x03, 0x22, 0x3C, 0xED}, "B1", "THREE MEM GRP", 0, 1, 0, 0},
-    {{0x1A, 0x88, 0x36, 0x02}, "B2", "THREE MEM GRP", 0, 1, 0, 0},
+    {{0x35, 0x64, 0x94, 0x5F}, "B0", "THREE MEM GRP"},
+    {{0x03, 0x22, 0x3C, 0xED}, "B1", "THREE MEM GRP"},
+    {{0x1A, 0x88, 0x36, 0x02}, "B2", "THREE MEM GRP"},
 
-    {{0xD4, 0xC8, 0x7D, 0x05}, "C0", "TWO MEM GRP", 0, 1, 0, 0},
-    {{0x3B, 0x3D, 0x7D, 0x05}, "C1", "TWO MEM GRP", 0, 1, 0, 0},
+    {{0xD4, 0xC8, 0x7D, 0x05}, "C0", "TWO MEM GRP"},
+    {{0x3B, 0x3D, 0x7D, 0x05}, "C1", "TWO MEM GRP"},
 
-    {{0xA5, 0xD7, 0x91, 0x5F}, "D0", "ONE MEM GRP", 0, 1, 0, 0}
+    {{0xA5, 0xD7, 0x91, 0x5F}, "D0", "ONE MEM GRP"}
 };
 
+#define CARD_SEED_COUNT (sizeof(card_seed) / sizeof(card_seed[0]))
+
 // ============================================
 // SYSTEM STATE
 // ============================================
-SystemState_t system_state = {0, 0, 0, 0.0f, 0.0f, 0, 0, 0, 0};
-char uart_buf[512];
+SystemState_t system_state = {0, 0, 0, 0, 0, 0};
+char uart_buf[768];                     // STATUS frame worst case ~650 bytes
 char temp_str[8] = "---";
 char hum_str[8] = "---";
 char air_str[8] = "---";
 volatile uint32_t system_tick = 0;
 
+typedef enum {
+    GATE_IDLE = 0,
+    GATE_OPENING,
+    GATE_HOLD,
+    GATE_CLOSING
+} GateState_t;
+
+GateState_t gate_state = GATE_IDLE;
+uint32_t gate_deadline = 0;
+uint16_t gate_hold_ticks = 0;
+uint8_t gate_emergency = 0;
+uint8_t scroll_timer = 0;               // Reset by anything that puts a message up
+
+// Scan sequence (task_rfid): each state is one screen
+typedef enum {
+    SCAN_POLL = 0,                      // Waiting for a card
+    SCAN_CHECKING,                      // "Checking..." up, route next
+    SCAN_DECIDE,                        // Card info up, entry/exit next
+    SCAN_RESULT,                        // WELCOME / THANK YOU up, gate next
+    SCAN_COOLDOWN
+} ScanState_t;
+
+// Sensor sample (task_sensors): ADC warm-up, the DHT11 start
+// pulse and its 40 bits (edge interrupt) run while the task sleeps
+typedef enum {
+    SENS_IDLE = 0,                      // ADC off until the next sample
+    SENS_ADC_WARMUP,                    // Burst running, DHT11 start next
+    SENS_DHT_START,                     // Start pulse low, release next
+    SENS_DHT_READ                       // Sensor answering, decode next
+} SensState_t;
+
+SensState_t sens_state = SENS_IDLE;
+
+ScanState_t scan_state = SCAN_POLL;
+uint8_t scan_uid[5];
+int16_t scan_card_idx = -1;
+ZoneMove_t scan_move;
+uint8_t scan_to_zone;
+#if CREDENTIAL_ENABLE
+Credential_t scan_cred;                 // Credential read on this scan
+Credential_Result_t scan_cred_result;
+#endif
+
+// ============================================
+// EMERGENCY (EINT1)
+// The ISR commands the gate and sets
+// emergency_pending; the rest runs from the
+// EV_BUTTON_EDGE handler. Times are TIMER1 us.
+// ============================================
+typedef struct {
+    uint32_t presses;
+    uint32_t bounces;                   // Edges inside the lockout
+    uint32_t glitches;                  // Pin already low again in the ISR
+    uint32_t gate_us;                   // ISR entry -> servo command
+    uint32_t gate_us_max;
+    uint32_t alert_us;                  // ISR entry -> ALERT queued
+    uint32_t alert_us_max;
+} Emergency_Stats_t;
+
+volatile uint8_t emergency_pending = 0;
+volatile Emergency_Stats_t emergency_stats;
+volatile uint32_t emergency_last_ms = 0;
+
+typedef enum {
+    BOOT_ANNOUNCE = 0,
+    BOOT_LED_BUZZER,
+    BOOT_LCD,
+    BOOT_SERVO_OPEN,
+    BOOT_SERVO_CLOSE,
+    BOOT_DHT11,
+    BOOT_DHT11_RELEASE,
+    BOOT_DHT11_READ,
+    BOOT_CARDS,
+    BOOT_DONE
+} BootStep_t;
+
+BootStep_t boot_step = BOOT_ANNOUNCE;
+uint32_t boot_deadline = 0;             // millis()
+uint32_t boot_ready_ms = 0;             // Reset -> first RC522 poll
+uint32_t boot_dht_start = 0;
+uint8_t boot_dht_attempt = 0;
+uint8_t boot_dht_ok = 0;
+uint8_t boot_rc522_version = 0;
+#if FLASHIDX_ENABLE
+uint8_t boot_flash_ok = 0;
+#endif
+uint16_t boot_card_next = 0;
+
 // ============================================
 // JSON HELPER FUNCTIONS
 // ============================================
 void send_json_system_status(void) {
+    PROF_BEGIN(PROF_JSON_FORMAT);
     sprintf(uart_buf,
         "STATUS,{\"type\":\"SYSTEM_STATUS\","
         "\"inside\":%d,\"capacity\":%d,"
         "\"entries\":%d,\"exits\":%d,"
-        "\"temp\":%.1f,\"hum\":%.1f,"
+        "\"temp\":" X10_FMT ",\"hum\":" X10_FMT ","
         "\"air\":%d,\"air_status\":\"%s\","
-        "\"uptime\":%lu}\r\n",
-        system_state.total_people_inside, MAX_ROOM_CAPACITY,
-        system_state.total_entries, system_state.total_exits,
-        system_state.temperature, system_state.humidity,
+        "\"uptime\":%lu,"
+        "\"env_sent\":%lu,\"env_suppressed\":%lu,"
+        "\"lcd_ovf\":%lu,\"lcd_max_lat_us\":%lu,"
+        "\"db_version\":%lu,\"db_cards\":%u,"
+        "\"scan_repeat\":%lu,\"scan_passback\":%lu,"
+        "\"bloom_rejects\":%lu,\"deny_suppressed\":%lu,"
+        "\"in_ph\":%u,\"out_ph\":%u,\"net_ph\":[%d,%d,%d],"
+        "\"ttf_s\":[%ld,%ld,%ld],\"forecast\":%u}\r\n",
+        access_counts.inside, MAX_ROOM_CAPACITY,
+        access_counts.entries, access_counts.exits,
+        X10_ARGS(system_state.temperature_x10), X10_ARGS(system_state.humidity_x10),
         system_state.air_quality, MQ135_GetStatusString(),
-        system_state.system_uptime);
+        (unsigned long)system_state.system_uptime,
+        (unsigned long)telemetry_stats.sent, (unsigned long)telemetry_stats.suppressed,
+        (unsigned long)lcd_async_stats.overflows,
+        (unsigned long)lcd_async_stats.max_latency_us,
+        (unsigned long)carddb_version(), carddb_count(),
+        (unsigned long)scancache_stats.repeats, (unsigned long)scancache_stats.passbacks,
+        (unsigned long)carddb_stats.bloom_rejects, (unsigned long)denylimit_stats.suppressed,
+        flowrate_per_hour(FLOW_ENTRY, 1), flowrate_per_hour(FLOW_EXIT, 1),
+        flowrate_net_per_hour(0), flowrate_net_per_hour(1), flowrate_net_per_hour(2),
+        (long)flowrate_ttf_s(0, access_counts.inside, MAX_ROOM_CAPACITY),
+        (long)flowrate_ttf_s(1, access_counts.inside, MAX_ROOM_CAPACITY),
+        (long)flowrate_ttf_s(2, access_counts.inside, MAX_ROOM_CAPACITY),
+        flowrate_stats.level);
+    PROF_END(PROF_JSON_FORMAT);
     uart_dual_send_string(uart_buf);
 }
 
 void send_json_rfid_scan(Card_t *card, const char *action, uint8_t success) {
+    PROF_BEGIN(PROF_JSON_FORMAT);
     sprintf(uart_buf,
         "RFID,{\"type\":\"CARD_SCAN\","
         "\"card\":\"%s\",\"group\":\"%s\","
         "\"uid\":\"%02X:%02X:%02X:%02X\","
         "\"action\":\"%s\",\"success\":%d,"
         "\"inside\":%d,\"capacity\":%d,"
+        "\"zone\":\"%s\",\"zone_n\":%u,"
         "\"scan_count\":%d}\r\n",
-        card->card_name, card->group_name,
+        card->card_name, card_group_name(card),
         card->uid[0], card->uid[1], card->uid[2], card->uid[3],
         action, success,
-        system_state.total_people_inside, MAX_ROOM_CAPACITY,
+        access_counts.inside, MAX_ROOM_CAPACITY,
+        zones_name(card->zone), zones[card->zone].count,
         card->scan_count);
+    PROF_END(PROF_JSON_FORMAT);
     uart_dual_send_string(uart_buf);
 }
 
@@ -153,7 +300,7 @@ void send_json_gate_event(const char *event) {
         "GATE,{\"type\":\"GATE_EVENT\","
         "\"event\":\"%s\","
         "\"inside\":%d}\r\n",
-        event, system_state.total_people_inside);
+        event, access_counts.inside);
     uart_dual_send_string(uart_buf);
 }
 
@@ -161,25 +308,29 @@ void send_json_emergency(void) {
     sprintf(uart_buf,
         "ALERT,{\"type\":\"EMERGENCY\","
         "\"inside\":%d,"
-        "\"temp\":%.1f,\"hum\":%.1f,"
+        "\"temp\":" X10_FMT ",\"hum\":" X10_FMT ","
         "\"air\":%d}\r\n",
-        system_state.total_people_inside,
-        system_state.temperature, system_state.humidity,
+        access_counts.inside,
+        X10_ARGS(system_state.temperature_x10), X10_ARGS(system_state.humidity_x10),
         system_state.air_quality);
     uart_dual_send_string(uart_buf);
 }
 
-void send_json_sensor_data(void) {
+void send_json_sensor_data(const char *reason) {
+    PROF_BEGIN(PROF_JSON_FORMAT);
     sprintf(uart_buf,
         "ENV,{\"type\":\"SENSOR_DATA\","
-        "\"temp\":%.1f,\"hum\":%.1f,"
-        "\"air\":%d,\"air_status\":\"%s\","
+        "\"reason\":\"%s\","
+        "\"temp\":" X10_FMT ",\"hum\":" X10_FMT ","
+        "\"air\":%d,\"air_raw\":%u,\"air_status\":\"%s\","
         "\"inside\":%d,"
         "\"temp_str\":\"%s\",\"hum_str\":\"%s\",\"air_str\":\"%s\"}\r\n",
-        system_state.temperature, system_state.humidity,
-        system_state.air_quality, MQ135_GetStatusString(),
-        system_state.total_people_inside,
+        reason,
+        X10_ARGS(system_state.temperature_x10), X10_ARGS(system_state.humidity_x10),
+        system_state.air_quality, mq135_raw_value, MQ135_GetStatusString(),
+        access_counts.inside,
         temp_str, hum_str, air_str);
+    PROF_END(PROF_JSON_FORMAT);
     uart_dual_send_string(uart_buf);
 }
 
@@ -213,63 +364,42 @@ void lcd_display_centered(uint8_t row, const char *text) {
     }
     line[16] = '\0';
 
-    lcd_goto(row, 0);
-    lcd_string(line);
+    // Draw only; the caller flushes the whole screen once
+    lcd_fb_line(row, line);
 }
 
 // ============================================
 // LED FUNCTIONS
+// Patterns play from the TIMER2 sequencer (FEEDBACK.c)
+// and return immediately
 // ============================================
 void led_init(void) {
-    LPC_GPIO1->FIODIR |= LED_ALL_PINS;
-    LPC_GPIO1->FIOCLR = LED_ALL_PINS;
+    feedback_init();
 }
 
 void led_all_on(void) {
-    LPC_GPIO1->FIOSET = LED_ALL_PINS;
+    feedback_led_base(LED_MASK_ALL);
 }
 
 void led_all_off(void) {
-    LPC_GPIO1->FIOCLR = LED_ALL_PINS;
-}
-
-void led_set(uint8_t led_num, uint8_t state) {
-    if(led_num < 1 || led_num > 7) return;
-    uint32_t pin = (1 << (18 + led_num));
-    if(state) {
-        LPC_GPIO1->FIOSET = pin;
-    } else {
-        LPC_GPIO1->FIOCLR = pin;
-    }
+    feedback_led_base(0);
 }
 
 void led_bargraph(uint8_t count) {
-    led_all_off();
-    for(uint8_t i = 1; i <= count && i <= 7; i++) {
-        led_set(i, 1);
-    }
+    if(count > 7) count = 7;
+    feedback_led_base((uint8_t)((1 << count) - 1));
 }
 
 void led_running_pattern(void) {
-    for(uint8_t i = 1; i <= 7; i++) {
-        led_all_off();
-        led_set(i, 1);
-        delay_ms(80);
-    }
-    led_all_off();
+    feedback_leds(&FB_LED_RUNNING, 1);
 }
 
 void led_blink_all(uint8_t times) {
-    for(uint8_t i = 0; i < times; i++) {
-        led_all_on();
-        delay_ms(150);
-        led_all_off();
-        delay_ms(150);
-    }
+    feedback_leds(&FB_LED_BLINK, times);
 }
 
 void led_show_occupancy(void) {
-    uint8_t led_count = (system_state.total_people_inside * 7) / MAX_ROOM_CAPACITY;
+    uint8_t led_count = (access_counts.inside * 7) / MAX_ROOM_CAPACITY;
     if(led_count > 7) led_count = 7;
     led_bargraph(led_count);
 }
@@ -277,50 +407,38 @@ void led_show_occupancy(void) {
 // ============================================
 // BUZZER
 // ============================================
-void buzzer_init(void) {
-    LPC_GPIO1->FIODIR |= BUZZER_PIN;
-    LPC_GPIO1->FIOCLR = BUZZER_PIN;
-}
-
 void buzzer_beep(uint16_t duration_ms) {
-    LPC_GPIO1->FIOSET = BUZZER_PIN;
-    delay_ms(duration_ms);
-    LPC_GPIO1->FIOCLR = BUZZER_PIN;
+    feedback_beep(duration_ms);
 }
 
-void buzzer_card_detected(void) { buzzer_beep(100); }
-void buzzer_gate_opening(void) { buzzer_beep(100); delay_ms(100); buzzer_beep(100); }
-void buzzer_gate_closing(void) { buzzer_beep(100); }
-void buzzer_error(void) { for(uint8_t i=0; i<3; i++) { buzzer_beep(500); delay_ms(200); } }
-void buzzer_emergency(void) { buzzer_beep(800); }
-void buzzer_success(void) { buzzer_beep(150); delay_ms(100); buzzer_beep(150); }
+void buzzer_card_detected(void) { feedback_buzzer(&FB_BUZZ_CARD); }
+void buzzer_gate_opening(void) { feedback_buzzer(&FB_BUZZ_GATE_OPEN); }
+void buzzer_gate_closing(void) { feedback_buzzer(&FB_BUZZ_GATE_CLOSE); }
+void buzzer_error(void) { feedback_buzzer(&FB_BUZZ_ERROR); }
+void buzzer_emergency(void) { feedback_buzzer(&FB_BUZZ_EMERGENCY); }
+void buzzer_success(void) { feedback_buzzer(&FB_BUZZ_SUCCESS); }
 
 // ============================================
 // SERVO
+// Hardware PWM; open/close only start the
+// movement (see SERVO.c)
 // ============================================
 void servo_init(void) {
-    LPC_GPIO0->FIODIR |= SERVO_PIN;
-    LPC_GPIO0->FIOCLR = SERVO_PIN;
-}
-
-void servo_pulse(uint16_t pulse_us) {
-    LPC_GPIO0->FIOSET = SERVO_PIN;
-    delay_us(pulse_us);
-    LPC_GPIO0->FIOCLR = SERVO_PIN;
-    delay_ms(20 - (pulse_us / 1000));
+    servo_pwm_init(SERVO_CLOSED_US);
 }
 
 void servo_open(void) {
     // uart_dual_send_string("[SERVO] Opening gate...\r\n");
     send_json_gate_event("OPENING");
-    for(uint8_t i = 0; i < 50; i++) servo_pulse(1500);
+    PROF_SPAN_END(PROF_SCAN_GATE);
+    servo_pwm_move(SERVO_OPEN_US);
     system_state.gate_open = 1;
 }
 
 void servo_close(void) {
     // uart_dual_send_string("[SERVO] Closing gate...\r\n");
     send_json_gate_event("CLOSING");
-    for(uint8_t i = 0; i < 50; i++) servo_pulse(1000);
+    servo_pwm_move(SERVO_CLOSED_US);
     system_state.gate_open = 0;
 }
 
@@ -329,48 +447,102 @@ void servo_close(void) {
 // ============================================
 void emergency_button_init(void) {
     LPC_GPIO2->FIODIR &= ~EMERGENCY_BUTTON;
-    LPC_PINCON->PINMODE4 |= (3 << 22);
+    LPC_PINCON->PINMODE4 |= (3 << 22);          // Pull-down, press = high
+
+    // P2.11 as EINT1 (PINSEL4[23:22] = 01), rising edge
+    LPC_PINCON->PINSEL4 &= ~(3 << 22);
+    LPC_PINCON->PINSEL4 |= (1 << 22);
+    LPC_SC->EXTMODE |= (1 << 1);
+    LPC_SC->EXTPOLAR |= (1 << 1);
+    LPC_SC->EXTINT = (1 << 1);                  // Drop a latched edge
+
+    NVIC_SetPriority(EINT1_IRQn, EMERGENCY_IRQ_PRIORITY);
+    NVIC_EnableIRQ(EINT1_IRQn);
 }
 
+// Pin level still reads through FIOPIN with the EINT1 function
 uint8_t emergency_button_pressed(void) {
     return (LPC_GPIO2->FIOPIN & EMERGENCY_BUTTON) ? 1 : 0;
 }
 
+// First edge acts at once; further edges within the lockout are
+// contact bounce. The gate is commanded here, before anything else.
+void EINT1_IRQHandler(void) {
+    uint32_t t_us = LPC_TIM1->TC;
+    uint32_t now = millis();
+
+    LPC_SC->EXTINT = (1 << 1);
+
+    if(!emergency_button_pressed()) {
+        emergency_stats.glitches++;
+        return;
+    }
+    if(emergency_stats.presses && (now - emergency_last_ms) < EMERGENCY_LOCKOUT_MS) {
+        emergency_stats.bounces++;
+        return;
+    }
+    emergency_last_ms = now;
+
+    servo_pwm_move(SERVO_OPEN_US);
+    system_state.gate_busy = 1;                 // RFID and boot servo steps stand off
+
+    emergency_stats.gate_us = LPC_TIM1->TC - t_us;
+    if(emergency_stats.gate_us > emergency_stats.gate_us_max) {
+        emergency_stats.gate_us_max = emergency_stats.gate_us;
+    }
+    emergency_stats.presses++;
+
+    emergency_pending = 1;                      // Until the handler has run
+    eventbus_post(EVQ_GPIO, EV_BUTTON_EDGE, 1, &t_us, sizeof(t_us));
+}
+
+void emergency_report(void) {
+    sprintf(uart_buf,
+        "STATUS,{\"type\":\"EMERGENCY_STATUS\",\"presses\":%lu,"
+        "\"bounces\":%lu,\"glitches\":%lu,\"gate_us\":%lu,\"gate_us_max\":%lu,"
+        "\"alert_us\":%lu,\"alert_us_max\":%lu}\r\n",
+        (unsigned long)emergency_stats.presses,
+        (unsigned long)emergency_stats.bounces,
+        (unsigned long)emergency_stats.glitches,
+        (unsigned long)emergency_stats.gate_us,
+        (unsigned long)emergency_stats.gate_us_max,
+        (unsigned long)emergency_stats.alert_us,
+        (unsigned long)emergency_stats.alert_us_max);
+    uart_dual_send_string(uart_buf);
+}
+
 // ============================================
 // SYSTEM DATA
 // ============================================
 void system_data_init(void) {
-    for(uint8_t i = 0; i < MAX_CARDS; i++) {
+    for(uint16_t i = 0; i < CARDDB_MAX_CARDS; i++) {
         cards[i].scan_count = 0;
         cards[i].last_scan_time = 0;
-        cards[i].is_inside = 0;
+        cards[i].zone = ZONE_OUTSIDE;
     }
+    zones_clear_counts();
 
-    system_state.total_people_inside = 0;
-    system_state.total_entries = 0;
-    system_state.total_exits = 0;
+    access_reset();
     system_state.system_uptime = 0;
     system_state.gate_busy = 0;
     system_tick = 0;
 }
 
-int8_t card_find(const uint8_t *uid) {
-    for(uint8_t i = 0; i < MAX_CARDS; i++) {
-        if(cards[i].is_active) {
-            if(memcmp(cards[i].uid, uid, 4) == 0) {
-                return i;
-            }
-        }
+void zone_seed_load(void) {
+    zones_init();
+
+    for(uint8_t i = 0; i < sizeof(zone_seed) / sizeof(zone_seed[0]); i++) {
+        zones_define(zone_seed[i].zone, zone_seed[i].name, zone_seed[i].capacity);
+    }
+    for(uint8_t i = 0; i < sizeof(door_seed) / sizeof(door_seed[0]); i++) {
+        zones_add_door(door_seed[i].reader, door_seed[i].from, door_seed[i].to);
     }
-    return -1;
 }
 
-void update_total_people(void) {
-    system_state.total_people_inside = 0;
-    for(uint8_t i = 0; i < MAX_CARDS; i++) {
-        if(cards[i].is_inside) {
-            system_state.total_people_inside++;
-        }
+void card_seed_load(void) {
+    carddb_init();
+    for(uint8_t i = 0; i < CARD_SEED_COUNT; i++) {
+        carddb_add(card_seed[i].uid, card_seed[i].card_name, card_seed[i].group_name);
     }
 }
 
@@ -379,25 +551,43 @@ void update_total_people(void) {
 // ============================================
 void sensors_read(void) {
     static uint8_t dht_fail_count = 0;
+    uint8_t dht_ok;
 
-    // Read DHT11
-    if(read_dht11()) {
-        system_state.temperature = temperature;
-        system_state.humidity = humidity;
+    // Read DHT11 (frame captured over the last DHT11_READ_MS)
+    PROF_BEGIN(PROF_DHT11_READ);
+    dht_ok = dht11_finish();
+    PROF_END(PROF_DHT11_READ);
 
-        sprintf(temp_str, "%.1f", temperature);
-        sprintf(hum_str, "%.1f", humidity);
+    if(dht_ok) {
+        system_state.temperature_x10 = temperature_x10;
+        system_state.humidity_x10 = humidity_x10;
+
+        sprintf(temp_str, X10_FMT, X10_ARGS(temperature_x10));
+        sprintf(hum_str, X10_FMT, X10_ARGS(humidity_x10));
+
+        // One recovery frame after reported errors
+        if(telemetry_error_cleared()) {
+            sprintf(uart_buf,
+                "ENV,{\"type\":\"SENSOR_RECOVERED\","
+                "\"sensor\":\"DHT11\","
+                "\"fail_count\":%d}\r\n",
+                dht_fail_count);
+            uart_dual_send_string(uart_buf);
+        }
 
         dht_fail_count = 0;
     } else {
-        dht_fail_count++;
+        if(dht_fail_count < 255) dht_fail_count++;
         
-        sprintf(uart_buf,
-            "ENV,{\"type\":\"SENSOR_ERROR\","
-            "\"sensor\":\"DHT11\","
-            "\"fail_count\":%d}\r\n",
-            dht_fail_count);
-        uart_dual_send_string(uart_buf);
+        // Repeated failures are collapsed by the telemetry policy
+        if(telemetry_error_should_report(system_tick)) {
+            sprintf(uart_buf,
+                "ENV,{\"type\":\"SENSOR_ERROR\","
+                "\"sensor\":\"DHT11\","
+                "\"fail_count\":%d}\r\n",
+                dht_fail_count);
+            uart_dual_send_string(uart_buf);
+        }
 
         if(dht_fail_count >= 5) {
             strcpy(temp_str, "ERR");
@@ -405,7 +595,8 @@ void sensors_read(void) {
         }
     }
 
-    // Read MQ135
+    // Read MQ135 (the partial ring since the last wrap included)
+    ADC_Burst_Update();
     system_state.air_quality = MQ135_Read();
     sprintf(air_str, "%d", system_state.air_quality);
 }
@@ -417,26 +608,23 @@ void lcd_display_card_info(Card_t *card) {
     char line1[17] = {0};
     char line2[17] = {0};
 
-    lcd_clear();
     snprintf(line1, 17, "Card: %-10s", card->card_name);
-    lcd_goto(0, 0);
-    lcd_string(line1);
+    lcd_fb_line(0, line1);
 
-    snprintf(line2, 17, "%-16s", card->group_name);
-    lcd_goto(1, 0);
-    lcd_string(line2);
+    snprintf(line2, 17, "%-16s", card_group_name(card));
+    lcd_fb_line(1, line2);
+
+    lcd_fb_flush();
 }
 
 void lcd_display_scrolling(uint8_t state) {
     char line1[17] = {0};
     char line2[17] = {0};
 
-    lcd_clear();
-
     switch(state % 3) {
         case 0:
             snprintf(line1, 17, "People: %d/%d ",
-                system_state.total_people_inside, MAX_ROOM_CAPACITY);
+                access_counts.inside, MAX_ROOM_CAPACITY);
             snprintf(line2, 17, "AirQ: %s    ", air_str);
             break;
 
@@ -451,78 +639,104 @@ void lcd_display_scrolling(uint8_t state) {
             break;
     }
 
-    lcd_goto(0, 0);
-    lcd_string(line1);
-    lcd_goto(1, 0);
-    lcd_string(line2);
+    // Only the cells that differ from the current screen are written
+    lcd_fb_line(0, line1);
+    lcd_fb_line(1, line2);
+    lcd_fb_flush();
 }
 
 // ============================================
 // ENTRY/EXIT LOGIC
 // ============================================
-uint8_t process_entry(int8_t card_idx) {
-    Card_t *card = &cards[card_idx];
-
-    if(system_state.total_people_inside >= MAX_ROOM_CAPACITY) {
-        return 0;
-    }
-
-    if(card->is_inside) {
-        // Commented out: uart_dual_send_string("Already inside!\r\n");
+// Decision and counts: ACCESS.c; the LEDs follow the total
+uint8_t process_entry(int16_t card_idx, uint8_t to_zone) {
+    if(!access_entry(&cards[card_idx], to_zone, system_tick)) {
         return 0;
     }
 
-    card->is_inside = 1;
-    card->scan_count++;
-    card->last_scan_time = system_tick;
-
-    system_state.total_entries++;
-    update_total_people();
     led_show_occupancy();
-
     return 1;
 }
 
-void process_exit(int8_t card_idx) {
-    Card_t *card = &cards[card_idx];
+void process_exit(int16_t card_idx, uint8_t to_zone) {
+    if(access_exit(&cards[card_idx], to_zone, system_tick)) {
+        led_show_occupancy();
+    }
+}
 
-    if(!card->is_inside) {
-        // Commented out: uart_dual_send_string("Not inside!\r\n");
+// ============================================
+// GATE SEQUENCE (non-blocking)
+// gate_start() kicks it off, gate_service() is
+// polled every main-loop pass (ticks = ~100ms)
+// ============================================
+void gate_start(uint16_t hold_ticks, uint8_t emergency) {
+    // A scan finishing late must not shorten an emergency opening
+    if(!emergency && (emergency_pending || (gate_emergency && gate_state != GATE_IDLE))) {
         return;
     }
 
-    card->is_inside = 0;
-    card->scan_count++;
-    card->last_scan_time = system_tick;
+    system_state.gate_busy = 1;
+    gate_hold_ticks = hold_ticks;
+    gate_emergency = emergency;
 
-    system_state.total_exits++;
-    update_total_people();
-    led_show_occupancy();
+    if(!emergency) {
+        // Commented out: uart_dual_send_string("[GATE] Starting operation...\r\n");
+        send_json_gate_event("OPERATION_START");
+
+        buzzer_gate_opening();
+        led_running_pattern();
+    }
+
+    servo_open();
+    gate_state = GATE_OPENING;
 }
 
 void gate_operate(void) {
-    system_state.gate_busy = 1;
-
-    // Commented out: uart_dual_send_string("[GATE] Starting operation...\r\n");
-    send_json_gate_event("OPERATION_START");
+    gate_start(GATE_OPEN_TIME * 10, 0);
+}
 
-    buzzer_gate_opening();
-    led_running_pattern();
-    servo_open();
+void gate_service(void) {
+    switch(gate_state) {
+        case GATE_OPENING:
+            if(!servo_pwm_moving()) {
+                // Commented out: uart_dual_send_string("[GATE] Gate open - waiting...\r\n");
+                send_json_gate_event("OPEN_WAITING");
+                gate_deadline = system_tick + gate_hold_ticks;
+                gate_state = GATE_HOLD;
+            }
+            break;
 
-    // Commented out: uart_dual_send_string("[GATE] Gate open - waiting...\r\n");
-    send_json_gate_event("OPEN_WAITING");
-    delay_ms(GATE_OPEN_TIME * 1000);
+        case GATE_HOLD:
+            if((int32_t)(system_tick - gate_deadline) >= 0) {
+                servo_close();
+                buzzer_gate_closing();
+                gate_state = GATE_CLOSING;
+            }
+            break;
 
-    servo_close();
-    buzzer_gate_closing();
+        case GATE_CLOSING:
+            if(!servo_pwm_moving()) {
+                gate_state = GATE_IDLE;
+                system_state.gate_busy = 0;
 
-    // Commented out: uart_dual_send_string("[GATE] Operation complete\r\n");
-    send_json_gate_event("OPERATION_COMPLETE");
+                if(gate_emergency) {
+                    led_show_occupancy();
+                    buzzer_card_detected();
+                    uart_dual_send_string("ALERT,{\"type\":\"EMERGENCY_CLEARED\"}\r\n");
+                } else {
+                    // Commented out: uart_dual_send_string("[GATE] Operation complete\r\n");
+                    send_json_gate_event("OPERATION_COMPLETE");
+                }
+            }
+            break;
 
-    system_state.gate_busy = 0;
+        default:
+            break;
+    }
 }
 
+// Per scan: occupancy only. The diagnostic reports go out on the
+// TASKS_REPORT_MS timer in task_ui.
 void print_statistics(void) {
     // Send JSON status instead of formatted text
     send_json_system_status();
@@ -530,10 +744,10 @@ void print_statistics(void) {
     /* COMMENTED OUT - OLD FORMAT
     uart_dual_send_string("\r\n========== STATUS ==========\r\n");
     sprintf(uart_buf, "Inside: %d/%d people\r\n",
-        system_state.total_people_inside, MAX_ROOM_CAPACITY);
+        access_counts.inside, MAX_ROOM_CAPACITY);
     uart_dual_send_string(uart_buf);
     sprintf(uart_buf, "Number of Entries: %d | Number of Exits: %d\r\n",
-        system_state.total_entries, system_state.total_exits);
+        access_counts.entries, access_counts.exits);
     uart_dual_send_string(uart_buf);
     sprintf(uart_buf, "Temp: %sC | Hum: %s%%\r\n", temp_str, hum_str);
     uart_dual_send_string(uart_buf);
@@ -545,393 +759,857 @@ void print_statistics(void) {
 }
 
 // ============================================
-// SYSTEM INITIALIZATION
+// SCAN SEQUENCE HELPERS
 // ============================================
-void system_init(void) {
-    UART0_Init();
-    delay_ms(100);
+void scan_show_result(const char *title) {
+    char line2[17];
 
-    init_uart3();
-    delay_ms(100);
+    lcd_fb_clear();
+    lcd_display_centered(0, title);
+    snprintf(line2, 17, "Inside: %d/%d",
+        access_counts.inside, MAX_ROOM_CAPACITY);
+    lcd_fb_line(1, line2);
+    lcd_fb_flush();
+}
 
-    // System ready message in JSON
-    uart_dual_send_string("INIT,{\"type\":\"SYSTEM_START\",\"version\":\"3.9\",\"capacity\":9}\r\n");
-    
-    /* COMMENTED OUT - OLD FORMAT
-    uart_dual_send_string("\r\n========================================\r\n");
-    uart_dual_send_string(" RFID SYSTEM - BATCH-3\r\n");
-    uart_dual_send_string(" 10 Cards (1 Person Each)\r\n");
-    uart_dual_send_string(" MAX CAPACITY: 9 PEOPLE\r\n");
-    uart_dual_send_string(" DHT11 PIN: P0.7\r\n");
-    uart_dual_send_string(" UART0: P0.2/P0.3 | UART3: P0.0/P0.1\r\n");
-    uart_dual_send_string("========================================\r\n");
-    */
-    
-    send_json_system_init("UART");
+#if CREDENTIAL_ENABLE
+// Second LCD line for a refused credential (16 chars max)
+const char* credential_lcd_reason(Credential_Result_t r) {
+    switch(r) {
+        case CRED_BAD_MAC:       return "Bad Credential";
+        case CRED_REVOKED:       return "Card Revoked";
+        case CRED_NOT_YET_VALID: return "Not Yet Valid";
+        case CRED_EXPIRED:       return "Card Expired";
+        case CRED_NO_ZONE:       return "No Zone Access";
+        default:                 return "Card Not Read";
+    }
+}
+#endif
+
+void scan_abort(void) {
+    if(scan_state == SCAN_CHECKING || scan_state == SCAN_DECIDE) {
+        PROF_SPAN_CANCEL(PROF_SCAN_DECISION);
+        PROF_SPAN_CANCEL(PROF_SCAN_GATE);
+    } else if(scan_state == SCAN_RESULT) {
+        PROF_SPAN_CANCEL(PROF_SCAN_GATE);
+    }
 
-    // uart_dual_send_string("[2/9] LEDs...\r\n");
-    led_init();
-    led_blink_all(1);
-    send_json_system_init("LED");
+    scan_state = SCAN_POLL;
+    task_sleep_ms(TASK_RFID, TASK_RFID_PERIOD_MS);
+}
 
-    // uart_dual_send_string("[3/9] Buzzer...\r\n");
-    buzzer_init();
-    buzzer_beep(200);
-    send_json_system_init("BUZZER");
+// The record can move while the task sleeps between screens: a DB,REV
+// frees it, a DB,ADD or credential load may evict a copy for its slot.
+// Find the card again by UID; NULL = revoked mid-scan
+Card_t* scan_card(void) {
+    scan_card_idx = carddb_lookup(scan_uid);
 
-    // uart_dual_send_string("[4/9] Emergency...\r\n");
-    emergency_button_init();
-    send_json_system_init("EMERGENCY");
+#if CREDENTIAL_ENABLE
+    // Evicted credential copy: the credential read on this scan still holds
+    if(scan_card_idx < 0 && scan_cred_result == CRED_OK) {
+        scan_card_idx = carddb_add_credential(scan_uid, scan_cred.group_id);
+    }
+#endif
 
-    // uart_dual_send_string("[5/9] LCD...\r\n");
-    lcd_init();
-    lcd_clear();
-    lcd_display_centered(0, "Initializing...");
-    send_json_system_init("LCD");
+    return (scan_card_idx >= 0) ? &cards[scan_card_idx] : 0;
+}
+
+void scan_card_gone(void) {
+    scancache_record(scan_uid, SCAN_ACT_DENIED, system_tick);
+
+    lcd_fb_clear();
+    lcd_display_centered(0, "Access Denied!");
+    lcd_display_centered(1, "Card Revoked");
+    lcd_fb_flush();
+
+    buzzer_error();
+    scroll_timer = 0;
+    scan_abort();
+}
+
+// ============================================
+// EVENT HANDLERS (main context, eventbus_dispatch)
+// ============================================
+// EMERGENCY - Gate is already moving (EINT1_IRQHandler);
+// ALERT first, then take over the gate sequence, LCD and buzzer
+void on_button_edge(const Event_t *ev) {
+    uint32_t t_us;
+
+    memcpy(&t_us, ev->data, sizeof(t_us));
+    emergency_pending = 0;
+
+    send_json_emergency();
+    emergency_stats.alert_us = LPC_TIM1->TC - t_us;
+    if(emergency_stats.alert_us > emergency_stats.alert_us_max) {
+        emergency_stats.alert_us_max = emergency_stats.alert_us;
+    }
+
+    // A scan in progress is dropped; one already decided keeps its count
+    scan_abort();
+
+    // Gate held open 5s; EMERGENCY_CLEARED is sent by gate_service()
+    gate_start(50, 1);
+
+    lcd_fb_clear();
+    lcd_display_centered(0, "EMERGENCY!");
+    lcd_display_centered(1, "Opening Gate...");
+    lcd_fb_flush();
+
+    buzzer_emergency();
+    led_all_on();
+
+    scroll_timer = 0;
+}
+
+// CARD DB - Apply ADD/REVOKE deltas from the ESP32
+void on_uart_rx_line(const Event_t *ev) {
+    (void)ev;
+    carddb_sync_poll();
+}
+
+// ADC filters run once per DMA ring wrap
+void on_sensor_ready(const Event_t *ev) {
+    (void)ev;
+    ADC_Burst_Update();
+}
+
+// A queue overflowed: catch up from the source itself
+void on_queue_lost(const Event_t *ev) {
+    if(ev->arg == EVQ_UART) {
+        for(uint8_t i = 0; i < UART3_RX_RING_SIZE / CARDDB_RX_BUDGET; i++) {
+            carddb_sync_poll();
+        }
+    } else if(ev->arg == EVQ_DMA) {
+        ADC_Burst_Update();
+    }
+}
+
+void events_subscribe(void) {
+    eventbus_subscribe(EV_BUTTON_EDGE, on_button_edge);
+    eventbus_subscribe(EV_UART_RX_LINE, on_uart_rx_line);
+    eventbus_subscribe(EV_SENSOR_READY, on_sensor_ready);
+    eventbus_subscribe(EV_QUEUE_LOST, on_queue_lost);
+}
+
+// ============================================
+// SYSTEM INITIALIZATION (fast path)
+// Only what a scan needs: UARTs, card store,
+// SSP0 + RC522, gate PWM, LCD. Everything that
+// waits on hardware (DHT11 warm-up, servo swing,
+// LED/buzzer demos, card list dump) runs later
+// from boot_selftest_service() in the main loop.
+// UART output at 9600 baud costs ~1ms per byte,
+// so no frames are sent until the reader is up.
+// ============================================
+void system_init(void) {
+    systick_init();
+    PROF_INIT();
+    SPITRACE_INIT();
+    eventbus_init();                // Before any producing interrupt is enabled
+    events_subscribe();
+
+    UART0_Init();
+    init_uart3();
+    uplink_init();
+
+    zone_seed_load();
+    card_seed_load();
+    scancache_init();
+    denylimit_init(0);
+#if CREDENTIAL_ENABLE
+    credential_init();
+#endif
+    system_data_init();
+    telemetry_init();
+    flowrate_init(millis());
+
+    led_init();
+    servo_init();
+    emergency_button_init();        // EINT1 commands the servo: after servo_init
+    MQ135_Init();
+    DHT11_Init();                   // Warm-up wait is timed by the self-test
+    boot_dht_start = millis();
 
-    // uart_dual_send_string("[6/9] RC522...\r\n");
     SSP0_init();
-    delay_ms(100);
 
+    // RC522 hard reset (P0.1)
     LPC_GPIO0->FIODIR |= (1<<1);
     LPC_GPIO0->FIOCLR = (1<<1);
-    delay_ms(100);
+    delay_ms(1);
     LPC_GPIO0->FIOSET = (1<<1);
-    delay_ms(100);
+    delay_ms(1);
 
     RC522_Init();
-    delay_ms(100);
 
-    uint8_t version = SSP0_Read(RC522_REG_VERSION);
-    
-    sprintf(uart_buf, "INIT,{\"type\":\"RC522_VERSION\",\"version\":\"0x%02X\"}\r\n", version);
-    uart_dual_send_string(uart_buf);
-    
-    // Commented out: sprintf(uart_buf, " Ver=0x%02X\r\n", version);
+    boot_rc522_version = SSP0_Read(RC522_REG_VERSION);
 
-    if(version == 0x00 || version == 0xFF) {
+    if(boot_rc522_version == 0x00 || boot_rc522_version == 0xFF) {
+        sprintf(uart_buf, "INIT,{\"type\":\"RC522_VERSION\",\"version\":\"0x%02X\"}\r\n",
+            boot_rc522_version);
+        uart_dual_send_string(uart_buf);
         uart_dual_send_string("INIT,{\"type\":\"RC522_ERROR\",\"status\":\"FAILED\"}\r\n");
-        lcd_clear();
+        lcd_init();
+        lcd_fb_clear();
         lcd_display_centered(0, "RC522 ERROR!");
+        lcd_fb_flush();
         buzzer_error();
         while(1);
     }
-    send_json_system_init("RC522");
 
-    // uart_dual_send_string("[7/9] DHT11 (P0.7)...\r\n");
-    DHT11_Init();
-    
-    lcd_clear();
-    lcd_display_centered(0, "Testing DHT11...");
-    lcd_display_centered(1, "Pin: P0.7");
-    delay_ms(2000);
-
-    uint8_t dht_success = 0;
-    for(uint8_t attempt = 1; attempt <= 3; attempt++) {
-        lcd_clear();
-        sprintf(uart_buf, "DHT11 Test %d/3", attempt);
-        lcd_display_centered(0, uart_buf);
-        lcd_display_centered(1, "Pin: P0.7");
-
-        if(read_dht11()) {
+#if FLASHIDX_ENABLE
+    // Optional season-pass index on SPI flash (P0.6 CS, same SSP0 bus)
+    boot_flash_ok = flashidx_init();
+#endif
+
+    lcd_init();
+    lcd_async_init();
+    power_init();                   // RIT wake timer; TIMER1 is running now
+    uartlink_init();                // Handshake runs from the main loop (TIMER1 up)
+    lcd_fb_clear();
+    lcd_display_centered(0, "BATCH-3");
+    lcd_display_centered(1, "Starting...");
+    lcd_fb_flush();
+
+    /* COMMENTED OUT - OLD FORMAT
+    uart_dual_send_string("\r\n========================================\r\n");
+    uart_dual_send_string(" RFID SYSTEM - BATCH-3\r\n");
+    uart_dual_send_string(" 10 Cards (1 Person Each)\r\n");
+    uart_dual_send_string(" MAX CAPACITY: 9 PEOPLE\r\n");
+    uart_dual_send_string(" DHT11 PIN: P0.7\r\n");
+    uart_dual_send_string(" UART0: P0.2/P0.3 | UART3: P0.0/P0.1\r\n");
+    uart_dual_send_string("========================================\r\n");
+    */
+}
+
+// ============================================
+// BOOT SELF-TESTS (background, non-blocking)
+// One step per main-loop pass; waits are SysTick
+// deadlines, so scanning runs in between. Each
+// result goes out as a later INIT frame.
+// ============================================
+void boot_selftest_service(void) {
+    uint32_t now = millis();
+
+    if(boot_step == BOOT_DONE || (int32_t)(now - boot_deadline) < 0) {
+        return;
+    }
+
+    switch(boot_step) {
+        case BOOT_ANNOUNCE:
+            // Reader has been polling since boot_ready_ms
             sprintf(uart_buf,
-                "INIT,{\"type\":\"DHT11_TEST\",\"attempt\":%d,\"temp\":%.1f,\"hum\":%.1f,\"status\":\"OK\"}\r\n",
-                attempt, temperature, humidity);
+                "INIT,{\"type\":\"SYSTEM_START\",\"version\":\"3.9\",\"capacity\":%d,"
+                "\"boot_to_scan_ms\":%lu}\r\n",
+                MAX_ROOM_CAPACITY, (unsigned long)boot_ready_ms);
+            uart_dual_send_string(uart_buf);
+            send_json_system_init("UART");
+
+            sprintf(uart_buf, "INIT,{\"type\":\"RC522_VERSION\",\"version\":\"0x%02X\"}\r\n",
+                boot_rc522_version);
+            uart_dual_send_string(uart_buf);
+            send_json_system_init("RC522");
+            send_json_system_init("EMERGENCY");
+            send_json_system_init("MQ135");
+#if FLASHIDX_ENABLE
+            if(boot_flash_ok) {
+                sprintf(uart_buf, "INIT,{\"type\":\"FLASH_INDEX\",\"status\":\"OK\",\"cards\":%lu}\r\n",
+                        (unsigned long)flashidx_record_count());
+            } else {
+                sprintf(uart_buf, "INIT,{\"type\":\"FLASH_INDEX\",\"status\":\"ABSENT\"}\r\n");
+            }
             uart_dual_send_string(uart_buf);
-            
-            // Commented out: sprintf(uart_buf, "T=%.1fC H=%.1f%% OK\r\n", temperature, humidity);
+#endif
+            boot_step = BOOT_LED_BUZZER;
+            break;
 
-            lcd_clear();
-            sprintf(uart_buf, "T:%.1fC H:%.1f%%", temperature, humidity);
-            lcd_display_centered(0, uart_buf);
-            lcd_display_centered(1, "SUCCESS!");
+        case BOOT_LED_BUZZER:
+            // Patterns play from TIMER2
+            led_blink_all(1);
+            send_json_system_init("LED");
+            buzzer_beep(200);
+            send_json_system_init("BUZZER");
+            boot_step = BOOT_LCD;
+            break;
 
-            sprintf(temp_str, "%.1f", temperature);
-            sprintf(hum_str, "%.1f", humidity);
+        case BOOT_LCD:
+            if(!system_state.gate_busy) {
+                lcd_fb_clear();
+                lcd_display_centered(0, "BATCH-3");
+                lcd_display_centered(1, "READY!");
+                lcd_fb_flush();
+            }
+            send_json_system_init("LCD");
+            boot_step = BOOT_SERVO_OPEN;
+            break;
 
-            dht_success = 1;
-            delay_ms(1500);
+        case BOOT_SERVO_OPEN:
+            // Skipped while a scan is using the gate
+            if(system_state.gate_busy) {
+                send_json_system_init("SERVO");
+                boot_step = BOOT_DHT11;
+                break;
+            }
+            servo_open();
+            boot_deadline = now + 1000;
+            boot_step = BOOT_SERVO_CLOSE;
             break;
-        } else {
+
+        case BOOT_SERVO_CLOSE:
+            // A scan during the swing takes the gate over
+            if(!system_state.gate_busy) {
+                servo_close();
+            }
+            send_json_system_init("SERVO");
+            boot_step = BOOT_DHT11;
+            break;
+
+        case BOOT_DHT11:
+            // DHT11 needs 2s after power before the first read
+            if((now - boot_dht_start) < 2000) {
+                boot_deadline = boot_dht_start + 2000;
+                break;
+            }
+
+            // Start pulse and frame run over the next two passes
+            dht11_start();
+            boot_deadline = now + DHT11_START_MS;
+            boot_step = BOOT_DHT11_RELEASE;
+            break;
+
+        case BOOT_DHT11_RELEASE:
+            dht11_release();
+            boot_deadline = now + DHT11_READ_MS;
+            boot_step = BOOT_DHT11_READ;
+            break;
+
+        case BOOT_DHT11_READ:
+            boot_dht_attempt++;
+            PROF_BEGIN(PROF_DHT11_READ);
+            boot_dht_ok = dht11_finish();
+            PROF_END(PROF_DHT11_READ);
+
+            if(boot_dht_ok) {
+                sprintf(uart_buf,
+                    "INIT,{\"type\":\"DHT11_TEST\",\"attempt\":%d,\"temp\":" X10_FMT ",\"hum\":" X10_FMT ",\"status\":\"OK\"}\r\n",
+                    boot_dht_attempt, X10_ARGS(temperature_x10), X10_ARGS(humidity_x10));
+                uart_dual_send_string(uart_buf);
+
+                sprintf(temp_str, X10_FMT, X10_ARGS(temperature_x10));
+                sprintf(hum_str, X10_FMT, X10_ARGS(humidity_x10));
+                boot_step = BOOT_CARDS;
+                break;
+            }
+
             sprintf(uart_buf,
                 "INIT,{\"type\":\"DHT11_TEST\",\"attempt\":%d,\"status\":\"FAIL\"}\r\n",
-                attempt);
+                boot_dht_attempt);
             uart_dual_send_string(uart_buf);
-            
-            lcd_clear();
-            lcd_display_centered(0, "DHT11 FAILED!");
-            lcd_display_centered(1, "Check P0.7");
-            delay_ms(1000);
-        }
 
-        if(attempt < 3) {
-            delay_ms(2500);
-        }
-    }
+            if(boot_dht_attempt < 3) {
+                boot_deadline = now + 2500;
+                boot_step = BOOT_DHT11;
+            } else {
+                uart_dual_send_string("INIT,{\"type\":\"DHT11_WARNING\",\"status\":\"CHECK_P0.7\"}\r\n");
+                strcpy(temp_str, "---");
+                strcpy(hum_str, "---");
+                boot_step = BOOT_CARDS;
+            }
+            break;
+
+        case BOOT_CARDS:
+            // Card database in JSON format, one card per pass
+            if(boot_card_next == 0) {
+                sprintf(uart_buf, "INIT,{\"type\":\"CARD_DATABASE\",\"total_cards\":%u,\"version\":%lu}\r\n",
+                        carddb_count(), (unsigned long)carddb_version());
+                uart_dual_send_string(uart_buf);
+            }
+
+            while(boot_card_next < CARDDB_MAX_CARDS && !cards[boot_card_next].is_active) {
+                boot_card_next++;
+            }
+
+            if(boot_card_next < CARDDB_MAX_CARDS) {
+                Card_t *card = &cards[boot_card_next++];
+                sprintf(uart_buf,
+                    "CARD,{\"id\":\"%s\",\"group\":\"%s\","
+                    "\"uid\":\"%02X:%02X:%02X:%02X\"}\r\n",
+                    card->card_name, card_group_name(card),
+                    card->uid[0], card->uid[1], card->uid[2], card->uid[3]);
+                uart_dual_send_string(uart_buf);
+                break;
+            }
 
-    if(!dht_success) {
-        uart_dual_send_string("INIT,{\"type\":\"DHT11_WARNING\",\"status\":\"CHECK_P0.7\"}\r\n");
-        strcpy(temp_str, "---");
-        strcpy(hum_str, "---");
+            /* COMMENTED OUT - OLD CARD LIST FORMAT
+            uart_dual_send_string("===== 10 CARDS (1 PERSON EACH) =====\r\n");
+            uart_dual_send_string("\nFOUR MEM GRP (4 cards - 1 person each):\r\n");
+            ...
+            */
+
+            sprintf(uart_buf,
+                "INIT,{\"type\":\"SYSTEM_READY\",\"status\":\"ONLINE\","
+                "\"boot_to_scan_ms\":%lu,\"selftest_ms\":%lu,\"dht11\":\"%s\"}\r\n",
+                (unsigned long)boot_ready_ms, (unsigned long)now,
+                boot_dht_ok ? "OK" : "FAIL");
+            uart_dual_send_string(uart_buf);
+            boot_step = BOOT_DONE;
+            break;
+
+        default:
+            boot_step = BOOT_DONE;
+            break;
     }
+}
 
-    delay_ms(1000);
+// ============================================
+// TASKS (see TASKS.h for priorities / periods)
+// Each body used to be a block of the main
+// loop; system_tick still counts 100ms ticks.
+// ============================================
+// EVENTS - Emergency button (EINT1), UART3 lines (card DB
+// deltas), ADC ring wraps; button edges are handled first
+void task_events(void) {
+    eventbus_dispatch(EVENTBUS_DISPATCH_BUDGET);
+    if(eventbus_pending()) task_signal(TASK_EVENTS);
+}
 
-    // uart_dual_send_string("[8/9] MQ135...\r\n");
-    MQ135_Init();
-    send_json_system_init("MQ135");
+// Every post wakes the events task (interrupt context)
+void on_event_posted(void) {
+    task_signal(TASK_EVENTS);
+}
 
-    // uart_dual_send_string("[9/9] Servo...\r\n");
-    servo_init();
+// GATE - Advance the open/hold/close sequence
+void task_gate(void) {
+    gate_service();
+}
 
-    lcd_clear();
-    lcd_display_centered(0, "Testing Servo...");
+// RFID - Reader poll, then the scan sequence; its screen
+// times are task sleeps, so the other tasks keep running
+void task_rfid(void) {
+    Card_t *card;
 
-    servo_open();
-    delay_ms(1000);
-    servo_close();
-    delay_ms(1000);
-    send_json_system_init("SERVO");
+    switch(scan_state) {
+        case SCAN_POLL: {
+            uint8_t tagType[2];
+            uint8_t anticoll;
 
-    system_data_init();
+            if(system_state.gate_busy) return;
+            if(RC522_Request(PICC_CMD_REQA, tagType) != MI_OK) return;
 
-    // Send card database in JSON format
-    uart_dual_send_string("INIT,{\"type\":\"CARD_DATABASE\",\"total_cards\":10}\r\n");
-    
-    for(uint8_t i = 0; i < MAX_CARDS; i++) {
-        sprintf(uart_buf,
-            "CARD,{\"id\":\"%s\",\"group\":\"%s\","
-            "\"uid\":\"%02X:%02X:%02X:%02X\"}\r\n",
-            cards[i].card_name, cards[i].group_name,
-            cards[i].uid[0], cards[i].uid[1], cards[i].uid[2], cards[i].uid[3]);
-        uart_dual_send_string(uart_buf);
-    }
+            anticoll = RC522_Anticoll(scan_uid);
 
-    /* COMMENTED OUT - OLD CARD LIST FORMAT
-    uart_dual_send_string("===== 10 CARDS (1 PERSON EACH) =====\r\n");
-    uart_dual_send_string("\nFOUR MEM GRP (4 cards - 1 person each):\r\n");
-    ...
-    */
+            // SPI trace (opt-in): keep the REQA -> anticoll exchange
+            if(anticoll == MI_OK) {
+                SPITRACE_TRIGGER();
+            }
 
-    uart_dual_send_string("INIT,{\"type\":\"SYSTEM_READY\",\"status\":\"ONLINE\"}\r\n");
-    
-    /* COMMENTED OUT - OLD FORMAT
-    uart_dual_send_string("========================================\r\n");
-    uart_dual_send_string(" SYSTEM READY - BATCH-3\r\n");
-    uart_dual_send_string(" Max: 9 People | DHT11: P0.7\r\n");
-    uart_dual_send_string("========================================\r\n\r\n");
-    */
+            // Repeat reads / anti-passback are dropped here without
+            // a decision cycle, a frame or any feedback
+            if(anticoll != MI_OK ||
+               scancache_check(scan_uid, system_tick) != SCAN_ACCEPT) {
+                return;
+            }
 
-    lcd_clear();
-    lcd_display_centered(0, "BATCH-3");
-    lcd_display_centered(1, "READY!");
+            PROF_SPAN_START(PROF_SCAN_DECISION);
+            PROF_SPAN_START(PROF_SCAN_GATE);
 
-    buzzer_success();
-    led_blink_all(2);
-    delay_ms(2000);
-}
+#if CREDENTIAL_ENABLE
+            scan_cred_result = CRED_NO_SECTOR;      // Nothing read on this scan yet
+#endif
 
-// ============================================
-// MAIN FUNCTION
-// ============================================
-int main(void) {
-    uint8_t tagType[2];
-    uint8_t uid_scanned[5];
-    uint16_t sensor_timer = 0;
-    uint8_t scroll_timer = 0;
-    uint8_t scroll_state = 0;
-    uint8_t uptime_timer = 0;
-    int8_t card_idx;
-    uint8_t emergency_prev = 0;
-    char line2[17];
+            // UID known: warm the flash index pages before the lookup
+            carddb_prefetch(scan_uid);
 
-    system_init();
+            // Bloom filter -> RAM index -> flash index
+            PROF_BEGIN(PROF_CARD_FIND);
+            scan_card_idx = carddb_lookup(scan_uid);
+            PROF_END(PROF_CARD_FIND);
 
-    while(1) {
-        system_tick++;
+            // Re-read of a card that was evicted from the recent-UID cache
+            if(scan_card_idx >= 0 &&
+               scancache_check_card(&cards[scan_card_idx], system_tick) != SCAN_ACCEPT) {
+                PROF_SPAN_CANCEL(PROF_SCAN_DECISION);
+                PROF_SPAN_CANCEL(PROF_SCAN_GATE);
+                return;
+            }
 
-        if(uptime_timer >= 100) {
-            uptime_timer = 0;
-            system_state.system_uptime += 10;
-        }
+#if CREDENTIAL_ENABLE
+            // No record anywhere, or a credential copy: the card's own
+            // credential decides (SCAN_CHECKING, entries only)
+            if(scan_card_idx < 0 || cards[scan_card_idx].source == CARD_SRC_CRED) {
+                PROF_BEGIN(PROF_CRED_READ);
+                scan_cred_result = credential_read(scan_uid, &scan_cred);
+                PROF_END(PROF_CRED_READ);
+
+                if(scan_cred_result == CRED_OK) {
+                    scan_card_idx = carddb_add_credential(scan_uid, scan_cred.group_id);
+                }
+            }
+#endif
 
-        // EMERGENCY
-        uint8_t emergency_current = emergency_button_pressed();
-        if(emergency_current && !emergency_prev) {
-            // Commented out: uart_dual_send_string("\r\n!!! EMERGENCY !!!\r\n");
-            send_json_emergency();
+            if(scan_card_idx == -1) {
+                const char *reason = "Unknown Card";
 
-            lcd_clear();
-            lcd_display_centered(0, "EMERGENCY!");
-            lcd_display_centered(1, "Opening Gate...");
+                PROF_SPAN_END(PROF_SCAN_DECISION);
+                PROF_SPAN_CANCEL(PROF_SCAN_GATE);
+                scancache_record(scan_uid, SCAN_ACT_UNKNOWN, system_tick);
 
-            buzzer_emergency();
-            led_all_on();
+                // Unknown card - send JSON (rate limited per UID,
+                // the rest goes into the DENIAL_SUMMARY frame)
+                if(denylimit_allow(scan_uid, system_tick)) {
+                    send_json_unknown_card(scan_uid);
+                }
 
-            system_state.gate_busy = 1;
-            servo_open();
-            delay_ms(5000);
-            servo_close();
-            system_state.gate_busy = 0;
+#if CREDENTIAL_ENABLE
+                if(scan_cred_result == CRED_BAD_MAC || scan_cred_result == CRED_REVOKED) {
+                    reason = credential_lcd_reason(scan_cred_result);
+                }
+#endif
+
+                lcd_fb_clear();
+                lcd_display_centered(0, "Access Denied!");
+                lcd_display_centered(1, reason);
+                lcd_fb_flush();
+
+                // Non-blocking: buzzer/LEDs run from TIMER2, the
+                // screen stays up until the next scroll update
+                buzzer_error();
+                led_blink_all(5);
+                scroll_timer = 0;
+                return;
+            }
 
-            led_show_occupancy();
             buzzer_card_detected();
-            
-            uart_dual_send_string("ALERT,{\"type\":\"EMERGENCY_CLEARED\"}\r\n");
-            // Commented out: uart_dual_send_string("Emergency closed\r\n\r\n");
-            
-            scroll_timer = 0;
-        }
-        emergency_prev = emergency_current;
+            led_blink_all(1);
 
-        // SENSORS - Read every 60 seconds and send data continuously
-        if(sensor_timer >= SENSOR_READ_INTERVAL) {
-            sensor_timer = 0;
-            sensors_read();
-            send_json_sensor_data();  // Send immediately after reading
-        }
+            lcd_fb_clear();
+            lcd_display_centered(0, "Card Detected!");
+            lcd_display_centered(1, "Checking...");
+            lcd_fb_flush();
 
-        // LCD - Update every 3 seconds
-        if(scroll_timer >= LCD_UPDATE_INTERVAL) {
-            scroll_timer = 0;
-            lcd_display_scrolling(scroll_state);
-            scroll_state = (scroll_state + 1) % 3;  // Now cycles through 3 screens
+            scan_state = SCAN_CHECKING;
+            task_sleep_ms(TASK_RFID, 1000);
+            break;
         }
 
-        // RFID
-        if(!system_state.gate_busy) {
-            if(RC522_Request(PICC_CMD_REQA, tagType) == MI_OK) {
-                if(RC522_Anticoll(uid_scanned) == MI_OK) {
-                    buzzer_card_detected();
-                    led_blink_all(1);
-
-                    lcd_clear();
-                    lcd_display_centered(0, "Card Detected!");
-                    lcd_display_centered(1, "Checking...");
-                    delay_ms(1000);
-
-                    /* COMMENTED OUT - OLD UID PRINT
-                    uart_dual_send_string("\r\n===== CARD SCAN =====\r\n");
-                    uart_dual_send_string("UID: ");
-                    for(uint8_t i = 0; i < 4; i++) {
-                        uart_dual_send_hex(uid_scanned[i]);
-                        if(i < 3) uart_dual_send_char(':');
-                    }
-                    uart_dual_send_string("\r\n");
-                    */
-
-                    card_idx = card_find(uid_scanned);
-
-                    if(card_idx == -1) {
-                        // Unknown card - send JSON
-                        send_json_unknown_card(uid_scanned);
-                        
-                        /* COMMENTED OUT
-                        uart_dual_send_string("UNKNOWN - DENIED\r\n");
-                        uart_dual_send_string("=====================\r\n\r\n");
-                        */
-
-                        lcd_clear();
-                        lcd_display_centered(0, "Access Denied!");
-                        lcd_display_centered(1, "Unknown Card");
-
-                        buzzer_error();
-                        led_blink_all(5);
-                        delay_ms(3000);
-                        scroll_timer = 0;
-                        led_show_occupancy();
-                        continue;
-                    }
-
-                    Card_t *card = &cards[card_idx];
-
-                    /* COMMENTED OUT
-                    sprintf(uart_buf, "Card: %s\r\n", card->card_name);
-                    uart_dual_send_string(uart_buf);
-                    sprintf(uart_buf, "Group: %s (1 person)\r\n", card->group_name);
-                    uart_dual_send_string(uart_buf);
-                    */
-
-                    lcd_display_card_info(card);
-                    delay_ms(2000);
-
-                    if(!card->is_inside) {
-                        if(process_entry(card_idx)) {
-                            // Entry granted - send JSON
-                            send_json_rfid_scan(card, "ENTRY", 1);
-                            
-                            /* COMMENTED OUT
-                            uart_dual_send_string("ENTRY GRANTED\r\n");
-                            uart_dual_send_string("=====================\r\n");
-                            */
-
-                            lcd_clear();
-                            lcd_display_centered(0, "WELCOME!");
-                            snprintf(line2, 17, "Inside: %d/%d",
-                                system_state.total_people_inside, MAX_ROOM_CAPACITY);
-                            lcd_goto(1, 0);
-                            lcd_string(line2);
-                            delay_ms(2000);
-
-                            print_statistics();
-                            gate_operate();
-
-                        } else {
-                            // Entry denied - room full
-                            send_json_rfid_scan(card, "ENTRY_DENIED_FULL", 0);
-                            
-                            /* COMMENTED OUT
-                            uart_dual_send_string("DENIED - FULL\r\n");
-                            uart_dual_send_string("=====================\r\n\r\n");
-                            */
-
-                            lcd_clear();
-                            lcd_display_centered(0, "ROOM FULL!");
-                            lcd_display_centered(1, "NO ENTRY");
-
-                            buzzer_error();
-                            led_blink_all(5);
-                            delay_ms(3000);
-                            scroll_timer = 0;
-                            led_show_occupancy();
-                            continue;
-                        }
-
-                    } else {
-                        process_exit(card_idx);
-                        
-                        // Exit recorded - send JSON
-                        send_json_rfid_scan(card, "EXIT", 1);
-                        
-                        /* COMMENTED OUT
-                        uart_dual_send_string("EXIT RECORDED\r\n");
-                        uart_dual_send_string("=====================\r\n");
-                        */
-
-                        lcd_clear();
-                        lcd_display_centered(0, "THANK YOU!");
-                        snprintf(line2, 17, "Inside: %d/%d",
-                            system_state.total_people_inside, MAX_ROOM_CAPACITY);
-                        lcd_goto(1, 0);
-                        lcd_string(line2);
-                        delay_ms(2000);
-
-                        print_statistics();
-                        gate_operate();
-                    }
-
-                    sensor_timer = 0;
+        case SCAN_CHECKING:
+            card = scan_card();
+            if(!card) {
+                scan_card_gone();
+                break;
+            }
+
+            /* COMMENTED OUT
+            sprintf(uart_buf, "Card: %s\r\n", card->card_name);
+            uart_dual_send_string(uart_buf);
+            sprintf(uart_buf, "Group: %s (1 person)\r\n", card_group_name(card));
+            uart_dual_send_string(uart_buf);
+            */
+
+            // Door of this reader decides the direction; a card last
+            // seen behind another door is refused without a move
+            scan_move = zones_route(READER_MAIN, card->zone, &scan_to_zone);
+            if(scan_move == ZONE_MOVE_INVALID) {
+                PROF_SPAN_END(PROF_SCAN_DECISION);
+                PROF_SPAN_CANCEL(PROF_SCAN_GATE);
+                scancache_record(scan_uid, SCAN_ACT_DENIED, system_tick);
+                send_json_rfid_scan(card, "ZONE_INVALID", 0);
+
+                lcd_fb_clear();
+                lcd_display_centered(0, "Access Denied!");
+                lcd_display_centered(1, "Wrong Door");
+                lcd_fb_flush();
+
+                buzzer_error();
+                scroll_timer = 0;
+                scan_state = SCAN_POLL;
+                break;
+            }
+
+#if CREDENTIAL_ENABLE
+            // Credential cards: window and zone right on every entry;
+            // one already inside may always leave
+            if(card->source == CARD_SRC_CRED && scan_move == ZONE_MOVE_IN) {
+                if(scan_cred_result == CRED_OK) {
+                    scan_cred_result = credential_check(&scan_cred, scan_to_zone,
+                                                        credential_today(millis()));
+                }
+                if(scan_cred_result != CRED_OK) {
+                    char action[24];
+
+                    PROF_SPAN_END(PROF_SCAN_DECISION);
+                    PROF_SPAN_CANCEL(PROF_SCAN_GATE);
+                    scancache_record(scan_uid, SCAN_ACT_DENIED, system_tick);
+                    sprintf(action, "CRED_%s", credential_result_name(scan_cred_result));
+                    send_json_rfid_scan(card, action, 0);
+
+                    lcd_fb_clear();
+                    lcd_display_centered(0, "Access Denied!");
+                    lcd_display_centered(1, credential_lcd_reason(scan_cred_result));
+                    lcd_fb_flush();
+
+                    buzzer_error();
                     scroll_timer = 0;
-                    delay_ms(1000);
+                    scan_state = SCAN_POLL;
+                    break;
                 }
             }
-        }
+#endif
+
+            lcd_display_card_info(card);
+            scan_state = SCAN_DECIDE;
+            task_sleep_ms(TASK_RFID, 2000);
+            break;
+
+        case SCAN_DECIDE:
+            card = scan_card();
+            if(!card) {
+                scan_card_gone();
+                break;
+            }
+
+            if(scan_move == ZONE_MOVE_IN) {
+                uint8_t granted = process_entry(scan_card_idx, scan_to_zone);
+                PROF_SPAN_END(PROF_SCAN_DECISION);
+
+                scancache_record(scan_uid,
+                    granted ? SCAN_ACT_ENTRY : SCAN_ACT_DENIED, system_tick);
+
+                if(!granted) {
+                    // Entry denied - room full
+                    PROF_SPAN_CANCEL(PROF_SCAN_GATE);
+                    send_json_rfid_scan(card, "ENTRY_DENIED_FULL", 0);
+
+                    lcd_fb_clear();
+                    lcd_display_centered(0, "ROOM FULL!");
+                    lcd_display_centered(1, "NO ENTRY");
+                    lcd_fb_flush();
+
+                    buzzer_error();
+                    led_blink_all(5);
+                    scroll_timer = 0;
+                    scan_state = SCAN_POLL;
+                    break;
+                }
+
+                // Entry granted - send JSON
+                send_json_rfid_scan(card, "ENTRY", 1);
+                scan_show_result("WELCOME!");
+
+            } else {
+                process_exit(scan_card_idx, scan_to_zone);
+                PROF_SPAN_END(PROF_SCAN_DECISION);
+                scancache_record(scan_uid, SCAN_ACT_EXIT, system_tick);
+
+                // Exit recorded - send JSON
+                send_json_rfid_scan(card, "EXIT", 1);
+
+                // A revoked card's record is released once it is out
+                carddb_card_left(scan_card_idx);
+
+                scan_show_result("THANK YOU!");
+            }
+
+            scan_state = SCAN_RESULT;
+            task_sleep_ms(TASK_RFID, 2000);
+            break;
+
+        case SCAN_RESULT:
+            print_statistics();
+            gate_operate();
+
+            scroll_timer = 0;
+            scan_state = SCAN_COOLDOWN;
+            task_sleep_ms(TASK_RFID, 1000);
+            break;
+
+        case SCAN_COOLDOWN:
+        default:
+            scan_state = SCAN_POLL;
+            break;
+    }
+}
+
+// SENSORS - Sample fast while values move, slow when stable;
+// ENV frames only go out on change, threshold crossing or heartbeat.
+// The ADC is only powered for ADC_RESUME_MS before each sample.
+void task_sensors(void) {
+    uint32_t interval_ms;
+
+    switch(sens_state) {
+        case SENS_IDLE:
+            // The boot self-test owns the DHT11 line until it has run
+            if(boot_step <= BOOT_DHT11_READ) {
+                task_sleep_ms(TASK_SENSORS, TASK_SENSORS_PERIOD_MS);
+                return;
+            }
+            ADC_Burst_Resume();
+            sens_state = SENS_ADC_WARMUP;
+            task_sleep_ms(TASK_SENSORS, ADC_RESUME_MS - DHT11_START_MS - DHT11_READ_MS);
+            return;
+
+        case SENS_ADC_WARMUP:
+            dht11_start();
+            sens_state = SENS_DHT_START;
+            task_sleep_ms(TASK_SENSORS, DHT11_START_MS);
+            return;
+
+        case SENS_DHT_START:
+            dht11_release();
+            sens_state = SENS_DHT_READ;
+            task_sleep_ms(TASK_SENSORS, DHT11_READ_MS);
+            return;
+
+        case SENS_DHT_READ:
+        default:
+            sens_state = SENS_IDLE;
+            break;
+    }
+
+    // One sample: read, evaluate, format (cycles in PERF env_report)
+    PROF_BEGIN(PROF_ENV_REPORT);
+    sensors_read();
+    ADC_Burst_Suspend();
+
+    Telemetry_Reason_t reason = telemetry_evaluate(
+        system_state.temperature_x10, system_state.humidity_x10,
+        system_state.air_quality, (uint8_t)mq135_status,
+        system_tick);
+    if(reason != TELEM_NONE) {
+        send_json_sensor_data(telemetry_reason_string(reason));
+    }
+    PROF_END(PROF_ENV_REPORT);
+
+    // Same cadence as before: the warm-up is part of the interval
+    interval_ms = (uint32_t)telemetry_sample_interval() * SYSTEM_TICK_MS;
+    task_sleep_ms(TASK_SENSORS,
+        interval_ms > ADC_RESUME_MS ? interval_ms - ADC_RESUME_MS : 0);
+}
+
+void task_telemetry(void) {
+    // SINKS - Restart a UART queue held by flow control
+    sink_service();
+    SPITRACE_SERVICE();
+
+    // UPLINK - Window refill, retransmit on timeout
+    uplink_service(millis());
+
+    // LINK - Baud negotiation / step-down on line errors
+    uartlink_service(millis());
+
+    // DENIALS - Summary of rate-limited UNKNOWN_CARD frames
+    denylimit_service(system_tick);
+
+    // FORECAST - Entry/exit rates, time-to-full alerts
+    flowrate_service(millis(), access_counts.inside, MAX_ROOM_CAPACITY);
+
+    // BOOT - Deferred self-tests and INIT frames
+    boot_selftest_service();
+}
+
+// Diagnostic reports, one per UI pass once the window closes; the
+// next waits until UART0 has drained to half a ring, so the burst
+// never crowds out scan and gate frames
+static void (* const ui_reports[])(void) = {
+    tasks_report,
+    power_report,
+#if CREDENTIAL_ENABLE
+    credential_report,
+#endif
+    zones_report,
+    uartlink_report,
+    sink_report,
+    uplink_report,
+    eventbus_report,
+    emergency_report
+};
+
+#define UI_REPORT_COUNT     (sizeof(ui_reports) / sizeof(ui_reports[0]))
+
+void task_ui(void) {
+    static uint8_t scroll_state = 0;
+    static uint8_t uptime_timer = 0;
+    static uint16_t perf_timer = 0;
+    static uint16_t task_report_timer = 0;
+    static uint8_t report_next = UI_REPORT_COUNT;
+
+    if(++uptime_timer >= 100) {
+        uptime_timer = 0;
+        system_state.system_uptime += 10;
+    }
 
-        sensor_timer++;
-        scroll_timer++;
-        uptime_timer++;
-        delay_ms(100);
+    // PERF - Profiler summary on UART0
+    if(++perf_timer >= PROF_REPORT_INTERVAL) {
+        perf_timer = 0;
+        PROF_REPORT();
+    }
+
+    // TASKS / POWER / CRED / ZONES / LINK / SINKS / UPLINK / EVENTS /
+    // EMERGENCY - CPU share, worst run, stack depth per task; awake
+    // duty, wake sources, gated clocks; credential outcomes (also
+    // rolls the credential day); zone counts; link, sink and uplink
+    // state; event queues; emergency presses
+    if(++task_report_timer >= TASKS_REPORT_MS / TASK_UI_PERIOD_MS) {
+        task_report_timer = 0;
+        report_next = 0;
+    }
+    if(report_next < UI_REPORT_COUNT && uart_tx_used(0) < UART_TX_RING_SIZE / 2) {
+        ui_reports[report_next++]();
+    }
+
+    // LCD - Finish a screen that overflowed the writer queue
+    lcd_fb_service();
+
+    // LCD - Update every 3 seconds
+    if(++scroll_timer >= LCD_UPDATE_INTERVAL) {
+        scroll_timer = 0;
+        lcd_display_scrolling(scroll_state);
+        scroll_state = (scroll_state + 1) % 3;  // Now cycles through 3 screens
+    }
+}
+
+void tasks_setup(void) {
+    tasks_init();
+
+    task_create(TASK_EVENTS, "EVENTS", task_events,
+        TASK_EVENTS_PRIO, TASK_EVENTS_PERIOD_MS, TASK_EVENTS_STACK);
+    task_create(TASK_GATE, "GATE", task_gate,
+        TASK_GATE_PRIO, TASK_GATE_PERIOD_MS, TASK_GATE_STACK);
+    task_create(TASK_RFID, "RFID", task_rfid,
+        TASK_RFID_PRIO, TASK_RFID_PERIOD_MS, TASK_RFID_STACK);
+    task_create(TASK_SENSORS, "SENSORS", task_sensors,
+        TASK_SENSORS_PRIO, TASK_SENSORS_PERIOD_MS, TASK_SENSORS_STACK);
+    task_create(TASK_TELEMETRY, "TELEMETRY", task_telemetry,
+        TASK_TELEMETRY_PRIO, TASK_TELEMETRY_PERIOD_MS, TASK_TELEMETRY_STACK);
+    task_create(TASK_UI, "UI", task_ui,
+        TASK_UI_PRIO, TASK_UI_PERIOD_MS, TASK_UI_STACK);
+
+    // Events posted before this point are picked up on the first pass
+    eventbus_set_notify(on_event_posted);
+    task_signal(TASK_EVENTS);
+}
+
+// ============================================
+// MAIN
+// ============================================
+int main(void) {
+    uint32_t tick_ms;
+
+    system_init();
+    tasks_setup();
+
+    // Reader is polled from the first pass on
+    boot_ready_ms = millis();
+    tick_ms = boot_ready_ms;
+
+    while(1) {
+        // One tick per SYSTEM_TICK_MS of elapsed millis(): the
+        // difference stays right across its 32-bit wrap
+        while(millis() - tick_ms >= SYSTEM_TICK_MS) {
+            tick_ms += SYSTEM_TICK_MS;
+            system_tick++;
+        }
+        tasks_run_once();
     }
 
     return 0;
-}
\ No newline at end of file
+}
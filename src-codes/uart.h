@@ -3,6 +3,60 @@
 
 #include <stdint.h>
 
+/* ================= Link Configuration ================= */
+#define UART0_BAUD            9600      // Debug console
+#define UART3_BAUD            9600      // ESP32 bridge, before negotiation
+#define UART_MAX_ERR_PPM      15000     // +/-1.5% per side
+
+// UART3 has no modem lines: RTS/CTS on GPIO (active low)
+#ifndef UART3_FLOW_CONTROL
+#define UART3_FLOW_CONTROL    1
+#endif
+#define UART3_RTS_PIN         (1 << 2)  // P2.2 out
+#define UART3_CTS_PIN         (1 << 3)  // P2.3 in
+#define UART3_RTS_HIGH        768       // Ring fill that raises RTS
+#define UART3_RTS_LOW         256       // Ring fill that lowers it again
+
+#define UART_TX_RING_SIZE     1024      // Per port
+#define UART3_RX_RING_SIZE    1024      // ESP32 downlink bytes
+#define UART_TX_FLUSH_MS      500       // Give up on a stuck CTS
+#define UART_TX_URGENT_SIZE   192       // One ALERT frame per port
+#define UART0_PCONP           (1 << 3)
+
+typedef struct {
+    uint16_t dl;               // DLM:DLL
+    uint8_t mul;               // FDR MulVal
+    uint8_t divadd;            // FDR DivAddVal
+    uint32_t actual;           // Resulting baud rate
+    int32_t err_ppm;
+} UartDivisor_t;
+
+typedef struct {
+    uint32_t tx_bytes;
+    uint32_t rx_bytes;
+    uint32_t line_errors;      // Overrun / parity / framing on RX
+    uint32_t cts_waits;        // FIFO loads held by the bridge
+    uint32_t rts_stops;        // Times we paused the bridge
+} Uart3_Stats_t;
+
+extern Uart3_Stats_t uart3_stats;
+
+uint32_t uart_pclk(uint8_t port);
+uint8_t uart_calc_divisor(uint32_t pclk, uint32_t baud, UartDivisor_t *d);
+uint8_t uart_set_baud(uint8_t port, uint32_t baud, UartDivisor_t *d);
+
+/* ================= TX Queues (port 0 / 3) ================= */
+uint8_t uart_tx_write(uint8_t port, const char *s, uint16_t len);
+uint8_t uart_tx_write_urgent(uint8_t port, const char *s, uint16_t len);
+void uart_tx_write_wait(uint8_t port, const char *s, uint16_t len);
+uint16_t uart_tx_used(uint8_t port);
+uint8_t uart_tx_idle(uint8_t port, uint32_t *since_us);
+uint16_t uart_tx_free(uint8_t port);
+void uart_tx_hold(uint8_t port, uint8_t on);
+void uart_tx_flush(uint8_t port);
+void uart_tx_service(void);
+uint8_t uart0_clock_gate(void);
+
 /* ================= UART0 Functions ================= */
 void UART0_Init(void);
 void uart_send_char(char c);
@@ -16,6 +70,8 @@ void uart3_send_char(char c);
 void uart3_send_string(const char *str);
 void uart3_send_hex(uint8_t value);
 char uart3_receive_char(void);
+uint8_t uart3_rx_read(uint8_t *c);
+uint32_t uart3_rx_overflows(void);
 
 /* ================= Dual UART Functions ================= */
 void uart_dual_send_char(char c);
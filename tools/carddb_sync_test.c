@@ -0,0 +1,432 @@
+/*
+ * ============================================
+ * CARD DATABASE DELTA SYNC TEST
+ * Streams a delta script through the real
+ * src-codes/CARDDB.c downlink parser, byte by
+ * byte as the UART3 RX ring hands it over, and
+ * runs scan lookups between the main-loop passes
+ * that apply it.
+ *
+ * The script mixes single DB,ADD / DB,UPD /
+ * DB,REV lines with DB,BEGIN..COMMIT batches of
+ * up to CARDDB_BATCH_MAX ops; every 50th batch is
+ * one op too large and must be refused whole.
+ * Names use the full 8 characters.
+ *
+ * A reference model follows the DB_ACK / DB_NAK
+ * replies. After every pass each lookup must
+ * agree with it, so a lookup that sees part of
+ * an open or refused batch fails the run.
+ *
+ * Reports apply throughput (ops/s on the link,
+ * host ns per op), the longest single pass (what
+ * a scan waits for) and carddb_lookup() latency
+ * percentiles while updates are streaming.
+ *
+ * Build (from the repo root):
+ *   gcc -O2 -DFLASHIDX_ENABLE=0 -DCARDMPH_ENABLE=0 -Isrc-codes \
+ *       tools/carddb_sync_test.c src-codes/CARDDB.c -o carddb_sync_test
+ *
+ * Usage:
+ *   carddb_sync_test [deltas] [baud] [seed]
+ *     deltas  ops in the script (default 50000)
+ *     baud    UART3 rate, 0 = unthrottled (default 115200)
+ *
+ * Exit status 1 on any FAIL.
+ * ============================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "CARDDB.h"
+#include "uart.h"
+
+#define POOL_SIZE        (CARDDB_MAX_CARDS * 3)     // UIDs the script draws from
+#define LIVE_MAX         (CARDDB_MAX_CARDS - 2 * CARDDB_BATCH_MAX)
+#define LOOKUPS_PER_PASS 16
+#define PASS_US          1000                       // Main loop pass
+#define TOO_LARGE_EVERY  50                         // Batches
+
+static const char *groups[] = { "DAY1", "DAY2", "DAY3", "WEEKEND", "VIP", "CREW", "ARTIST" };
+#define GROUP_N (sizeof(groups) / sizeof(groups[0]))
+
+// ============================================
+// Reference model + expected replies
+// ============================================
+typedef struct {
+    uint8_t uid[4];
+    uint8_t live;
+    char name[CARDDB_NAME_LEN];
+    uint8_t group;
+} Model_t;
+
+typedef struct {
+    uint8_t op;                 // 'A' add/upd, 'R' revoke
+    uint16_t card;              // Pool index
+    char name[CARDDB_NAME_LEN];
+    uint8_t group;
+} Op_t;
+
+typedef struct {
+    uint32_t first;             // Into ops[]
+    uint16_t n;
+    uint8_t expect_ack;
+} Unit_t;
+
+static Model_t pool[POOL_SIZE];
+static uint16_t live_n = 0;
+
+static Op_t *ops;
+static uint32_t ops_n = 0;
+static Unit_t *units;
+static uint32_t units_n = 0;
+static uint32_t unit_next = 0;      // Next unit a reply belongs to
+
+static char *script;
+static uint32_t script_len = 0;
+static uint32_t script_pos = 0;
+static uint32_t rx_avail = 0;       // Bytes in the RX ring
+
+static uint32_t acks = 0;
+static uint32_t naks = 0;
+static uint32_t reply_fail = 0;
+static uint32_t applied_ops = 0;
+
+// ============================================
+// Firmware stubs (uart / link / clock)
+// ============================================
+static uint64_t now_us = 0;
+
+uint32_t millis(void) {
+    return (uint32_t)(now_us / 1000);
+}
+
+void delay_ms(uint32_t ms) { (void)ms; }
+void delay_us(uint32_t us) { (void)us; }
+
+uint32_t uart3_rx_overflows(void) { return 0; }
+void uartlink_rx_line(char **tok, uint8_t n) { (void)tok; (void)n; }
+void uplink_ack(uint32_t seq, uint32_t now) { (void)seq; (void)now; }
+
+uint8_t uart3_rx_read(uint8_t *c) {
+    if(!rx_avail || script_pos >= script_len) return 0;
+    *c = (uint8_t)script[script_pos++];
+    rx_avail--;
+    return 1;
+}
+
+// Replies close the oldest outstanding unit
+void uart_dual_send_string(const char *s) {
+    uint8_t ack;
+    Unit_t *u;
+
+    if(strncmp(s, "DB,", 3) != 0) return;
+    ack = strstr(s, "\"DB_ACK\"") != NULL;
+    if(ack) acks++;
+    else naks++;
+
+    if(unit_next >= units_n) {
+        reply_fail++;
+        return;
+    }
+    u = &units[unit_next++];
+    if(ack != u->expect_ack) {
+        if(reply_fail < 3) printf("  unexpected reply %s", s);
+        reply_fail++;
+    }
+    if(!ack) return;
+
+    for(uint32_t i = u->first; i < u->first + u->n; i++) {
+        Model_t *m = &pool[ops[i].card];
+        if(ops[i].op == 'A') {
+            m->live = 1;
+            memcpy(m->name, ops[i].name, CARDDB_NAME_LEN);
+            m->group = ops[i].group;
+        } else {
+            m->live = 0;
+        }
+    }
+    applied_ops += u->n;
+}
+
+// ============================================
+// Random numbers (xorshift64*)
+// ============================================
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t rnd(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (uint32_t)((rng_state * 2685821657736338717ULL) >> 32);
+}
+
+// ============================================
+// Script
+// ============================================
+static void emit(const char *line) {
+    uint32_t n = (uint32_t)strlen(line);
+    memcpy(script + script_len, line, n);
+    script_len += n;
+}
+
+// One op; the script's own view of liveness keeps the store below capacity
+static void gen_op(uint8_t *plan_live, Op_t *op) {
+    char line[80];
+    uint16_t c;
+    Model_t *m;
+
+    do {
+        c = (uint16_t)(rnd() % POOL_SIZE);
+    } while(!plan_live[c] && live_n >= LIVE_MAX);
+    m = &pool[c];
+
+    op->card = c;
+    if(plan_live[c] && (live_n >= LIVE_MAX || rnd() % 3 == 0)) {
+        op->op = 'R';
+        plan_live[c] = 0;
+        live_n--;
+        sprintf(line, "DB,REV,%02X%02X%02X%02X\r\n", m->uid[0], m->uid[1], m->uid[2], m->uid[3]);
+    } else {
+        op->op = 'A';
+        snprintf(op->name, CARDDB_NAME_LEN, "P%07u", rnd() % 10000000);
+        op->group = (uint8_t)(rnd() % GROUP_N);
+        if(!plan_live[c]) live_n++;
+        plan_live[c] = 1;
+        sprintf(line, "DB,%s,%02X%02X%02X%02X,%s,%s\r\n", (rnd() & 1) ? "ADD" : "UPD",
+                m->uid[0], m->uid[1], m->uid[2], m->uid[3], op->name, groups[op->group]);
+    }
+    emit(line);
+}
+
+static void gen_script(uint32_t deltas) {
+    uint8_t *plan_live = calloc(POOL_SIZE, 1);
+    uint8_t *saved = malloc(POOL_SIZE);
+    uint32_t version = 0;
+    uint32_t batches = 0;
+    char line[40];
+
+    for(uint32_t i = 0; i < POOL_SIZE; i++) {
+        uint32_t k = rnd() | 1;                 // Distinct enough for a pool this size
+        memcpy(pool[i].uid, &k, 4);
+        for(uint32_t j = 0; j < i; j++) {
+            if(memcmp(pool[j].uid, pool[i].uid, 4) == 0) { i--; break; }
+        }
+    }
+
+    while(ops_n < deltas) {
+        Unit_t *u = &units[units_n++];
+
+        u->first = ops_n;
+        u->expect_ack = 1;
+
+        if(rnd() % 4 == 0) {
+            gen_op(plan_live, &ops[ops_n++]);
+            u->n = 1;
+            version++;
+            continue;
+        }
+
+        batches++;
+        u->n = (uint16_t)(1 + rnd() % CARDDB_BATCH_MAX);
+        if(batches % TOO_LARGE_EVERY == 0) {
+            u->n = CARDDB_BATCH_MAX + 1;
+            u->expect_ack = 0;
+            memcpy(saved, plan_live, POOL_SIZE);
+        }
+        if(u->expect_ack && ops_n + u->n > deltas) u->n = (uint16_t)(deltas - ops_n);
+
+        sprintf(line, "DB,BEGIN,%lu\r\n", (unsigned long)(version + 1));
+        emit(line);
+        {
+            uint16_t live_before = live_n;
+            for(uint16_t k = 0; k < u->n; k++) {
+                gen_op(plan_live, &ops[ops_n + k]);
+            }
+            if(u->expect_ack) {
+                ops_n += u->n;
+                version++;
+            } else {
+                // Refused: nothing of it happens, its ops are not kept
+                memcpy(plan_live, saved, POOL_SIZE);
+                live_n = live_before;
+                u->first = ops_n;
+            }
+        }
+        emit("DB,COMMIT\r\n");
+    }
+
+    free(plan_live);
+    free(saved);
+}
+
+// ============================================
+// Lookups against the model
+// ============================================
+static uint32_t lookup_fail = 0;
+
+static uint8_t lookup_ok(uint16_t c, int16_t idx) {
+    const Model_t *m = &pool[c];
+
+    if(!m->live) return idx < 0;
+    return idx >= 0 && cards[idx].is_active &&
+           strcmp(cards[idx].card_name, m->name) == 0 &&
+           strcmp(card_group_name(&cards[idx]), groups[m->group]) == 0;
+}
+
+static uint64_t ns_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// ============================================
+// Main
+// ============================================
+int main(int argc, char **argv) {
+    uint32_t deltas = (argc > 1) ? (uint32_t)atoi(argv[1]) : 50000;
+    uint32_t baud = (argc > 2) ? (uint32_t)atoi(argv[2]) : 115200;
+    uint32_t *lat;
+    uint32_t lat_n = 0;
+    uint32_t lat_cap;
+    uint32_t passes = 0;
+    uint32_t ring_full = 0;
+    uint64_t poll_ns = 0;
+    uint64_t poll_max_ns = 0;
+    uint64_t rx_credit = 0;             // Bytes x 1e6 arrived on the link
+    uint8_t fail = 0;
+
+    if(argc > 3) rng_state ^= (uint64_t)atoi(argv[3]) * 0x2545F4914F6CDD1DULL;
+    if(deltas == 0) deltas = 1;
+
+    ops = calloc(deltas + CARDDB_BATCH_MAX + 1, sizeof(Op_t));
+    units = calloc(deltas + deltas / TOO_LARGE_EVERY + 2, sizeof(Unit_t));
+    script = malloc((size_t)(deltas + deltas / 4 + 64) * 48);
+    if(!ops || !units || !script) return 2;
+
+    gen_script(deltas);
+
+    lat_cap = (script_len / 8 + 16) * LOOKUPS_PER_PASS;
+    lat = malloc((size_t)lat_cap * sizeof(uint32_t));
+    if(!lat) return 2;
+
+    carddb_init();
+
+    while(script_pos < script_len) {
+        uint64_t t0;
+        uint64_t dt;
+
+        // Link -> RX ring during the last pass
+        if(baud) {
+            rx_credit += (uint64_t)(baud / 10) * PASS_US;
+            while(rx_credit >= 1000000) {
+                rx_credit -= 1000000;
+                if(rx_avail < UART3_RX_RING_SIZE - 1) rx_avail++;
+                else ring_full++;
+            }
+        } else {
+            rx_avail = CARDDB_RX_BUDGET;
+        }
+        now_us += PASS_US;
+
+        t0 = ns_now();
+        carddb_sync_poll();
+        dt = ns_now() - t0;
+        poll_ns += dt;
+        if(dt > poll_max_ns) poll_max_ns = dt;
+        passes++;
+
+        // Scans between passes: live and unknown UIDs alike
+        for(uint8_t k = 0; k < LOOKUPS_PER_PASS; k++) {
+            uint16_t c = (uint16_t)(rnd() % POOL_SIZE);
+            int16_t idx;
+
+            t0 = ns_now();
+            idx = carddb_lookup(pool[c].uid);
+            dt = ns_now() - t0;
+            if(lat_n < lat_cap) lat[lat_n++] = (uint32_t)dt;
+
+            if(!lookup_ok(c, idx)) {
+                if(lookup_fail < 3) {
+                    printf("  lookup %02X%02X%02X%02X after pass %u: idx %d, model %s\n",
+                           pool[c].uid[0], pool[c].uid[1], pool[c].uid[2], pool[c].uid[3],
+                           passes, idx, pool[c].live ? "live" : "absent");
+                }
+                lookup_fail++;
+            }
+        }
+    }
+
+    // Whole store against the model
+    {
+        uint32_t bad = 0;
+        uint32_t live = 0;
+
+        for(uint16_t c = 0; c < POOL_SIZE; c++) {
+            if(!lookup_ok(c, card_find(pool[c].uid))) bad++;
+            live += pool[c].live;
+        }
+        if(bad) printf("  FAIL %u cards differ from the model at the end\n", bad);
+        if(live != carddb_count()) {
+            printf("  FAIL %u cards in the store, model has %u\n", carddb_count(), live);
+            bad++;
+        }
+        fail |= bad != 0;
+    }
+
+    qsort(lat, lat_n, sizeof(uint32_t), cmp_u32);
+
+    {
+        double secs = now_us / 1e6;
+        double host_s = poll_ns / 1e9;
+
+        printf("CARDDB %u slots, %u hash entries, batch max %u\n",
+               CARDDB_MAX_CARDS, CARDDB_HASH_SIZE, CARDDB_BATCH_MAX);
+        printf("script   %u ops in %u units, %u bytes (%.1f bytes/op)\n",
+               ops_n, units_n, script_len, (double)script_len / ops_n);
+        printf("replies  %u ACK, %u NAK, version %lu\n", acks, naks,
+               (unsigned long)carddb_version());
+        if(baud) {
+            printf("link     %u baud: %.1f s, %.0f ops/s applied, ring full %u bytes\n",
+                   baud, secs, applied_ops / secs, ring_full);
+        }
+        printf("apply    %u passes, host %.0f ns/op (%.2f Mops/s), longest pass %.1f us\n",
+               passes, poll_ns / (double)(applied_ops ? applied_ops : 1),
+               host_s > 0 ? applied_ops / host_s / 1e6 : 0.0, poll_max_ns / 1e3);
+        printf("lookup   %u during updates: p50 %u ns, p99 %u ns, max %u ns\n",
+               lat_n, lat_n ? lat[lat_n / 2] : 0,
+               lat_n ? lat[(uint32_t)(0.99 * (lat_n - 1))] : 0,
+               lat_n ? lat[lat_n - 1] : 0);
+    }
+
+    if(applied_ops != ops_n) {
+        printf("  FAIL %u ops applied, %u in the script\n", applied_ops, ops_n);
+        fail = 1;
+    }
+    if(reply_fail || unit_next != units_n) {
+        printf("  FAIL %u replies out of line, %u of %u units answered\n",
+               reply_fail, unit_next, units_n);
+        fail = 1;
+    }
+    if(lookup_fail) {
+        printf("  FAIL %u lookups disagreed with the model (half-applied batch)\n", lookup_fail);
+        fail = 1;
+    }
+    if(ring_full) {
+        printf("  FAIL UART3 RX ring overflowed\n");
+        fail = 1;
+    }
+
+    printf("%s\n", fail ? "FAIL" : "PASS");
+    return fail;
+}
@@ -0,0 +1,283 @@
+/*
+ * ============================================
+ * CARD TABLE (MPH) BENCHMARK
+ * Runs the real src-codes/CARDMPH.c lookup on
+ * the host against a table built by
+ * tools/cardmph_gen.py and compares it with the
+ * linear scan the firmware used before: an
+ * array of the old 44-byte Card_t records
+ * walked with is_active + memcmp(uid) per entry.
+ *
+ * The card keys come from the linked table, so
+ * one binary measures one table size. Lookups
+ * of every card (hits) and of as many random
+ * unknown UIDs (misses) are timed; the O(n)
+ * scan runs on the first 2000 of each.
+ * Checks:
+ *   - cardmph_find() returns every card's own
+ *     record and rejects every unknown UID
+ *   - it agrees with the linear scan
+ *
+ * Build and run (from the repo root), one binary
+ * per table size:
+ *   gcc -O2 -DCARDMPH_ENABLE=1 -Isrc-codes tools/cardmph_bench.c \
+ *       src-codes/CARDMPH.c src-codes/CARDMPH_DATA.c -o cardmph_bench
+ *   for n in 1000 10000 23000; do
+ *       ./cardmph_bench --csv $n > cards_$n.csv
+ *       python3 tools/cardmph_gen.py cards_$n.csv mph_$n.c
+ *       gcc -O2 -DCARDMPH_ENABLE=1 -Isrc-codes tools/cardmph_bench.c \
+ *           src-codes/CARDMPH.c mph_$n.c -o mph_$n && ./mph_$n
+ *   done
+ *   23000 is near the largest table that fits the
+ *   flash budget (CARDMPH_FLASH_BUDGET, ~23,800
+ *   cards); cardmph_gen.py refuses larger lists.
+ *
+ * Usage:
+ *   cardmph_bench [rounds]       time the linked table
+ *   cardmph_bench --csv n [seed] print a random n-card CSV
+ *
+ * Exit status 1 on any FAIL.
+ * ============================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "CARDMPH.h"
+
+// Card record of the linear-scan firmware
+typedef struct {
+    uint8_t uid[4];
+    char card_name[16];
+    char group_name[16];
+    uint16_t scan_count;
+    uint8_t is_active;
+    uint8_t is_inside;
+    uint32_t last_scan_time;
+} Legacy_Card_t;
+
+static Legacy_Card_t *legacy;
+static uint32_t legacy_n;
+static uint64_t legacy_compares = 0;
+
+// ============================================
+// Random numbers (xorshift64*)
+// ============================================
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t rnd(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (uint32_t)((rng_state * 2685821657736338717ULL) >> 32);
+}
+
+static uint64_t ns_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// ============================================
+// CSV for tools/cardmph_gen.py
+// ============================================
+static int write_csv(uint32_t n) {
+    uint32_t *keys = malloc(n * sizeof(uint32_t));
+
+    if(!keys) return 2;
+    for(uint32_t i = 0; i < n; i++) {
+        keys[i] = rnd();
+    }
+    qsort(keys, n, sizeof(uint32_t), cmp_u32);
+    for(uint32_t i = 1; i < n; i++) {
+        if(keys[i] == keys[i - 1]) {
+            keys[i] = rnd();                        // Rare: re-draw and sort again
+            qsort(keys, n, sizeof(uint32_t), cmp_u32);
+            i = 0;
+        }
+    }
+
+    printf("# %u random cards (cardmph_bench --csv)\n", n);
+    for(uint32_t i = 0; i < n; i++) {
+        uint32_t k = keys[i];
+        printf("%02X%02X%02X%02X,C%07u,PASS-%u\n",
+               k & 0xFF, (k >> 8) & 0xFF, (k >> 16) & 0xFF, k >> 24, i, i % 8);
+    }
+    free(keys);
+    return 0;
+}
+
+// ============================================
+// Linear scan (pre-index firmware card_find)
+// ============================================
+static int32_t legacy_find(const uint8_t *uid) {
+    for(uint32_t i = 0; i < legacy_n; i++) {
+        legacy_compares++;
+        if(legacy[i].is_active) {
+            if(memcmp(legacy[i].uid, uid, 4) == 0) {
+                return (int32_t)i;
+            }
+        }
+    }
+    return -1;
+}
+
+static void key_uid(uint32_t key, uint8_t *uid) {
+    uid[0] = (uint8_t)key;
+    uid[1] = (uint8_t)(key >> 8);
+    uid[2] = (uint8_t)(key >> 16);
+    uid[3] = (uint8_t)(key >> 24);
+}
+
+static uint8_t key_known(uint32_t key, const uint32_t *sorted) {
+    return bsearch(&key, sorted, cardmph_count, sizeof(uint32_t), cmp_u32) != NULL;
+}
+
+// ============================================
+// Main
+// ============================================
+int main(int argc, char **argv) {
+    uint32_t rounds = 5;
+    uint32_t n = cardmph_count;
+    uint32_t *sorted;
+    uint32_t *hits;
+    uint32_t *misses;
+    uint32_t wrong = 0;
+    uint32_t disagree = 0;
+    uint32_t legacy_rounds;
+    uint64_t t0;
+    uint64_t mph_hit_ns, mph_miss_ns, lin_hit_ns, lin_miss_ns;
+    uint64_t lin_hit_cmp, lin_miss_cmp;
+    volatile uintptr_t sink = 0;
+
+    if(argc > 1 && strcmp(argv[1], "--csv") == 0) {
+        if(argc < 3) return 2;
+        if(argc > 3) rng_state ^= (uint64_t)atoi(argv[3]) * 0x2545F4914F6CDD1DULL;
+        return write_csv((uint32_t)atoi(argv[2]));
+    }
+    if(argc > 1) rounds = (uint32_t)atoi(argv[1]);
+    if(rounds == 0) rounds = 1;
+
+    // Keys straight from the linked table; the scan array in card order
+    sorted = malloc(n * sizeof(uint32_t));
+    hits = malloc(n * sizeof(uint32_t));
+    misses = malloc(n * sizeof(uint32_t));
+    legacy = calloc(n, sizeof(Legacy_Card_t));
+    if(!sorted || !hits || !misses || !legacy) return 2;
+
+    for(uint32_t i = 0; i < n; i++) {
+        sorted[i] = cardmph_table[i].key;
+    }
+    qsort(sorted, n, sizeof(uint32_t), cmp_u32);
+    for(uint32_t i = 0; i < n; i++) {
+        key_uid(sorted[i], legacy[i].uid);
+        memcpy(legacy[i].card_name, "CARD", 5);
+        legacy[i].is_active = 1;
+    }
+    legacy_n = n;
+
+    // Scan order: shuffled cards, and as many UIDs not in the table
+    memcpy(hits, sorted, n * sizeof(uint32_t));
+    for(uint32_t i = n - 1; i > 0; i--) {
+        uint32_t j = rnd() % (i + 1);
+        uint32_t t = hits[i];
+        hits[i] = hits[j];
+        hits[j] = t;
+    }
+    for(uint32_t i = 0; i < n; i++) {
+        do { misses[i] = rnd(); } while(key_known(misses[i], sorted));
+    }
+
+    // Correctness: every card and unknown UID; the O(n) scan on a sample
+    legacy_rounds = (n > 2000) ? 2000 : n;
+    for(uint32_t i = 0; i < n; i++) {
+        uint8_t uid[4];
+        const CardMph_Record_t *rec;
+
+        key_uid(hits[i], uid);
+        rec = cardmph_find(uid);
+        if(!rec || rec->key != hits[i]) wrong++;
+        if(i < legacy_rounds && (rec != 0) != (legacy_find(uid) >= 0)) disagree++;
+
+        key_uid(misses[i], uid);
+        rec = cardmph_find(uid);
+        if(rec) wrong++;
+        if(i < legacy_rounds && (rec != 0) != (legacy_find(uid) >= 0)) disagree++;
+    }
+
+    // MPH timing
+    t0 = ns_now();
+    for(uint32_t r = 0; r < rounds; r++) {
+        for(uint32_t i = 0; i < n; i++) {
+            uint8_t uid[4];
+            key_uid(hits[i], uid);
+            sink += (uintptr_t)cardmph_find(uid);
+        }
+    }
+    mph_hit_ns = ns_now() - t0;
+
+    t0 = ns_now();
+    for(uint32_t r = 0; r < rounds; r++) {
+        for(uint32_t i = 0; i < n; i++) {
+            uint8_t uid[4];
+            key_uid(misses[i], uid);
+            sink += (uintptr_t)cardmph_find(uid);
+        }
+    }
+    mph_miss_ns = ns_now() - t0;
+
+    // Linear scan timing on the same sample
+    legacy_compares = 0;
+    t0 = ns_now();
+    for(uint32_t i = 0; i < legacy_rounds; i++) {
+        uint8_t uid[4];
+        key_uid(hits[i], uid);
+        sink += (uintptr_t)legacy_find(uid);
+    }
+    lin_hit_ns = ns_now() - t0;
+    lin_hit_cmp = legacy_compares;
+
+    legacy_compares = 0;
+    t0 = ns_now();
+    for(uint32_t i = 0; i < legacy_rounds; i++) {
+        uint8_t uid[4];
+        key_uid(misses[i], uid);
+        sink += (uintptr_t)legacy_find(uid);
+    }
+    lin_miss_ns = ns_now() - t0;
+    lin_miss_cmp = legacy_compares;
+    (void)sink;
+
+    printf("%u cards, %u buckets: MPH %u bytes const (disp %u + records %u), "
+           "linear %u bytes RAM\n\n",
+           n, cardmph_buckets,
+           (uint32_t)(cardmph_buckets * sizeof(CardMph_Disp_t) + n * sizeof(CardMph_Record_t)),
+           (uint32_t)(cardmph_buckets * sizeof(CardMph_Disp_t)),
+           (uint32_t)(n * sizeof(CardMph_Record_t)),
+           (uint32_t)(n * sizeof(Legacy_Card_t)));
+    printf("%-8s %12s %12s %14s %14s %9s\n",
+           "lookup", "hit ns", "miss ns", "hit compares", "miss compares", "speedup");
+    printf("%-8s %12.1f %12.1f %14u %14u %9s\n", "mph",
+           (double)mph_hit_ns / ((uint64_t)rounds * n),
+           (double)mph_miss_ns / ((uint64_t)rounds * n), 1, 1, "");
+    printf("%-8s %12.1f %12.1f %14.1f %14.1f %8.0fx\n", "linear",
+           (double)lin_hit_ns / legacy_rounds, (double)lin_miss_ns / legacy_rounds,
+           (double)lin_hit_cmp / legacy_rounds, (double)lin_miss_cmp / legacy_rounds,
+           ((double)lin_hit_ns / legacy_rounds) /
+           ((double)mph_hit_ns / ((uint64_t)rounds * n)));
+
+    if(wrong) printf("  FAIL %u MPH lookups returned the wrong record\n", wrong);
+    if(disagree) printf("  FAIL %u MPH lookups disagree with the linear scan\n", disagree);
+
+    printf("%s\n", (wrong || disagree) ? "FAIL" : "PASS");
+    return (wrong || disagree) ? 1 : 0;
+}
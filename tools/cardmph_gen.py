@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+"""
+============================================
+CARD TABLE MPH GENERATOR
+CSV -> C source with a minimal perfect hash
+(CHD: compress, hash, displace) and a const
+record table, for CARDMPH.c
+
+CSV columns: uid,name,group   (same as flashidx_build.py)
+  uid   8 hex digits, optional ':' separators
+  name  up to 8 characters
+  group up to 15 characters, at most 16 distinct groups
+  an optional 4th column "inactive" marks a disabled card
+
+The tables go into the MCU flash: records (16 bytes) + displacements
+(2 bytes per 4 cards) + group names must stay within
+CARDMPH_FLASH_BUDGET (CARDMPH.h, 384 KB), i.e. about 23,800 cards.
+A larger list is refused.
+
+Usage: cardmph_gen.py cards.csv CARDMPH_DATA.c
+
+Lookup on the target (must match CARDMPH.c):
+  h    = fmix32(key ^ seed)
+  b    = (h * buckets) >> 32
+  f1   = h % n
+  f2   = ((h * 0x9E3779B1) >> 16) % n
+  slot = (f1 + d0[b] * f2 + d1[b]) % n
+  hit  = table[slot].key == key
+============================================
+"""
+
+import csv
+import random
+import struct
+import sys
+
+NAME_LEN = 8
+GROUP_LEN = 16
+MAX_GROUPS = 16
+MAX_CARDS = 65535
+BUCKET_LOAD = 4             # Keys per bucket (2 bytes of flash per bucket)
+REC_ACTIVE = 0x01
+REC_SIZE = 16               # sizeof(CardMph_Record_t) on the target
+DISP_SIZE = 2               # sizeof(CardMph_Disp_t)
+FLASH_BUDGET = 384 * 1024   # CARDMPH_FLASH_BUDGET (CARDMPH.h)
+MASK32 = 0xFFFFFFFF
+
+
+def fmix32(h):
+    h ^= h >> 16
+    h = (h * 0x85EBCA6B) & MASK32
+    h ^= h >> 13
+    h = (h * 0xC2B2AE35) & MASK32
+    h ^= h >> 16
+    return h
+
+
+def parse_uid(text):
+    digits = text.replace(":", "").replace(" ", "")
+    if len(digits) != 8:
+        raise ValueError("bad UID: %r" % text)
+    return struct.unpack("<I", bytes.fromhex(digits))[0]
+
+
+def read_cards(path):
+    groups = []
+    cards = {}
+    with open(path, newline="") as f:
+        for row in csv.reader(f):
+            if not row or row[0].startswith("#"):
+                continue
+            key = parse_uid(row[0])
+            name = row[1].strip()[:NAME_LEN]
+            group = row[2].strip()[:GROUP_LEN - 1]
+            flags = 0 if (len(row) > 3 and row[3].strip().lower() == "inactive") else REC_ACTIVE
+            if group not in groups:
+                if len(groups) >= MAX_GROUPS:
+                    raise ValueError("more than %d groups" % MAX_GROUPS)
+                groups.append(group)
+            if key in cards:
+                raise ValueError("duplicate UID %08X" % key)
+            cards[key] = (name, groups.index(group), flags)
+    if not cards or len(cards) > MAX_CARDS:
+        raise ValueError("need 1..%d cards" % MAX_CARDS)
+    return cards, groups
+
+
+def flash_bytes(n, buckets, n_groups):
+    return n * REC_SIZE + buckets * DISP_SIZE + n_groups * GROUP_LEN
+
+
+def try_seed(keys, seed, buckets):
+    n = len(keys)
+    members = [[] for _ in range(buckets)]
+
+    for key in keys:
+        h = fmix32(key ^ seed)
+        f1 = h % n
+        f2 = (((h * 0x9E3779B1) & MASK32) >> 16) % n
+        members[(h * buckets) >> 32].append((key, f1, f2))
+
+    disp = [(0, 0)] * buckets
+    slots = [None] * n
+    order = sorted(range(buckets), key=lambda b: -len(members[b]))
+
+    for b in order:
+        group = members[b]
+        if not group:
+            break
+        placed = False
+        for d0 in range(256):
+            for d1 in range(256):
+                pos = [(f1 + d0 * f2 + d1) % n for _, f1, f2 in group]
+                if len(set(pos)) != len(pos) or any(slots[p] is not None for p in pos):
+                    continue
+                for (key, _, _), p in zip(group, pos):
+                    slots[p] = key
+                disp[b] = (d0, d1)
+                placed = True
+                break
+            if placed:
+                break
+        if not placed:
+            return None
+    return disp, slots
+
+
+def c_string(text):
+    return '"' + text.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def emit(path, cards, groups, seed, disp, slots, src):
+    n = len(slots)
+    out = []
+    out.append("/**")
+    out.append(" * ============================================")
+    out.append(" * CARD TABLE (GENERATED - do not edit)")
+    out.append(" * Source: %s, %d cards, %d groups" % (src, n, len(groups)))
+    out.append(" * Regenerate: tools/cardmph_gen.py")
+    out.append(" * ============================================")
+    out.append(" */")
+    out.append("")
+    out.append('#include "CARDMPH.h"')
+    out.append("")
+    out.append("#if CARDMPH_ENABLE")
+    out.append("")
+    out.append("const uint32_t cardmph_seed = 0x%08XUL;" % seed)
+    out.append("const uint16_t cardmph_count = %d;" % n)
+    out.append("const uint16_t cardmph_buckets = %d;" % len(disp))
+    out.append("const uint8_t cardmph_group_count = %d;" % len(groups))
+    out.append("")
+    out.append("const char cardmph_groups[%d][CARDMPH_GROUP_LEN] = {" % len(groups))
+    for g in groups:
+        out.append("    %s," % c_string(g))
+    out.append("};")
+    out.append("")
+    out.append("const CardMph_Disp_t cardmph_disp[%d] = {" % len(disp))
+    for i in range(0, len(disp), 8):
+        out.append("    " + " ".join("{%d, %d}," % d for d in disp[i:i + 8]))
+    out.append("};")
+    out.append("")
+    out.append("const CardMph_Record_t cardmph_table[%d] = {" % n)
+    for key in slots:
+        name, group, flags = cards[key]
+        out.append("    {0x%08XUL, %s, %d, %d}," % (key, c_string(name), group, flags))
+    out.append("};")
+    out.append("")
+    out.append("// Flash budget (CARDMPH.h)")
+    out.append("typedef char cardmph_flash_check[(sizeof(cardmph_table) + sizeof(cardmph_disp) +")
+    out.append("    sizeof(cardmph_groups) <= CARDMPH_FLASH_BUDGET) ? 1 : -1];")
+    out.append("")
+    out.append("#endif // CARDMPH_ENABLE")
+    out.append("")
+
+    with open(path, "w", newline="\r\n") as f:
+        f.write("\n".join(out))
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__)
+        sys.exit(1)
+
+    cards, groups = read_cards(sys.argv[1])
+    keys = sorted(cards)
+    buckets = max(1, (len(keys) + BUCKET_LOAD - 1) // BUCKET_LOAD)
+    size = flash_bytes(len(keys), buckets, len(groups))
+    if size > FLASH_BUDGET:
+        limit = len(keys)
+        while flash_bytes(limit, (limit + BUCKET_LOAD - 1) // BUCKET_LOAD, len(groups)) > FLASH_BUDGET:
+            limit -= 1
+        print("%d cards need %d bytes of flash, budget is %d (CARDMPH_FLASH_BUDGET): "
+              "at most %d cards" % (len(keys), size, FLASH_BUDGET, limit))
+        sys.exit(1)
+    rng = random.Random(0x4D5048)           # Reproducible output
+
+    for attempt in range(64):
+        seed = rng.getrandbits(32)
+        result = try_seed(keys, seed, buckets)
+        if result:
+            disp, slots = result
+            emit(sys.argv[2], cards, groups, seed, disp, slots, sys.argv[1].split("/")[-1])
+            print("%d cards, %d buckets, seed 0x%08X (attempt %d), %d of %d bytes of flash" %
+                  (len(keys), buckets, seed, attempt + 1, size, FLASH_BUDGET))
+            return
+
+    print("no displacement found; raise BUCKET_LOAD headroom")
+    sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
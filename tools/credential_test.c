@@ -0,0 +1,548 @@
+/*
+ * ============================================
+ * CARD CREDENTIAL HOST TEST
+ * Runs the firmware's CREDENTIAL.c and the real
+ * RC522_RFID.c driver on the host against a
+ * register model of an RC522 with a simulated
+ * MIFARE Classic 1K card (64 blocks, key A per
+ * sector trailer, select -> auth -> read/write,
+ * Crypto1 state in Status2Reg). Checks:
+ *   - SipHash-2-4 reference vectors
+ *   - issue (RC522_Write) then credential_read
+ *   - altered block, other venue key, block
+ *     copied to another UID, blank card, other
+ *     sector key, card gone after auth
+ *   - validity window before / after CRED,DAY,
+ *     day roll-over on millis(), zone rights,
+ *     CRED,REV
+ *   - Crypto1 is off after every read
+ * then verifies a large population of distinct
+ * cards with no card table at all, and times
+ * full reads through the driver (SPI transfers
+ * and modelled reader time per read).
+ *
+ * Build (from the repo root):
+ *   gcc -O2 -DPROFILE_ENABLE=0 -Isrc-codes tools/credential_test.c \
+ *       src-codes/CREDENTIAL.c src-codes/RC522_RFID.c -o credential_test
+ *
+ * Usage:
+ *   credential_test [cards] [reads]
+ *     cards  distinct credentials verified (default 100000)
+ *     reads  full driver reads timed (default 1000)
+ *
+ * Exit status 1 when a check failed.
+ * ============================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "SSP0.h"
+#include "DELAY.h"
+#include "RC522_RFID.h"
+#include "CREDENTIAL.h"
+
+#define SPI_XFER_US     6           // 2 bytes at 3.125MHz + CS / call overhead
+#define TEST_DAY        20745       // 2026-10-19
+
+static int fail = 0;
+
+// ============================================
+// Simulated MIFARE Classic 1K card
+// ============================================
+typedef struct {
+    uint8_t uid[4];
+    uint8_t blocks[64][16];
+} Card_t;
+
+static const uint8_t key_transport[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+static const uint8_t key_other[6] = {0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5};
+static const uint8_t venue_key[16] = {
+    0x3A, 0x91, 0x5C, 0x07, 0xE2, 0x48, 0xB6, 0x1D,
+    0x70, 0xC9, 0x25, 0x8E, 0x13, 0xF4, 0x6B, 0xA8
+};
+static const uint8_t other_venue_key[16] = {
+    0x3A, 0x91, 0x5C, 0x07, 0xE2, 0x48, 0xB6, 0x1D,
+    0x70, 0xC9, 0x25, 0x8E, 0x13, 0xF4, 0x6B, 0xA9
+};
+
+static void card_blank(Card_t *c, uint32_t uid, const uint8_t *key_a) {
+    memset(c, 0, sizeof(*c));
+    c->uid[0] = (uint8_t)(uid >> 24);
+    c->uid[1] = (uint8_t)(uid >> 16);
+    c->uid[2] = (uint8_t)(uid >> 8);
+    c->uid[3] = (uint8_t)uid;
+    for(uint8_t s = 0; s < 16; s++) {
+        uint8_t *t = c->blocks[s * 4 + 3];
+        memcpy(t, key_a, 6);
+        t[6] = 0xFF; t[7] = 0x07; t[8] = 0x80; t[9] = 0x69;
+        memset(t + 10, 0xFF, 6);
+    }
+}
+
+// ============================================
+// RC522 Register Model (see rc522_replay.c)
+// ============================================
+static uint8_t regs[64];
+static uint8_t fifo[64];
+static uint8_t fifo_n, fifo_rd;
+static uint32_t irq_at;
+static uint8_t irq_bits;
+static uint32_t model_us;
+static uint32_t spi_xfers;
+
+static Card_t *card;                // Card in the field, 0 = none
+static uint8_t card_halted, card_selected, card_write_step, card_write_block;
+static int8_t card_auth_sector = -1;
+static uint8_t card_leave_after_auth;
+
+static uint16_t crc_a(const uint8_t *p, uint8_t n) {
+    uint16_t crc = 0x6363;
+    for(uint8_t i = 0; i < n; i++) {
+        uint8_t b = p[i] ^ (uint8_t)crc;
+        b ^= b << 4;
+        crc = (crc >> 8) ^ ((uint16_t)b << 8) ^ ((uint16_t)b << 3) ^ (b >> 4);
+    }
+    return crc;
+}
+
+static void fifo_load(const uint8_t *p, uint8_t n, uint8_t last_bits) {
+    memcpy(fifo, p, n);
+    fifo_n = n;
+    fifo_rd = 0;
+    regs[RC522_REG_CONTROL] = last_bits;
+}
+
+static uint32_t model_timer_us(void) {
+    uint32_t pre = ((uint32_t)(regs[RC522_REG_TMODE] & 0x0F) << 8) | regs[RC522_REG_TPRESCALER];
+    uint32_t reload = ((uint32_t)regs[RC522_REG_TRELOAD_HI] << 8) | regs[RC522_REG_TRELOAD_LO];
+    return (uint32_t)((uint64_t)reload * (2 * pre + 1) * 1000000ULL / 13560000ULL);
+}
+
+static void card_idle(void) {
+    card_selected = 0;
+    card_auth_sector = -1;
+    card_write_step = 0;
+}
+
+static void model_transceive(void) {
+    uint8_t in[64], out[18];
+    uint8_t n = fifo_n - fifo_rd;
+    uint8_t ack = 0x0A;
+    uint16_t crc;
+
+    memcpy(in, fifo + fifo_rd, n);
+    fifo_n = fifo_rd = 0;
+
+    irq_bits = 0x01;
+    irq_at = model_us + model_timer_us();
+
+    if(!card || n == 0) return;
+
+    if((in[0] == PICC_CMD_REQA && !card_halted) || in[0] == PICC_CMD_WUPA) {
+        card_halted = 0;
+        card_idle();
+        out[0] = 0x04; out[1] = 0x00;
+        fifo_load(out, 2, 0);
+    } else if(card_halted) {
+        return;
+    } else if(card_write_step && n == 18) {
+        card_write_step = 0;
+        memcpy(card->blocks[card_write_block], in, 16);
+        fifo_load(&ack, 1, 4);
+    } else if(in[0] == PICC_CMD_SEL_CL1 && n == 2 && in[1] == 0x20) {
+        memcpy(out, card->uid, 4);
+        out[4] = card->uid[0] ^ card->uid[1] ^ card->uid[2] ^ card->uid[3];
+        fifo_load(out, 5, 0);
+    } else if(in[0] == PICC_CMD_SEL_CL1 && n == 9 && in[1] == 0x70 &&
+              memcmp(in + 2, card->uid, 4) == 0) {
+        card_selected = 1;
+        out[0] = 0x08;
+        crc = crc_a(out, 1);
+        out[1] = (uint8_t)crc; out[2] = (uint8_t)(crc >> 8);
+        fifo_load(out, 3, 0);
+    } else if(in[0] == PICC_CMD_HLTA) {
+        card_halted = 1;
+        card_idle();
+        return;
+    } else if(in[0] == PICC_CMD_MF_READ && n == 4 && in[1] < 64 &&
+              card_auth_sector == in[1] / 4) {
+        memcpy(out, card->blocks[in[1]], 16);
+        crc = crc_a(out, 16);
+        out[16] = (uint8_t)crc; out[17] = (uint8_t)(crc >> 8);
+        fifo_load(out, 18, 0);
+    } else if(in[0] == PICC_CMD_MF_WRITE && n == 4 && in[1] < 64 &&
+              card_auth_sector == in[1] / 4 && (in[1] & 3) != 3) {
+        card_write_step = 1;
+        card_write_block = in[1];
+        fifo_load(&ack, 1, 4);
+    } else {
+        return;                     // No answer: timeout
+    }
+
+    irq_bits = 0x30;
+    irq_at = model_us + 100 + n * 100;
+}
+
+// FIFO: mode, block, key[6], uid[4]
+static void model_authent(void) {
+    const uint8_t *in = fifo + fifo_rd;
+    uint8_t ok = card && card_selected && !card_halted && (fifo_n - fifo_rd) >= 12 &&
+                 in[0] == PICC_CMD_MF_AUTH_KEY_A && in[1] < 64 &&
+                 memcmp(in + 8, card->uid, 4) == 0 &&
+                 memcmp(in + 2, card->blocks[(in[1] / 4) * 4 + 3], 6) == 0;
+
+    fifo_n = fifo_rd = 0;
+    if(ok) {
+        card_auth_sector = (int8_t)(in[1] / 4);
+        regs[RC522_REG_STATUS2] |= 0x08;
+        irq_bits = 0x10;
+        irq_at = model_us + 1000;
+        if(card_leave_after_auth) card = 0;
+    } else {
+        // A failed auth leaves the card idle until the next REQA
+        if(card) card_idle();
+        regs[RC522_REG_STATUS2] &= ~0x08;
+        irq_bits = 0x01;
+        irq_at = model_us + model_timer_us();
+    }
+}
+
+static void model_command(uint8_t cmd) {
+    uint16_t crc;
+
+    regs[RC522_REG_COMMAND] = cmd;
+    switch(cmd) {
+        case RC522_CMD_SOFT_RESET:
+            memset(regs, 0, sizeof(regs));
+            fifo_n = fifo_rd = 0;
+            irq_bits = 0;
+            break;
+        case RC522_CMD_CALC_CRC:
+            crc = crc_a(fifo + fifo_rd, fifo_n - fifo_rd);
+            regs[RC522_REG_CRC_RESULT_L] = (uint8_t)crc;
+            regs[RC522_REG_CRC_RESULT_H] = (uint8_t)(crc >> 8);
+            regs[RC522_REG_DIVIRQ] |= 0x04;
+            break;
+        case RC522_CMD_MF_AUTHENT:
+            model_authent();
+            break;
+        default:
+            break;
+    }
+}
+
+// ============================================
+// SSP0 / DELAY / UART stubs used by the firmware
+// ============================================
+void SSP0_Write(uint8_t addr, uint8_t value) {
+    model_us += SPI_XFER_US;
+    spi_xfers++;
+
+    switch(addr) {
+        case RC522_REG_COMIRQ:
+        case RC522_REG_DIVIRQ:
+            if(value & 0x80) regs[addr] |= value & 0x7F;
+            else regs[addr] &= ~(value & 0x7F);
+            break;
+        case RC522_REG_FIFO_DATA:
+            if(fifo_n < sizeof(fifo)) fifo[fifo_n++] = value;
+            break;
+        case RC522_REG_FIFO_LEVEL:
+            if(value & 0x80) fifo_n = fifo_rd = 0;
+            break;
+        case RC522_REG_COMMAND:
+            model_command(value & 0x0F);
+            break;
+        case RC522_REG_BIT_FRAMING:
+            regs[addr] = value & 0x7F;
+            if((value & 0x80) && regs[RC522_REG_COMMAND] == RC522_CMD_TRANSCEIVE) {
+                model_transceive();
+            }
+            break;
+        default:
+            regs[addr & 0x3F] = value;
+            break;
+    }
+}
+
+uint8_t SSP0_Read(uint8_t addr) {
+    model_us += SPI_XFER_US;
+    spi_xfers++;
+
+    switch(addr) {
+        case RC522_REG_COMIRQ:
+            if(irq_bits && (int32_t)(model_us - irq_at) >= 0) {
+                regs[addr] |= irq_bits;
+                irq_bits = 0;
+            }
+            return regs[addr];
+        case RC522_REG_FIFO_DATA:
+            return (fifo_rd < fifo_n) ? fifo[fifo_rd++] : 0;
+        case RC522_REG_FIFO_LEVEL:
+            return fifo_n - fifo_rd;
+        case RC522_REG_VERSION:
+            return 0x92;
+        default:
+            return regs[addr & 0x3F];
+    }
+}
+
+void delay_ms(uint32_t ms) { model_us += ms * 1000; }
+void delay_us(uint32_t us) { model_us += us; }
+
+static uint32_t now_ms;
+uint32_t millis(void) { return now_ms; }
+
+static char last_frame[512];
+void uart_dual_send_string(const char *str) {
+    strncpy(last_frame, str, sizeof(last_frame) - 1);
+}
+
+// ============================================
+// Scan / issue through the driver
+// ============================================
+static uint8_t poll_uid(uint8_t *uid) {
+    uint8_t tag[2];
+
+    if(RC522_Request(PICC_CMD_REQA, tag) != MI_OK) return 0;
+    return RC522_Anticoll(uid) == MI_OK;
+}
+
+static Credential_Result_t scan(Card_t *c, Credential_t *out) {
+    uint8_t uid[5];
+
+    card = c;
+    card_halted = 0;
+    if(!poll_uid(uid)) return CRED_RESULT_COUNT;
+    return credential_read(uid, out);
+}
+
+// Issuer station: transport key A, write the block
+static uint8_t issue(Card_t *c, const Credential_t *cred, const uint8_t *key) {
+    uint8_t uid[5], block[16];
+    uint8_t ok;
+
+    credential_set_key(key);
+    card = c;
+    card_halted = 0;
+    ok = poll_uid(uid) && RC522_SelectTag(uid) == MI_OK &&
+         RC522_Auth(PICC_CMD_MF_AUTH_KEY_A, CREDENTIAL_BLOCK, (uint8_t *)key_transport, uid) == MI_OK;
+    if(ok) {
+        credential_encode(cred, uid, block);
+        ok = RC522_Write(CREDENTIAL_BLOCK, block) == MI_OK;
+    }
+    RC522_StopCrypto();
+    credential_set_key(venue_key);
+    return ok;
+}
+
+static void expect(const char *name, Credential_Result_t got, Credential_Result_t want) {
+    int ok = (got == want);
+
+    printf("  %-40s %-14s %-14s%s\n", name,
+        got < CRED_RESULT_COUNT ? credential_result_name(got) : "NO_CARD",
+        credential_result_name(want), ok ? "" : "  FAIL");
+    if(!ok) fail = 1;
+}
+
+static void expect_true(const char *name, int cond) {
+    printf("  %-40s %-29s%s\n", name, cond ? "yes" : "no", cond ? "" : "  FAIL");
+    if(!cond) fail = 1;
+}
+
+static void rx(const char *op, const char *arg) {
+    char l0[8], l1[8], l2[16];
+    char *tok[3] = {l0, l1, l2};
+
+    strcpy(l0, "CRED");
+    strcpy(l1, op);
+    strcpy(l2, arg);
+    credential_rx_line(tok, 3);
+}
+
+static double elapsed_ns(const struct timespec *t0, const struct timespec *t1) {
+    return (t1->tv_sec - t0->tv_sec) * 1e9 + (t1->tv_nsec - t0->tv_nsec);
+}
+
+int main(int argc, char **argv) {
+    uint32_t n_cards = (argc > 1) ? (uint32_t)strtoul(argv[1], 0, 10) : 100000;
+    uint32_t n_reads = (argc > 2) ? (uint32_t)strtoul(argv[2], 0, 10) : 1000;
+    static Card_t c1, c2;
+    Credential_t cred, got;
+    Credential_t base = {7, TEST_DAY - 30, TEST_DAY + 30, 0x0003};
+    uint8_t key[16], msg[15];
+
+    now_ms = 0;
+    RC522_Init();
+    credential_init();
+    credential_set_key(venue_key);
+
+    // ----------------------------------------
+    printf("siphash-2-4 reference (key 00..0f, msg 00..len-1)\n");
+    for(uint8_t i = 0; i < 16; i++) key[i] = i;
+    for(uint8_t i = 0; i < 15; i++) msg[i] = i;
+    expect_true("len 0  = 726fdb47dd0e0e31", credential_siphash(key, msg, 0) == 0x726fdb47dd0e0e31ULL);
+    expect_true("len 8  = 93f5f5799a932462", credential_siphash(key, msg, 8) == 0x93f5f5799a932462ULL);
+    expect_true("len 15 = a129ca6149be45e5", credential_siphash(key, msg, 15) == 0xa129ca6149be45e5ULL);
+
+    // ----------------------------------------
+    printf("card reads                                 got            expected\n");
+    card_blank(&c1, 0xF352222A, key_transport);
+    expect_true("issue over the reader (RC522_Write)", issue(&c1, &base, venue_key));
+    expect("issued card", scan(&c1, &got), CRED_OK);
+    expect_true("fields read back",
+        got.group_id == base.group_id && got.valid_from == base.valid_from &&
+        got.valid_until == base.valid_until && got.zones == base.zones);
+    expect_true("Crypto1 off after the read", !(regs[RC522_REG_STATUS2] & 0x08));
+
+    c2 = c1;
+    c2.blocks[CREDENTIAL_BLOCK][1] ^= 0x01;
+    expect("group byte altered", scan(&c2, &got), CRED_BAD_MAC);
+    c2 = c1;
+    c2.blocks[CREDENTIAL_BLOCK][15] ^= 0x80;
+    expect("MAC byte altered", scan(&c2, &got), CRED_BAD_MAC);
+    c2 = c1;
+    c2.blocks[CREDENTIAL_BLOCK][5] = 0xFF;
+    expect("validity extended", scan(&c2, &got), CRED_BAD_MAC);
+
+    card_blank(&c2, 0x0A0B0C0D, key_transport);
+    memcpy(c2.blocks[CREDENTIAL_BLOCK], c1.blocks[CREDENTIAL_BLOCK], 16);
+    expect("block copied to another UID", scan(&c2, &got), CRED_BAD_MAC);
+
+    card_blank(&c2, 0x0A0B0C0D, key_transport);
+    issue(&c2, &base, other_venue_key);
+    expect("issued for another venue", scan(&c2, &got), CRED_BAD_MAC);
+
+    card_blank(&c2, 0x11223344, key_transport);
+    expect("blank card", scan(&c2, &got), CRED_BLANK);
+    expect_true("Crypto1 off after the read", !(regs[RC522_REG_STATUS2] & 0x08));
+
+    card_blank(&c2, 0x11223344, key_other);
+    expect("other sector key", scan(&c2, &got), CRED_NO_SECTOR);
+
+    card_leave_after_auth = 1;
+    expect("card gone after auth", scan(&c1, &got), CRED_READ_ERR);
+    card_leave_after_auth = 0;
+
+    expect("no card in the field", scan(0, &got), CRED_RESULT_COUNT);
+
+    // ----------------------------------------
+    printf("entry checks                               got            expected\n");
+    cred = base;
+    expect("in window, zone 1", credential_check(&cred, 1, TEST_DAY), CRED_OK);
+    expect("in window, zone 2", credential_check(&cred, 2, TEST_DAY), CRED_OK);
+    expect("zone 3 not granted", credential_check(&cred, 3, TEST_DAY), CRED_NO_ZONE);
+    expect("last valid day", credential_check(&cred, 1, base.valid_until), CRED_OK);
+    expect("day after valid_until", credential_check(&cred, 1, base.valid_until + 1), CRED_EXPIRED);
+    cred.zones = 0x7FFF;
+    expect("zone 17, rights 1..15", credential_check(&cred, 17, TEST_DAY), CRED_NO_ZONE);
+    cred.zones = CREDENTIAL_ZONES_ALL;
+    expect("zone 40, all zones", credential_check(&cred, 40, TEST_DAY), CRED_OK);
+
+    cred = base;
+    cred.valid_from = TEST_DAY + 5;
+    expect("future card, day not synced", credential_check(&cred, 1, credential_today(now_ms)), CRED_OK);
+    cred.valid_until = CREDENTIAL_BUILD_DAY - 1;
+    cred.valid_from = 0;
+    expect("expired before build, not synced", credential_check(&cred, 1, credential_today(now_ms)), CRED_EXPIRED);
+
+    now_ms = 5000;
+    rx("DAY", "20745");
+    expect_true("CRED,DAY acked", strstr(last_frame, "CRED_ACK") != 0);
+    cred = base;
+    cred.valid_from = TEST_DAY + 5;
+    expect("future card, day synced", credential_check(&cred, 1, credential_today(now_ms)), CRED_NOT_YET_VALID);
+    now_ms += 5 * CREDENTIAL_DAY_MS;
+    expect_true("day rolls on millis (+5 days)", credential_today(now_ms) == TEST_DAY + 5);
+    expect("future card, 5 days later", credential_check(&cred, 1, credential_today(now_ms)), CRED_OK);
+    now_ms = 5000 + 4000000000UL;           // Across the 2^32 ms wrap
+    expect_true("day across the millis wrap", credential_today(now_ms + 300000000UL) ==
+        TEST_DAY + (uint16_t)((4000000000ULL + 300000000ULL) / CREDENTIAL_DAY_MS));
+
+    rx("REV", "F352222A");
+    expect_true("CRED,REV acked", strstr(last_frame, "CRED_ACK") != 0);
+    expect("revoked card", scan(&c1, &got), CRED_REVOKED);
+    rx("REV", "F35222");
+    expect_true("CRED,REV short UID refused", strstr(last_frame, "BAD_CMD") != 0);
+    rx("DAY", "x1");
+    expect_true("CRED,DAY garbage refused", strstr(last_frame, "BAD_ARG") != 0);
+
+    // ----------------------------------------
+    {
+        struct timespec t0, t1;
+        uint8_t uid[4], block[16];
+        uint32_t accepted = 0, forged = 0;
+        uint64_t x = 0x9E3779B97F4A7C15ULL;
+
+        // Any number of cards: each carries its own credential
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for(uint32_t i = 0; i < n_cards; i++) {
+            Credential_t c = base;
+
+            uid[0] = (uint8_t)(i >> 24) ^ 0x5A; uid[1] = (uint8_t)(i >> 16);
+            uid[2] = (uint8_t)(i >> 8); uid[3] = (uint8_t)i;
+            c.group_id = (uint8_t)i;
+            credential_encode(&c, uid, block);
+            if(credential_verify(block, uid, &got) == CRED_OK && got.group_id == c.group_id) {
+                accepted++;
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        printf("population\n");
+        printf("  %lu distinct cards, %lu accepted, card table 0 bytes, %.0f ns/encode+verify\n",
+            (unsigned long)n_cards, (unsigned long)accepted,
+            n_cards ? elapsed_ns(&t0, &t1) / n_cards : 0.0);
+        expect_true("every card accepted", accepted == n_cards);
+
+        // Random MACs for one UID/payload: none may pass
+        credential_encode(&base, uid, block);
+        for(uint32_t i = 0; i < n_cards; i++) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            memcpy(block + CREDENTIAL_MAC_OFFSET, &x, 8);
+            if(credential_verify(block, uid, &got) == CRED_OK) forged++;
+        }
+        printf("  %lu random MACs, %lu accepted\n", (unsigned long)n_cards, (unsigned long)forged);
+        expect_true("no forged MAC accepted", forged == 0);
+    }
+
+    {
+        struct timespec t0, t1;
+        uint32_t us_read = 0, x_read = 0, ok = 0;
+
+        card_blank(&c2, 0x35649450, key_transport);
+        issue(&c2, &base, venue_key);
+
+        // Only credential_read(): the REQA/anticoll poll runs for every card
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for(uint32_t i = 0; i < n_reads; i++) {
+            uint8_t uid[5];
+            uint32_t us0, x0;
+
+            card = &c2;
+            card_halted = 0;
+            if(!poll_uid(uid)) continue;
+            us0 = model_us;
+            x0 = spi_xfers;
+            if(credential_read(uid, &got) == CRED_OK) ok++;
+            us_read += model_us - us0;
+            x_read += spi_xfers - x0;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        printf("driver reads (select + auth + read + stop crypto, after the poll)\n");
+        printf("  %lu reads, %lu ok, %.1f SPI transfers/read, %.2f ms modelled/read, %.0f ns host/scan\n",
+            (unsigned long)n_reads, (unsigned long)ok,
+            n_reads ? (double)x_read / n_reads : 0.0,
+            n_reads ? us_read / 1000.0 / n_reads : 0.0,
+            n_reads ? elapsed_ns(&t0, &t1) / n_reads : 0.0);
+        expect_true("every read accepted", ok == n_reads);
+    }
+
+    credential_report();
+    printf("%s", last_frame);
+    printf("%s\n", fail ? "FAIL" : "PASS");
+    return fail;
+}
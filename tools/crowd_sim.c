@@ -0,0 +1,955 @@
+/*
+ * ============================================
+ * CROWD SIMULATOR
+ * Discrete-event model of a venue with N gates,
+ * linked against the firmware's own logic:
+ *   ACCESS.c   entry/exit decision, capacity check
+ *   ZONES.c    door routing and zone counts
+ *   CARDDB.c   card store, carddb_lookup()
+ *   FLOWRATE.c time-to-full forecast alerts
+ * Each gate is one reader on the street <-> venue
+ * door; a scan goes carddb_lookup -> zones_route
+ * -> access_entry / access_exit as in main.c.
+ *
+ * Visitors arrive in groups, queue at the
+ * shortest gate together, stay for a dwell time
+ * once the whole group is settled and leave
+ * through the shortest exit gate. A visitor
+ * refused for a full venue retries after a wait
+ * and gives up after max_retries.
+ *
+ * Scenarios come from an INI file; keys before
+ * the first [section] are defaults for all of
+ * them. Every scenario x replication is its own
+ * process (the firmware modules keep global
+ * state), run up to -j at a time.
+ *
+ * Build (from the repo root):
+ *   gcc -O2 -DCARDDB_MAX_CARDS=32000 -DCARDDB_HASH_BITS=16 \
+ *       -DFLASHIDX_ENABLE=0 -DCARDMPH_ENABLE=0 -Isrc-codes \
+ *       tools/crowd_sim.c src-codes/ACCESS.c src-codes/ZONES.c \
+ *       src-codes/CARDDB.c src-codes/FLOWRATE.c -lm -o crowd_sim
+ *
+ * Usage:
+ *   crowd_sim scenarios.ini [-j jobs]
+ *
+ * Keys (defaults in sim_defaults below):
+ *   visitors, gates, exit_gates (last k gates are exit only),
+ *   capacity (0 = unbounded), arrival = poisson | peak | batch,
+ *   window_s, peak_at (0..1, peak), batch_interval_s (batch),
+ *   group_p = p1,p2,... (group size 1,2,... weights),
+ *   dwell = exp | lognormal | fixed, dwell_mean_s, dwell_sd_s,
+ *   service_s, service_sd_s (lognormal; sd 0 = fixed),
+ *   deny_s, retry_s (exp mean), max_retries, reps, seed
+ * ============================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "ACCESS.h"
+#include "ZONES.h"
+#include "CARDDB.h"
+#include "FLOWRATE.h"
+
+#define ZONE_VENUE       1
+#define MAX_SCENARIOS    64
+#define MAX_GROUP_SIZE   16
+#define SAMPLE_S         10.0       // flowrate_service() period
+#define WINDOW_S         300.0      // Throughput window for the peak rate
+
+// ============================================
+// Scenario
+// ============================================
+enum { ARR_POISSON, ARR_PEAK, ARR_BATCH };
+enum { DW_EXP, DW_LOGNORMAL, DW_FIXED };
+
+typedef struct {
+    char name[32];
+    uint32_t visitors;
+    uint16_t gates;
+    uint16_t exit_gates;
+    uint32_t capacity;
+    uint8_t arrival;
+    double window_s;
+    double peak_at;
+    double batch_interval_s;
+    double group_p[MAX_GROUP_SIZE];
+    uint8_t group_max;
+    uint8_t dwell;
+    double dwell_mean_s;
+    double dwell_sd_s;
+    double service_s;
+    double service_sd_s;
+    double deny_s;
+    double retry_s;
+    uint8_t max_retries;
+    uint16_t reps;
+    uint32_t seed;
+} Scenario_t;
+
+static const Scenario_t sim_defaults = {
+    "default", 50000, 8, 0, 20000, ARR_POISSON, 7200.0, 0.3, 300.0,
+    {0.5, 0.25, 0.15, 0.1}, 4, DW_EXP, 5400.0, 1800.0,
+    4.0, 1.5, 3.0, 600.0, 2, 4, 1
+};
+
+// Results of one run (sent back over a pipe)
+typedef struct {
+    uint32_t visitors;
+    uint32_t groups;
+    uint32_t entries;
+    uint32_t exits;
+    uint32_t denied_full;           // access_entry() refusals
+    uint32_t turned_away;           // Gave up after max_retries
+    uint32_t store_full;            // carddb_add() failed: no slot
+    uint32_t zone_invalid;
+    uint32_t forecast_alerts;       // CAPACITY_FORECAST frames
+    uint32_t count_errors;          // Firmware totals vs simulator
+    uint32_t peak_inside;
+    uint32_t q_max;
+    uint64_t events;
+    double makespan_s;
+    double entries_ph;              // Over first..last entry
+    double peak_entries_ph;         // Best WINDOW_S window
+    double exits_ph;
+    double q_mean;                  // Time-averaged, all gates
+    double wait_in_mean, wait_in_p50, wait_in_p95, wait_in_max;
+    double wait_out_mean, wait_out_p95, wait_out_max;
+    double gate_util_mean, gate_util_max;
+    double full_s;                  // Time at capacity
+    double wall_s;
+} SimResult_t;
+
+// ============================================
+// Firmware stubs (uart / link / clock)
+// ============================================
+static double sim_now;
+
+uint32_t millis(void) {
+    return (uint32_t)(sim_now * 1000.0);
+}
+
+void delay_ms(uint32_t ms) { (void)ms; }
+void delay_us(uint32_t us) { (void)us; }
+
+void uart_dual_send_string(const char *s) { (void)s; }
+uint32_t uart3_rx_overflows(void) { return 0; }
+uint8_t uart3_rx_read(uint8_t *c) { (void)c; return 0; }
+void uartlink_rx_line(char **tok, uint8_t n) { (void)tok; (void)n; }
+void uplink_ack(uint32_t seq, uint32_t now) { (void)seq; (void)now; }
+
+// ============================================
+// Random numbers (xorshift64*)
+// ============================================
+static uint64_t rng_state;
+
+static double rnd(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return ((rng_state * 2685821657736338717ULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double rnd_exp(double mean) {
+    return -mean * log(1.0 - rnd());
+}
+
+static double rnd_normal(void) {
+    double u = rnd(), v = rnd();
+    return sqrt(-2.0 * log(1.0 - u)) * cos(6.283185307179586 * v);
+}
+
+// Lognormal with the given mean and sd (sd 0 = fixed)
+static double rnd_lognormal(double mean, double sd) {
+    double s2;
+
+    if(sd <= 0.0) return mean;
+    s2 = log(1.0 + (sd * sd) / (mean * mean));
+    return exp(log(mean) - 0.5 * s2 + sqrt(s2) * rnd_normal());
+}
+
+// ============================================
+// Event Queue (binary heap on time, then seq)
+// ============================================
+enum { EV_ARRIVE, EV_SERVICE_DONE, EV_RETRY, EV_DWELL_END, EV_SAMPLE };
+
+typedef struct {
+    double t;
+    uint64_t seq;
+    uint32_t id;
+    uint8_t type;
+} Event_t;
+
+static Event_t *heap;
+static uint32_t heap_n, heap_cap;
+static uint64_t heap_seq;
+
+static int ev_before(const Event_t *a, const Event_t *b) {
+    return a->t < b->t || (a->t == b->t && a->seq < b->seq);
+}
+
+static void ev_push(double t, uint8_t type, uint32_t id) {
+    uint32_t i;
+
+    if(heap_n == heap_cap) {
+        heap_cap = heap_cap ? heap_cap * 2 : 1024;
+        heap = realloc(heap, heap_cap * sizeof(Event_t));
+    }
+    i = heap_n++;
+    heap[i].t = t;
+    heap[i].seq = heap_seq++;
+    heap[i].id = id;
+    heap[i].type = type;
+
+    while(i && ev_before(&heap[i], &heap[(i - 1) / 2])) {
+        Event_t tmp = heap[i];
+        heap[i] = heap[(i - 1) / 2];
+        heap[(i - 1) / 2] = tmp;
+        i = (i - 1) / 2;
+    }
+}
+
+static Event_t ev_pop(void) {
+    Event_t top = heap[0];
+    uint32_t i = 0;
+
+    heap[0] = heap[--heap_n];
+    for(;;) {
+        uint32_t l = 2 * i + 1, r = l + 1, m = i;
+        if(l < heap_n && ev_before(&heap[l], &heap[m])) m = l;
+        if(r < heap_n && ev_before(&heap[r], &heap[m])) m = r;
+        if(m == i) break;
+        Event_t tmp = heap[i];
+        heap[i] = heap[m];
+        heap[m] = tmp;
+        i = m;
+    }
+    return top;
+}
+
+// ============================================
+// Model State
+// ============================================
+enum { P_ARRIVING, P_QUEUED_IN, P_INSIDE, P_QUEUED_OUT, P_DONE, P_GAVE_UP };
+enum { OUT_ENTRY, OUT_DENIED, OUT_EXIT, OUT_INVALID };
+
+typedef struct {
+    uint8_t uid[4];
+    uint32_t group;
+    uint8_t state;
+    uint8_t attempts;
+    double queued_at;
+} Person_t;
+
+typedef struct {
+    uint32_t first;
+    uint16_t size;
+    uint16_t pending;               // Members not yet in or given up
+    uint16_t inside;
+} Group_t;
+
+typedef struct {
+    uint32_t *q;
+    uint32_t head, tail, cap;       // Ring, grows on demand
+    uint8_t can_in, can_out;
+    uint8_t busy;
+    uint8_t outcome;
+    uint32_t person;
+    double busy_s;
+} Gate_t;
+
+static const Scenario_t *sc;
+static Person_t *people;
+static Group_t *groups;
+static Gate_t *gates;
+static uint32_t n_people, n_groups;
+
+static uint32_t q_total;
+static double q_area, q_last_t;
+static double full_since = -1.0;
+
+static double *waits_in, *waits_out;
+static uint32_t n_waits_in, n_waits_out;
+static uint32_t *window_entries;
+static uint32_t n_windows;
+static double first_entry_t = -1.0, last_entry_t, first_exit_t = -1.0, last_exit_t;
+
+static SimResult_t res;
+
+static uint32_t q_len(const Gate_t *g) {
+    return g->tail - g->head;
+}
+
+static void q_account(void) {
+    q_area += q_total * (sim_now - q_last_t);
+    q_last_t = sim_now;
+}
+
+static uint16_t gate_pick(uint8_t exit) {
+    uint16_t best = 0;
+    uint32_t best_load = UINT32_MAX;
+
+    for(uint16_t i = 0; i < sc->gates; i++) {
+        uint32_t load;
+        if(exit ? !gates[i].can_out : !gates[i].can_in) continue;
+        load = q_len(&gates[i]) + gates[i].busy;
+        if(load < best_load) {
+            best_load = load;
+            best = i;
+        }
+    }
+    return best;
+}
+
+static double sample_dwell(void) {
+    switch(sc->dwell) {
+        case DW_FIXED: return sc->dwell_mean_s;
+        case DW_LOGNORMAL: return rnd_lognormal(sc->dwell_mean_s, sc->dwell_sd_s);
+        default: return rnd_exp(sc->dwell_mean_s);
+    }
+}
+
+static void record_wait(double w, uint8_t exit) {
+    if(exit) waits_out[n_waits_out++] = w;
+    else waits_in[n_waits_in++] = w;
+}
+
+// ============================================
+// Gate: the scan as main.c makes it
+// ============================================
+static void gate_start(uint16_t gi) {
+    Gate_t *g = &gates[gi];
+    Person_t *p;
+    int16_t idx;
+    uint8_t to_zone;
+    ZoneMove_t move;
+    double dur;
+    uint32_t tick = (uint32_t)(sim_now * 10.0);     // ~100 ms main-loop ticks
+
+    if(g->busy || q_len(g) == 0) return;
+
+    q_account();
+    g->person = g->q[g->head++ % g->cap];
+    q_total--;
+    p = &people[g->person];
+    record_wait(sim_now - p->queued_at, p->state == P_QUEUED_OUT);
+
+    idx = carddb_lookup(p->uid);
+    move = (idx < 0) ? ZONE_MOVE_INVALID : zones_route(gi, cards[idx].zone, &to_zone);
+
+    if(move == ZONE_MOVE_INVALID) {
+        g->outcome = OUT_INVALID;
+        dur = sc->deny_s;
+    } else if(move == ZONE_MOVE_IN) {
+        if(access_entry(&cards[idx], to_zone, tick)) {
+            g->outcome = OUT_ENTRY;
+            dur = rnd_lognormal(sc->service_s, sc->service_sd_s);
+        } else {
+            g->outcome = OUT_DENIED;
+            dur = sc->deny_s;
+        }
+    } else {
+        access_exit(&cards[idx], to_zone, tick);
+        carddb_card_left(idx);
+        g->outcome = OUT_EXIT;
+        dur = rnd_lognormal(sc->service_s, sc->service_sd_s);
+    }
+
+    g->busy = 1;
+    g->busy_s += dur;
+    ev_push(sim_now + dur, EV_SERVICE_DONE, gi);
+}
+
+static void gate_enqueue(uint16_t gi, uint32_t person, uint8_t state) {
+    Gate_t *g = &gates[gi];
+
+    if(q_len(g) == g->cap) {
+        uint32_t ncap = g->cap ? g->cap * 2 : 64;
+        uint32_t *nq = malloc(ncap * sizeof(uint32_t));
+        for(uint32_t i = 0; i < g->cap; i++) nq[i] = g->q[(g->head + i) % g->cap];
+        free(g->q);
+        g->q = nq;
+        g->tail = g->cap;
+        g->head = 0;
+        g->cap = ncap;
+    }
+
+    q_account();
+    g->q[g->tail++ % g->cap] = person;
+    q_total++;
+    if(q_total > res.q_max) res.q_max = q_total;
+
+    people[person].state = state;
+    people[person].queued_at = sim_now;
+    gate_start(gi);
+}
+
+static void venue_changed(void) {
+    uint32_t inside = (uint32_t)zones[ZONE_VENUE].count;
+
+    if(inside > res.peak_inside) res.peak_inside = inside;
+
+    if(sc->capacity && inside >= sc->capacity) {
+        if(full_since < 0) full_since = sim_now;
+    } else if(full_since >= 0) {
+        res.full_s += sim_now - full_since;
+        full_since = -1.0;
+    }
+}
+
+static void visitor_leaves(Person_t *p, uint8_t state) {
+    p->state = state;
+    carddb_revoke(p->uid);              // Not inside: frees the slot
+}
+
+static void group_settled(uint32_t gid) {
+    Group_t *grp = &groups[gid];
+
+    if(grp->pending) return;
+    if(grp->inside) ev_push(sim_now + sample_dwell(), EV_DWELL_END, gid);
+}
+
+static void service_done(uint16_t gi) {
+    Gate_t *g = &gates[gi];
+    Person_t *p = &people[g->person];
+    Group_t *grp = &groups[p->group];
+
+    g->busy = 0;
+
+    switch(g->outcome) {
+        case OUT_ENTRY:
+            res.entries++;
+            if(first_entry_t < 0) first_entry_t = sim_now;
+            last_entry_t = sim_now;
+            if(sim_now / WINDOW_S < n_windows) window_entries[(uint32_t)(sim_now / WINDOW_S)]++;
+            p->state = P_INSIDE;
+            grp->inside++;
+            grp->pending--;
+            group_settled(p->group);
+            break;
+
+        case OUT_DENIED:
+            res.denied_full++;
+            if(++p->attempts > sc->max_retries) {
+                res.turned_away++;
+                visitor_leaves(p, P_GAVE_UP);
+                grp->pending--;
+                group_settled(p->group);
+            } else {
+                p->state = P_ARRIVING;
+                ev_push(sim_now + rnd_exp(sc->retry_s), EV_RETRY, g->person);
+            }
+            break;
+
+        case OUT_EXIT:
+            res.exits++;
+            if(first_exit_t < 0) first_exit_t = sim_now;
+            last_exit_t = sim_now;
+            visitor_leaves(p, P_DONE);
+            break;
+
+        default:
+            res.zone_invalid++;
+            visitor_leaves(p, P_GAVE_UP);
+            break;
+    }
+
+    venue_changed();
+    gate_start(gi);
+}
+
+// ============================================
+// Arrivals
+// ============================================
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double arrival_time(uint32_t g, uint32_t n_groups_est) {
+    double u = rnd(), w = sc->window_s, m = sc->peak_at;
+
+    switch(sc->arrival) {
+        case ARR_PEAK:
+            // Triangular density on [0, w], mode at peak_at * w
+            if(u < m) return w * sqrt(u * m);
+            return w * (1.0 - sqrt((1.0 - u) * (1.0 - m)));
+        case ARR_BATCH: {
+            // Buses: groups in equal loads every batch_interval_s
+            uint32_t loads = (uint32_t)(w / sc->batch_interval_s) + 1;
+            uint32_t per = (n_groups_est + loads - 1) / loads;
+            return (g / per) * sc->batch_interval_s + rnd_exp(30.0);
+        }
+        default:
+            return u * w;
+    }
+}
+
+static uint16_t group_size(void) {
+    double tot = 0, u;
+
+    for(uint8_t i = 0; i < sc->group_max; i++) tot += sc->group_p[i];
+    u = rnd() * tot;
+    for(uint8_t i = 0; i < sc->group_max; i++) {
+        if(u < sc->group_p[i]) return i + 1;
+        u -= sc->group_p[i];
+    }
+    return sc->group_max;
+}
+
+static void build_population(void) {
+    double mean = 0, tot = 0, *times;
+
+    for(uint8_t i = 0; i < sc->group_max; i++) {
+        mean += (i + 1) * sc->group_p[i];
+        tot += sc->group_p[i];
+    }
+    mean = tot > 0 ? mean / tot : 1.0;
+
+    people = calloc(sc->visitors, sizeof(Person_t));
+    groups = calloc(sc->visitors, sizeof(Group_t));
+    n_people = n_groups = 0;
+
+    while(n_people < sc->visitors) {
+        Group_t *grp = &groups[n_groups];
+        uint16_t size = group_size();
+
+        if(size > sc->visitors - n_people) size = sc->visitors - n_people;
+        grp->first = n_people;
+        grp->size = size;
+        for(uint16_t k = 0; k < size; k++) {
+            Person_t *p = &people[n_people];
+            uint32_t key = n_people + 1;
+
+            p->uid[0] = (uint8_t)(key >> 24);
+            p->uid[1] = (uint8_t)(key >> 16);
+            p->uid[2] = (uint8_t)(key >> 8);
+            p->uid[3] = (uint8_t)key;
+            p->group = n_groups;
+            n_people++;
+        }
+        n_groups++;
+    }
+
+    times = malloc(n_groups * sizeof(double));
+    for(uint32_t g = 0; g < n_groups; g++) {
+        times[g] = arrival_time(g, (uint32_t)(sc->visitors / mean) + 1);
+    }
+    qsort(times, n_groups, sizeof(double), cmp_double);
+    for(uint32_t g = 0; g < n_groups; g++) ev_push(times[g], EV_ARRIVE, g);
+    free(times);
+}
+
+static void group_arrives(uint32_t gid) {
+    Group_t *grp = &groups[gid];
+    uint16_t gi = gate_pick(0);
+    char gname[8];
+
+    // Cards are handed out at the door; the group is the card group
+    snprintf(gname, sizeof(gname), "G%u", grp->size);
+    for(uint16_t k = 0; k < grp->size; k++) {
+        Person_t *p = &people[grp->first + k];
+        char name[CARDDB_NAME_LEN];
+
+        snprintf(name, sizeof(name), "V%u", (grp->first + k) % 1000000);
+        if(carddb_add(p->uid, name, gname) < 0) {
+            res.store_full++;
+            p->state = P_GAVE_UP;
+            continue;
+        }
+        grp->pending++;
+        gate_enqueue(gi, grp->first + k, P_QUEUED_IN);
+    }
+}
+
+static void dwell_end(uint32_t gid) {
+    Group_t *grp = &groups[gid];
+    uint16_t gi = gate_pick(1);
+
+    for(uint16_t k = 0; k < grp->size; k++) {
+        uint32_t pi = grp->first + k;
+        if(people[pi].state == P_INSIDE) gate_enqueue(gi, pi, P_QUEUED_OUT);
+    }
+}
+
+// ============================================
+// One Run
+// ============================================
+static double percentile(double *v, uint32_t n, double q) {
+    if(!n) return 0;
+    return v[(uint32_t)(q * (n - 1))];
+}
+
+static void run(const Scenario_t *s, uint32_t rep) {
+    struct timespec w0, w1;
+    double mean;
+
+    clock_gettime(CLOCK_MONOTONIC, &w0);
+    sc = s;
+    rng_state = 0x9E3779B97F4A7C15ULL ^ ((uint64_t)s->seed << 32) ^ (rep + 1) * 0xD1B54A32D192ED03ULL;
+    memset(&res, 0, sizeof(res));
+
+    carddb_init();
+    zones_init();
+    zones_define(ZONE_VENUE, "VENUE", (uint16_t)s->capacity);
+    for(uint16_t i = 0; i < s->gates; i++) {
+        zones_add_door((uint8_t)i, ZONE_OUTSIDE, ZONE_VENUE);
+    }
+    access_reset();
+    sim_now = 0;
+    flowrate_init(millis());
+
+    gates = calloc(s->gates, sizeof(Gate_t));
+    for(uint16_t i = 0; i < s->gates; i++) {
+        uint8_t exit_only = s->exit_gates && i >= s->gates - s->exit_gates;
+        gates[i].can_in = !exit_only;
+        gates[i].can_out = !s->exit_gates || exit_only;
+    }
+
+    build_population();
+    waits_in = malloc(n_people * (s->max_retries + 1) * sizeof(double));
+    waits_out = malloc(n_people * sizeof(double));
+    n_windows = (uint32_t)(4 * (s->window_s + s->dwell_mean_s) / WINDOW_S) + 16;
+    window_entries = calloc(n_windows, sizeof(uint32_t));
+    ev_push(SAMPLE_S, EV_SAMPLE, 0);
+
+    while(heap_n) {
+        Event_t ev = ev_pop();
+
+        sim_now = ev.t;
+        res.events++;
+        switch(ev.type) {
+            case EV_ARRIVE:       group_arrives(ev.id); break;
+            case EV_SERVICE_DONE: service_done((uint16_t)ev.id); break;
+            case EV_RETRY:        gate_enqueue(gate_pick(0), ev.id, P_QUEUED_IN); break;
+            case EV_DWELL_END:    dwell_end(ev.id); break;
+            case EV_SAMPLE:
+                flowrate_service(millis(), access_counts.inside, (int16_t)s->capacity);
+                if(heap_n) ev_push(sim_now + SAMPLE_S, EV_SAMPLE, 0);
+                break;
+        }
+        if(ev.type != EV_SAMPLE) res.makespan_s = sim_now;
+    }
+    q_account();
+    venue_changed();
+
+    // The firmware's totals must agree with the model's
+    if(access_counts.inside != 0 || zones[ZONE_VENUE].count != 0) res.count_errors++;
+    if(access_counts.entries != (uint16_t)res.entries) res.count_errors++;
+    if(access_counts.exits != (uint16_t)res.exits) res.count_errors++;
+    if(carddb_count() != 0) res.count_errors++;
+
+    res.visitors = n_people;
+    res.groups = n_groups;
+    res.forecast_alerts = flowrate_stats.alerts;
+    res.q_mean = res.makespan_s > 0 ? q_area / res.makespan_s : 0;
+    if(last_entry_t > first_entry_t) res.entries_ph = res.entries * 3600.0 / (last_entry_t - first_entry_t);
+    if(last_exit_t > first_exit_t) res.exits_ph = res.exits * 3600.0 / (last_exit_t - first_exit_t);
+    for(uint32_t w = 0; w < n_windows; w++) {
+        double r = window_entries[w] * 3600.0 / WINDOW_S;
+        if(r > res.peak_entries_ph) res.peak_entries_ph = r;
+    }
+
+    qsort(waits_in, n_waits_in, sizeof(double), cmp_double);
+    qsort(waits_out, n_waits_out, sizeof(double), cmp_double);
+    mean = 0;
+    for(uint32_t i = 0; i < n_waits_in; i++) mean += waits_in[i];
+    res.wait_in_mean = n_waits_in ? mean / n_waits_in : 0;
+    res.wait_in_p50 = percentile(waits_in, n_waits_in, 0.50);
+    res.wait_in_p95 = percentile(waits_in, n_waits_in, 0.95);
+    res.wait_in_max = n_waits_in ? waits_in[n_waits_in - 1] : 0;
+    mean = 0;
+    for(uint32_t i = 0; i < n_waits_out; i++) mean += waits_out[i];
+    res.wait_out_mean = n_waits_out ? mean / n_waits_out : 0;
+    res.wait_out_p95 = percentile(waits_out, n_waits_out, 0.95);
+    res.wait_out_max = n_waits_out ? waits_out[n_waits_out - 1] : 0;
+
+    mean = 0;
+    for(uint16_t i = 0; i < s->gates; i++) {
+        double u = res.makespan_s > 0 ? gates[i].busy_s / res.makespan_s : 0;
+        mean += u;
+        if(u > res.gate_util_max) res.gate_util_max = u;
+    }
+    res.gate_util_mean = mean / s->gates;
+
+    clock_gettime(CLOCK_MONOTONIC, &w1);
+    res.wall_s = (w1.tv_sec - w0.tv_sec) + (w1.tv_nsec - w0.tv_nsec) * 1e-9;
+}
+
+// ============================================
+// Scenario File
+// ============================================
+static int scenario_set(Scenario_t *s, const char *k, const char *v) {
+    if(!strcmp(k, "visitors")) s->visitors = (uint32_t)atol(v);
+    else if(!strcmp(k, "gates")) s->gates = (uint16_t)atoi(v);
+    else if(!strcmp(k, "exit_gates")) s->exit_gates = (uint16_t)atoi(v);
+    else if(!strcmp(k, "capacity")) s->capacity = (uint32_t)atol(v);
+    else if(!strcmp(k, "arrival")) {
+        if(!strcmp(v, "poisson")) s->arrival = ARR_POISSON;
+        else if(!strcmp(v, "peak")) s->arrival = ARR_PEAK;
+        else if(!strcmp(v, "batch")) s->arrival = ARR_BATCH;
+        else return 0;
+    }
+    else if(!strcmp(k, "window_s")) s->window_s = atof(v);
+    else if(!strcmp(k, "peak_at")) s->peak_at = atof(v);
+    else if(!strcmp(k, "batch_interval_s")) s->batch_interval_s = atof(v);
+    else if(!strcmp(k, "group_p")) {
+        char buf[256], *tok;
+        snprintf(buf, sizeof(buf), "%s", v);
+        s->group_max = 0;
+        for(tok = strtok(buf, ","); tok && s->group_max < MAX_GROUP_SIZE; tok = strtok(0, ",")) {
+            s->group_p[s->group_max++] = atof(tok);
+        }
+    }
+    else if(!strcmp(k, "dwell")) {
+        if(!strcmp(v, "exp")) s->dwell = DW_EXP;
+        else if(!strcmp(v, "lognormal")) s->dwell = DW_LOGNORMAL;
+        else if(!strcmp(v, "fixed")) s->dwell = DW_FIXED;
+        else return 0;
+    }
+    else if(!strcmp(k, "dwell_mean_s")) s->dwell_mean_s = atof(v);
+    else if(!strcmp(k, "dwell_sd_s")) s->dwell_sd_s = atof(v);
+    else if(!strcmp(k, "service_s")) s->service_s = atof(v);
+    else if(!strcmp(k, "service_sd_s")) s->service_sd_s = atof(v);
+    else if(!strcmp(k, "deny_s")) s->deny_s = atof(v);
+    else if(!strcmp(k, "retry_s")) s->retry_s = atof(v);
+    else if(!strcmp(k, "max_retries")) s->max_retries = (uint8_t)atoi(v);
+    else if(!strcmp(k, "reps")) s->reps = (uint16_t)atoi(v);
+    else if(!strcmp(k, "seed")) s->seed = (uint32_t)atol(v);
+    else return 0;
+    return 1;
+}
+
+static char* trim(char *s) {
+    char *e;
+    while(*s == ' ' || *s == '\t') s++;
+    e = s + strlen(s);
+    while(e > s && (e[-1] == ' ' || e[-1] == '\t' || e[-1] == '\r' || e[-1] == '\n')) *--e = '\0';
+    return s;
+}
+
+static int scenarios_load(const char *path, Scenario_t *list, int max) {
+    Scenario_t defaults = sim_defaults;
+    Scenario_t *cur = &defaults;
+    char line[512];
+    int n = 0, ln = 0;
+    FILE *f = fopen(path, "r");
+
+    if(!f) {
+        perror(path);
+        return -1;
+    }
+
+    while(fgets(line, sizeof(line), f)) {
+        char *s = trim(line), *eq;
+
+        ln++;
+        if(!*s || *s == '#' || *s == ';') continue;
+        if(*s == '[') {
+            char *e = strchr(s, ']');
+            if(!e || n >= max) { fprintf(stderr, "%s:%d: bad section\n", path, ln); fclose(f); return -1; }
+            *e = '\0';
+            list[n] = defaults;
+            snprintf(list[n].name, sizeof(list[n].name), "%s", s + 1);
+            cur = &list[n++];
+            continue;
+        }
+        eq = strchr(s, '=');
+        if(!eq) { fprintf(stderr, "%s:%d: expected key = value\n", path, ln); fclose(f); return -1; }
+        *eq = '\0';
+        if(!scenario_set(cur, trim(s), trim(eq + 1))) {
+            fprintf(stderr, "%s:%d: bad key or value '%s'\n", path, ln, trim(s));
+            fclose(f);
+            return -1;
+        }
+    }
+    fclose(f);
+
+    for(int i = 0; i < n; i++) {
+        Scenario_t *s = &list[i];
+        if(s->gates == 0 || s->gates > ZONE_READER_MAX || s->exit_gates >= s->gates ||
+           s->capacity > 32767 || s->reps == 0 || s->group_max == 0) {
+            fprintf(stderr, "%s: scenario [%s] out of range "
+                            "(gates 1..%d, exit_gates < gates, capacity <= 32767)\n",
+                    path, s->name, ZONE_READER_MAX);
+            return -1;
+        }
+    }
+    return n;
+}
+
+// ============================================
+// Report (mean / min / max over replications)
+// ============================================
+#define FIELD(f)  offsetof(SimResult_t, f)
+
+typedef struct {
+    const char *label;
+    size_t off;
+    uint8_t is_double;
+} Metric_t;
+
+static const Metric_t metrics[] = {
+    {"entries",              FIELD(entries), 0},
+    {"exits",                FIELD(exits), 0},
+    {"entries/h",            FIELD(entries_ph), 1},
+    {"peak entries/h (5m)",  FIELD(peak_entries_ph), 1},
+    {"exits/h",              FIELD(exits_ph), 1},
+    {"queue mean",           FIELD(q_mean), 1},
+    {"queue max",            FIELD(q_max), 0},
+    {"entry wait mean s",    FIELD(wait_in_mean), 1},
+    {"entry wait p50 s",     FIELD(wait_in_p50), 1},
+    {"entry wait p95 s",     FIELD(wait_in_p95), 1},
+    {"entry wait max s",     FIELD(wait_in_max), 1},
+    {"exit wait mean s",     FIELD(wait_out_mean), 1},
+    {"exit wait p95 s",      FIELD(wait_out_p95), 1},
+    {"gate util mean",       FIELD(gate_util_mean), 1},
+    {"gate util max",        FIELD(gate_util_max), 1},
+    {"peak inside",          FIELD(peak_inside), 0},
+    {"time at capacity s",   FIELD(full_s), 1},
+    {"denied (full)",        FIELD(denied_full), 0},
+    {"turned away",          FIELD(turned_away), 0},
+    {"no card slot",         FIELD(store_full), 0},
+    {"zone invalid",         FIELD(zone_invalid), 0},
+    {"forecast alerts",      FIELD(forecast_alerts), 0},
+    {"makespan s",           FIELD(makespan_s), 1},
+    {"count errors",         FIELD(count_errors), 0},
+};
+
+static double metric_get(const SimResult_t *r, const Metric_t *m) {
+    const char *p = (const char *)r + m->off;
+    if(m->is_double) return *(const double *)p;
+    return *(const uint32_t *)p;
+}
+
+static void report(const Scenario_t *s, const SimResult_t *r, uint16_t n) {
+    printf("[%s] %u visitors, %u gates (%u exit only), capacity %u, %u reps\n",
+           s->name, s->visitors, s->gates, s->exit_gates, s->capacity, n);
+    printf("  %-22s %12s %12s %12s\n", "", "mean", "min", "max");
+
+    for(size_t i = 0; i < sizeof(metrics) / sizeof(metrics[0]); i++) {
+        double sum = 0, lo = 0, hi = 0;
+        for(uint16_t k = 0; k < n; k++) {
+            double v = metric_get(&r[k], &metrics[i]);
+            sum += v;
+            if(k == 0 || v < lo) lo = v;
+            if(k == 0 || v > hi) hi = v;
+        }
+        printf("  %-22s %12.1f %12.1f %12.1f\n", metrics[i].label, sum / n, lo, hi);
+    }
+    printf("\n");
+}
+
+// ============================================
+// Parallel Runs (one process per replication)
+// ============================================
+typedef struct {
+    int scenario;
+    uint16_t rep;
+    pid_t pid;
+    int fd;
+} Job_t;
+
+int main(int argc, char **argv) {
+    static Scenario_t list[MAX_SCENARIOS];
+    SimResult_t *results;
+    Job_t *jobs;
+    int n, jobs_max = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t n_jobs = 0, next = 0, running = 0, done = 0;
+    uint32_t *base;
+    struct timespec w0, w1;
+    double wall, sim_s = 0, cpu_s = 0;
+
+    if(argc < 2) {
+        fprintf(stderr, "usage: %s scenarios.ini [-j jobs]\n", argv[0]);
+        return 2;
+    }
+    if(argc > 3 && !strcmp(argv[2], "-j")) jobs_max = atoi(argv[3]);
+    if(jobs_max < 1) jobs_max = 1;
+
+    n = scenarios_load(argv[1], list, MAX_SCENARIOS);
+    if(n <= 0) {
+        if(n == 0) fprintf(stderr, "%s: no [scenario] sections\n", argv[1]);
+        return 2;
+    }
+
+    base = calloc(n, sizeof(uint32_t));
+    for(int i = 0; i < n; i++) {
+        base[i] = n_jobs;
+        n_jobs += list[i].reps;
+    }
+    jobs = calloc(n_jobs, sizeof(Job_t));
+    results = calloc(n_jobs, sizeof(SimResult_t));
+    for(int i = 0; i < n; i++) {
+        for(uint16_t r = 0; r < list[i].reps; r++) {
+            jobs[base[i] + r].scenario = i;
+            jobs[base[i] + r].rep = r;
+        }
+    }
+
+    fflush(stdout);
+    clock_gettime(CLOCK_MONOTONIC, &w0);
+    while(done < n_jobs) {
+        int status;
+        pid_t pid;
+
+        while(running < (uint32_t)jobs_max && next < n_jobs) {
+            Job_t *j = &jobs[next];
+            int fds[2];
+
+            if(pipe(fds) != 0) { perror("pipe"); return 2; }
+            j->pid = fork();
+            if(j->pid == 0) {
+                close(fds[0]);
+                run(&list[j->scenario], j->rep);
+                if(write(fds[1], &res, sizeof(res)) != (ssize_t)sizeof(res)) _exit(1);
+                _exit(0);
+            }
+            if(j->pid < 0) { perror("fork"); return 2; }
+            close(fds[1]);
+            j->fd = fds[0];
+            next++;
+            running++;
+        }
+
+        pid = wait(&status);
+        if(pid < 0) break;
+        for(uint32_t i = 0; i < next; i++) {
+            if(jobs[i].pid != pid) continue;
+            if(read(jobs[i].fd, &results[i], sizeof(SimResult_t)) != (ssize_t)sizeof(SimResult_t)) {
+                fprintf(stderr, "run %s/%u failed\n", list[jobs[i].scenario].name, jobs[i].rep);
+                return 1;
+            }
+            close(jobs[i].fd);
+            break;
+        }
+        running--;
+        done++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &w1);
+    wall = (w1.tv_sec - w0.tv_sec) + (w1.tv_nsec - w0.tv_nsec) * 1e-9;
+
+    for(int i = 0; i < n; i++) {
+        report(&list[i], &results[base[i]], list[i].reps);
+    }
+    for(uint32_t i = 0; i < n_jobs; i++) {
+        sim_s += results[i].makespan_s;
+        cpu_s += results[i].wall_s;
+    }
+    printf("%u runs on %d jobs: %.1f simulated hours in %.2f s wall "
+           "(%.2f s CPU), %.0fx real time\n",
+           n_jobs, jobs_max, sim_s / 3600.0, wall, cpu_s, wall > 0 ? sim_s / wall : 0);
+
+    for(uint32_t i = 0; i < n_jobs; i++) {
+        if(results[i].count_errors) return 1;
+    }
+    return 0;
+}
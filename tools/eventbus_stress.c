@@ -0,0 +1,211 @@
+/*
+ * ============================================
+ * EVENT BUS STRESS TEST
+ * Runs the firmware's EVENTBUS.c on the host
+ * with one producer thread per queue (standing
+ * in for the interrupt handlers) and the main
+ * thread as the dispatcher. Every event carries
+ * its producer's attempt counter and its
+ * complement, so the consumer can check:
+ *   - per-queue order (seq strictly increasing)
+ *   - payload and type intact (no torn slots)
+ *   - seq gaps == the queue's drop count
+ *   - delivered + drops == attempts
+ *   - EV_QUEUE_LOST only after drops, hwm <= size
+ *
+ * Build (from the repo root):
+ *   gcc -O2 -pthread -DEVENTBUS_HOST -Isrc-codes \
+ *       tools/eventbus_stress.c src-codes/EVENTBUS.c -o eventbus_stress
+ *   (add -fsanitize=thread to check the barriers)
+ *
+ * Usage:
+ *   eventbus_stress [events_per_queue] [burst] [consumer_delay]
+ *     burst           posts per producer before it yields (default 4,
+ *                     0 = never; on one core a producer then fills its
+ *                     queue for a whole time slice)
+ *     consumer_delay  spin iterations after each dispatch (forces drops)
+ * ============================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "EVENTBUS.h"
+
+// ============================================
+// Firmware stubs
+// ============================================
+uint32_t millis(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000u + ts.tv_nsec / 1000000u);
+}
+
+void uart_dual_send_string(char *str) {
+    fputs(str, stdout);
+}
+
+// ============================================
+// Producers
+// ============================================
+typedef struct {
+    pthread_t thread;
+    uint8_t queue;
+    uint32_t attempts;
+    uint32_t burst;
+    uint32_t drops_seen;            // Posts that returned 0
+    volatile int done;
+} Producer_t;
+
+// Type follows the seq, so a torn slot shows up as a type mismatch
+static uint8_t seq_type(uint32_t seq) {
+    return (uint8_t)(EV_CARD_DETECTED + seq % (EV_UART_RX_LINE - EV_CARD_DETECTED + 1));
+}
+
+static void *producer_main(void *arg) {
+    Producer_t *p = (Producer_t *)arg;
+    uint32_t data[2];
+
+    for(uint32_t seq = 0; seq < p->attempts; seq++) {
+        data[0] = seq;
+        data[1] = ~seq;
+        if(!eventbus_post(p->queue, seq_type(seq), p->queue, data, sizeof(data))) {
+            p->drops_seen++;
+        }
+        if(p->burst && (seq % p->burst) == p->burst - 1) sched_yield();
+    }
+
+    __atomic_store_n(&p->done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// ============================================
+// Consumer checks
+// ============================================
+typedef struct {
+    uint64_t received;
+    uint64_t gaps;                  // Sum of skipped seqs
+    uint32_t next_seq;
+    uint32_t order_errors;
+    uint32_t payload_errors;
+    uint32_t lost_events;
+} Check_t;
+
+static Check_t checks[EVQ_COUNT];
+
+static void on_event(const Event_t *ev) {
+    Check_t *c;
+    uint32_t data[2];
+
+    if(ev->arg >= EVQ_COUNT || ev->len != sizeof(data)) {
+        checks[0].payload_errors++;
+        return;
+    }
+
+    c = &checks[ev->arg];
+    memcpy(data, ev->data, sizeof(data));
+
+    if(data[1] != ~data[0] || ev->type != seq_type(data[0])) c->payload_errors++;
+
+    if(data[0] < c->next_seq) {
+        c->order_errors++;
+    } else {
+        c->gaps += data[0] - c->next_seq;
+        c->next_seq = data[0] + 1;
+    }
+    c->received++;
+}
+
+static void on_lost(const Event_t *ev) {
+    if(ev->arg < EVQ_COUNT) checks[ev->arg].lost_events++;
+}
+
+static volatile uint32_t spin_sink;
+
+int main(int argc, char **argv) {
+    uint32_t events = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 2000000;
+    uint32_t burst = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 4;
+    uint32_t delay = (argc > 3) ? (uint32_t)strtoul(argv[3], NULL, 0) : 0;
+    Producer_t prod[EVQ_COUNT];
+    struct timespec t0, t1;
+    uint64_t dispatched = 0;
+    uint32_t empty_passes = 0;
+    int fail = 0;
+
+    eventbus_init();
+    for(uint8_t t = EV_CARD_DETECTED; t <= EV_UART_RX_LINE; t++) eventbus_subscribe(t, on_event);
+    eventbus_subscribe(EV_QUEUE_LOST, on_lost);
+
+    memset(prod, 0, sizeof(prod));
+    memset(checks, 0, sizeof(checks));
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(uint8_t q = 0; q < EVQ_COUNT; q++) {
+        prod[q].queue = q;
+        prod[q].attempts = events;
+        prod[q].burst = burst;
+        pthread_create(&prod[q].thread, NULL, producer_main, &prod[q]);
+    }
+
+    // Dispatch until every producer is done and two passes come back empty
+    for(;;) {
+        uint16_t n = eventbus_dispatch(EVENTBUS_DISPATCH_BUDGET);
+        uint8_t all_done = 1;
+
+        dispatched += n;
+        for(uint32_t i = 0; i < delay; i++) spin_sink += i;
+
+        for(uint8_t q = 0; q < EVQ_COUNT; q++) {
+            if(!__atomic_load_n(&prod[q].done, __ATOMIC_ACQUIRE)) all_done = 0;
+        }
+
+        if(all_done && n == 0) {
+            if(++empty_passes >= 2) break;
+        } else {
+            empty_passes = 0;
+            if(n == 0) sched_yield();
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    for(uint8_t q = 0; q < EVQ_COUNT; q++) pthread_join(prod[q].thread, NULL);
+
+    printf("queue size     attempts   delivered       drops  gaps_ok  lost_ev  hwm  order  payload\n");
+    for(uint8_t q = 0; q < EVQ_COUNT; q++) {
+        const EventBus_QueueStats_t *s = eventbus_queue_stats(q);
+        Check_t *c = &checks[q];
+        int ok;
+
+        c->gaps += prod[q].attempts - c->next_seq;     // Drops after the last delivery
+        ok = c->order_errors == 0 && c->payload_errors == 0 &&
+             c->gaps == s->drops && s->drops == prod[q].drops_seen &&
+             c->received + s->drops == prod[q].attempts &&
+             s->posted == c->received && s->hwm <= s->size &&
+             (s->drops ? c->lost_events > 0 && c->lost_events <= s->drops
+                       : c->lost_events == 0) &&
+             eventbus_depth(q) == 0;
+
+        printf("%5u %4u %12u %11llu %11lu %8s %8u %4u %6u %8u%s\n",
+            q, s->size, prod[q].attempts, (unsigned long long)c->received,
+            (unsigned long)s->drops, c->gaps == s->drops ? "yes" : "NO",
+            c->lost_events, s->hwm, c->order_errors, c->payload_errors,
+            ok ? "" : "  FAIL");
+        if(!ok) fail = 1;
+    }
+
+    {
+        double sec = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+        printf("dispatched %llu in %.2f s (%.1f M events/s), unhandled %lu\n",
+            (unsigned long long)dispatched, sec, dispatched / sec / 1e6,
+            (unsigned long)eventbus_stats.unhandled);
+    }
+
+    eventbus_report();
+    printf("%s\n", fail ? "FAIL" : "PASS");
+    return fail;
+}
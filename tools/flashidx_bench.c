@@ -0,0 +1,401 @@
+/*
+ * ============================================
+ * FLASH INDEX PAGE CACHE BENCHMARK
+ * Runs the real src-codes/FLASHIDX.c on the
+ * host with FLASHIDX_SIM: pages come from a RAM
+ * image laid out like tools/flashidx_build.py
+ * writes it, and every page read is charged the
+ * SSP0 time it takes on the board (READ command,
+ * 3 address bytes, 256 data bytes at 3.125MHz).
+ *
+ * Scan traces replayed against the flash tier
+ * alone (no RAM store in front), each lookup
+ * followed by the group name fetch tier_load()
+ * does:
+ *   uniform  any card, 5% unknown UIDs
+ *   rolls    parties of 2-6 cards from the same
+ *            issue roll (consecutive UIDs)
+ *   rescan   40% re-taps of one of the last 20
+ *            cards (passback, repeat taps)
+ *   trace    UIDs from a file, one hex UID per
+ *            line (e.g. cut from a UART0 log)
+ *
+ * Reports page hit rate, SPI bytes and the SPI
+ * time per lookup (mean, p99, max). Checks:
+ *   - every card found with its record, unknown
+ *     UIDs not found
+ *   - a cold lookup reads at most two pages
+ *   - a warm re-tap reads nothing
+ *
+ * Build (from the repo root):
+ *   gcc -O2 -DFLASHIDX_ENABLE=1 -DFLASHIDX_SIM -DPROFILE_ENABLE=0 \
+ *       -Isrc-codes tools/flashidx_bench.c src-codes/FLASHIDX.c \
+ *       -o flashidx_bench
+ *   (add -DFLASHIDX_CACHE_PAGES=n to compare cache sizes)
+ *
+ * Usage:
+ *   flashidx_bench [cards] [scans] [seed]
+ *   flashidx_bench --trace uids.txt [cards]
+ *
+ * Exit status 1 on any FAIL.
+ * ============================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "FLASHIDX.h"
+
+#define ROLL_SIZE       50          // Cards per issue roll (consecutive UIDs)
+#define GROUPS          6
+#define SPI_HZ          3125000     // PCLK 25MHz / CPSR 8
+#define SPI_CMD_BYTES   4           // READ + 24-bit address
+#define TRACE_MAX       1000000
+
+// ============================================
+// Image (same layout as flashidx_build.py)
+// ============================================
+static uint8_t *image;
+static uint32_t image_size;
+static uint32_t *keys;              // Sorted card keys
+static uint32_t card_count;
+
+static void wr32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint8_t key_group(uint32_t key) {
+    return (uint8_t)((key >> 7) % GROUPS);
+}
+
+static void key_name(uint32_t key, char *name) {
+    char buf[12];
+    snprintf(buf, sizeof(buf), "S%07u", key % 10000000);
+    memcpy(name, buf, 8);
+}
+
+static void image_build(void) {
+    uint32_t leaf_count = (card_count + FLASHIDX_LEAF_RECORDS - 1) / FLASHIDX_LEAF_RECORDS;
+    uint32_t inner_count = (leaf_count + FLASHIDX_INNER_KEYS - 1) / FLASHIDX_INNER_KEYS;
+    uint32_t group_page = 1;
+    uint32_t leaf_page = 2;
+    uint32_t inner_page = leaf_page + leaf_count;
+    uint32_t root_page = inner_page + inner_count;
+    FlashIdx_Header_t hdr;
+
+    // Root keys run on over as many pages as they need
+    image_size = root_page * FLASHIDX_PAGE_SIZE +
+                 (inner_count * 4 + FLASHIDX_PAGE_SIZE - 1) / FLASHIDX_PAGE_SIZE * FLASHIDX_PAGE_SIZE;
+    image = malloc(image_size);
+    memset(image, 0xFF, image_size);
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = FLASHIDX_MAGIC;
+    hdr.version = FLASHIDX_VERSION;
+    hdr.page_size = FLASHIDX_PAGE_SIZE;
+    hdr.record_count = card_count;
+    hdr.group_page = group_page;
+    hdr.leaf_page = leaf_page;
+    hdr.leaf_count = leaf_count;
+    hdr.inner_page = inner_page;
+    hdr.inner_count = inner_count;
+    hdr.root_page = root_page;
+    hdr.root_count = (uint16_t)inner_count;
+    hdr.group_count = GROUPS;
+    memcpy(image, &hdr, sizeof(hdr));
+
+    for(uint8_t g = 0; g < GROUPS; g++) {
+        char *p = (char *)image + group_page * FLASHIDX_PAGE_SIZE + g * FLASHIDX_GROUP_LEN;
+        memset(p, 0, FLASHIDX_GROUP_LEN);
+        snprintf(p, FLASHIDX_GROUP_LEN, "PASS-%u", g);
+    }
+
+    for(uint32_t i = 0; i < card_count; i++) {
+        uint32_t leaf = i / FLASHIDX_LEAF_RECORDS;
+        FlashIdx_Record_t rec;
+
+        memset(&rec, 0, sizeof(rec));
+        rec.key = keys[i];
+        key_name(keys[i], rec.name);
+        rec.group = key_group(keys[i]);
+        rec.flags = FLASHIDX_REC_ACTIVE;
+        memcpy(image + (leaf_page + leaf) * FLASHIDX_PAGE_SIZE +
+               (i % FLASHIDX_LEAF_RECORDS) * sizeof(rec), &rec, sizeof(rec));
+
+        if(i % FLASHIDX_LEAF_RECORDS == 0) {
+            uint32_t inner = leaf / FLASHIDX_INNER_KEYS;
+            wr32(image + (inner_page + inner) * FLASHIDX_PAGE_SIZE +
+                 (leaf % FLASHIDX_INNER_KEYS) * 4, keys[i]);
+            if(leaf % FLASHIDX_INNER_KEYS == 0) {
+                wr32(image + root_page * FLASHIDX_PAGE_SIZE + inner * 4, keys[i]);
+            }
+        }
+    }
+
+    flashidx_sim_image = image;
+    flashidx_sim_size = image_size;
+}
+
+// ============================================
+// Random numbers (xorshift64*)
+// ============================================
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t rnd(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (uint32_t)((rng_state * 2685821657736338717ULL) >> 32);
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Cards issued in rolls of consecutive UIDs; keys sorted, no duplicates
+static void population(uint32_t n) {
+    uint32_t i = 0;
+
+    keys = malloc(n * sizeof(uint32_t));
+    while(i < n) {
+        uint32_t base = rnd() & 0xFFFFFF00u;
+        for(uint32_t k = 0; k < ROLL_SIZE && i < n; k++) {
+            keys[i++] = base + k;
+        }
+    }
+    qsort(keys, n, sizeof(uint32_t), cmp_u32);
+
+    for(i = 1; i < n; i++) {
+        if(keys[i] == keys[i - 1]) {
+            keys[i] = rnd() & 0xFFFFFF00u;          // Rare: re-draw and sort again
+            qsort(keys, n, sizeof(uint32_t), cmp_u32);
+            i = 0;
+        }
+    }
+    card_count = n;
+}
+
+static uint8_t key_known(uint32_t key) {
+    return bsearch(&key, keys, card_count, sizeof(uint32_t), cmp_u32) != NULL;
+}
+
+// ============================================
+// Traces
+// ============================================
+static uint32_t *trace;
+static uint32_t trace_n;
+
+static uint32_t unknown_key(void) {
+    uint32_t k;
+    do { k = rnd() | 0x80; } while(key_known(k));
+    return k;
+}
+
+static void trace_uniform(uint32_t scans) {
+    for(trace_n = 0; trace_n < scans; trace_n++) {
+        trace[trace_n] = (rnd() % 100 < 5) ? unknown_key() : keys[rnd() % card_count];
+    }
+}
+
+// Parties from one roll: neighbours in the sorted key order
+static void trace_rolls(uint32_t scans) {
+    trace_n = 0;
+    while(trace_n < scans) {
+        uint32_t first = rnd() % card_count;
+        uint32_t size = 2 + rnd() % 5;
+
+        for(uint32_t k = 0; k < size && trace_n < scans; k++) {
+            uint32_t i = first + (rnd() % 8);
+            trace[trace_n++] = keys[i < card_count ? i : card_count - 1];
+        }
+    }
+}
+
+static void trace_rescan(uint32_t scans) {
+    for(trace_n = 0; trace_n < scans; trace_n++) {
+        if(trace_n >= 20 && rnd() % 100 < 40) {
+            trace[trace_n] = trace[trace_n - 1 - rnd() % 20];
+        } else {
+            trace[trace_n] = keys[rnd() % card_count];
+        }
+    }
+}
+
+static uint8_t trace_file(const char *path) {
+    FILE *f = fopen(path, "r");
+    char line[128];
+
+    if(!f) {
+        perror(path);
+        return 0;
+    }
+    trace_n = 0;
+    while(trace_n < TRACE_MAX && fgets(line, sizeof(line), f)) {
+        uint8_t uid[4];
+        unsigned v[4];
+
+        if(sscanf(line, "%2x:%2x:%2x:%2x", &v[0], &v[1], &v[2], &v[3]) != 4 &&
+           sscanf(line, "%2x%2x%2x%2x", &v[0], &v[1], &v[2], &v[3]) != 4) {
+            continue;
+        }
+        for(uint8_t i = 0; i < 4; i++) uid[i] = (uint8_t)v[i];
+        trace[trace_n++] = (uint32_t)uid[0] | ((uint32_t)uid[1] << 8) |
+                           ((uint32_t)uid[2] << 16) | ((uint32_t)uid[3] << 24);
+    }
+    fclose(f);
+    return 1;
+}
+
+// ============================================
+// Replay
+// ============================================
+static uint32_t fail = 0;
+
+static double spi_us(uint32_t bytes, uint32_t reads) {
+    return (bytes + reads * SPI_CMD_BYTES) * 8.0 * 1e6 / SPI_HZ;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void replay(const char *label) {
+    double *lat = malloc((trace_n ? trace_n : 1) * sizeof(double));
+    double sum = 0;
+    uint32_t wrong = 0;
+    uint32_t too_many = 0;
+    uint32_t warm_reads = 0;
+    FlashIdx_Stats_t s0;
+
+    flashidx_init();
+    s0 = flashidx_stats;
+
+    for(uint32_t i = 0; i < trace_n; i++) {
+        FlashIdx_Record_t rec;
+        char group[FLASHIDX_GROUP_LEN];
+        uint8_t uid[4];
+        uint32_t misses0 = flashidx_stats.page_misses;
+        uint32_t bytes0 = flashidx_stats.bytes_read;
+        uint8_t known = key_known(trace[i]);
+        uint8_t found;
+
+        memcpy(uid, &trace[i], 4);
+        found = flashidx_lookup(uid, &rec);
+        if(flashidx_stats.page_misses - misses0 > 2) too_many++;     // Inner + leaf
+        if(found) flashidx_group_name(rec.group, group);
+
+        if(found != known) {
+            wrong++;
+        } else if(found) {
+            char name[8];
+            key_name(trace[i], name);
+            if(rec.key != trace[i] || memcmp(rec.name, name, 8) != 0 ||
+               rec.group != key_group(trace[i])) {
+                wrong++;
+            }
+        }
+
+        lat[i] = spi_us(flashidx_stats.bytes_read - bytes0,
+                        flashidx_stats.page_misses - misses0);
+        sum += lat[i];
+    }
+
+    // Re-tap of the last card: served from the cache
+    if(trace_n) {
+        uint8_t uid[4];
+        uint32_t misses0 = flashidx_stats.page_misses;
+
+        memcpy(uid, &trace[trace_n - 1], 4);
+        flashidx_lookup(uid, 0);
+        warm_reads = flashidx_stats.page_misses - misses0;
+    }
+
+    qsort(lat, trace_n, sizeof(double), cmp_double);
+    {
+        uint32_t hits = flashidx_stats.page_hits - s0.page_hits;
+        uint32_t misses = flashidx_stats.page_misses - s0.page_misses;
+
+        printf("%-8s %7u %8u %8.1f%% %9.1f %8.0f %8.0f %8.0f%s\n",
+               label, card_count, trace_n,
+               100.0 * hits / ((hits + misses) ? (hits + misses) : 1),
+               (double)(flashidx_stats.bytes_read - s0.bytes_read) / (trace_n ? trace_n : 1),
+               trace_n ? sum / trace_n : 0.0,
+               trace_n ? lat[(uint32_t)(0.99 * (trace_n - 1))] : 0.0,
+               trace_n ? lat[trace_n - 1] : 0.0,
+               (wrong || too_many || warm_reads) ? "  FAIL" : "");
+    }
+    if(wrong) printf("  FAIL %u lookups returned the wrong answer\n", wrong);
+    if(too_many) printf("  FAIL %u lookups read more than two pages\n", too_many);
+    if(warm_reads) printf("  FAIL warm re-tap read %u pages\n", warm_reads);
+    fail += wrong + too_many + warm_reads;
+    free(lat);
+}
+
+static void header(void) {
+    printf("%u cache pages, SPI %.2f MHz: %.0f us per page read\n\n",
+           FLASHIDX_CACHE_PAGES, SPI_HZ / 1e6, spi_us(FLASHIDX_PAGE_SIZE, 1));
+    printf("%-8s %7s %8s %9s %9s %8s %8s %8s\n",
+           "trace", "cards", "scans", "hit rate", "bytes/sc", "mean us", "p99 us", "max us");
+}
+
+static void setup(uint32_t cards) {
+    free(keys);
+    free(image);
+    keys = 0;
+    population(cards);
+    image_build();
+    if(!flashidx_init()) {
+        printf("  FAIL image rejected by flashidx_init()\n");
+        fail++;
+    }
+}
+
+// ============================================
+// Main
+// ============================================
+int main(int argc, char **argv) {
+    static const uint32_t sizes[] = { 1000, 20000, 100000 };
+    uint32_t scans = 20000;
+
+    trace = malloc(TRACE_MAX * sizeof(uint32_t));
+    if(!trace) return 2;
+
+    if(argc > 1 && strcmp(argv[1], "--trace") == 0) {
+        if(argc < 3 || !trace_file(argv[2])) return 2;
+        setup((argc > 3) ? (uint32_t)atoi(argv[3]) : 20000);
+        header();
+        replay("trace");
+    } else {
+        uint32_t only = (argc > 1) ? (uint32_t)atoi(argv[1]) : 0;
+
+        if(argc > 2) scans = (uint32_t)atoi(argv[2]);
+        if(argc > 3) rng_state ^= (uint64_t)atoi(argv[3]) * 0x2545F4914F6CDD1DULL;
+        if(scans > TRACE_MAX) scans = TRACE_MAX;
+
+        header();
+        for(uint8_t s = 0; s < 3; s++) {
+            uint32_t cards = only ? only : sizes[s];
+
+            setup(cards);
+            trace_uniform(scans);
+            replay("uniform");
+            trace_rolls(scans);
+            replay("rolls");
+            trace_rescan(scans);
+            replay("rescan");
+            if(only) break;
+        }
+    }
+
+    printf("%s\n", fail ? "FAIL" : "PASS");
+    return fail ? 1 : 0;
+}
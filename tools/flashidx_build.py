@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""
+============================================
+FLASH CARD INDEX BUILDER
+CSV -> SPI NOR flash image for FLASHIDX.c
+
+CSV columns: uid,name,group
+  uid   8 hex digits, optional ':' separators (F3:52:22:2A)
+  name  up to 8 characters (longer names are cut)
+  group up to 15 characters, at most 16 distinct groups
+  an optional 4th column "inactive" marks a disabled card
+
+Usage: flashidx_build.py cards.csv index.bin
+Layout constants must match FLASHIDX.h
+============================================
+"""
+
+import csv
+import struct
+import sys
+
+MAGIC = 0x58444943          # "CIDX"
+VERSION = 1
+PAGE_SIZE = 256
+LEAF_RECORDS = 16
+INNER_KEYS = 64
+ROOT_MAX = 256
+GROUP_LEN = 16
+MAX_GROUPS = 16
+NAME_LEN = 8
+REC_ACTIVE = 0x01
+
+HEADER_FMT = "<IHHIIIIIIIHBB"
+RECORD_FMT = "<I8sBBH"
+
+
+def parse_uid(text):
+    digits = text.replace(":", "").replace(" ", "")
+    if len(digits) != 8:
+        raise ValueError("bad UID: %r" % text)
+    uid = bytes.fromhex(digits)
+    return struct.unpack("<I", uid)[0]          # Same key as rd32() on the target
+
+
+def pad_page(data):
+    if len(data) % PAGE_SIZE:
+        data += b"\xFF" * (PAGE_SIZE - len(data) % PAGE_SIZE)
+    return data
+
+
+def build(rows):
+    groups = []
+    records = {}
+
+    for row in rows:
+        if not row or row[0].startswith("#"):
+            continue
+        key = parse_uid(row[0])
+        name = row[1].strip()[:NAME_LEN].encode("ascii")
+        group = row[2].strip()[:GROUP_LEN - 1]
+        flags = 0 if (len(row) > 3 and row[3].strip().lower() == "inactive") else REC_ACTIVE
+
+        if group not in groups:
+            if len(groups) >= MAX_GROUPS:
+                raise ValueError("more than %d groups" % MAX_GROUPS)
+            groups.append(group)
+
+        if key in records:
+            raise ValueError("duplicate UID %08X" % key)
+        records[key] = (name, groups.index(group), flags)
+
+    keys = sorted(records)
+    if not keys:
+        raise ValueError("no cards")
+
+    leaf_count = (len(keys) + LEAF_RECORDS - 1) // LEAF_RECORDS
+    inner_count = (leaf_count + INNER_KEYS - 1) // INNER_KEYS
+    if inner_count > ROOT_MAX:
+        raise ValueError("too many cards for a %d-key root" % ROOT_MAX)
+
+    group_page = 1
+    leaf_page = 2
+    inner_page = leaf_page + leaf_count
+    root_page = inner_page + inner_count
+
+    # Groups
+    group_data = b"".join(g.encode("ascii").ljust(GROUP_LEN, b"\0") for g in groups)
+
+    # Leaves
+    leaves = []
+    leaf_first = []
+    for i in range(leaf_count):
+        chunk = keys[i * LEAF_RECORDS:(i + 1) * LEAF_RECORDS]
+        leaf_first.append(chunk[0])
+        page = b""
+        for key in chunk:
+            name, group, flags = records[key]
+            page += struct.pack(RECORD_FMT, key, name.ljust(NAME_LEN, b"\0"), group, flags, 0)
+        leaves.append(pad_page(page))
+
+    # Inner pages: first key of each leaf, 64 per page
+    inners = []
+    root = []
+    for i in range(inner_count):
+        chunk = leaf_first[i * INNER_KEYS:(i + 1) * INNER_KEYS]
+        root.append(chunk[0])
+        inners.append(pad_page(b"".join(struct.pack("<I", k) for k in chunk)))
+
+    header = struct.pack(HEADER_FMT, MAGIC, VERSION, PAGE_SIZE, len(keys),
+                         group_page, leaf_page, leaf_count,
+                         inner_page, inner_count,
+                         root_page, len(root), len(groups), 0)
+
+    image = pad_page(header)
+    image += pad_page(group_data)
+    image += b"".join(leaves)
+    image += b"".join(inners)
+    image += pad_page(b"".join(struct.pack("<I", k) for k in root))
+    return image, len(keys), len(groups)
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__)
+        sys.exit(1)
+
+    with open(sys.argv[1], newline="") as f:
+        image, count, group_count = build(csv.reader(f))
+
+    with open(sys.argv[2], "wb") as f:
+        f.write(image)
+
+    print("%d cards, %d groups, %d bytes (%d pages)" %
+          (count, group_count, len(image), len(image) // PAGE_SIZE))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,397 @@
+/*
+ * ============================================
+ * FLOW RATE ESTIMATOR TEST
+ * Drives the real src-codes/FLOWRATE.c with
+ * synthetic Poisson entry/exit traces on a
+ * virtual millis() clock (started 30 min before
+ * the 32-bit wrap, so every run crosses it) and
+ * calls flowrate_service() every 100 ms like the
+ * main loop does.
+ *
+ * Scenarios:
+ *   steady   fixed rates for 24 h: bias and spread
+ *            of each horizon against the true rate
+ *            and against the EWMA's own Poisson
+ *            spread, sqrt(a/(2-a) * rate/bucket)
+ *   step     entry rate x6: time for each horizon
+ *            to cover 63% of the step (= its tau)
+ *   fill     net inflow into a 2000-person venue:
+ *            TTF error, and each alert level is
+ *            raised in order, ahead of the fill
+ *   idle     no scans for 2 h: rates reset
+ *
+ * CPU cost is reported as host ns per scan
+ * (flowrate_record) and per service call.
+ *
+ * Build (from the repo root):
+ *   gcc -O2 -Isrc-codes tools/flowrate_test.c src-codes/FLOWRATE.c \
+ *       -lm -o flowrate_test
+ *
+ * Usage:
+ *   flowrate_test [seed]
+ *
+ * Exit status 1 on any FAIL.
+ * ============================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#include "FLOWRATE.h"
+
+#define SERVICE_MS      100             // Main loop tick
+#define CLOCK_START     (0xFFFFFFFFUL - 30UL * 60 * 1000)
+
+static const double flow_tau[FLOW_HORIZONS] = { FLOW_H0_TAU_S, FLOW_H1_TAU_S, FLOW_H2_TAU_S };
+static const double flow_alpha[FLOW_HORIZONS] = {
+    FLOW_H0_ALPHA_Q16 / 65536.0, FLOW_H1_ALPHA_Q16 / 65536.0, FLOW_H2_ALPHA_Q16 / 65536.0
+};
+
+// ============================================
+// Firmware stubs + alert capture
+// ============================================
+static uint32_t alert_count = 0;
+static uint8_t alert_level[32];
+static double alert_time_s[32];
+static double sim_s = 0;
+
+void uart_dual_send_string(const char *s) {
+    const char *p = strstr(s, "\"level\":");
+
+    if(p && alert_count < 32) {
+        alert_level[alert_count] = (uint8_t)atoi(p + 8);
+        alert_time_s[alert_count] = sim_s;
+        alert_count++;
+    }
+}
+
+// ============================================
+// Random numbers (xorshift64*)
+// ============================================
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static double rnd(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return ((rng_state * 2685821657736338717ULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double rnd_exp(double mean) {
+    return -mean * log(1.0 - rnd());
+}
+
+static uint64_t ns_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// ============================================
+// Trace driver
+// Rates in people per hour, as functions of time
+// ============================================
+typedef double (*Rate_fn)(double t_s);
+
+static uint32_t now_ms(void) {
+    return (uint32_t)(CLOCK_START + (uint64_t)(sim_s * 1000.0));
+}
+
+static int32_t inside = 0;
+static uint64_t record_ns = 0;
+static uint64_t record_calls = 0;
+static uint64_t service_ns = 0;
+static uint64_t service_calls = 0;
+
+// Non-homogeneous Poisson streams by thinning: candidates at
+// RATE_MAX, each kept with probability rate(t) / RATE_MAX
+#define RATE_MAX    3600.0
+
+static void run(double from_s, double to_s, Rate_fn in_rate, Rate_fn out_rate,
+                int16_t capacity, void (*probe)(double t_s)) {
+    double next_in = from_s + rnd_exp(3600.0 / RATE_MAX);
+    double next_out = from_s + rnd_exp(3600.0 / RATE_MAX);
+    double next_service = from_s;
+
+    while(next_service < to_s) {
+        uint64_t t0;
+
+        while(next_in < next_service || next_out < next_service) {
+            uint8_t entry = next_in <= next_out;
+            double r;
+
+            sim_s = entry ? next_in : next_out;
+            r = entry ? in_rate(sim_s) : out_rate(sim_s);
+            if(entry) next_in += rnd_exp(3600.0 / RATE_MAX);
+            else next_out += rnd_exp(3600.0 / RATE_MAX);
+
+            if(rnd() * RATE_MAX >= r) continue;
+            if(!entry && inside == 0) continue;     // Nobody left to exit
+
+            t0 = ns_now();
+            flowrate_record(entry ? FLOW_ENTRY : FLOW_EXIT, now_ms());
+            record_ns += ns_now() - t0;
+            record_calls++;
+            inside += entry ? 1 : -1;
+        }
+
+        sim_s = next_service;
+        t0 = ns_now();
+        flowrate_service(now_ms(), (int16_t)inside, capacity);
+        service_ns += ns_now() - t0;
+        service_calls++;
+        if(probe) probe(sim_s);
+        next_service += SERVICE_MS / 1000.0;
+    }
+    sim_s = to_s;
+}
+
+static uint32_t fail = 0;
+
+// ============================================
+// Steady: bias / spread per horizon
+// ============================================
+#define STEADY_IN   720.0
+#define STEADY_OUT  540.0
+
+static double rate_steady_in(double t) { (void)t; return STEADY_IN; }
+static double rate_steady_out(double t) { (void)t; return STEADY_OUT; }
+
+static double st_sum[2][FLOW_HORIZONS];
+static double st_sq[2][FLOW_HORIZONS];
+static uint32_t st_n = 0;
+static double st_from = 0;
+static uint32_t st_last_bucket = 0;
+
+static void steady_probe(double t) {
+    uint32_t b = flowrate_stats.buckets;
+
+    if(t < st_from || b == st_last_bucket) return;
+    st_last_bucket = b;
+    for(uint8_t d = 0; d < 2; d++) {
+        for(uint8_t h = 0; h < FLOW_HORIZONS; h++) {
+            double v = flowrate_per_hour((FlowRate_Dir_t)d, h);
+            st_sum[d][h] += v;
+            st_sq[d][h] += v * v;
+        }
+    }
+    st_n++;
+}
+
+static void test_steady(void) {
+    double t_end = 24 * 3600.0;
+
+    flowrate_init(now_ms());
+    inside = 0;
+    st_from = 5 * FLOW_H2_TAU_S;                // Past the longest warm-up
+    run(sim_s, sim_s + t_end, rate_steady_in, rate_steady_out, 30000, steady_probe);
+
+    printf("steady    in %.0f/h, out %.0f/h, %u buckets sampled\n", STEADY_IN, STEADY_OUT, st_n);
+    printf("  %-6s %-5s %9s %8s %9s %9s\n", "dir", "tau", "mean/h", "bias", "sd/h", "model sd");
+    for(uint8_t d = 0; d < 2; d++) {
+        double truth = d ? STEADY_OUT : STEADY_IN;
+
+        for(uint8_t h = 0; h < FLOW_HORIZONS; h++) {
+            double mean = st_sum[d][h] / st_n;
+            double sd = sqrt(fmax(0.0, st_sq[d][h] / st_n - mean * mean));
+            double a = flow_alpha[h];
+            double per_bucket = truth * FLOW_BUCKET_MS / 3600000.0;
+            double model = sqrt(a / (2.0 - a) * per_bucket) * (3600000.0 / FLOW_BUCKET_MS);
+            double bias = (mean - truth) / truth;
+            uint8_t bad = fabs(bias) > 0.03 || sd > 1.5 * model;
+
+            printf("  %-6s %4.0fs %9.1f %7.1f%% %9.1f %9.1f%s\n", d ? "exit" : "entry",
+                   flow_tau[h], mean, 100.0 * bias, sd, model, bad ? "  FAIL" : "");
+            fail += bad;
+        }
+    }
+}
+
+// ============================================
+// Step: response time per horizon
+// ============================================
+#define STEP_LOW    300.0
+#define STEP_HIGH   1800.0
+static double step_at;
+
+static double rate_step_in(double t) { return t < step_at ? STEP_LOW : STEP_HIGH; }
+static double rate_zero(double t) { (void)t; return 0; }
+
+static double step_reached[FLOW_HORIZONS];
+
+static void step_probe(double t) {
+    for(uint8_t h = 0; h < FLOW_HORIZONS; h++) {
+        if(t >= step_at && step_reached[h] < 0 &&
+           flowrate_per_hour(FLOW_ENTRY, h) >= STEP_LOW + 0.632 * (STEP_HIGH - STEP_LOW)) {
+            step_reached[h] = t - step_at;
+        }
+    }
+}
+
+static void test_step(void) {
+    // Average over a few runs: one run is noisy at the 63% crossing
+    double sum[FLOW_HORIZONS] = {0};
+    const uint8_t runs = 20;
+
+    for(uint8_t r = 0; r < runs; r++) {
+        double t0;
+
+        flowrate_init(now_ms());
+        inside = 0;
+        t0 = sim_s;
+        step_at = t0 + 5 * FLOW_H2_TAU_S;
+        for(uint8_t h = 0; h < FLOW_HORIZONS; h++) step_reached[h] = -1;
+        run(t0, step_at + 5 * FLOW_H2_TAU_S, rate_step_in, rate_zero, 30000, step_probe);
+        for(uint8_t h = 0; h < FLOW_HORIZONS; h++) sum[h] += step_reached[h];
+    }
+
+    printf("\nstep      entry %.0f/h -> %.0f/h, 63%% response over %u runs\n",
+           STEP_LOW, STEP_HIGH, runs);
+    for(uint8_t h = 0; h < FLOW_HORIZONS; h++) {
+        double mean = sum[h] / runs;
+        // Bucketing delays the response by up to one bucket
+        uint8_t bad = mean < 0.7 * flow_tau[h] || mean > 1.3 * flow_tau[h] + FLOW_BUCKET_MS / 1000.0;
+
+        printf("  tau %4.0fs: %6.0fs%s\n", flow_tau[h], mean, bad ? "  FAIL" : "");
+        fail += bad;
+    }
+}
+
+// ============================================
+// Fill: TTF accuracy and alert lead time
+// ============================================
+#define FILL_CAPACITY 2000
+#define FILL_IN       3000.0
+#define FILL_OUT      600.0
+
+static double fill_start;
+static double fill_full_s;
+static double ttf_err_sum = 0;
+static uint32_t ttf_err_n = 0;
+static double ttf_pred_at[64];
+static double ttf_pred[64];
+static uint32_t ttf_pred_n = 0;
+
+static double rate_fill_in(double t) { return t < fill_start + 60 ? 0 : FILL_IN; }
+static double rate_fill_out(double t) { return t < fill_start + 60 ? 0 : FILL_OUT; }
+
+static void fill_probe(double t) {
+    static uint32_t last = 0;
+
+    if(fill_full_s < 0 && inside >= FILL_CAPACITY) fill_full_s = t;
+
+    // One TTF sample a minute while filling, scored once the fill time is known
+    if(fill_full_s < 0 && (uint32_t)(t - fill_start) / 60 != last && ttf_pred_n < 64) {
+        last = (uint32_t)(t - fill_start) / 60;
+        ttf_pred_at[ttf_pred_n] = t;
+        ttf_pred[ttf_pred_n] = flowrate_ttf_s(flowrate_config.alert_horizon,
+                                              (int16_t)inside, FILL_CAPACITY);
+        ttf_pred_n++;
+    }
+}
+
+static void test_fill(void) {
+    uint8_t seen[FLOW_ALERT_LEVELS + 1] = {0};
+    uint8_t order_ok = 1;
+
+    flowrate_init(now_ms());
+    inside = 0;
+    alert_count = 0;
+    fill_start = sim_s;
+    fill_full_s = -1;
+    run(sim_s, sim_s + 3600.0, rate_fill_in, rate_fill_out, FILL_CAPACITY, fill_probe);
+
+    printf("\nfill      capacity %u, in %.0f/h, out %.0f/h: full after %.0fs\n",
+           FILL_CAPACITY, FILL_IN, FILL_OUT, fill_full_s - fill_start);
+
+    // TTF once the alert horizon has warmed up (3 tau in)
+    for(uint32_t i = 0; i < ttf_pred_n; i++) {
+        double actual = fill_full_s - ttf_pred_at[i];
+
+        if(ttf_pred_at[i] - fill_start < 60 + 3 * FLOW_H1_TAU_S || ttf_pred[i] < 0) continue;
+        ttf_err_sum += fabs(ttf_pred[i] - actual) / actual;
+        ttf_err_n++;
+    }
+    if(ttf_err_n) {
+        double err = ttf_err_sum / ttf_err_n;
+        uint8_t bad = err > 0.15;
+        printf("  TTF mean abs error %.1f%% over %u samples%s\n", 100.0 * err, ttf_err_n,
+               bad ? "  FAIL" : "");
+        fail += bad;
+    }
+
+    for(uint32_t i = 0; i < alert_count; i++) {
+        uint8_t lv = alert_level[i];
+        double lead = fill_full_s - alert_time_s[i];
+        uint32_t limit = lv ? flowrate_config.alert_ttf_s[lv - 1] : 0;
+
+        if(alert_time_s[i] > fill_full_s) continue;
+        if(lv && !seen[lv]) {
+            // Raised with at least half of its threshold still to go
+            uint8_t bad = lead < 0.5 * limit;
+            printf("  level %u (full in <%us) raised %.0fs before full%s\n", lv, limit, lead,
+                   bad ? "  FAIL" : "");
+            fail += bad;
+            for(uint8_t k = 1; k < lv; k++) if(!seen[k]) order_ok = 0;
+            seen[lv] = 1;
+        }
+    }
+    for(uint8_t lv = 1; lv <= FLOW_ALERT_LEVELS; lv++) {
+        if(flowrate_config.alert_ttf_s[lv - 1] && !seen[lv]) {
+            printf("  FAIL level %u never raised before full\n", lv);
+            fail++;
+        }
+    }
+    if(!order_ok) {
+        printf("  FAIL levels raised out of order\n");
+        fail++;
+    }
+}
+
+// ============================================
+// Idle: rates reset after FLOW_MAX_CATCHUP
+// ============================================
+static void test_idle(void) {
+    uint32_t resets = flowrate_stats.resets;
+    uint8_t bad;
+
+    flowrate_init(now_ms());
+    inside = 0;
+    run(sim_s, sim_s + 600.0, rate_steady_in, rate_steady_out, 30000, 0);
+    resets = flowrate_stats.resets;
+    sim_s += 2 * 3600.0;
+    flowrate_service(now_ms(), 0, 30000);
+
+    bad = flowrate_stats.resets != resets + 1 ||
+          flowrate_per_hour(FLOW_ENTRY, 0) != 0 || flowrate_per_hour(FLOW_ENTRY, 2) != 0;
+    printf("\nidle      2 h gap: %u reset, entry rates %u/%u/%u per hour%s\n",
+           flowrate_stats.resets - resets, flowrate_per_hour(FLOW_ENTRY, 0),
+           flowrate_per_hour(FLOW_ENTRY, 1), flowrate_per_hour(FLOW_ENTRY, 2),
+           bad ? "  FAIL" : "");
+    fail += bad;
+}
+
+// ============================================
+// Main
+// ============================================
+int main(int argc, char **argv) {
+    if(argc > 1) rng_state ^= (uint64_t)atoi(argv[1]) * 0x2545F4914F6CDD1DULL;
+
+    test_steady();
+    test_step();
+    test_fill();
+    test_idle();
+
+    printf("\ncpu       %.1f ns per scan (%llu), %.1f ns per service call (%llu)\n",
+           (double)record_ns / record_calls, (unsigned long long)record_calls,
+           (double)service_ns / service_calls, (unsigned long long)service_calls);
+    printf("clock     started at 0x%08lX, ended at 0x%08lX (crossed the wrap)\n",
+           (unsigned long)CLOCK_START, (unsigned long)now_ms());
+
+    printf("%s\n", fail ? "FAIL" : "PASS");
+    return fail ? 1 : 0;
+}
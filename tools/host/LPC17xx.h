@@ -0,0 +1,89 @@
+/*
+ * ============================================
+ * HOST DEVICE HEADER
+ * Stand-in for the LPC17xx device header when a
+ * tools/ harness compiles a firmware module that
+ * touches registers (LCD.c, UAART0.c). Only the
+ * registers those modules use are declared.
+ *
+ * GPIO0 and TIMER1 are reached through the
+ * harness: every LPC_GPIO0 / LPC_TIM1 access
+ * first calls host_gpio0() / host_tim1(), so the
+ * harness sees the previous pin write land before
+ * the next one and can hand out its virtual clock
+ * as TIMER1->TC.
+ *
+ * UART reads with a side effect go through the
+ * harness too: LSR and RBR expand to a one-slot
+ * array indexed by host_uart_lsr() /
+ * host_uart_rbr(), which load the slot first, so
+ * each RBR read takes the next received byte and
+ * LSR follows what is left. Other UART registers
+ * are plain fields (THR keeps the last byte).
+ *
+ * Use with -Itools/host ahead of -Isrc-codes.
+ * ============================================
+ */
+
+#ifndef LPC17XX_HOST_H
+#define LPC17XX_HOST_H
+
+#include <stdint.h>
+
+typedef enum {
+    TIMER1_IRQn = 2,
+    UART0_IRQn = 5,
+    UART3_IRQn = 8
+} IRQn_Type;
+
+typedef struct {
+    volatile uint32_t FIODIR;
+    volatile uint32_t FIOMASK;
+    volatile uint32_t FIOPIN;
+    volatile uint32_t FIOSET;
+    volatile uint32_t FIOCLR;
+} LPC_GPIO_TypeDef;
+
+typedef struct {
+    volatile uint32_t IR, TCR, TC, PR, PC, MCR, MR0;
+} LPC_TIM_TypeDef;
+
+typedef struct {
+    volatile uint32_t PCONP;
+    volatile uint32_t PCLKSEL0, PCLKSEL1;
+} LPC_SC_TypeDef;
+
+typedef struct {
+    volatile uint32_t PINSEL0, PINMODE4;
+} LPC_PINCON_TypeDef;
+
+typedef struct {
+    volatile uint32_t RBR_slot[1], THR, DLL, DLM, IER, IIR, FCR, LCR, LSR_slot[1], FDR;
+} LPC_UART_TypeDef;
+
+// Provided by the harness
+LPC_GPIO_TypeDef *host_gpio0(void);
+LPC_TIM_TypeDef *host_tim1(void);
+extern LPC_SC_TypeDef host_sc;
+extern LPC_PINCON_TypeDef host_pincon;
+extern LPC_GPIO_TypeDef host_gpio2;
+extern LPC_UART_TypeDef host_uart0, host_uart3;
+extern uint32_t SystemCoreClock;
+uint32_t host_uart_lsr(void);
+uint32_t host_uart_rbr(void);
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority);
+
+#define LPC_GPIO0   (host_gpio0())
+#define LPC_TIM1    (host_tim1())
+#define LPC_SC      (&host_sc)
+#define LPC_PINCON  (&host_pincon)
+#define LPC_GPIO2   (&host_gpio2)
+#define LPC_UART0   (&host_uart0)
+#define LPC_UART3   (&host_uart3)
+#define LSR         LSR_slot[host_uart_lsr()]
+#define RBR         RBR_slot[host_uart_rbr()]
+
+#endif // LPC17XX_HOST_H
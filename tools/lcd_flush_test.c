@@ -0,0 +1,451 @@
+/*
+ * ============================================
+ * LCD FLUSH TEST (MOCK HD44780)
+ * Runs the real src-codes/LCD.c on the host
+ * against a pin-level model of the HD44780 on
+ * P0.10/11 (RS/EN) and P0.19-22 (D4-D7). The
+ * model latches a nibble on each EN falling
+ * edge, follows the 8-bit -> 4-bit switch of
+ * lcd_init(), keeps DDRAM and the address
+ * counter, and counts every write that arrives
+ * while the controller is still busy.
+ *
+ * Time is virtual: delay_us/delay_ms advance
+ * the clock, TIMER1->TC reads it and the async
+ * writer's MR0 match is stepped tick by tick.
+ *
+ * Per flush it reports the bytes that reached
+ * the panel, cursor moves, bus time until the
+ * panel holds the new screen, and how long the
+ * caller was blocked. Checks:
+ *   - the panel equals the framebuffer after
+ *     every flush (blocking and async)
+ *   - bytes / moves / bus_us in lcd_flush_stats
+ *     match what the panel received
+ *   - an unchanged screen writes nothing
+ *   - a newer screen replaces one still queued
+ *   - a full redraw dropped before it drained
+ *     is redone in full by the next flush
+ *   - no write while the controller is busy
+ *
+ * Build (from the repo root):
+ *   gcc -O2 -DPROFILE_ENABLE=0 -Itools/host -Isrc-codes \
+ *       tools/lcd_flush_test.c src-codes/LCD.c -o lcd_flush_test
+ *
+ * Usage:
+ *   lcd_flush_test [screens] [seed]
+ *
+ * Exit status 1 on any FAIL.
+ * ============================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "LPC17xx.h"
+#include "LCD.h"
+#include "DELAY.h"
+
+#define HD_EXEC_US      37      // Data / most commands
+#define HD_CLEAR_US     1520    // Clear, home
+
+// ============================================
+// Virtual clock + device stand-ins
+// ============================================
+static uint64_t now_us = 0;
+static LPC_GPIO_TypeDef gpio0;
+static LPC_TIM_TypeDef tim1;
+static uint32_t pins = 0;
+static uint8_t tim1_irq_on = 0;
+
+LPC_SC_TypeDef host_sc;
+uint32_t SystemCoreClock = 100000000;
+
+void NVIC_EnableIRQ(IRQn_Type irq) { if(irq == TIMER1_IRQn) tim1_irq_on = 1; }
+void NVIC_DisableIRQ(IRQn_Type irq) { if(irq == TIMER1_IRQn) tim1_irq_on = 0; }
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority) { (void)irq; (void)priority; }
+
+void TIMER1_IRQHandler(void);
+
+// ============================================
+// HD44780 model
+// ============================================
+static struct {
+    uint8_t eight_bit;          // Powers up in 8-bit mode
+    uint8_t half;               // Upper nibble latched, lower next
+    uint8_t hi;
+    uint8_t cgram;              // Data goes to CGRAM
+    uint8_t ac;                 // DDRAM address counter
+    char ddram[0x80];
+    uint64_t busy_until;
+    uint64_t last_write_us;
+    uint32_t data;              // Bytes written (data)
+    uint32_t cmds;              // Bytes written (commands)
+    uint32_t moves;             // Set-DDRAM-address commands
+    uint32_t busy_hits;         // Writes while busy
+} hd;
+
+static void hd_reset(void) {
+    memset(&hd, 0, sizeof(hd));
+    hd.eight_bit = 1;
+    memset(hd.ddram, ' ', sizeof(hd.ddram));
+}
+
+static void hd_advance(void) {
+    if(hd.ac == 0x27) hd.ac = 0x40;
+    else if(hd.ac == 0x67) hd.ac = 0x00;
+    else hd.ac++;
+}
+
+static void hd_exec(uint8_t rs, uint8_t b) {
+    uint32_t exec = HD_EXEC_US;
+
+    if(rs) {
+        if(!hd.cgram) {
+            hd.ddram[hd.ac & 0x7F] = (char)b;
+            hd_advance();
+        }
+        hd.data++;
+    } else {
+        hd.cmds++;
+        if(b == 0x01) {
+            memset(hd.ddram, ' ', sizeof(hd.ddram));
+            hd.ac = 0;
+            hd.cgram = 0;
+            exec = HD_CLEAR_US;
+        } else if((b & 0xFE) == 0x02) {
+            hd.ac = 0;
+            hd.cgram = 0;
+            exec = HD_CLEAR_US;
+        } else if(b & 0x80) {
+            hd.ac = b & 0x7F;
+            hd.cgram = 0;
+            hd.moves++;
+        } else if(b & 0x40) {
+            hd.cgram = 1;
+        } else if(b & 0x20) {
+            hd.eight_bit = (b & 0x10) != 0;
+        }
+    }
+    hd.busy_until = now_us + exec;
+    hd.last_write_us = now_us;
+}
+
+static void hd_strobe(uint32_t p) {
+    uint8_t nibble = (p >> 19) & 0x0F;
+    uint8_t rs = (p & RS) != 0;
+
+    if(!hd.half && now_us < hd.busy_until) {
+        hd.busy_hits++;
+    }
+    if(hd.eight_bit) {
+        hd_exec(rs, (uint8_t)(nibble << 4));    // D0-D3 not wired
+        return;
+    }
+    if(!hd.half) {
+        hd.hi = nibble;
+        hd.half = 1;
+        return;
+    }
+    hd.half = 0;
+    hd_exec(rs, (uint8_t)((hd.hi << 4) | nibble));
+}
+
+// Apply the last FIOSET/FIOCLR write to the pins
+static void gpio_settle(void) {
+    uint32_t prev = pins;
+
+    pins = (pins | gpio0.FIOSET) & ~gpio0.FIOCLR;
+    gpio0.FIOSET = 0;
+    gpio0.FIOCLR = 0;
+    gpio0.FIOPIN = pins;
+
+    if((prev & EN) && !(pins & EN)) {
+        hd_strobe(pins);
+    }
+}
+
+LPC_GPIO_TypeDef *host_gpio0(void) {
+    gpio_settle();
+    return &gpio0;
+}
+
+LPC_TIM_TypeDef *host_tim1(void) {
+    tim1.TC = (uint32_t)now_us;
+    return &tim1;
+}
+
+void delay_us(uint32_t us) {
+    gpio_settle();
+    now_us += us;
+}
+
+void delay_ms(uint32_t ms) {
+    gpio_settle();
+    now_us += (uint64_t)ms * 1000;
+}
+
+// Step the async writer's MR0 match, at most max_ticks (0 = until idle)
+static uint32_t run_ticks(uint32_t max_ticks) {
+    uint32_t n = 0;
+
+    while(tim1_irq_on && (tim1.MCR & 1) && (max_ticks == 0 || n < max_ticks)) {
+        if(tim1.MR0 > (uint32_t)now_us) now_us = tim1.MR0;
+        TIMER1_IRQHandler();
+        gpio_settle();
+        n++;
+    }
+    return n;
+}
+
+// ============================================
+// Screens (shapes of the firmware ones)
+// ============================================
+static char want[LCD_ROWS][LCD_COLS + 1];
+static uint32_t rng = 1;
+
+static uint32_t rnd(void) {
+    rng = rng * 1103515245u + 12345u;
+    return (rng >> 16) & 0x7FFF;
+}
+
+static void draw(const char *l1, const char *l2) {
+    char line[LCD_COLS + 1];
+
+    snprintf(line, sizeof(line), "%-16s", l1);
+    lcd_fb_line(0, line);
+    memcpy(want[0], line, LCD_COLS);
+    snprintf(line, sizeof(line), "%-16s", l2);
+    lcd_fb_line(1, line);
+    memcpy(want[1], line, LCD_COLS);
+}
+
+static void draw_random(uint32_t kind) {
+    static const char *names[] = { "Alice", "Bob", "Chandra", "Dmitri", "Eve" };
+    static const char *groups[] = { "STAFF", "VISITOR", "CONTRACTOR", "VIP" };
+    static const char *titles[] = { "ENTRY GRANTED", "EXIT OK", "ACCESS DENIED", "ROOM FULL" };
+    char l1[32];
+    char l2[32];
+
+    switch(kind % 6) {
+        case 0:     // Scroll page 0
+            snprintf(l1, sizeof(l1), "People: %u/%u ", rnd() % 60, 50u);
+            snprintf(l2, sizeof(l2), "AirQ: %u    ", 300 + rnd() % 400);
+            break;
+        case 1:     // Scroll page 1
+            snprintf(l1, sizeof(l1), "Temp: %u.%uC      ", 18 + rnd() % 10, rnd() % 10);
+            snprintf(l2, sizeof(l2), "Humi: %u%%      ", 30 + rnd() % 40);
+            break;
+        case 2:     // Scroll page 2
+            snprintf(l1, sizeof(l1), "AirQ: %u    ", 300 + rnd() % 400);
+            snprintf(l2, sizeof(l2), "%s", (rnd() & 1) ? "GOOD" : "MODERATE");
+            break;
+        case 3:     // Card info
+            snprintf(l1, sizeof(l1), "Card: %-10s", names[rnd() % 5]);
+            snprintf(l2, sizeof(l2), "%s", groups[rnd() % 4]);
+            break;
+        case 4:     // Result (centered title)
+        {
+            const char *t = titles[rnd() % 4];
+            int pad = (LCD_COLS - (int)strlen(t)) / 2;
+            snprintf(l1, sizeof(l1), "%*s%s", pad, "", t);
+            snprintf(l2, sizeof(l2), "Inside: %u/%u", rnd() % 50, 50u);
+            break;
+        }
+        default:
+            snprintf(l1, sizeof(l1), "Checking...");
+            snprintf(l2, sizeof(l2), "%s", "");
+            break;
+    }
+    draw(l1, l2);
+}
+
+static uint8_t panel_ok(void) {
+    for(uint8_t r = 0; r < LCD_ROWS; r++) {
+        if(memcmp(&hd.ddram[r ? 0x40 : 0x00], want[r], LCD_COLS) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void panel_dump(void) {
+    printf("    panel |%.16s|%.16s|\n", &hd.ddram[0x00], &hd.ddram[0x40]);
+    printf("    want  |%.16s|%.16s|\n", want[0], want[1]);
+}
+
+// ============================================
+// One measured flush
+// ============================================
+typedef struct {
+    uint32_t bytes;
+    uint32_t moves;
+    uint64_t bus_us;        // Flush call -> last byte executed
+    uint64_t blocked_us;    // Flush call -> flush returns
+} Flush_t;
+
+static Flush_t flush_measure(uint32_t drain) {
+    Flush_t f;
+    uint32_t bytes0 = hd.data + hd.cmds;
+    uint32_t moves0 = hd.moves;
+    uint64_t t0 = now_us;
+
+    lcd_fb_flush();
+    gpio_settle();
+    f.blocked_us = now_us - t0;
+    if(drain) run_ticks(0);
+
+    f.bytes = hd.data + hd.cmds - bytes0;
+    f.moves = hd.moves - moves0;
+    f.bus_us = f.bytes ? hd.last_write_us + HD_EXEC_US - t0 : 0;
+    return f;
+}
+
+static uint32_t fail = 0;
+
+static void check(uint8_t ok, const char *what) {
+    if(!ok) {
+        printf("  FAIL %s\n", what);
+        panel_dump();
+        fail++;
+    }
+}
+
+// ============================================
+// Scenarios
+// ============================================
+static void test_blocking(void) {
+    Flush_t f;
+
+    hd_reset();
+    lcd_init();
+    check(!hd.eight_bit, "lcd_init leaves the panel in 4-bit mode");
+
+    lcd_fb_clear();
+    draw("Presence System", "Booting...");
+    f = flush_measure(0);
+    check(panel_ok(), "blocking flush: panel == framebuffer");
+    printf("blocking  boot screen  %3u bytes %2u moves  bus %6llu us  blocked %6llu us\n",
+           f.bytes, f.moves, (unsigned long long)f.bus_us,
+           (unsigned long long)f.blocked_us);
+
+    draw("Presence System", "Ready");
+    f = flush_measure(0);
+    check(panel_ok(), "blocking flush (diff): panel == framebuffer");
+    printf("blocking  diff screen  %3u bytes %2u moves  bus %6llu us  blocked %6llu us\n\n",
+           f.bytes, f.moves, (unsigned long long)f.bus_us,
+           (unsigned long long)f.blocked_us);
+}
+
+static void test_async_screens(uint32_t screens) {
+    uint64_t sum_bytes = 0;
+    uint64_t sum_moves = 0;
+    uint64_t sum_bus = 0;
+    uint32_t max_bytes = 0;
+    uint64_t max_bus = 0;
+    uint32_t stat_mismatch = 0;
+    uint32_t panel_bad = 0;
+    uint32_t blocked = 0;
+    Flush_t f;
+
+    lcd_async_init();
+
+    // Same screen again: nothing to write
+    f = flush_measure(1);
+    check(f.bytes == 0, "unchanged screen writes no bytes");
+
+    for(uint32_t i = 0; i < screens; i++) {
+        draw_random(rnd());
+        f = flush_measure(1);
+
+        if(!panel_ok()) {
+            if(!panel_bad) panel_dump();
+            panel_bad++;
+        }
+        if(f.bytes != lcd_flush_stats.bytes || f.moves != lcd_flush_stats.cursor_moves ||
+           f.bus_us > lcd_flush_stats.bus_us + LCD_TICK_US) {
+            stat_mismatch++;
+        }
+        if(f.blocked_us) blocked++;
+
+        sum_bytes += f.bytes;
+        sum_moves += f.moves;
+        sum_bus += f.bus_us;
+        if(f.bytes > max_bytes) max_bytes = f.bytes;
+        if(f.bus_us > max_bus) max_bus = f.bus_us;
+    }
+
+    printf("async     %u screens   %5.1f bytes %4.1f moves  bus %6.0f us avg, "
+           "max %u bytes / %llu us\n",
+           screens, (double)sum_bytes / screens, (double)sum_moves / screens,
+           (double)sum_bus / screens, max_bytes, (unsigned long long)max_bus);
+    printf("          full redraw would be %u bytes / %u us\n\n",
+           LCD_ROWS * (LCD_COLS + 1), LCD_ROWS * (LCD_COLS + 1) * LCD_DATA_US);
+
+    check(panel_bad == 0, "async flush: panel == framebuffer after drain");
+    check(stat_mismatch == 0, "lcd_flush_stats match the bytes on the bus");
+    check(blocked == 0, "async flush never blocks the caller");
+    check(max_bytes <= LCD_ROWS * (LCD_COLS + 1), "no flush writes more than a full redraw");
+}
+
+static void test_replace(void) {
+    uint32_t replaced0 = lcd_async_stats.replaced;
+
+    // Screen A still queued when B is drawn: B wins
+    draw("AAAAAAAAAAAAAAAA", "aaaaaaaaaaaaaaaa");
+    flush_measure(0);
+    run_ticks(6);
+    draw("Checking...", "");
+    flush_measure(1);
+    check(panel_ok(), "newer screen replaces a queued one");
+    check(lcd_async_stats.replaced > replaced0, "queued bytes counted as replaced");
+    printf("replace   %u queued bytes dropped\n", lcd_async_stats.replaced - replaced0);
+}
+
+static void test_invalidate(void) {
+    Flush_t f;
+
+    // Panel scribbled outside the driver: invalidate forces a full redraw
+    memset(&hd.ddram[0x40], '#', LCD_COLS);
+    lcd_fb_invalidate();
+    f = flush_measure(1);
+    check(panel_ok(), "invalidate + flush restores the panel");
+    check(f.bytes == LCD_ROWS * (LCD_COLS + 1), "invalidate rewrites every cell");
+
+    f = flush_measure(1);
+    check(f.bytes == 0, "shadow valid again after a drained full redraw");
+
+    // Full redraw cut short by a newer screen: that one must be full too
+    memset(&hd.ddram[0x00], '#', LCD_COLS);
+    lcd_fb_invalidate();
+    flush_measure(0);
+    run_ticks(8);
+    draw("Scan Card...", "");
+    f = flush_measure(1);
+    check(panel_ok(), "dropped full redraw is redone by the next flush");
+    check(f.bytes == LCD_ROWS * (LCD_COLS + 1), "next flush after a dropped redraw is full");
+    printf("invalidate full redraw %u bytes\n", f.bytes);
+}
+
+// ============================================
+// Main
+// ============================================
+int main(int argc, char **argv) {
+    uint32_t screens = (argc > 1) ? (uint32_t)atoi(argv[1]) : 2000;
+
+    if(argc > 2) rng = (uint32_t)atoi(argv[2]);
+    if(screens == 0) screens = 1;
+
+    test_blocking();
+    test_async_screens(screens);
+    test_replace();
+    test_invalidate();
+
+    printf("\n%u writes while busy\n", hd.busy_hits);
+    check(hd.busy_hits == 0, "no write while the controller is busy");
+
+    printf("%s\n", fail ? "FAIL" : "PASS");
+    return fail ? 1 : 0;
+}
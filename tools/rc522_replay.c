@@ -0,0 +1,575 @@
+/*
+ * ============================================
+ * RC522 SPI REPLAY BENCHMARK
+ * Runs the real src-codes/RC522_RFID.c on the
+ * host against a replay SSP0 backend fed by a
+ * TRACE capture (SPITRACE.c dump in a UART0 log).
+ * Each recorded driver call (M line) is made
+ * again with the same arguments; every register
+ * access is matched against the recording:
+ *   matched  same register, same direction
+ *   missed   recorded but not made any more
+ *   extra    made but not in the recording
+ *   wr_diff  write with a different value
+ * Reads return the recorded value, so a driver
+ * change can be checked for SPI traffic per scan
+ * phase before it goes near the board.
+ *
+ * --synth records a capture first against a
+ * register model of an RC522 with a MIFARE card
+ * (idle REQA polls, then REQA, anticoll, select,
+ * auth, read, write, halt) and replays that.
+ *
+ * Build (from the repo root):
+ *   gcc -O2 -DPROFILE_ENABLE=0 -DSPITRACE_ENABLE=1 -Isrc-codes \
+ *       tools/rc522_replay.c src-codes/RC522_RFID.c -o rc522_replay
+ *
+ * Usage:
+ *   rc522_replay capture.log [repeat]
+ *   rc522_replay --synth [idle_polls] [repeat] [save.log]
+ *
+ * Exit status 1 when the replay diverged.
+ * Phase numbers must match SPITRACE.h.
+ * ============================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "SSP0.h"
+#include "DELAY.h"
+#include "RC522_RFID.h"
+#include "SPITRACE.h"
+
+#define MAX_ENTRIES     (1 << 20)
+#define SPI_XFER_US     6           // 2 bytes at 3.125MHz + CS / call overhead
+#define SPI_BUS_NS      5120        // 16 bits at PCLK 25MHz / CPSR 8
+
+static const char *phase_names[SPITRACE_PH_COUNT] = {
+    "NONE", "INIT", "REQUEST", "ANTICOLL", "SELECT",
+    "AUTH", "READ", "WRITE", "HALT"
+};
+
+typedef struct {
+    uint32_t t_us;
+    uint8_t kind;
+    uint8_t addr;
+    uint8_t value;
+    uint8_t phase;
+} Entry_t;
+
+typedef struct {
+    uint32_t calls;
+    uint32_t rec_xfers;
+    uint32_t rec_us;
+    uint32_t xfers;
+    uint32_t matched;
+    uint32_t missed;
+    uint32_t extra;
+    uint32_t wr_diff;
+    uint64_t host_ns;
+} PhaseStats_t;
+
+enum { BACKEND_MODEL, BACKEND_REPLAY };
+
+static Entry_t *trace;
+static uint32_t trace_n;
+static int backend;
+
+// ============================================
+// Recorder (model backend)
+// ============================================
+static uint32_t model_us;
+static uint8_t rec_phase;
+
+static void rec_push(uint8_t kind, uint8_t addr, uint8_t value) {
+    if(trace_n >= MAX_ENTRIES) return;
+    trace[trace_n].t_us = model_us;
+    trace[trace_n].kind = kind;
+    trace[trace_n].addr = addr;
+    trace[trace_n].value = value;
+    trace[trace_n].phase = rec_phase;
+    trace_n++;
+}
+
+// ============================================
+// RC522 Register Model + one MIFARE Classic card
+// ============================================
+static uint8_t regs[64];
+static uint8_t fifo[64];
+static uint8_t fifo_n, fifo_rd;
+static uint32_t irq_at;             // model_us the pending IRQ fires
+static uint8_t irq_bits;
+static uint8_t card_present, card_halted, card_write_step;
+static const uint8_t card_uid[4] = {0xF3, 0x52, 0x22, 0x2A};
+
+static uint16_t crc_a(const uint8_t *p, uint8_t n) {
+    uint16_t crc = 0x6363;
+    for(uint8_t i = 0; i < n; i++) {
+        uint8_t b = p[i] ^ (uint8_t)crc;
+        b ^= b << 4;
+        crc = (crc >> 8) ^ ((uint16_t)b << 8) ^ ((uint16_t)b << 3) ^ (b >> 4);
+    }
+    return crc;
+}
+
+static void fifo_load(const uint8_t *p, uint8_t n, uint8_t last_bits) {
+    memcpy(fifo, p, n);
+    fifo_n = n;
+    fifo_rd = 0;
+    regs[RC522_REG_CONTROL] = last_bits;
+}
+
+static uint32_t model_timer_us(void) {
+    uint32_t pre = ((uint32_t)(regs[RC522_REG_TMODE] & 0x0F) << 8) | regs[RC522_REG_TPRESCALER];
+    uint32_t reload = ((uint32_t)regs[RC522_REG_TRELOAD_HI] << 8) | regs[RC522_REG_TRELOAD_LO];
+    return (uint32_t)((uint64_t)reload * (2 * pre + 1) * 1000000ULL / 13560000ULL);
+}
+
+static void model_transceive(void) {
+    uint8_t in[64], out[18];
+    uint8_t n = fifo_n - fifo_rd;
+    uint16_t crc;
+
+    memcpy(in, fifo + fifo_rd, n);
+    fifo_n = fifo_rd = 0;
+
+    // No answer: the RC522 timer runs out
+    irq_bits = 0x01;
+    irq_at = model_us + model_timer_us();
+
+    if(!card_present || n == 0) return;
+
+    if((in[0] == PICC_CMD_REQA && !card_halted) || in[0] == PICC_CMD_WUPA) {
+        card_halted = 0;
+        out[0] = 0x04; out[1] = 0x00;
+        fifo_load(out, 2, 0);
+    } else if(card_halted) {
+        return;
+    } else if(in[0] == PICC_CMD_SEL_CL1 && n == 2 && in[1] == 0x20) {
+        memcpy(out, card_uid, 4);
+        out[4] = card_uid[0] ^ card_uid[1] ^ card_uid[2] ^ card_uid[3];
+        fifo_load(out, 5, 0);
+    } else if(in[0] == PICC_CMD_SEL_CL1 && n == 9 && in[1] == 0x70) {
+        out[0] = 0x08;
+        crc = crc_a(out, 1);
+        out[1] = (uint8_t)crc; out[2] = (uint8_t)(crc >> 8);
+        fifo_load(out, 3, 0);
+    } else if(in[0] == PICC_CMD_HLTA) {
+        card_halted = 1;
+        return;
+    } else if(in[0] == PICC_CMD_MF_READ && n == 4) {
+        for(uint8_t i = 0; i < 16; i++) out[i] = (uint8_t)(in[1] * 16 + i);
+        crc = crc_a(out, 16);
+        out[16] = (uint8_t)crc; out[17] = (uint8_t)(crc >> 8);
+        fifo_load(out, 18, 0);
+    } else if((in[0] == PICC_CMD_MF_WRITE && n == 4) || (card_write_step && n == 18)) {
+        card_write_step = !card_write_step;
+        out[0] = 0x0A;
+        fifo_load(out, 1, 4);
+    } else {
+        return;
+    }
+
+    // Frame out + answer back at 106kbit/s
+    irq_bits = 0x30;
+    irq_at = model_us + 100 + n * 100;
+}
+
+static void model_command(uint8_t cmd) {
+    uint16_t crc;
+
+    regs[RC522_REG_COMMAND] = cmd;
+    switch(cmd) {
+        case RC522_CMD_SOFT_RESET:
+            memset(regs, 0, sizeof(regs));
+            fifo_n = fifo_rd = 0;
+            irq_bits = 0;
+            break;
+        case RC522_CMD_CALC_CRC:
+            crc = crc_a(fifo + fifo_rd, fifo_n - fifo_rd);
+            regs[RC522_REG_CRC_RESULT_L] = (uint8_t)crc;
+            regs[RC522_REG_CRC_RESULT_H] = (uint8_t)(crc >> 8);
+            regs[RC522_REG_DIVIRQ] |= 0x04;
+            break;
+        case RC522_CMD_MF_AUTHENT:
+            fifo_n = fifo_rd = 0;
+            if(card_present && !card_halted) {
+                regs[RC522_REG_STATUS2] |= 0x08;
+                irq_bits = 0x10;
+                irq_at = model_us + 1000;
+            } else {
+                irq_bits = 0x01;
+                irq_at = model_us + model_timer_us();
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void model_write(uint8_t addr, uint8_t value) {
+    switch(addr) {
+        case RC522_REG_COMIRQ:
+        case RC522_REG_DIVIRQ:
+            if(value & 0x80) regs[addr] |= value & 0x7F;
+            else regs[addr] &= ~(value & 0x7F);
+            break;
+        case RC522_REG_FIFO_DATA:
+            if(fifo_n < sizeof(fifo)) fifo[fifo_n++] = value;
+            break;
+        case RC522_REG_FIFO_LEVEL:
+            if(value & 0x80) fifo_n = fifo_rd = 0;
+            break;
+        case RC522_REG_COMMAND:
+            model_command(value & 0x0F);
+            break;
+        case RC522_REG_BIT_FRAMING:
+            regs[addr] = value & 0x7F;
+            if((value & 0x80) && regs[RC522_REG_COMMAND] == RC522_CMD_TRANSCEIVE) {
+                model_transceive();
+            }
+            break;
+        default:
+            regs[addr & 0x3F] = value;
+            break;
+    }
+}
+
+static uint8_t model_read(uint8_t addr) {
+    switch(addr) {
+        case RC522_REG_COMIRQ:
+            if(irq_bits && (int32_t)(model_us - irq_at) >= 0) {
+                regs[addr] |= irq_bits;
+                irq_bits = 0;
+            }
+            return regs[addr];
+        case RC522_REG_FIFO_DATA:
+            return (fifo_rd < fifo_n) ? fifo[fifo_rd++] : 0;
+        case RC522_REG_FIFO_LEVEL:
+            return fifo_n - fifo_rd;
+        case RC522_REG_VERSION:
+            return 0x92;
+        default:
+            return regs[addr & 0x3F];
+    }
+}
+
+// ============================================
+// Replay Backend
+// ============================================
+static uint32_t rp_cur, rp_end;
+static uint8_t rp_phase;
+static uint8_t rp_last[64];         // Last recorded read per register in this call
+static PhaseStats_t stats[SPITRACE_PH_COUNT];
+
+static int32_t replay_match(uint8_t kind, uint8_t addr) {
+    for(uint32_t k = rp_cur; k < rp_end; k++) {
+        if(trace[k].kind == kind && trace[k].addr == addr) {
+            stats[rp_phase].missed += k - rp_cur;
+            stats[rp_phase].matched++;
+            rp_cur = k + 1;
+            return (int32_t)k;
+        }
+    }
+    stats[rp_phase].extra++;
+    return -1;
+}
+
+// ============================================
+// SSP0 / DELAY / SPITRACE stubs used by RC522_RFID.c
+// ============================================
+void SSP0_Write(uint8_t addr, uint8_t value) {
+    if(backend == BACKEND_MODEL) {
+        model_us += SPI_XFER_US;
+        model_write(addr, value);
+        rec_push(SPITRACE_WRITE, addr, value);
+    } else {
+        int32_t k = replay_match(SPITRACE_WRITE, addr);
+        stats[rp_phase].xfers++;
+        if(k >= 0 && trace[k].value != value) stats[rp_phase].wr_diff++;
+    }
+}
+
+uint8_t SSP0_Read(uint8_t addr) {
+    uint8_t v;
+
+    if(backend == BACKEND_MODEL) {
+        model_us += SPI_XFER_US;
+        v = model_read(addr);
+        rec_push(SPITRACE_READ, addr, v);
+        return v;
+    } else {
+        int32_t k = replay_match(SPITRACE_READ, addr);
+        stats[rp_phase].xfers++;
+        if(k >= 0) rp_last[addr & 0x3F] = trace[k].value;
+        return rp_last[addr & 0x3F];
+    }
+}
+
+void spitrace_phase(uint8_t phase) {
+    if(backend == BACKEND_MODEL) {
+        rec_phase = phase;
+        rec_push(SPITRACE_MARK, phase, 0);
+    }
+}
+
+void delay_ms(uint32_t ms) {
+    if(backend == BACKEND_MODEL) model_us += ms * 1000;
+}
+
+void delay_us(uint32_t us) {
+    if(backend == BACKEND_MODEL) model_us += us;
+}
+
+// ============================================
+// Capture Text (same lines SPITRACE.c sends)
+// ============================================
+static void capture_write(FILE *f) {
+    fprintf(f, "TRACE,{\"type\":\"SPI_TRACE\",\"n\":%u,\"overwritten\":0,\"t0\":0}\r\n", trace_n);
+    for(uint32_t i = 0; i < trace_n; i++) {
+        const Entry_t *e = &trace[i];
+        fprintf(f, "TRACE,%u,%u,%c,%u,%02X,%02X\r\n", i, e->t_us,
+                "WRM"[e->kind], e->phase, e->addr, e->value);
+    }
+}
+
+// Entries before a capture's first M line belong to a cut-off call
+static uint32_t capture_read(FILE *f) {
+    char line[256];
+    uint32_t partial = 0;
+    uint8_t in_call = 0;
+
+    trace_n = 0;
+    while(fgets(line, sizeof(line), f)) {
+        char *p = strstr(line, "TRACE,");
+        unsigned long idx, t;
+        unsigned int ph, addr, value;
+        char kind;
+
+        if(!p) continue;
+        p += 6;
+        if(*p == '{') {
+            if(strstr(p, "\"SPI_TRACE\"")) in_call = 0;
+            continue;
+        }
+        if(sscanf(p, "%lu,%lu,%c,%u,%x,%x", &idx, &t, &kind, &ph, &addr, &value) != 6) {
+            continue;
+        }
+        if(kind == 'M') in_call = 1;
+        if(!in_call) { partial++; continue; }
+        if(trace_n >= MAX_ENTRIES) break;
+
+        trace[trace_n].t_us = (uint32_t)t;
+        trace[trace_n].kind = (kind == 'W') ? SPITRACE_WRITE :
+                              (kind == 'R') ? SPITRACE_READ : SPITRACE_MARK;
+        trace[trace_n].phase = (ph < SPITRACE_PH_COUNT) ? (uint8_t)ph : 0;
+        trace[trace_n].addr = (uint8_t)addr;
+        trace[trace_n].value = (uint8_t)value;
+        trace_n++;
+    }
+    return partial;
+}
+
+// ============================================
+// Replay one recorded call
+// ============================================
+static uint8_t fifo_writes(uint32_t from, uint32_t to, uint8_t *out, uint8_t max) {
+    uint8_t n = 0;
+    for(uint32_t k = from; k < to && n < max; k++) {
+        if(trace[k].kind == SPITRACE_WRITE && trace[k].addr == RC522_REG_FIFO_DATA) {
+            out[n++] = trace[k].value;
+        }
+    }
+    return n;
+}
+
+static uint8_t replay_uid[5];
+
+static void replay_call(uint8_t phase, uint32_t from, uint32_t to) {
+    uint8_t fw[64], buf[18];
+    uint8_t n = fifo_writes(from, to, fw, sizeof(fw));
+    struct timespec t0, t1;
+
+    memset(fw + n, 0, sizeof(fw) - n);
+    rp_cur = from;
+    rp_end = to;
+    rp_phase = phase;
+    memset(rp_last, 0, sizeof(rp_last));
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    switch(phase) {
+        case SPITRACE_PH_INIT:
+            RC522_Init();
+            break;
+        case SPITRACE_PH_REQUEST:
+            RC522_Request(n ? fw[0] : PICC_CMD_REQA, buf);
+            break;
+        case SPITRACE_PH_ANTICOLL:
+            RC522_Anticoll(replay_uid);
+            break;
+        case SPITRACE_PH_SELECT:
+            // CRC pass writes 93 70 uid[5] first
+            memcpy(buf, fw + 2, 5);
+            RC522_SelectTag(buf);
+            break;
+        case SPITRACE_PH_AUTH:
+            RC522_Auth(fw[0], fw[1], fw + 2, fw + 8);
+            break;
+        case SPITRACE_PH_READ:
+            RC522_Read(fw[1], buf);
+            break;
+        case SPITRACE_PH_WRITE:
+            // CRC(2) ToCard(4) CRC(16 data) ToCard(18)
+            RC522_Write(fw[1], fw + 6);
+            break;
+        case SPITRACE_PH_HALT:
+            RC522_Halt();
+            break;
+        default:
+            break;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    stats[phase].missed += rp_end - rp_cur;
+    stats[phase].host_ns += (uint64_t)(t1.tv_sec - t0.tv_sec) * 1000000000ULL +
+                            (uint64_t)(t1.tv_nsec - t0.tv_nsec);
+}
+
+static void replay_all(uint32_t repeat) {
+    memset(stats, 0, sizeof(stats));
+
+    for(uint32_t r = 0; r < repeat; r++) {
+        uint32_t i = 0;
+
+        while(i < trace_n) {
+            uint32_t end = i + 1;
+            uint8_t ph = trace[i].phase;
+
+            while(end < trace_n && trace[end].kind != SPITRACE_MARK) end++;
+
+            if(r == 0) {
+                stats[ph].calls++;
+                stats[ph].rec_xfers += end - i - 1;
+                stats[ph].rec_us += trace[end - 1].t_us - trace[i].t_us;
+            }
+            replay_call(ph, i + 1, end);
+            i = end;
+        }
+    }
+}
+
+// ============================================
+// Synthetic session against the model
+// ============================================
+static void synth_session(uint32_t idle_polls) {
+    uint8_t tag[2], uid[5], block[18];
+    uint8_t key[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    uint8_t data[16];
+
+    backend = BACKEND_MODEL;
+    trace_n = 0;
+    model_us = 0;
+    card_present = card_halted = card_write_step = 0;
+
+    RC522_Init();
+    for(uint32_t i = 0; i < idle_polls; i++) {
+        RC522_Request(PICC_CMD_REQA, tag);
+    }
+
+    card_present = 1;
+    RC522_Request(PICC_CMD_REQA, tag);
+    RC522_Anticoll(uid);
+    RC522_SelectTag(uid);
+    RC522_Auth(PICC_CMD_MF_AUTH_KEY_A, 4, key, uid);
+    RC522_Read(4, block);
+    for(uint8_t i = 0; i < 16; i++) data[i] = (uint8_t)(0xA0 + i);
+    RC522_Write(4, data);
+    RC522_Halt();
+    RC522_Request(PICC_CMD_REQA, tag);     // Halted: no answer
+}
+
+// ============================================
+// Report
+// ============================================
+static int report(uint32_t repeat, uint32_t partial) {
+    PhaseStats_t tot;
+    int diverged = 0;
+
+    memset(&tot, 0, sizeof(tot));
+    printf("%u entries, %u partial-call entries skipped, replayed x%u\n\n",
+           trace_n, partial, repeat);
+    printf("%-9s %6s %8s %8s %8s %7s %6s %7s %9s %9s %9s\n",
+           "phase", "calls", "rec_xfr", "xfr", "matched", "missed", "extra",
+           "wr_diff", "rec_us", "bus_us", "host_ns");
+
+    for(uint8_t p = 0; p < SPITRACE_PH_COUNT; p++) {
+        PhaseStats_t *s = &stats[p];
+        uint32_t xfers = s->xfers / repeat;
+
+        if(!s->calls) continue;
+        printf("%-9s %6u %8u %8u %8u %7u %6u %7u %9u %9u %9llu\n",
+               phase_names[p], s->calls, s->rec_xfers, xfers,
+               s->matched / repeat, s->missed / repeat, s->extra / repeat,
+               s->wr_diff / repeat, s->rec_us,
+               (uint32_t)((uint64_t)xfers * SPI_BUS_NS / 1000),
+               (unsigned long long)(s->host_ns / repeat / s->calls));
+
+        tot.calls += s->calls;
+        tot.rec_xfers += s->rec_xfers;
+        tot.xfers += xfers;
+        tot.host_ns += s->host_ns;
+        if(s->missed || s->extra || s->wr_diff) diverged = 1;
+    }
+
+    printf("\n%u calls, %u transactions recorded, %u replayed, host %.1f ns/transaction\n",
+           tot.calls, tot.rec_xfers, tot.xfers,
+           tot.xfers ? (double)tot.host_ns / repeat / tot.xfers : 0.0);
+    printf("%s\n", diverged ? "DIVERGED" : "identical SPI traffic");
+    return diverged;
+}
+
+int main(int argc, char **argv) {
+    uint32_t repeat = 1;
+    uint32_t partial = 0;
+    FILE *f;
+
+    if(argc < 2) {
+        fprintf(stderr, "usage: %s capture.log [repeat]\n"
+                        "       %s --synth [idle_polls] [repeat] [save.log]\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    trace = calloc(MAX_ENTRIES, sizeof(Entry_t));
+    if(!trace) return 2;
+
+    if(strcmp(argv[1], "--synth") == 0) {
+        uint32_t polls = (argc > 2) ? (uint32_t)atoi(argv[2]) : 3;
+        if(argc > 3) repeat = (uint32_t)atoi(argv[3]);
+
+        // Round trip through the text format the board sends
+        synth_session(polls);
+        f = (argc > 4) ? fopen(argv[4], "w+") : tmpfile();
+        if(!f) return 2;
+        capture_write(f);
+        rewind(f);
+    } else {
+        if(argc > 2) repeat = (uint32_t)atoi(argv[2]);
+        f = fopen(argv[1], "r");
+        if(!f) {
+            perror(argv[1]);
+            return 2;
+        }
+    }
+    if(repeat == 0) repeat = 1;
+
+    partial = capture_read(f);
+    fclose(f);
+
+    backend = BACKEND_REPLAY;
+    replay_all(repeat);
+    return report(repeat, partial);
+}
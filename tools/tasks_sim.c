@@ -0,0 +1,408 @@
+/*
+ * ============================================
+ * TASK GRAPH SIMULATOR
+ * Runs the firmware's scheduler (TASKS.c) and
+ * event bus (EVENTBUS.c) on the host against a
+ * virtual microsecond clock. The six tasks have
+ * the priorities / periods / stack budgets of
+ * TASKS.h; their bodies are cost models of the
+ * firmware ones (RFID idle poll ~12ms of SPI,
+ * ENV sample ~1ms once the DHT11 frame has been
+ * captured by its edge interrupt, TELEMETRY
+ * queueing frames without waiting, ...).
+ *
+ * Interrupts are scheduled in virtual time and
+ * posted as soon as the clock passes them: EINT1
+ * button presses, UART3 lines, ADC ring wraps
+ * (only while the sensor task has the ADC on)
+ * and card arrivals at the reader. Checks:
+ *   - every event is handled, in order per queue
+ *   - an event waits at most for the longest run
+ *     of one other task (no blocking beyond that)
+ *   - every periodic task keeps its rate
+ *   - no task body runs longer than RUN_BUDGET_US
+ *     (the scheduler is cooperative: a long run
+ *     delays every other task)
+ *
+ * Idle time is reported the way POWER.c spends
+ * it: awake duty, core wake-ups per second with
+ * tickless idle (one per sleep, SysTick kept for
+ * waits under POWER_TICKLESS_MIN_MS) against a
+ * free-running 1ms tick, and the ADC's on time.
+ *
+ * Build (from the repo root):
+ *   gcc -O2 -DTASKS_HOST -DEVENTBUS_HOST -Isrc-codes \
+ *       tools/tasks_sim.c src-codes/TASKS.c src-codes/EVENTBUS.c \
+ *       -lm -o tasks_sim
+ *
+ * Usage:
+ *   tasks_sim [seconds] [seed] [legacy]
+ *     legacy          1 = before the idle manager: ADC always on,
+ *                     DHT11 start pulse spun in delay_ms and its
+ *                     bits bit-banged, 1% of TELEMETRY runs waiting
+ *                     ~50ms on a full UART queue, 1ms tick
+ *                     (the run budget is not checked)
+ * ============================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "TASKS.h"
+#include "EVENTBUS.h"
+#include "POWER.h"
+#include "DHT11.h"
+
+#define ADC_RESUME_MS 250       // ADC_BURST.h (needs the device header)
+#define RUN_BUDGET_US 15000     // Longest body allowed (RFID idle poll ~12ms)
+
+// ============================================
+// Virtual clock + interrupt sources
+// ============================================
+static uint64_t now_us = 0;
+static uint64_t end_us;
+static int print_frames = 0;
+
+typedef struct {
+    const char *name;
+    uint8_t queue;
+    uint8_t type;
+    double mean_ms;         // Exponential gaps (0 = fixed period_ms)
+    double period_ms;
+    uint64_t next_us;
+    uint32_t fired;
+    uint32_t handled;
+    uint32_t seq_errors;
+    uint64_t lat_sum;
+    uint32_t lat_max;
+    uint32_t hist[64];      // 1ms bins, last = overflow
+} Source_t;
+
+enum { SRC_BUTTON = 0, SRC_UART, SRC_ADC, SRC_COUNT };
+
+static Source_t sources[SRC_COUNT] = {
+    {"button",  EVQ_GPIO, EV_BUTTON_EDGE,  20000.0, 0,    0, 0, 0, 0, 0, 0, {0}},
+    {"uart",    EVQ_UART, EV_UART_RX_LINE, 500.0,   0,    0, 0, 0, 0, 0, 0, {0}},
+    {"adc",     EVQ_DMA,  EV_SENSOR_READY, 0,       43.0, 0, 0, 0, 0, 0, 0, {0}},
+};
+
+static int legacy = 0;
+static uint64_t adc_on_since = UINT64_MAX;
+static uint64_t adc_on_us = 0;
+
+// Idle accounting
+static uint64_t idle_us = 0;
+static uint32_t sleeps = 0;
+static uint64_t wakes_tickless = 0;
+static uint64_t wakes_ticking = 0;
+
+static uint64_t card_next_us;
+static double card_mean_ms = 4000.0;
+static uint32_t cards_presented = 0;
+
+static double urand(void) {
+    return (rand() + 1.0) / ((double)RAND_MAX + 2.0);
+}
+
+static uint64_t gap_us(const Source_t *s) {
+    if(s->mean_ms > 0) return (uint64_t)(-log(urand()) * s->mean_ms * 1000.0) + 1;
+    return (uint64_t)(s->period_ms * 1000.0);
+}
+
+// Interrupts whose time has come, oldest first
+static void fire_due(void) {
+    for(;;) {
+        Source_t *first = NULL;
+
+        for(int i = 0; i < SRC_COUNT; i++) {
+            if(sources[i].next_us <= now_us &&
+               (!first || sources[i].next_us < first->next_us)) {
+                first = &sources[i];
+            }
+        }
+        if(!first) break;
+
+        {
+            uint32_t data[2] = {(uint32_t)first->next_us, first->fired};
+            eventbus_post(first->queue, first->type, 0, data, sizeof(data));
+        }
+        first->fired++;
+        first->next_us += gap_us(first);
+    }
+}
+
+static void advance_us(uint64_t us) {
+    now_us += us;
+    fire_due();
+}
+
+static uint64_t next_irq_us(void) {
+    uint64_t t = UINT64_MAX;
+    for(int i = 0; i < SRC_COUNT; i++) {
+        if(sources[i].next_us < t) t = sources[i].next_us;
+    }
+    return t;
+}
+
+// ============================================
+// Firmware stubs
+// ============================================
+uint32_t millis(void) { return (uint32_t)(now_us / 1000); }
+uint32_t tasks_host_now_us(void) { return (uint32_t)now_us; }
+
+// Sleep until the next task is due or the next interrupt
+void tasks_host_idle(uint32_t ms) {
+    uint64_t wake = (ms == 0xFFFFFFFF) ? UINT64_MAX : (millis() + (uint64_t)ms) * 1000;
+    uint64_t irq = next_irq_us();
+    uint64_t ticks;
+
+    if(irq < wake) wake = irq;
+    if(wake > end_us) wake = end_us;
+    if(wake <= now_us) wake = now_us + 1;
+
+    // 1ms ticks inside the sleep; the one ending it is the wake
+    ticks = wake / 1000 - now_us / 1000;
+    sleeps++;
+    idle_us += wake - now_us;
+    wakes_ticking += (ticks && wake % 1000 == 0) ? ticks : ticks + 1;
+    wakes_tickless += (ms >= POWER_TICKLESS_MIN_MS && !legacy) ? 1 :
+                      (ticks && wake % 1000 == 0) ? ticks : ticks + 1;
+
+    advance_us(wake - now_us);
+}
+
+static void adc_power(int on) {
+    if(on && adc_on_since == UINT64_MAX) {
+        adc_on_since = now_us;
+        sources[SRC_ADC].next_us = now_us + gap_us(&sources[SRC_ADC]);
+    } else if(!on && adc_on_since != UINT64_MAX) {
+        adc_on_us += now_us - adc_on_since;
+        adc_on_since = UINT64_MAX;
+        sources[SRC_ADC].next_us = UINT64_MAX;
+    }
+}
+
+void uart_dual_send_string(char *str) {
+    if(print_frames) fputs(str, stdout);
+}
+
+// ============================================
+// Handlers (run inside the EVENTS task)
+// ============================================
+static void on_event(const Event_t *ev) {
+    Source_t *s = NULL;
+    uint32_t data[2];
+    uint32_t lat;
+
+    for(int i = 0; i < SRC_COUNT; i++) {
+        if(sources[i].type == ev->type) s = &sources[i];
+    }
+    if(!s) return;
+
+    memcpy(data, ev->data, sizeof(data));
+    if(data[1] != s->handled) s->seq_errors++;
+    s->handled = data[1] + 1;
+
+    lat = (uint32_t)now_us - data[0];
+    s->lat_sum += lat;
+    if(lat > s->lat_max) s->lat_max = lat;
+    s->hist[(lat / 1000) < 63 ? (lat / 1000) : 63]++;
+
+    // Handler costs: ALERT frame + LCD, line parse, ADC filters
+    advance_us(ev->type == EV_BUTTON_EDGE ? 1800 : ev->type == EV_UART_RX_LINE ? 300 : 150);
+}
+
+// ============================================
+// Totals across the firmware's 60s windows
+// ============================================
+static uint32_t total_runs[TASK_COUNT];
+static uint32_t total_max_us[TASK_COUNT];
+static uint32_t total_late_ms[TASK_COUNT];
+
+static void fold_window(void) {
+    for(int i = 0; i < TASK_COUNT; i++) {
+        total_runs[i] += tasks[i].runs;
+        if(tasks[i].us_max > total_max_us[i]) total_max_us[i] = tasks[i].us_max;
+        if(tasks[i].late_max_ms > total_late_ms[i]) total_late_ms[i] = tasks[i].late_max_ms;
+    }
+}
+
+// ============================================
+// Task cost models
+// ============================================
+static int scan_step = 0;
+
+static void task_events(void) {
+    eventbus_dispatch(EVENTBUS_DISPATCH_BUDGET);
+    if(eventbus_pending()) task_signal(TASK_EVENTS);
+}
+
+static void on_posted(void) {
+    task_signal(TASK_EVENTS);
+}
+
+static void task_gate(void) { advance_us(20); }
+
+// Idle REQA ~12ms (SPI trace, ComIrq poll runs out); a card
+// starts the Checking / Decide / Result / Cooldown screens
+static void task_rfid(void) {
+    static const uint32_t step_sleep_ms[4] = {1000, 2000, 2000, 1000};
+
+    if(scan_step == 0) {
+        if(now_us >= card_next_us) {
+            card_next_us = now_us + (uint64_t)(-log(urand()) * card_mean_ms * 1000.0);
+            cards_presented++;
+            advance_us(9000);                       // REQA + anticoll + lookup + LCD
+            task_sleep_ms(TASK_RFID, step_sleep_ms[scan_step++]);
+        } else {
+            advance_us(12000);
+        }
+        return;
+    }
+
+    advance_us(scan_step == 2 ? 4000 : 1500);       // Decision + frames / stats + gate
+    if(scan_step < 4) task_sleep_ms(TASK_RFID, step_sleep_ms[scan_step]);
+    scan_step = (scan_step + 1) % 5;
+}
+
+// ADC on ADC_RESUME_MS ahead, DHT11 start pulse and frame slept
+// through (42 edge interrupts of ~1us), then decode + MQ135 + ENV frame
+static void task_sensors(void) {
+    static int phase = 0;
+
+    if(legacy) {
+        advance_us(DHT11_START_MS * 1000 + 5500);
+        task_sleep_ms(TASK_SENSORS, 2000);
+        return;
+    }
+
+    switch(phase) {
+        case 0:
+            adc_power(1);
+            advance_us(30);
+            task_sleep_ms(TASK_SENSORS, ADC_RESUME_MS - DHT11_START_MS - DHT11_READ_MS);
+            break;
+        case 1:
+            advance_us(5);
+            task_sleep_ms(TASK_SENSORS, DHT11_START_MS);
+            break;
+        case 2:
+            advance_us(5);
+            task_sleep_ms(TASK_SENSORS, DHT11_READ_MS);
+            break;
+        default:
+            advance_us(1000);
+            adc_power(0);
+            task_sleep_ms(TASK_SENSORS, 2000 - ADC_RESUME_MS);
+            break;
+    }
+    phase = (phase + 1) % 4;
+}
+
+static void task_telemetry(void) {
+    if(legacy && (rand() % 100) < 1) advance_us(50000);        // Waited on a full queue
+    else advance_us(150);
+}
+
+static void task_ui(void) {
+    static uint32_t n = 0;
+    advance_us((++n % 30) == 0 ? 2500 : 200);       // Scroll screen every 3s
+    if(n % 600 == 0) {
+        fold_window();
+        tasks_report();
+    }
+}
+
+// ============================================
+// Main
+// ============================================
+int main(int argc, char **argv) {
+    uint32_t seconds = (argc > 1) ? (uint32_t)atoi(argv[1]) : 3600;
+    unsigned seed = (argc > 2) ? (unsigned)atoi(argv[2]) : 1;
+    uint32_t blocking_bound = 0;
+    int fail = 0;
+
+    if(argc > 3) legacy = atoi(argv[3]);
+    srand(seed);
+    end_us = (uint64_t)seconds * 1000000;
+
+    eventbus_init();
+    for(int i = 0; i < SRC_COUNT; i++) {
+        eventbus_subscribe(sources[i].type, on_event);
+        sources[i].next_us = gap_us(&sources[i]);
+    }
+    sources[SRC_ADC].next_us = UINT64_MAX;
+    if(legacy) adc_power(1);
+    eventbus_set_notify(on_posted);
+    card_next_us = (uint64_t)(card_mean_ms * 1000);
+
+    tasks_init();
+    task_create(TASK_EVENTS, "EVENTS", task_events,
+        TASK_EVENTS_PRIO, TASK_EVENTS_PERIOD_MS, TASK_EVENTS_STACK);
+    task_create(TASK_GATE, "GATE", task_gate,
+        TASK_GATE_PRIO, TASK_GATE_PERIOD_MS, TASK_GATE_STACK);
+    task_create(TASK_RFID, "RFID", task_rfid,
+        TASK_RFID_PRIO, TASK_RFID_PERIOD_MS, TASK_RFID_STACK);
+    task_create(TASK_SENSORS, "SENSORS", task_sensors,
+        TASK_SENSORS_PRIO, TASK_SENSORS_PERIOD_MS, TASK_SENSORS_STACK);
+    task_create(TASK_TELEMETRY, "TELEMETRY", task_telemetry,
+        TASK_TELEMETRY_PRIO, TASK_TELEMETRY_PERIOD_MS, TASK_TELEMETRY_STACK);
+    task_create(TASK_UI, "UI", task_ui,
+        TASK_UI_PRIO, TASK_UI_PERIOD_MS, TASK_UI_STACK);
+
+    while(now_us < end_us) tasks_run_once();
+    fold_window();
+    adc_power(0);
+
+    // Longest run of any task but EVENTS, plus the other handlers queued ahead
+    for(int i = 1; i < TASK_COUNT; i++) {
+        if(total_max_us[i] > blocking_bound) blocking_bound = total_max_us[i];
+    }
+    blocking_bound += EVENTBUS_DISPATCH_BUDGET * 1800;
+
+    printf("%u s simulated, %u cards presented\n\n", seconds, cards_presented);
+    printf("task        prio  period    runs  expected  max_us  late_ms\n");
+    for(int i = 0; i < TASK_COUNT; i++) {
+        const Task_t *t = &tasks[i];
+        uint32_t expect = t->period_ms ? seconds * 1000u / t->period_ms : 0;
+        int ok = 1;
+
+        // Sensors and RFID set their own sleeps; the rest keep >= 90% of their rate
+        if(i == TASK_GATE || i == TASK_TELEMETRY || i == TASK_UI) {
+            ok = total_runs[i] >= expect * 9 / 10;
+        }
+        if(!legacy && total_max_us[i] > RUN_BUDGET_US) ok = 0;
+        printf("%-10s %5u %7u %7u %9u %7u %8u%s\n", t->name, t->prio, t->period_ms,
+            total_runs[i], expect, total_max_us[i], total_late_ms[i], ok ? "" : "  SLOW");
+        if(!ok) fail = 1;
+    }
+
+    printf("\nsource   fired  handled  lost  mean_us   max_us  (bound %u us)\n", blocking_bound);
+    for(int i = 0; i < SRC_COUNT; i++) {
+        Source_t *s = &sources[i];
+        const EventBus_QueueStats_t *q = eventbus_queue_stats(s->queue);
+        uint32_t handled = s->fired - q->drops - eventbus_depth(s->queue);
+        int ok = s->seq_errors == 0 && s->lat_max <= blocking_bound;
+
+        printf("%-7s %6u %8u %5lu %8.0f %8u%s\n", s->name, s->fired, handled,
+            (unsigned long)q->drops, handled ? (double)s->lat_sum / handled : 0.0,
+            s->lat_max, ok ? "" : "  FAIL");
+        if(!ok) fail = 1;
+    }
+
+    printf("\nidle: awake duty %.2f%%, %u sleeps, wake-ups/s %.1f (1ms tick: %.1f), ADC on %.1f%%\n",
+        100.0 * (end_us - idle_us) / end_us, sleeps,
+        wakes_tickless / (double)seconds, wakes_ticking / (double)seconds,
+        100.0 * adc_on_us / end_us);
+
+    printf("\nlast window as reported by the firmware:\n");
+    print_frames = 1;
+    tasks_report();
+    eventbus_report();
+
+    printf("%s\n", fail ? "FAIL" : "PASS");
+    return fail;
+}
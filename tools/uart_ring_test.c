@@ -0,0 +1,290 @@
+/*
+ * ============================================
+ * UART RING TEST
+ * Runs the real src-codes/UAART0.c on the host
+ * against register stand-ins (tools/host) and
+ * checks both UART3 rings across thousands of
+ * wraps of their indices.
+ *
+ * TX: frames of 1..300 bytes are queued with
+ * uart_tx_write() while the THRE interrupt
+ * drains 16 bytes at a time. Checks:
+ *   - uart_tx_used() equals the model fill
+ *   - a frame is taken exactly when it fits,
+ *     and never while the queue is held for a
+ *     rate switch (uart_tx_hold)
+ *   - bytes leave in the order queued
+ *
+ * RX: a bridge model sends bursts of up to one
+ * FIFO (16 bytes) per interrupt and stops once
+ * it sees RTS raised (after the burst already in
+ * flight); the reader drains in bursts and
+ * stalls now and then. Checks:
+ *   - bytes arrive in order, none lost
+ *   - RTS is raised whenever the fill reaches
+ *     UART3_RTS_HIGH, and only released once it
+ *     is at or below UART3_RTS_LOW
+ *   - the fill posted with each line event
+ *     matches the model
+ *
+ * Build (from the repo root):
+ *   gcc -O2 -DEVENTBUS_HOST -Itools/host -Isrc-codes \
+ *       tools/uart_ring_test.c src-codes/UAART0.c -o uart_ring_test
+ *
+ * Usage:
+ *   uart_ring_test [steps] [seed]
+ *
+ * Exit status 1 on any FAIL.
+ * ============================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "LPC17xx.h"
+#include "uart.h"
+#include "SINK.h"
+#include "EVENTBUS.h"
+#include "DELAY.h"
+
+// ============================================
+// Device stand-ins
+// ============================================
+LPC_SC_TypeDef host_sc;
+LPC_PINCON_TypeDef host_pincon;
+LPC_GPIO_TypeDef host_gpio2;
+LPC_UART_TypeDef host_uart0, host_uart3;
+uint32_t SystemCoreClock = 100000000;
+
+static LPC_GPIO_TypeDef gpio0;
+static LPC_TIM_TypeDef tim1;
+
+// Bytes in the UART3 receive FIFO for the next interrupt
+static uint8_t rx_fifo[16];
+static uint8_t rx_fifo_n = 0;
+static uint8_t rx_fifo_pos = 0;
+
+LPC_GPIO_TypeDef *host_gpio0(void) { return &gpio0; }
+LPC_TIM_TypeDef *host_tim1(void) { return &tim1; }
+
+uint32_t host_uart_lsr(void) {
+    host_uart3.LSR_slot[0] = (rx_fifo_pos < rx_fifo_n ? 0x01 : 0) | 0x60;
+    host_uart0.LSR_slot[0] = 0x60;
+    return 0;
+}
+
+uint32_t host_uart_rbr(void) {
+    host_uart3.RBR_slot[0] = (rx_fifo_pos < rx_fifo_n) ? rx_fifo[rx_fifo_pos++] : 0;
+    return 0;
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq) { (void)irq; }
+void NVIC_DisableIRQ(IRQn_Type irq) { (void)irq; }
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority) { (void)irq; (void)priority; }
+
+uint32_t millis(void) { return 0; }
+void delay_ms(uint32_t ms) { (void)ms; }
+void delay_us(uint32_t us) { (void)us; }
+void sink_publish(const char *frame) { (void)frame; }
+
+void UART0_IRQHandler(void);
+void UART3_IRQHandler(void);
+
+// ============================================
+// Random numbers (xorshift64*)
+// ============================================
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t rnd(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (uint32_t)((rng_state * 2685821657736338717ULL) >> 32);
+}
+
+static uint8_t stream_byte(uint32_t i) {
+    uint8_t c = (uint8_t)(i * 7 + (i >> 8));
+    return (c == '\n') ? 'n' : c;               // Line ends only where placed
+}
+
+// ============================================
+// TX ring
+// ============================================
+static uint32_t test_tx(uint32_t steps) {
+    static char frame[300];
+    uint32_t fail = 0;
+    uint32_t queued = 0, sent = 0;              // Stream positions
+    uint32_t bad_used = 0, bad_take = 0, bad_order = 0;
+    uint32_t taken = 0, refused = 0, holds = 0;
+    uint8_t held = 0;
+
+    for(uint32_t i = 0; i < steps; i++) {
+        uint32_t before = uart3_stats.tx_bytes;
+        uint32_t fill = queued - sent;
+
+        if(rnd() % 500 == 0) {
+            held = !held;
+            holds += held;
+            uart_tx_hold(3, held);
+        }
+
+        if(rnd() % 100 < 45) {
+            uint16_t len = 1 + rnd() % sizeof(frame);
+            uint8_t fits = !held && len <= (UART_TX_RING_SIZE - 1) - fill;
+            uint8_t ok;
+
+            for(uint16_t k = 0; k < len; k++) frame[k] = (char)stream_byte(queued + k);
+            ok = uart_tx_write(3, frame, len);
+            if(ok != fits) bad_take++;
+            if(ok) {
+                queued += len;
+                taken++;
+            } else {
+                refused++;
+            }
+        } else {
+            host_uart3.IIR = 0x02;              // THRE
+            UART3_IRQHandler();
+            host_uart3.IIR = 0x01;
+        }
+
+        // Bytes loaded into the FIFO by the kick or the interrupt
+        if(uart3_stats.tx_bytes != before) {
+            sent += uart3_stats.tx_bytes - before;
+            if((uint8_t)host_uart3.THR != stream_byte(sent - 1)) bad_order++;
+        }
+        if(uart_tx_used(3) != queued - sent) bad_used++;
+        if(uart_tx_free(3) != (held ? 0 : (UART_TX_RING_SIZE - 1) - (queued - sent))) bad_used++;
+    }
+    uart_tx_hold(3, 0);
+
+    printf("TX  %u steps, %u frames taken, %u refused, %u holds, %u bytes, %u ring wraps\n",
+           steps, taken, refused, holds, sent, sent / UART_TX_RING_SIZE);
+    if(bad_used) printf("  FAIL uart_tx_used() / uart_tx_free() off the model %u times\n", bad_used);
+    if(bad_take) printf("  FAIL %u frames taken / refused against the free space\n", bad_take);
+    if(bad_order) printf("  FAIL %u bytes left out of order\n", bad_order);
+    if(sent < 16 * UART_TX_RING_SIZE) {
+        printf("  FAIL too few wraps to test\n");
+        fail++;
+    }
+    return fail + bad_used + bad_take + bad_order;
+}
+
+// ============================================
+// RX ring + RTS flow control
+// ============================================
+static uint32_t line_events = 0;
+static uint32_t line_bad_fill = 0;
+static uint32_t line_fill_base = 0;         // Ring fill before the burst
+
+// Posted from the ISR right after the '\n' went into the ring
+uint8_t eventbus_post(uint8_t queue, uint8_t type, uint16_t arg,
+                      const void *data, uint8_t len) {
+    (void)queue; (void)type; (void)data; (void)len;
+    line_events++;
+    if(arg != line_fill_base + rx_fifo_pos) line_bad_fill++;
+    return 1;
+}
+
+static uint8_t rts = 0;
+
+// RTS changes land as FIOSET / FIOCLR writes
+static void rts_follow(void) {
+    if(host_gpio2.FIOSET & UART3_RTS_PIN) rts = 1;
+    if(host_gpio2.FIOCLR & UART3_RTS_PIN) rts = 0;
+    host_gpio2.FIOSET = 0;
+    host_gpio2.FIOCLR = 0;
+}
+
+static uint32_t test_rx(uint32_t steps) {
+    uint32_t fail = 0;
+    uint32_t rx_sent = 0, rx_read = 0;
+    uint32_t bad_order = 0, bad_rts_high = 0, bad_rts_low = 0;
+    uint32_t stall = 0;
+    uint32_t stops_before = uart3_stats.rts_stops;
+
+    for(uint32_t i = 0; i < steps; i++) {
+        uint32_t fill = rx_sent - rx_read;
+
+        if(rnd() % 100 < 50) {
+            // Bridge: one burst, unless it has seen RTS
+            if(rts) continue;
+            rx_fifo_n = 1 + rnd() % 16;
+            rx_fifo_pos = 0;
+            for(uint8_t k = 0; k < rx_fifo_n; k++) {
+                uint32_t pos = rx_sent + k;
+                rx_fifo[k] = (rnd() % 40 == 0) ? '\n' : stream_byte(pos);
+            }
+            line_fill_base = fill;
+            host_uart3.IIR = 0x04;              // RDA
+            UART3_IRQHandler();
+            rx_sent += rx_fifo_n;
+            rts_follow();
+            if(rx_sent - rx_read >= UART3_RTS_HIGH && !rts) bad_rts_high++;
+        } else {
+            // Reader: stalls for a while now and then, else a burst
+            uint32_t n;
+            uint8_t was = rts;
+
+            if(stall) {
+                stall--;
+                continue;
+            }
+            if(rnd() % 50 == 0) stall = rnd() % 200;
+
+            n = 1 + rnd() % 48;
+            for(uint32_t k = 0; k < n; k++) {
+                uint8_t c;
+                uint32_t pos = rx_read;
+
+                if(!uart3_rx_read(&c)) break;
+                rx_read++;
+                if(c != '\n' && c != stream_byte(pos)) bad_order++;
+                rts_follow();
+                if(was && !rts && rx_sent - rx_read > UART3_RTS_LOW) bad_rts_low++;
+                if(rts && rx_sent - rx_read <= UART3_RTS_LOW) bad_rts_low++;
+                was = rts;
+            }
+        }
+    }
+
+    printf("RX  %u steps, %u bytes, %u ring wraps, %u lines, %u RTS stops, %u overflows\n",
+           steps, rx_sent, rx_sent / UART3_RX_RING_SIZE, line_events,
+           uart3_stats.rts_stops - stops_before, uart3_rx_overflows());
+    if(bad_order) printf("  FAIL %u bytes read out of order\n", bad_order);
+    if(bad_rts_high) printf("  FAIL RTS not raised at %u fills >= %u\n", bad_rts_high, UART3_RTS_HIGH);
+    if(bad_rts_low) printf("  FAIL RTS released above %u (or held below) %u times\n", UART3_RTS_LOW, bad_rts_low);
+    if(line_bad_fill) printf("  FAIL %u line events with the wrong fill\n", line_bad_fill);
+    if(uart3_rx_overflows()) {
+        printf("  FAIL receive ring overflowed under flow control\n");
+        fail++;
+    }
+    if(uart3_stats.rts_stops == stops_before || rx_sent < 16 * UART3_RX_RING_SIZE) {
+        printf("  FAIL too few wraps / RTS stops to test\n");
+        fail++;
+    }
+    return fail + bad_order + bad_rts_high + bad_rts_low + line_bad_fill;
+}
+
+// ============================================
+// Main
+// ============================================
+int main(int argc, char **argv) {
+    uint32_t steps = 400000;
+    uint32_t fail = 0;
+
+    if(argc > 1) steps = (uint32_t)atoi(argv[1]);
+    if(argc > 2) rng_state ^= (uint64_t)atoi(argv[2]) * 0x2545F4914F6CDD1DULL;
+
+    UART0_Init();
+    init_uart3();
+    rts_follow();
+
+    fail += test_tx(steps);
+    fail += test_rx(steps);
+
+    printf("%s\n", fail ? "FAIL" : "PASS");
+    return fail ? 1 : 0;
+}
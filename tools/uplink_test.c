@@ -0,0 +1,531 @@
+/*
+ * ============================================
+ * RELIABLE UPLINK LOSSY-LINK TEST
+ * Runs the real src-codes/UPLINK.c on the host
+ * against an emulated UART3 link and ESP32
+ * bridge, on a virtual millisecond clock:
+ *
+ *   uart_tx_write -> TX ring (UART_TX_RING_SIZE)
+ *   -> wire at the baud rate -> line loss ->
+ *   one-way latency -> bridge -> ACK,N -> loss ->
+ *   latency -> uplink_ack()
+ *
+ * The bridge follows the protocol in UPLINK.h:
+ * delivers seq == expected, re-ACKs anything
+ * else, skips to N on SYNC,N and takes the first
+ * seq it sees as its base after a restart.
+ *
+ * Scenarios:
+ *   loss     steady scan/telemetry load with 0-20%
+ *            of lines lost each way
+ *   bulk     window kept full: goodput against
+ *            the link's line rate and against
+ *            stop-and-wait (one frame per RTT)
+ *   outage   link down 5 s and 30 s (longer than
+ *            the buffer holds), with and without
+ *            a bridge reboot
+ * Checks:
+ *   - the bridge sees every frame once, in order,
+ *     with the body it was submitted with
+ *   - nothing is lost unless the buffer overflowed,
+ *     and then exactly uplink_stats.lost frames
+ *     are missing (and skipped by SYNC when the
+ *     bridge kept its state)
+ *   - recovery (link back -> backlog delivered)
+ *     within UPLINK_RTO_MAX_MS + the drain time
+ *   - bulk goodput >= 80% of the line rate (or of
+ *     the window per round trip, whichever is
+ *     lower) without loss, and above stop-and-wait
+ *     at every loss rate
+ *
+ * Build (from the repo root):
+ *   gcc -O2 -Isrc-codes tools/uplink_test.c src-codes/UPLINK.c \
+ *       -lm -o uplink_test
+ *
+ * Usage:
+ *   uplink_test [seed] [baud] [latency_ms]
+ *     baud        UART3 rate, default 115200 (bridges that
+ *                 ACK negotiate 57600 or more, UARTLINK.h)
+ *     latency_ms  one way, bridge turnaround included
+ *                 (default 10)
+ *
+ * Exit status 1 on any FAIL.
+ * ============================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "UPLINK.h"
+#include "uart.h"
+
+#define SERVICE_MS      10              // Main loop calls uplink_service()
+#define LOAD_FPS        4               // Scans + telemetry, steady load
+#define LOAD_SECONDS    120
+#define FRAME_PAD       80              // Body padding: ~120-byte frames
+#define FRAME_WIRE_MAX  130             // Longest test frame with its seq
+#define MAX_FRAMES      40000
+#define LINE_MAX        256
+#define PIPE_MAX        4096
+
+static uint32_t baud = 115200;
+static uint32_t latency_ms = 10;        // Each way, bridge processing included
+
+// ============================================
+// Random numbers (xorshift64*)
+// ============================================
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static double rnd(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return ((rng_state * 2685821657736338717ULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// ============================================
+// Virtual clock + UART3 TX ring
+// ============================================
+static uint32_t now_ms = 0;
+
+static char tx_ring[UART_TX_RING_SIZE];
+static uint32_t tx_head = 0;
+static uint32_t tx_tail = 0;
+static uint64_t wire_bytes = 0;
+
+uint32_t millis(void) { return now_ms; }
+void delay_ms(uint32_t ms) { (void)ms; }
+void delay_us(uint32_t us) { (void)us; }
+void uart_dual_send_string(const char *s) { (void)s; }
+
+uint16_t uart_tx_used(uint8_t port) {
+    (void)port;
+    return (uint16_t)(tx_head - tx_tail);
+}
+
+uint16_t uart_tx_free(uint8_t port) {
+    return (UART_TX_RING_SIZE - 1) - uart_tx_used(port);
+}
+
+uint8_t uart_tx_write(uint8_t port, const char *s, uint16_t len) {
+    if(len > uart_tx_free(port)) return 0;
+    for(uint16_t i = 0; i < len; i++) {
+        tx_ring[tx_head++ % UART_TX_RING_SIZE] = s[i];
+    }
+    return 1;
+}
+
+// ============================================
+// Link: lines with a loss rate and a delay
+// ============================================
+typedef struct {
+    uint32_t at;
+    char line[LINE_MAX];
+} Pipe_Entry_t;
+
+typedef struct {
+    Pipe_Entry_t q[PIPE_MAX];
+    uint32_t head;
+    uint32_t tail;
+} Pipe_t;
+
+static Pipe_t up_pipe;                  // MCU -> bridge
+static Pipe_t down_pipe;                // Bridge -> MCU
+static double loss_up = 0;
+static double loss_down = 0;
+static uint8_t link_down = 0;
+
+static void pipe_put(Pipe_t *p, const char *line, double loss) {
+    Pipe_Entry_t *e;
+
+    if(link_down || rnd() < loss) return;
+    if(p->head - p->tail >= PIPE_MAX) return;
+    e = &p->q[p->head++ % PIPE_MAX];
+    e->at = now_ms + latency_ms;
+    snprintf(e->line, LINE_MAX, "%s", line);
+}
+
+static const char* pipe_get(Pipe_t *p) {
+    Pipe_Entry_t *e;
+
+    if(p->head == p->tail) return NULL;
+    e = &p->q[p->tail % PIPE_MAX];
+    if((int32_t)(now_ms - e->at) < 0) return NULL;
+    p->tail++;
+    return e->line;
+}
+
+// Bytes leave the TX ring at the line rate and are cut into lines
+static char wire_line[LINE_MAX];
+static uint16_t wire_len = 0;
+static uint8_t wire_broken = 0;         // Part of the line went out on a dead link
+static double wire_credit = 0;
+
+static void wire_step(void) {
+    wire_credit += baud / 10.0 / 1000.0;
+    while(wire_credit >= 1.0 && tx_tail != tx_head) {
+        char c = tx_ring[tx_tail++ % UART_TX_RING_SIZE];
+
+        wire_credit -= 1.0;
+        wire_bytes++;
+        wire_broken |= link_down;
+        if(wire_len < LINE_MAX - 1) wire_line[wire_len++] = c;
+        if(c == '\n') {
+            wire_line[wire_len] = '\0';
+            if(!wire_broken) pipe_put(&up_pipe, wire_line, loss_up);
+            wire_len = 0;
+            wire_broken = 0;
+        }
+    }
+    if(tx_tail == tx_head && wire_credit > 1.0) wire_credit = 1.0;   // Idle line
+}
+
+// ============================================
+// Bridge (ESP32) model
+// ============================================
+static uint8_t br_based = 0;
+static uint32_t br_expect = 0;
+static uint32_t br_skipped = 0;
+static uint32_t br_delivered = 0;
+static uint32_t br_bad = 0;             // Out of order or wrong body
+static uint32_t br_dup = 0;             // Delivered again (base lost in a reboot)
+
+static uint32_t submit_ms[MAX_FRAMES];
+static uint32_t deliver_ms[MAX_FRAMES];
+static uint32_t submitted = 0;
+static uint32_t pre_reliable = 0;       // Sent fire-and-forget before the first ACK
+
+static void bridge_ack(void) {
+    char ack[24];
+
+    sprintf(ack, "ACK,%lu\r\n", (unsigned long)(br_expect - 1));
+    pipe_put(&down_pipe, ack, loss_down);
+}
+
+static void bridge_line(const char *line) {
+    const char *s;
+    uint32_t seq;
+
+    if(strncmp(line, "SYNC,", 5) == 0) {
+        seq = (uint32_t)strtoul(line + 5, NULL, 10);
+        if(!br_based) {
+            br_based = 1;
+            br_expect = seq;
+        } else if(seq > br_expect) {
+            // Only frames past the best-effort start count
+            for(uint32_t k = br_expect; k < seq; k++) {
+                if(k > pre_reliable) br_skipped++;
+            }
+            br_expect = seq;
+        }
+        return;
+    }
+
+    s = strstr(line, "{\"seq\":");
+    if(!s) return;
+    seq = (uint32_t)strtoul(s + 7, NULL, 10);
+    if(!br_based) {
+        br_based = 1;
+        br_expect = seq;
+    }
+
+    if(seq == br_expect) {
+        const char *id = strstr(line, "\"id\":");
+
+        // Frame k was submitted k-th and carries its own index
+        if(seq == 0 || seq > submitted || !id || strtoul(id + 5, NULL, 10) != seq) {
+            br_bad++;
+        } else if(deliver_ms[seq - 1]) {
+            br_dup++;
+        } else {
+            deliver_ms[seq - 1] = now_ms;
+        }
+        br_delivered++;
+        br_expect++;
+    }
+    bridge_ack();
+}
+
+static void bridge_reboot(void) {
+    br_based = 0;
+}
+
+// ============================================
+// Scenario driver
+// ============================================
+static void submit_frame(void) {
+    char frame[LINE_MAX];
+    uint16_t n;
+
+    if(submitted >= MAX_FRAMES) return;
+    n = (uint16_t)sprintf(frame, "SCAN,{\"id\":%lu,\"pad\":\"%.*s\"}\r\n",
+                          (unsigned long)(submitted + 1), FRAME_PAD,
+                          "................................................................"
+                          "................................................................");
+    submit_ms[submitted] = now_ms;
+    deliver_ms[submitted] = 0;
+    submitted++;
+    uplink_submit(frame, n);
+}
+
+static void step(void) {
+    const char *line;
+
+    now_ms++;
+    if(!uplink_stats.reliable) pre_reliable = submitted;
+    wire_step();
+    while((line = pipe_get(&up_pipe)) != NULL) {
+        bridge_line(line);
+    }
+    while((line = pipe_get(&down_pipe)) != NULL) {
+        if(strncmp(line, "ACK,", 4) == 0) {
+            uplink_ack((uint32_t)strtoul(line + 4, NULL, 10), now_ms);
+        }
+    }
+    if(now_ms % SERVICE_MS == 0) uplink_service(now_ms);
+}
+
+static void reset(double up, double down) {
+    uplink_init();
+    memset(&up_pipe, 0, sizeof(up_pipe));
+    memset(&down_pipe, 0, sizeof(down_pipe));
+    tx_head = tx_tail = 0;
+    wire_len = 0;
+    wire_broken = 0;
+    wire_credit = 0;
+    wire_bytes = 0;
+    loss_up = up;
+    loss_down = down;
+    link_down = 0;
+    br_based = 0;
+    br_skipped = br_delivered = br_bad = br_dup = 0;
+    submitted = 0;
+    pre_reliable = 0;
+    now_ms = 1000;
+}
+
+// Until the backlog is delivered or the limit passes
+static void drain(uint32_t limit_ms) {
+    uint32_t end = now_ms + limit_ms;
+
+    while(now_ms < end && (uplink_stats.backlog || tx_head != tx_tail ||
+          up_pipe.head != up_pipe.tail || down_pipe.head != down_pipe.tail)) {
+        step();
+    }
+}
+
+static uint32_t fail = 0;
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Delivery latency percentiles over delivered frames
+static void latency(uint32_t *p50, uint32_t *p99) {
+    static uint32_t lat[MAX_FRAMES];
+    uint32_t n = 0;
+
+    for(uint32_t i = 0; i < submitted; i++) {
+        if(deliver_ms[i]) lat[n++] = deliver_ms[i] - submit_ms[i];
+    }
+    qsort(lat, n, sizeof(uint32_t), cmp_u32);
+    *p50 = n ? lat[n / 2] : 0;
+    *p99 = n ? lat[(n * 99) / 100] : 0;
+}
+
+// Every frame delivered in order, or evicted (lost counts evictions before
+// an ACK, some of which had arrived) and skipped by SYNC. A rebooted bridge
+// cannot skip or drop what it saw before, so there the check is missing <=
+// lost and repeats are allowed. Frames before the first ACK are best effort.
+static uint8_t check_stream(uint8_t rebooted) {
+    uint8_t bad = 0;
+    uint32_t missing = 0;
+
+    for(uint32_t i = pre_reliable; i < submitted; i++) {
+        if(!deliver_ms[i]) missing++;
+    }
+
+    if(br_bad || (br_dup && !rebooted)) {
+        printf("  FAIL %u frames out of order or with the wrong body, %u repeated\n",
+               br_bad, br_dup);
+        bad = 1;
+    }
+    if(missing > uplink_stats.lost) {
+        printf("  FAIL %u frames after the first ACK missing, uplink counted %lu lost\n",
+               missing, (unsigned long)uplink_stats.lost);
+        bad = 1;
+    }
+    if(!rebooted && missing != br_skipped) {
+        printf("  FAIL %u frames missing, bridge skipped %u\n", missing, br_skipped);
+        bad = 1;
+    }
+    return bad;
+}
+
+// ============================================
+// Loss: steady load
+// ============================================
+static void test_loss(void) {
+    static const double rates[] = { 0, 0.01, 0.05, 0.10, 0.20 };
+
+    printf("loss      %u frames/s for %us, %lu baud, %lums each way\n",
+           LOAD_FPS, LOAD_SECONDS, (unsigned long)baud, (unsigned long)latency_ms);
+    printf("  %-6s %9s %8s %8s %8s %8s %8s\n",
+           "loss", "delivered", "retx", "timeout", "fast", "p50 ms", "p99 ms");
+
+    for(uint8_t k = 0; k < sizeof(rates) / sizeof(rates[0]); k++) {
+        uint32_t p50, p99;
+        uint8_t bad;
+
+        reset(rates[k], rates[k]);
+        while(now_ms < 1000 + LOAD_SECONDS * 1000) {
+            if(now_ms % (1000 / LOAD_FPS) == 0) submit_frame();
+            step();
+        }
+        drain(60000);
+        latency(&p50, &p99);
+
+        // Past 10% the RTO backs off long enough for the buffer to overflow
+        bad = check_stream(0) || (rates[k] <= 0.10 && uplink_stats.lost != 0);
+        printf("  %4.0f%% %9u %8lu %8lu %8lu %8u %8u%s\n", 100 * rates[k], br_delivered,
+               (unsigned long)uplink_stats.retransmits, (unsigned long)uplink_stats.timeouts,
+               (unsigned long)uplink_stats.fast_retransmits, p50, p99, bad ? "  FAIL" : "");
+        fail += bad;
+    }
+}
+
+// ============================================
+// Bulk: window kept full
+// ============================================
+static void test_bulk(void) {
+    static const double rates[] = { 0, 0.01, 0.05 };
+    const uint32_t seconds = 30;
+    double frame_bytes = 0;
+    double line_fps, win_fps, saw_fps;
+
+    printf("\nbulk      backlog kept at %u frames for %us\n", 2 * UPLINK_WINDOW, seconds);
+    printf("  %-6s %10s %10s %10s %10s %10s\n",
+           "loss", "frames/s", "line rate", "window", "stop-wait", "wire eff");
+
+    for(uint8_t k = 0; k < sizeof(rates) / sizeof(rates[0]); k++) {
+        uint32_t t0;
+        uint32_t d0;
+        double fps, rtt;
+        uint8_t bad;
+
+        reset(rates[k], rates[k]);
+        submit_frame();
+        frame_bytes = (double)(tx_head - tx_tail);
+
+        // Until the bridge has ACKed once (the first frames may be lost)
+        while(!uplink_stats.reliable) {
+            if(now_ms % (1000 / LOAD_FPS) == 0) submit_frame();
+            step();
+        }
+        t0 = now_ms;
+        d0 = br_delivered;
+        while(now_ms < t0 + seconds * 1000) {
+            while(uplink_stats.backlog < 2 * UPLINK_WINDOW) submit_frame();
+            step();
+        }
+        fps = (br_delivered - d0) * 1000.0 / (now_ms - t0);
+        drain(60000);
+
+        // Line rate: frames back to back. Window: UPLINK_WINDOW per round
+        // trip. Stop-and-wait: one per round trip, plus an RTO for every
+        // lost frame or ACK
+        rtt = 2.0 * latency_ms + frame_bytes * 10000.0 / baud + SERVICE_MS / 2.0;
+        line_fps = baud / 10.0 / frame_bytes;
+        win_fps = UPLINK_WINDOW * 1000.0 / rtt;
+        saw_fps = 1000.0 / (rtt + (1.0 / ((1 - rates[k]) * (1 - rates[k])) - 1.0) * UPLINK_RTO_MS);
+
+        bad = check_stream(0) || uplink_stats.lost != 0 ||
+              (rates[k] == 0 && fps < 0.8 * fmin(line_fps, win_fps)) || fps < saw_fps;
+        printf("  %4.0f%% %10.1f %10.1f %10.1f %10.1f %9.0f%%%s\n", 100 * rates[k], fps,
+               line_fps, win_fps, saw_fps, 100.0 * br_delivered * frame_bytes / wire_bytes,
+               bad ? "  FAIL" : "");
+        fail += bad;
+    }
+}
+
+// ============================================
+// Outage: link down, optional bridge reboot
+// ============================================
+static void test_outage(void) {
+    static const struct { uint32_t ms; uint8_t reboot; } cases[] = {
+        { 5000, 0 }, { 5000, 1 }, { 30000, 0 }, { 30000, 1 }
+    };
+
+    printf("\noutage    %u frames/s, link down after 20 s\n", LOAD_FPS);
+    printf("  %-14s %8s %8s %8s %8s %12s %10s\n",
+           "down", "backlog", "lost", "repeats", "rto ms", "recovery ms", "limit ms");
+
+    for(uint8_t k = 0; k < sizeof(cases) / sizeof(cases[0]); k++) {
+        uint32_t up_at, head_at_up, backlog_at_up, rto_at_up;
+        uint32_t recovered = 0;
+        uint32_t limit;
+        uint8_t bad;
+
+        reset(0.01, 0.01);
+        while(now_ms < 21000) {
+            if(now_ms % (1000 / LOAD_FPS) == 0) submit_frame();
+            step();
+        }
+
+        link_down = 1;
+        if(cases[k].reboot) bridge_reboot();
+        while(now_ms < 21000 + cases[k].ms) {
+            if(now_ms % (1000 / LOAD_FPS) == 0) submit_frame();
+            step();
+        }
+
+        // Lines queued on the dead link are gone
+        link_down = 0;
+        up_pipe.tail = up_pipe.head;
+        down_pipe.tail = down_pipe.head;
+        up_at = now_ms;
+        head_at_up = submitted;
+        backlog_at_up = uplink_stats.backlog;
+        rto_at_up = uplink_stats.rto_ms;
+
+        while(now_ms < up_at + 60000) {
+            if(now_ms % (1000 / LOAD_FPS) == 0) submit_frame();
+            step();
+            if(!recovered && br_based && br_expect > head_at_up) {
+                recovered = now_ms - up_at;
+            }
+        }
+        drain(60000);
+
+        // One RTO of polling, then the backlog at the line rate
+        limit = rto_at_up + (uint32_t)(backlog_at_up * FRAME_WIRE_MAX * 10000.0 / baud) +
+                4 * latency_ms + 1000;
+        bad = check_stream(cases[k].reboot) || !recovered || recovered > limit ||
+              (cases[k].ms < 10000 && uplink_stats.lost != 0);
+        printf("  %5.0fs%-8s %8u %8lu %8u %8u %12u %10u%s\n", cases[k].ms / 1000.0,
+               cases[k].reboot ? " reboot" : "", backlog_at_up, (unsigned long)uplink_stats.lost,
+               br_dup, rto_at_up, recovered, limit, bad ? "  FAIL" : "");
+        fail += bad;
+    }
+}
+
+// ============================================
+// Main
+// ============================================
+int main(int argc, char **argv) {
+    if(argc > 1) rng_state ^= (uint64_t)atoi(argv[1]) * 0x2545F4914F6CDD1DULL;
+    if(argc > 2) baud = (uint32_t)atoi(argv[2]);
+    if(argc > 3) latency_ms = (uint32_t)atoi(argv[3]);
+
+    test_loss();
+    test_bulk();
+    test_outage();
+
+    printf("%s\n", fail ? "FAIL" : "PASS");
+    return fail ? 1 : 0;
+}
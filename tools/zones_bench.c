@@ -0,0 +1,326 @@
+/*
+ * ============================================
+ * ZONE GRAPH BENCHMARK
+ * Runs the real src-codes/ZONES.c and ACCESS.c
+ * on the host over a 64-zone venue: the street
+ * (zone 0) and 63 nested zones in a binary tree
+ * six levels deep, one reader per door plus an
+ * emergency door from the deepest zone straight
+ * to the street (64 readers).
+ *
+ * Cards walk the graph: each scan is a random
+ * card at a random door of its current zone, as
+ * main.c routes it (zones_route -> access_entry
+ * / access_exit). A share of scans are at a
+ * random reader instead (missed read, tailgate)
+ * and must be rejected by the graph.
+ * Checks:
+ *   - every zone count equals a recount of the
+ *     card zone bytes, at every checkpoint
+ *   - no capacity is exceeded
+ *   - every card move is between adjacent zones
+ *   - rejected scans match the model exactly
+ *   - ZONE_STATUS frames list all 63 zones and
+ *     are well formed with full-length names and
+ *     5-digit counts
+ * The same walk on a 2-zone and a 16-zone venue
+ * shows the per-scan cost does not grow with the
+ * graph (16 vs 64 zones is checked; the 2-zone
+ * room has a different move mix); a recount over
+ * the cards (the cost without kept counts) is
+ * timed alongside.
+ *
+ * Build (from the repo root):
+ *   gcc -O2 -Isrc-codes tools/zones_bench.c src-codes/ZONES.c \
+ *       src-codes/ACCESS.c src-codes/FLOWRATE.c -lm -o zones_bench
+ *
+ * Usage:
+ *   zones_bench [scans] [seed]
+ *
+ * Exit status 1 on any FAIL.
+ * ============================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "ZONES.h"
+#include "ACCESS.h"
+
+#define BENCH_CARDS     20000
+#define BENCH_STRAY_PCT 2               // Scans at a random reader
+#define BENCH_CHECKS    16              // Recount checkpoints per run
+
+// ============================================
+// Firmware stubs + frame capture
+// ============================================
+static uint32_t frame_count = 0;
+static uint32_t frame_bad = 0;
+static uint32_t frame_zones = 0;
+static uint32_t frame_max_len = 0;
+
+uint32_t millis(void) { return 0; }
+void delay_ms(uint32_t ms) { (void)ms; }
+void delay_us(uint32_t us) { (void)us; }
+
+void uart_dual_send_string(const char *s) {
+    uint32_t len = (uint32_t)strlen(s);
+    const char *p = s;
+
+    if(strncmp(s, "STATUS,{\"type\":\"ZONE_STATUS\"", 28) != 0) return;
+    frame_count++;
+    if(len > frame_max_len) frame_max_len = len;
+    if(len < 4 || strcmp(s + len - 4, "]}\r\n") != 0) frame_bad++;
+    while((p = strstr(p, "{\"id\":")) != NULL) {
+        frame_zones++;
+        p++;
+    }
+}
+
+// ============================================
+// Random numbers (xorshift64*)
+// ============================================
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t rnd(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (uint32_t)((rng_state * 2685821657736338717ULL) >> 32);
+}
+
+static uint64_t ns_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// ============================================
+// Venue: binary tree of n-1 zones under the street
+// Zone z > 1 hangs off z / 2 through reader z - 1;
+// zone 1 off the street through reader 0.
+// ============================================
+typedef struct {
+    uint8_t from;
+    uint8_t to;
+} Door_t;
+
+static Door_t doors[ZONE_READER_MAX];
+static uint8_t n_doors;
+static uint8_t zone_doors_of[ZONE_MAX][4];      // Readers touching each zone
+static uint8_t zone_door_n[ZONE_MAX];
+static uint16_t capacity[ZONE_MAX];
+
+static Card_t walkers[BENCH_CARDS];
+
+static void door_add(uint8_t from, uint8_t to) {
+    uint8_t r = n_doors++;
+
+    doors[r].from = from;
+    doors[r].to = to;
+    zone_doors_of[from][zone_door_n[from]++] = r;
+    zone_doors_of[to][zone_door_n[to]++] = r;
+    zones_add_door(r, from, to);
+}
+
+static void venue_build(uint8_t n_zones) {
+    char name[ZONE_NAME_LEN];
+
+    zones_init();
+    access_reset();
+    memset(zone_door_n, 0, sizeof(zone_door_n));
+    n_doors = 0;
+
+    for(uint8_t z = 1; z < n_zones; z++) {
+        // Full-length names; leaves small enough to fill up now and then
+        snprintf(name, sizeof(name), "ZONE-%06u", z);
+        capacity[z] = (2 * z >= n_zones) ? BENCH_CARDS / n_zones : ZONE_NO_LIMIT;
+        zones_define(z, name, capacity[z]);
+    }
+    door_add(ZONE_OUTSIDE, 1);
+    for(uint8_t z = 2; z < n_zones; z++) {
+        door_add(z / 2, z);
+    }
+    if(n_zones > 2) door_add(ZONE_OUTSIDE, n_zones - 1);     // Emergency door
+
+    memset(walkers, 0, sizeof(walkers));
+    for(uint32_t i = 0; i < BENCH_CARDS; i++) {
+        walkers[i].zone = ZONE_OUTSIDE;
+    }
+}
+
+// ============================================
+// Scan trace: card, door choice, stray reader
+// ============================================
+typedef struct {
+    uint16_t card;
+    uint8_t pick;                       // Door of the card's zone (mod its door count)
+    uint8_t stray;                      // Reader to scan at, or 0xFF for a real door
+} Scan_t;
+
+static Scan_t *trace;
+
+static void trace_build(uint32_t n) {
+    for(uint32_t i = 0; i < n; i++) {
+        trace[i].card = (uint16_t)(rnd() % BENCH_CARDS);
+        trace[i].pick = (uint8_t)rnd();
+        trace[i].stray = (rnd() % 100 < BENCH_STRAY_PCT) ? (uint8_t)(rnd() % ZONE_READER_MAX) : 0xFF;
+    }
+}
+
+static inline uint8_t scan_reader(const Scan_t *s) {
+    uint8_t z = walkers[s->card].zone;
+
+    if(s->stray != 0xFF) return s->stray;
+    return zone_doors_of[z][s->pick % zone_door_n[z]];
+}
+
+// One scan as main.c handles it
+static inline uint8_t scan_once(uint8_t reader, Card_t *card) {
+    uint8_t to;
+    ZoneMove_t move = zones_route(reader, card->zone, &to);
+
+    if(move == ZONE_MOVE_IN) return access_entry(card, to, 0);
+    if(move == ZONE_MOVE_OUT) return access_exit(card, to, 0);
+    return 0;
+}
+
+// ============================================
+// Checked run (model) and timed run
+// ============================================
+static uint32_t fail = 0;
+
+static void recount(uint32_t *ref) {
+    memset(ref, 0, ZONE_MAX * sizeof(uint32_t));
+    for(uint32_t i = 0; i < BENCH_CARDS; i++) {
+        ref[walkers[i].zone]++;
+    }
+}
+
+static void run_checked(uint8_t n_zones, uint32_t n) {
+    uint32_t ref[ZONE_MAX];
+    uint32_t bad_count = 0, bad_cap = 0, bad_edge = 0;
+    uint32_t model_invalid = 0;
+
+    for(uint32_t i = 0; i < n; i++) {
+        const Scan_t *s = &trace[i];
+        Card_t *card = &walkers[s->card];
+        uint8_t reader = scan_reader(s);
+        uint8_t before = card->zone;
+
+        if(reader >= n_doors || (doors[reader].from != before && doors[reader].to != before)) {
+            model_invalid++;
+        }
+        scan_once(reader, card);
+        if(card->zone != before && !zones_adjacent(before, card->zone)) bad_edge++;
+
+        if((i + 1) % (n / BENCH_CHECKS) == 0 || i + 1 == n) {
+            recount(ref);
+            for(uint8_t z = 1; z < n_zones; z++) {
+                if(zones[z].count != ref[z]) bad_count++;
+                if(capacity[z] && zones[z].count > capacity[z]) bad_cap++;
+            }
+            if(access_counts.inside != (int32_t)(BENCH_CARDS - ref[ZONE_OUTSIDE])) bad_count++;
+        }
+    }
+
+    if(bad_count) printf("  FAIL %u zone counts differ from the card recount\n", bad_count);
+    if(bad_cap) printf("  FAIL %u zones over capacity\n", bad_cap);
+    if(bad_edge) printf("  FAIL %u moves between zones with no door\n", bad_edge);
+    if(zones_stats.invalid != model_invalid) {
+        printf("  FAIL %u scans rejected, model expects %u\n", zones_stats.invalid, model_invalid);
+        fail++;
+    }
+    fail += bad_count + bad_cap + bad_edge;
+}
+
+static double run_timed(uint32_t n) {
+    uint64_t t0 = ns_now();
+    volatile uint32_t sink = 0;
+
+    for(uint32_t i = 0; i < n; i++) {
+        const Scan_t *s = &trace[i];
+        sink += scan_once(scan_reader(s), &walkers[s->card]);
+    }
+    (void)sink;
+    return (double)(ns_now() - t0) / n;
+}
+
+// Occupancy of every zone without kept counts: one pass over the cards
+static double recount_ns(uint8_t n_zones) {
+    uint32_t ref[ZONE_MAX];
+    const uint32_t rounds = 50;
+    volatile uint32_t sink = 0;
+    uint64_t t0 = ns_now();
+
+    for(uint32_t r = 0; r < rounds; r++) {
+        recount(ref);
+        sink += ref[r % n_zones];
+    }
+    (void)sink;
+    return (double)(ns_now() - t0) / rounds;
+}
+
+// ============================================
+// Main
+// ============================================
+int main(int argc, char **argv) {
+    static const uint8_t sizes[] = { 2, 16, ZONE_MAX };
+    uint32_t n = 2000000;
+    double per_scan[3];
+
+    if(argc > 1) n = (uint32_t)atoi(argv[1]);
+    if(argc > 2) rng_state ^= (uint64_t)atoi(argv[2]) * 0x2545F4914F6CDD1DULL;
+    if(n < BENCH_CHECKS) n = BENCH_CHECKS;
+
+    trace = malloc(n * sizeof(Scan_t));
+    if(!trace) return 2;
+    trace_build(n);
+
+    printf("%u cards, %u scans, %u%% at a stray reader\n\n", BENCH_CARDS, n, BENCH_STRAY_PCT);
+    printf("%-6s %-6s %10s %10s %10s %8s %12s\n",
+           "zones", "doors", "moves", "rejected", "full", "ns/scan", "recount ns");
+
+    for(uint8_t k = 0; k < 3; k++) {
+        uint8_t nz = sizes[k];
+        uint32_t fail_before = fail;
+
+        venue_build(nz);
+        run_checked(nz, n);
+        printf("%-6u %-6u %10u %10u %10u", nz, n_doors,
+               zones_stats.moves, zones_stats.invalid, zones_stats.full);
+
+        // Timed on a fresh venue over the same trace
+        venue_build(nz);
+        per_scan[k] = run_timed(n);
+        printf(" %8.1f %12.0f%s\n", per_scan[k], recount_ns(nz), fail != fail_before ? "  FAIL" : "");
+    }
+
+    // Per-scan cost flat from 16 to 64 zones (allow timer noise)
+    if(per_scan[2] > 1.5 * per_scan[1] + 5.0) {
+        printf("  FAIL per-scan cost grows with the venue (%.1f ns at 16 zones, %.1f at 64)\n",
+               per_scan[1], per_scan[2]);
+        fail++;
+    }
+
+    // ZONE_STATUS with every zone defined and 5-digit counts
+    for(uint8_t z = 1; z < ZONE_MAX; z++) {
+        zones[z].count = 65535;
+        zones[z].capacity = 65535;
+    }
+    zones_report();
+    printf("\nZONE_STATUS %u frames, %u zones, longest %u bytes\n",
+           frame_count, frame_zones, frame_max_len);
+    if(frame_zones != ZONE_MAX - 1 || frame_bad ||
+       frame_count != (ZONE_MAX - 1 + ZONE_REPORT_CHUNK - 1) / ZONE_REPORT_CHUNK) {
+        printf("  FAIL ZONE_STATUS frames malformed or incomplete\n");
+        fail++;
+    }
+
+    free(trace);
+    printf("%s\n", fail ? "FAIL" : "PASS");
+    return fail ? 1 : 0;
+}